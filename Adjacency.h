@@ -0,0 +1,672 @@
+#ifndef __ADJACENCY_H
+#define __ADJACENCY_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include "Exceptions.h"
+#include "MemoryUsage.h"
+#include "ThreadPool.h"
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+
+/// @file Adjacency.h
+/// @brief Contains the Adjacency class used by the Edges to look up edges by their source and
+///  target, its thresholds and their member function definitions
+
+
+/// @brief The thresholds at which the adjacency switches between its dense and sparse
+///  representation, the gap between sparse_below and dense_above prevents switching back and forth
+struct AdjacencyThresholds {
+    /// @brief The density (entries / nodes^2) under which the dense matrix becomes sparse rows
+    double sparse_below = 0.05;
+
+    /// @brief The density (entries / nodes^2) over which the sparse rows become a dense matrix
+    double dense_above = 0.25;
+
+    /// @brief The number of nodes under which the adjacency always stays dense
+    size_t min_sparse_nodes = 64;
+};
+
+/// @brief The adjacency of the graph, [x][y] is the id of the edge from x to y if it exists,
+///  NONE otherwise; stored either as a dense matrix or as sparse rows sorted by target,
+///  depending on the current density. Copies share the rows until one of them writes to a row,
+///  so copying costs a pointer per row; the ids stay right whichever copy of the edges they
+///  are looked up in
+class Adjacency {
+public:
+    /// @brief The entry of a source and target without an edge
+    static constexpr size_t NONE = SIZE_MAX;
+
+    /// @brief Constructs an empty adjacency with the default thresholds
+    Adjacency() = default;
+
+    /// @brief Get the number of nodes (rows and columns) of the adjacency
+    /// @return The number of nodes
+    size_t size() const;
+
+    /// @brief Get the number of entries of the adjacency
+    /// @return The number of entries
+    size_t entry_count() const;
+
+    /// @brief Get the current density of the adjacency
+    /// @return The number of entries divided by the number of cells
+    double density() const;
+
+    /// @brief Returns if the adjacency is currently stored as a dense matrix
+    /// @return True if stored as a dense matrix, false if stored as sparse rows
+    bool is_dense() const;
+
+    /// @brief Get the thresholds used for switching the representation
+    /// @return The thresholds
+    const AdjacencyThresholds& thresholds() const;
+
+    /// @brief Set the thresholds used for switching the representation and switch right away
+    ///  if the current density calls for it
+    /// @param thresholds The new thresholds
+    /// @exception InvalidArgumentException If the thresholds do not leave a gap between
+    ///  sparse_below and dense_above
+    void set_thresholds(const AdjacencyThresholds& thresholds);
+
+    /// @brief Gets the entry at the given source and target, expects both to be in range
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    /// @return The id of the edge, NONE if there is none
+    size_t find(size_t source, size_t target) const;
+
+    /// @brief Hints the processor to start loading the row of the given source, the first thing
+    ///  find reads; expects the source to be in range. Issued a few lookups before prefetch, the
+    ///  row is there by the time prefetch needs it
+    /// @param source The id of the source node
+    void prefetch_row(size_t source) const noexcept;
+
+    /// @brief Hints the processor to start loading what find reads for the given source and
+    ///  target, the entry of a dense row or the middle of a sparse one; expects both to be in
+    ///  range. Issued a few lookups ahead, it overlaps their cache misses
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    void prefetch(size_t source, size_t target) const noexcept;
+
+    /// @brief Calls the given function for every entry in the row of the given source node,
+    ///  in the order of increasing target ids, expects the source to be in range
+    /// @tparam Function A callable taking the id of the target node and the id of the edge
+    /// @param source The id of the source node
+    /// @param function The function to call
+    template <typename Function>
+    void for_each_neighbor(size_t source, Function function) const;
+
+    /// @brief Get the source and target of every entry, ordered by source and then by target
+    /// @return The pairs of source and target ids
+    std::vector<std::pair<size_t, size_t>> entries() const;
+
+    /// @brief Sets the entry at the given source and target, expects both to be in range
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    /// @param edge The id of the edge
+    /// @exception UnavailableMemoryException If a sparse row cannot grow or a shared row cannot
+    ///  be copied
+    void set(size_t source, size_t target, size_t edge);
+
+    /// @brief Removes the entry at the given source and target, expects both to be in range and
+    ///  the entry, if there is one, to have been set since the adjacency was last copied;
+    ///  never switches the representation and never throws
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    void clear(size_t source, size_t target) noexcept;
+
+    /// @brief Grows the adjacency by one new node, with no new entries
+    /// @exception UnavailableMemoryException If there isn't enough memory to grow
+    void grow();
+
+    /// @brief Grows the adjacency by many new nodes at once, with no new entries; every dense
+    ///  row is resized only once
+    /// @param count The number of new nodes
+    /// @exception UnavailableMemoryException If there isn't enough memory to grow, the adjacency
+    ///  is left as it was
+    void grow(size_t count);
+
+    /// @brief Shrinks the adjacency back to the given number of nodes, expects the entries of the
+    ///  removed nodes to be cleared already and the adjacency to have grown since it was last
+    ///  copied, so the dense rows are not shared
+    /// @param nodes The number of nodes to keep
+    void truncate(size_t nodes) noexcept;
+
+    /// @brief Discards all entries and resizes the adjacency to the given number of nodes,
+    ///  choosing the representation from the number of entries that are about to be set;
+    ///  dense rows are allocated and zeroed by the threads of the pool, so on NUMA machines
+    ///  every row lands on the node of the thread that touched it first
+    /// @param nodes The number of nodes
+    /// @param expected_entries The number of entries that will be set afterwards
+    /// @param pool The thread pool to run on
+    /// @exception UnavailableMemoryException If there isn't enough memory
+    void reset(size_t nodes, size_t expected_entries, ThreadPool& pool = ThreadPool::global());
+
+    /// @brief Sets the entries of many edges at once in parallel, expects a freshly reset
+    ///  adjacency and edges with distinct sources and targets that are in range; the endpoints
+    ///  come from columns indexed by edge id, so the edges themselves are never read
+    /// @tparam Column A column of node ids indexed by edge id with a size(), like
+    ///  my_array::Array<size_t> or std::vector<size_t>, safe to read from several threads
+    /// @param sources The id of the source node of every edge
+    /// @param targets The id of the target node of every edge
+    /// @param mirrored True to also set the entry from the target to the source
+    /// @param pool The thread pool to run on
+    /// @exception UnavailableMemoryException If there isn't enough memory, the adjacency has
+    ///  to be reset afterwards
+    template <typename Column>
+    void fill(const Column& sources, const Column& targets, bool mirrored,
+        ThreadPool& pool = ThreadPool::global());
+
+    /// @brief Reallocates a row on the calling thread, so on NUMA machines it lands on the node
+    ///  of that thread; the row is left where it was if there isn't enough memory
+    /// @param source The id of the source node of the row
+    void rehome_row(size_t source) noexcept;
+
+    /// @brief Adds the memory used by the adjacency to the adjacency, slack and shared of the
+    ///  given breakdown: the table of the rows and the rows with their headers, the spare
+    ///  capacity of both as slack; walks the rows but never the entries, rows shared with
+    ///  copies are counted by each of them and as shared
+    /// @param usage The breakdown to add to
+    void memory_usage(MemoryUsage& usage) const;
+
+private:
+    /// @brief A dense row, the edge id of every target id
+    using DenseRow = std::vector<size_t>;
+
+    /// @brief A sparse row, pairs of target id and edge id sorted by the target id
+    using SparseRow = std::vector<std::pair<size_t, size_t>>;
+
+    /// @brief Get a dense row the adjacency can write to, copying it if it is shared
+    /// @param source The id of the source node of the row
+    /// @return The row
+    /// @exception std::bad_alloc If the row cannot be copied
+    DenseRow& own_dense_row_(size_t source);
+
+    /// @brief Get a sparse row the adjacency can write to, allocating it if it is empty and
+    ///  copying it if it is shared
+    /// @param source The id of the source node of the row
+    /// @return The row
+    /// @exception std::bad_alloc If the row cannot be allocated or copied
+    SparseRow& own_sparse_row_(size_t source);
+
+    /// @brief Tests if a row is shared with a copy
+    /// @tparam Row The type of the row
+    /// @param row The row
+    /// @return True if the row is shared
+    template <typename Row>
+    static bool shared_(const std::shared_ptr<Row>& row);
+
+    /// @brief Adds the memory used by the table of the rows and by the rows to a breakdown, see
+    ///  memory_usage
+    /// @tparam Row The type of the rows
+    /// @param rows The table of the rows
+    /// @param usage The breakdown to add to
+    template <typename Row>
+    static void memory_usage_(const std::vector<std::shared_ptr<Row>>& rows, MemoryUsage& usage);
+
+    /// @brief Tests if the given shape should be stored as sparse rows when currently dense
+    /// @param nodes The number of nodes
+    /// @param entries The number of entries
+    /// @return True if the dense matrix should become sparse rows
+    bool should_become_sparse_(size_t nodes, size_t entries) const;
+
+    /// @brief Tests if the given shape should be stored as a dense matrix when currently sparse
+    /// @param nodes The number of nodes
+    /// @param entries The number of entries
+    /// @return True if the sparse rows should become a dense matrix
+    bool should_become_dense_(size_t nodes, size_t entries) const;
+
+    /// @brief Switches the representation if the current density calls for it,
+    ///  keeps the current representation if the other one cannot be allocated
+    void rebalance_() noexcept;
+
+    /// @brief Moves the entries from the dense matrix into sparse rows
+    /// @exception std::bad_alloc If the sparse rows cannot be allocated
+    void to_sparse_();
+
+    /// @brief Moves the entries from the sparse rows into the dense matrix
+    /// @exception std::bad_alloc If the dense matrix cannot be allocated
+    void to_dense_();
+
+    /// @brief Finds the position of the target inside a sparse row
+    /// @param row The sparse row
+    /// @param target The id of the target node
+    /// @return The iterator to the first pair with target not less than the given one
+    static typename SparseRow::const_iterator lower_bound_(const SparseRow& row, size_t target);
+
+    /// @brief Hints the processor to start loading the cache line of an address
+    /// @param address The address
+    static void prefetch_(const void* address) noexcept;
+
+    /// @brief The rows of the dense matrix, only used while dense_ is true; never nullptr
+    std::vector<std::shared_ptr<DenseRow>> matrix_;
+
+    /// @brief The sparse rows, only used while dense_ is false; nullptr for an empty row
+    std::vector<std::shared_ptr<SparseRow>> rows_;
+
+    /// @brief True if stored as a dense matrix, false if stored as sparse rows
+    bool dense_ = true;
+
+    /// @brief The number of nodes
+    size_t size_ = 0;
+
+    /// @brief The number of entries
+    size_t entry_count_ = 0;
+
+    /// @brief The thresholds used for switching the representation
+    AdjacencyThresholds thresholds_;
+};
+
+inline size_t Adjacency::size() const {
+    return size_;
+}
+
+inline size_t Adjacency::entry_count() const {
+    return entry_count_;
+}
+
+inline double Adjacency::density() const {
+    if (size_ == 0) return 0;
+    return static_cast<double>(entry_count_) / (static_cast<double>(size_) * size_);
+}
+
+inline bool Adjacency::is_dense() const {
+    return dense_;
+}
+
+inline const AdjacencyThresholds& Adjacency::thresholds() const {
+    return thresholds_;
+}
+
+inline void Adjacency::set_thresholds(const AdjacencyThresholds& thresholds) {
+    if (!(thresholds.sparse_below < thresholds.dense_above))
+        throw InvalidArgumentException::adjacency_thresholds_without_gap
+        (thresholds.sparse_below, thresholds.dense_above);
+    thresholds_ = thresholds;
+    rebalance_();
+}
+
+inline bool Adjacency::should_become_sparse_(size_t nodes, size_t entries) const {
+    if (nodes < thresholds_.min_sparse_nodes) return false;
+    double cells = static_cast<double>(nodes) * nodes;
+    return static_cast<double>(entries) < thresholds_.sparse_below * cells;
+}
+
+inline bool Adjacency::should_become_dense_(size_t nodes, size_t entries) const {
+    if (nodes < thresholds_.min_sparse_nodes) return true;
+    double cells = static_cast<double>(nodes) * nodes;
+    return static_cast<double>(entries) > thresholds_.dense_above * cells;
+}
+
+inline void Adjacency::rebalance_() noexcept {
+    try {
+        if (dense_ && should_become_sparse_(size_, entry_count_)) to_sparse_();
+        else if (!dense_ && should_become_dense_(size_, entry_count_)) to_dense_();
+    }
+    catch (...) {
+        // switching is only an optimization, both representations answer the same way
+    }
+}
+
+inline void Adjacency::to_sparse_() {
+    std::vector<std::shared_ptr<SparseRow>> rows(size_);
+    for (size_t i = 0; i < size_; i++) {
+        const DenseRow& row = *matrix_[i];
+        SparseRow sparse;
+        for (size_t j = 0; j < size_; j++) {
+            if (row[j] != NONE) sparse.emplace_back(j, row[j]);
+        }
+        if (!sparse.empty()) rows[i] = std::make_shared<SparseRow>(std::move(sparse));
+    }
+    rows_ = std::move(rows);
+    matrix_ = std::vector<std::shared_ptr<DenseRow>>();
+    dense_ = false;
+}
+
+inline void Adjacency::to_dense_() {
+    std::vector<std::shared_ptr<DenseRow>> matrix;
+    matrix.reserve(size_);
+    for (size_t i = 0; i < size_; i++) {
+        matrix.push_back(std::make_shared<DenseRow>(size_, NONE));
+        if (rows_[i] == nullptr) continue;
+        for (const auto& entry : *rows_[i]) {
+            (*matrix[i])[entry.first] = entry.second;
+        }
+    }
+    matrix_ = std::move(matrix);
+    rows_ = std::vector<std::shared_ptr<SparseRow>>();
+    dense_ = true;
+}
+
+template <typename Row>
+bool Adjacency::shared_(const std::shared_ptr<Row>& row) {
+    if (row.use_count() > 1) return true;
+    // pairs with the release of the copy that let go of the row last,
+    // so writing to the row happens after its reads
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return false;
+}
+
+inline Adjacency::DenseRow& Adjacency::own_dense_row_(size_t source) {
+    std::shared_ptr<DenseRow>& row = matrix_[source];
+    if (shared_(row)) row = std::make_shared<DenseRow>(*row);
+    return *row;
+}
+
+inline Adjacency::SparseRow& Adjacency::own_sparse_row_(size_t source) {
+    std::shared_ptr<SparseRow>& row = rows_[source];
+    if (row == nullptr) row = std::make_shared<SparseRow>();
+    else if (shared_(row)) row = std::make_shared<SparseRow>(*row);
+    return *row;
+}
+
+inline Adjacency::SparseRow::const_iterator Adjacency::lower_bound_(const SparseRow& row,
+        size_t target) {
+    return std::lower_bound(row.begin(), row.end(), target,
+        [](const std::pair<size_t, size_t>& entry, size_t value) {
+            return entry.first < value;
+        });
+}
+
+inline size_t Adjacency::find(size_t source, size_t target) const {
+    if (dense_) return (*matrix_[source])[target];
+    const SparseRow* row = rows_[source].get();
+    if (row == nullptr) return NONE;
+    auto it = lower_bound_(*row, target);
+    if (it == row->end() || it->first != target) return NONE;
+    return it->second;
+}
+
+inline void Adjacency::prefetch_row(size_t source) const noexcept {
+    const void* row = dense_ ? static_cast<const void*>(matrix_[source].get()) :
+        static_cast<const void*>(rows_[source].get());
+    if (row != nullptr) prefetch_(row);
+}
+
+inline void Adjacency::prefetch(size_t source, size_t target) const noexcept {
+    if (dense_) {
+        prefetch_(matrix_[source]->data() + target);
+        return;
+    }
+    const SparseRow* row = rows_[source].get();
+    // the binary search of find starts in the middle of the row
+    if (row != nullptr) prefetch_(row->data() + row->size() / 2);
+}
+
+inline void Adjacency::prefetch_(const void* address) noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#elif defined(__GNUC__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+}
+
+template <typename Function>
+void Adjacency::for_each_neighbor(size_t source, Function function) const {
+    if (dense_) {
+        const DenseRow& row = *matrix_[source];
+        for (size_t target = 0; target < size_; target++) {
+            if (row[target] != NONE) function(target, row[target]);
+        }
+        return;
+    }
+    const SparseRow* row = rows_[source].get();
+    if (row == nullptr) return;
+    for (const auto& entry : *row) {
+        function(entry.first, entry.second);
+    }
+}
+
+inline std::vector<std::pair<size_t, size_t>> Adjacency::entries() const {
+    std::vector<std::pair<size_t, size_t>> result;
+    result.reserve(entry_count_);
+    for (size_t source = 0; source < size_; source++) {
+        for_each_neighbor(source, [&](size_t target, size_t) {
+            result.emplace_back(source, target);
+        });
+    }
+    return result;
+}
+
+inline void Adjacency::set(size_t source, size_t target, size_t edge) {
+    try {
+        if (dense_) {
+            DenseRow& row = own_dense_row_(source);
+            if (row[target] == NONE) ++entry_count_;
+            row[target] = edge;
+        }
+        else {
+            SparseRow& row = own_sparse_row_(source);
+            auto position = row.begin() + (lower_bound_(row, target) - row.cbegin());
+            if (position != row.end() && position->first == target) {
+                position->second = edge;
+            }
+            else {
+                row.emplace(position, target, edge);
+                ++entry_count_;
+            }
+        }
+    }
+    catch (...) {
+        throw UnavailableMemoryException::adjacency_matrix_unable_to_insert();
+    }
+    rebalance_();
+}
+
+inline void Adjacency::clear(size_t source, size_t target) noexcept {
+    // an entry that was never set leaves a shared row alone
+    if (find(source, target) == NONE) return;
+    if (dense_) {
+        own_dense_row_(source)[target] = NONE;
+        --entry_count_;
+        return;
+    }
+    SparseRow& row = own_sparse_row_(source);
+    row.erase(row.begin() + (lower_bound_(row, target) - row.cbegin()));
+    --entry_count_;
+}
+
+inline void Adjacency::grow() {
+    grow(1);
+}
+
+inline void Adjacency::grow(size_t count) {
+    if (count == 0) return;
+    size_t grown = size_ + count;
+    // switch before growing, so a sparse graph never allocates more dense rows
+    if (dense_ && should_become_sparse_(grown, entry_count_)) {
+        try {
+            to_sparse_();
+        }
+        catch (...) {
+            // stay dense
+        }
+    }
+    if (!dense_) {
+        try {
+            // the new rows are empty, so they stay unallocated
+            rows_.resize(grown);
+        }
+        catch (...) {
+            throw UnavailableMemoryException::adjacency_matrix_unable_to_insert();
+        }
+        size_ = grown;
+        return;
+    }
+    size_t resized = 0;
+    try {
+        for (; resized < size_; resized++) {
+            std::shared_ptr<DenseRow>& row = matrix_[resized];
+            if (shared_(row)) {
+                // a shared row is copied straight into its grown size
+                std::shared_ptr<DenseRow> grown_row = std::make_shared<DenseRow>(grown, NONE);
+                std::copy(row->begin(), row->end(), grown_row->begin());
+                row = std::move(grown_row);
+            }
+            else {
+                row->resize(grown, NONE);
+            }
+        }
+        matrix_.reserve(grown);
+        while (matrix_.size() < grown) {
+            matrix_.push_back(std::make_shared<DenseRow>(grown, NONE));
+        }
+    }
+    catch (...) {
+        for (size_t i = 0; i < resized; i++) {
+            matrix_[i]->resize(size_);
+        }
+        matrix_.resize(size_);
+        throw UnavailableMemoryException::adjacency_matrix_unable_to_insert();
+    }
+    size_ = grown;
+}
+
+inline void Adjacency::truncate(size_t nodes) noexcept {
+    if (nodes >= size_) return;
+    if (dense_) {
+        for (size_t i = 0; i < nodes; i++) {
+            DenseRow& row = *matrix_[i];
+            row.erase(row.begin() + nodes, row.end());
+        }
+        matrix_.erase(matrix_.begin() + nodes, matrix_.end());
+    }
+    else {
+        rows_.erase(rows_.begin() + nodes, rows_.end());
+    }
+    size_ = nodes;
+}
+
+inline void Adjacency::reset(size_t nodes, size_t expected_entries, ThreadPool& pool) {
+    matrix_ = std::vector<std::shared_ptr<DenseRow>>();
+    rows_ = std::vector<std::shared_ptr<SparseRow>>();
+    size_ = 0;
+    entry_count_ = 0;
+    dense_ = !should_become_sparse_(nodes, expected_entries);
+    try {
+        if (dense_) {
+            matrix_.resize(nodes);
+            pool.parallel_for(0, nodes, [&](size_t i) {
+                matrix_[i] = std::make_shared<DenseRow>(nodes, NONE);
+            });
+        }
+        else {
+            rows_.resize(nodes);
+        }
+    }
+    catch (...) {
+        matrix_ = std::vector<std::shared_ptr<DenseRow>>();
+        rows_ = std::vector<std::shared_ptr<SparseRow>>();
+        throw UnavailableMemoryException::adjacency_matrix_unable_to_insert();
+    }
+    size_ = nodes;
+}
+
+template <typename Column>
+void Adjacency::fill(const Column& sources, const Column& targets, bool mirrored,
+        ThreadPool& pool) {
+    size_t count = sources.size();
+    std::atomic<size_t> entries(0);
+    try {
+        if (dense_) {
+            // every edge owns its cells, so the threads never write the same cell
+            pool.parallel_for_ranges(0, count, [&](size_t begin, size_t end) {
+                size_t local = 0;
+                for (size_t edge = begin; edge < end; edge++) {
+                    size_t source = sources[edge];
+                    size_t target = targets[edge];
+                    (*matrix_[source])[target] = edge;
+                    ++local;
+                    if (mirrored && source != target) {
+                        (*matrix_[target])[source] = edge;
+                        ++local;
+                    }
+                }
+                entries.fetch_add(local, std::memory_order_relaxed);
+            });
+        }
+        else {
+            // count the entries of every row, size the rows, scatter the entries, sort the rows
+            std::unique_ptr<std::atomic<size_t>[]> cursors(new std::atomic<size_t>[size_]);
+            pool.parallel_for(0, size_, [&](size_t i) {
+                cursors[i].store(0, std::memory_order_relaxed);
+            });
+            pool.parallel_for(0, count, [&](size_t i) {
+                size_t source = sources[i];
+                size_t target = targets[i];
+                cursors[source].fetch_add(1, std::memory_order_relaxed);
+                if (mirrored && source != target)
+                    cursors[target].fetch_add(1, std::memory_order_relaxed);
+            });
+            pool.parallel_for(0, size_, [&](size_t i) {
+                size_t degree = cursors[i].load(std::memory_order_relaxed);
+                if (degree != 0) rows_[i] = std::make_shared<SparseRow>(degree);
+                entries.fetch_add(degree, std::memory_order_relaxed);
+                cursors[i].store(0, std::memory_order_relaxed);
+            });
+            pool.parallel_for(0, count, [&](size_t edge) {
+                size_t source = sources[edge];
+                size_t target = targets[edge];
+                (*rows_[source])[cursors[source].fetch_add(1, std::memory_order_relaxed)] =
+                    std::make_pair(target, edge);
+                if (mirrored && source != target)
+                    (*rows_[target])[cursors[target].fetch_add(1, std::memory_order_relaxed)] =
+                        std::make_pair(source, edge);
+            });
+            pool.parallel_for(0, size_, [&](size_t i) {
+                if (rows_[i] == nullptr) return;
+                std::sort(rows_[i]->begin(), rows_[i]->end(),
+                    [](const std::pair<size_t, size_t>& a,
+                        const std::pair<size_t, size_t>& b) {
+                        return a.first < b.first;
+                    });
+            });
+        }
+    }
+    catch (std::bad_alloc& e) {
+        (void)e;
+        throw UnavailableMemoryException::adjacency_matrix_unable_to_insert();
+    }
+    entry_count_ = entries.load(std::memory_order_relaxed);
+    rebalance_();
+}
+
+
+inline void Adjacency::rehome_row(size_t source) noexcept {
+    try {
+        // the copy is the adjacency's own, even if the row was shared
+        if (dense_) matrix_[source] = std::make_shared<DenseRow>(*matrix_[source]);
+        else if (rows_[source] != nullptr)
+            rows_[source] = std::make_shared<SparseRow>(*rows_[source]);
+    }
+    catch (const std::bad_alloc&) {
+        // the old row works just as well, only from further away
+    }
+}
+
+inline void Adjacency::memory_usage(MemoryUsage& usage) const {
+    if (dense_) memory_usage_(matrix_, usage);
+    else memory_usage_(rows_, usage);
+}
+
+template <typename Row>
+void Adjacency::memory_usage_(const std::vector<std::shared_ptr<Row>>& rows,
+        MemoryUsage& usage) {
+    usage.adjacency += rows.size() * sizeof(std::shared_ptr<Row>);
+    usage.slack += (rows.capacity() - rows.size()) * sizeof(std::shared_ptr<Row>);
+    for (const std::shared_ptr<Row>& row : rows) {
+        if (row == nullptr) continue;
+        usage.adjacency += sizeof(Row) + row->size() * sizeof(typename Row::value_type);
+        usage.slack += (row->capacity() - row->size()) * sizeof(typename Row::value_type);
+        if (shared_(row))
+            usage.shared += sizeof(Row) + row->capacity() * sizeof(typename Row::value_type);
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,76 @@
+#ifndef __ADJACENCY_VIEW_H
+#define __ADJACENCY_VIEW_H
+
+#include "Exceptions.h"
+#include "Graph.h"
+
+
+/// @file AdjacencyView.h
+/// @brief Contains the EdgesView class and its member function definitions
+///
+/// An adjacency view is any class with size() returning the number of nodes and
+/// for_each_neighbor(source, function) calling function(target) for every edge outgoing from
+/// the source in the order of increasing target ids. Algorithms take their adjacency as a
+/// template parameter satisfying this, so the Edges (through an EdgesView), the K2Tree and the
+/// CompressedCsr can be used interchangeably.
+
+
+/// @brief An adjacency view of the Edges of a graph
+/// @tparam NData The data associated with the Graph's nodes
+/// @tparam EData The data associated with the Graph's edges
+template <typename NData, typename EData>
+class EdgesView {
+public:
+    /// @brief Constructs a view of the given edges, the edges have to outlive the view
+    /// @param edges The edges to view
+    explicit EdgesView(const Edges<NData, EData>& edges);
+
+    /// @brief Get the number of nodes
+    /// @return The number of nodes
+    size_t size() const;
+
+    /// @brief Calls the given function for the target of every edge outgoing from the given
+    ///  source, in the order of increasing target ids
+    /// @tparam Function A callable taking the id of the target node
+    /// @param source The id of the source node
+    /// @param function The function to call
+    /// @exception NonexistingItemException If the source node does not exist
+    template <typename Function>
+    void for_each_neighbor(size_t source, Function function) const;
+
+private:
+    /// @brief The edges being viewed
+    const Edges<NData, EData>& edges_;
+};
+
+/// @brief Makes an adjacency view of the given edges
+/// @tparam NData The data associated with the Graph's nodes
+/// @tparam EData The data associated with the Graph's edges
+/// @param edges The edges to view
+/// @return The adjacency view
+template <typename NData, typename EData>
+EdgesView<NData, EData> adjacency_view(const Edges<NData, EData>& edges) {
+    return EdgesView<NData, EData>(edges);
+}
+
+template <typename NData, typename EData>
+EdgesView<NData, EData>::EdgesView(const Edges<NData, EData>& edges) : edges_(edges) {}
+
+template <typename NData, typename EData>
+size_t EdgesView<NData, EData>::size() const {
+    return edges_.adjacency().size();
+}
+
+template <typename NData, typename EData>
+template <typename Function>
+void EdgesView<NData, EData>::for_each_neighbor(size_t source, Function function) const {
+    size_t size = edges_.adjacency().size();
+    if (source >= size)
+        throw NonexistingItemException::accessing_edge_nonexistant_source(source, size);
+    edges_.adjacency().for_each_neighbor(source, [&](size_t target, size_t) {
+        function(target);
+    });
+}
+
+
+#endif
\ No newline at end of file
@@ -7,7 +7,11 @@
 #include <vector>
 #include <string>
 #include <iterator>
+#include <atomic>
+#include <new>
+#include <type_traits>
 #include "Exceptions.h"
+#include "ThreadPool.h"
 
 
 /// @file Array.h
@@ -19,7 +23,18 @@ namespace my_array {
 	/// @brief The default size of the blocks used internally for storage inside the array
 	const int DEFAULT_BLOCK_SIZE = 10;
 
-	/// @brief A dynamic array that never invalidates pointers
+	/// @brief The number of elements under which copying is not split between threads any further
+	const size_t PARALLEL_COPY_GRAIN = 4096;
+
+	/// @brief A dynamic array of blocks, adding elements never moves the ones already there.
+	///  Copies share the blocks of elements, so copying costs a pointer per block; the first
+	///  write to a shared block, through a non-const accessor or by adding or removing an
+	///  element, gives the writer a block of its own. The array a block was copied from keeps
+	///  its elements in place and hands the copy to the arrays sharing the block, so references
+	///  into an array stay valid while it is written to; references a copy took into a shared
+	///  block follow that block, so they are only stable until either side writes to it. Arrays
+	///  sharing blocks have to be used from one thread at a time, only a frozen copy may be read
+	///  from another thread while the array is written to
 	/// @tparam element The element of the array
 	template <typename element>
 	class Array {
@@ -33,24 +48,103 @@ namespace my_array {
 		void push_back(const element& item);
 
 		/// @brief Add an item to the end of the array
-		/// @param item The item to add
+		/// @param item The item to add, moved into the array
 		void push_back(element&& item);
 
-		/// @brief Remove the last element of the array
+		/// @brief Construct an element at the end of the array in place; a last block shared with
+		///  a copy is unshared first
+		/// @tparam Args The types of the arguments of the element's constructor
+		/// @param args The arguments forwarded to the element's constructor
+		/// @return A reference to the constructed element
+		/// @exception UnavailableMemoryException If we don't have enough memory to add a block,
+		///  exceptions of the element's constructor leave the array unchanged
+		template <typename... Args>
+		element& emplace_back(Args&&... args);
+
+		/// @brief Remove the last element of the array; a last block shared with a copy is
+		///  unshared first
 		/// @exception EmptyArrayException If tried to pop back on an empty array
+		/// @exception UnavailableMemoryException If the shared last block cannot be copied
 		void pop_back();
 
+		/// @brief Allocate the blocks for the given number of elements up front,
+		///  so adding up to that many elements never allocates
+		/// @param capacity The number of elements
+		/// @exception UnavailableMemoryException If we don't have enough memory to add the blocks,
+		///  the blocks added until then are kept
+		void reserve(size_t capacity);
+
 		/// @brief Get the number of elements inside the array
 		/// @return The count of elements of the array
 		inline size_t size() const;
 
+		/// @brief Get the number of elements the allocated blocks can hold
+		/// @return The capacity of the array
+		size_t capacity() const;
+
+		/// @brief Get the number of bytes allocated by the array, its blocks and the table of
+		///  the blocks; the free spots of the blocks included, blocks shared with copies are
+		///  counted by each of them
+		/// @return The number of bytes
+		size_t memory_usage() const;
+
+		/// @brief Get the number of bytes of the blocks shared with copies of the array, the
+		///  part of memory_usage every array sharing them counts as well
+		/// @return The number of bytes
+		size_t shared_memory_usage() const;
+
+		/// @brief Get the size of the blocks used internally for storage
+		/// @return The number of elements of a block
+		size_t block_size() const;
+
+		/// @brief Tests if the block holding an index is shared with a copy of the array
+		/// @param index The index of an element
+		/// @return True if the block is shared
+		bool is_shared(size_t index) const;
+
+		/// @brief Tests if any block is shared with a copy of the array
+		/// @return True if a block is shared
+		bool is_shared() const;
+
+		/// @brief Gives the array a block of its own for an index if the block is shared with a
+		///  copy of the array. A block the array was copied from keeps its elements in place, the
+		///  copy of them goes to the arrays sharing it; a block the array got from another array
+		///  is copied away, its elements move to new addresses then
+		/// @param index The index of an element
+		/// @return True if the block was copied
+		/// @exception UnavailableMemoryException If there isn't enough memory for the copy,
+		///  the array is left as it was
+		bool unshare(size_t index);
+
+		/// @brief Gives the array a block of its own for every block shared with a copy of the
+		///  array, the same way as unshare of an index does; the blocks are
+		///  copied in parallel, so on NUMA machines the copies land on the node of the thread
+		///  that copied them
+		/// @return True if any block was copied
+		/// @exception UnavailableMemoryException If there isn't enough memory for the copies,
+		///  the array is left as it was
+		bool unshare();
+
+		class frozen;
+
+		/// @brief Takes a read-only copy of the elements the array holds now; the blocks are
+		///  copied in parallel into blocks of the copy's own, so the elements of the array never
+		///  move and writing to them, through any reference, never shows in the copy. The copy
+		///  may be read from another thread while the array is written to, it has to be taken on
+		///  the thread writing the array
+		/// @return The copy
+		/// @exception UnavailableMemoryException If there isn't enough memory for the copy
+		frozen freeze() const;
+
 		/// @brief Print the elements of the array using operator<< to the specified stream
 		/// @param os The output stream to print to
 		void print(std::ostream& os = std::cout) const;
 
-		/// @brief Get the element at a given index
+		/// @brief Get the element at a given index, unsharing its block first
 		/// @param index The index of the element
 		/// @return A reference to the element at the given index
+		/// @exception OutOfRangeException If tried to acces an out of range index
+		/// @exception UnavailableMemoryException If the shared block cannot be copied
 		element& at(size_t index);
 
 		/// @brief Get the element at a given index
@@ -58,9 +152,11 @@ namespace my_array {
 		/// @return A reference to the element at the given index
 		const element& at(size_t index) const;
 
-		/// @brief Get the element at a given index
+		/// @brief Get the element at a given index, unsharing its block first
 		/// @param index The index of the element
 		/// @return A reference to the element at the given index
+		/// @exception OutOfRangeException If tried to acces an out of range index
+		/// @exception UnavailableMemoryException If the shared block cannot be copied
 		element& operator[](size_t index);
 
 		/// @brief Get the element at a given index
@@ -68,17 +164,21 @@ namespace my_array {
 		/// @return A reference to the element at the given index
 		const element& operator[](size_t index) const;
 
-		/// @brief Copy constructor
+		/// @brief Copy constructor, shares the blocks of the other array
 		/// @param other The array to copy from
+		/// @exception UnavailableMemoryException If there isn't enough memory for the table of
+		///  the blocks
 		Array(const Array<element>& other);
 
 		/// @brief Move constructor
 		/// @param other The array to move
 		Array(Array<element>&& other) noexcept;
 
-		/// @brief Copy assignment
+		/// @brief Copy assignment, shares the blocks of the other array
 		/// @param other The array to copy from
 		/// @return A reference to the array copied to
+		/// @exception UnavailableMemoryException If there isn't enough memory for the table of
+		///  the blocks, the array is left as it was
 		Array<element>& operator=(const Array<element>& other);
 
 		/// @brief Move assignment
@@ -96,7 +196,36 @@ namespace my_array {
 		/// @return The iterator to the space after the last element
 		iterator end();
 
+		/// @brief Moves the memory of the blocks holding elements to NUMA nodes; the elements
+		///  keep their addresses, only the pages move, and only where binding is supported
+		/// @tparam Function A callable taking the index of an element and returning its NUMA node
+		/// @param node_of The function choosing the node of a block from its first element
+		template <typename Function>
+		void bind_blocks(Function node_of) const;
+
 	private:
+		/// @brief Uninitialized storage for a single element, elements are only constructed
+		///  when they are added so a block costs no constructor calls
+		using slot = typename std::aligned_storage<sizeof(element), alignof(element)>::type;
+
+		/// @brief A block of slots, shared by the copies of an array; destroys the elements
+		///  constructed inside it once the last copy lets go of it
+		struct block {
+			/// @brief Allocates a block without elements
+			/// @param size The number of slots
+			/// @exception std::bad_alloc If the slots cannot be allocated
+			explicit block(size_t size);
+
+			/// @brief Destroys the constructed elements
+			~block();
+
+			/// @brief The slots of the elements
+			std::unique_ptr<slot[]> slots;
+
+			/// @brief The number of elements constructed at the start of the slots
+			size_t constructed;
+		};
+
 		/// @brief Get the amount of free spots for elements
 		/// @return The size of the free space
 		size_t free_space_count_();
@@ -105,21 +234,102 @@ namespace my_array {
 		/// @exception UnavailableMemoryException If we don't have enough memory to add a block
 		void add_block_();
 
+		/// @brief Get the number of blocks holding elements
+		/// @return The number of blocks
+		size_t used_blocks_() const;
+
+		/// @brief Copies a block and its elements
+		/// @param source The block to copy
+		/// @return The copy
+		/// @exception std::bad_alloc If the copy cannot be allocated, or what copying an element
+		///  throws
+		std::shared_ptr<block> copy_block_(const block& source) const;
+
+		/// @brief Tests if a block is shared with a copy of the array
+		/// @param block The index of the block
+		/// @return True if the block is shared
+		bool shared_block_(size_t block) const;
+
+		/// @brief Tests if the array keeps the elements of a shared block when it is unshared,
+		///  handing the copy of them to the arrays sharing it
+		/// @param block The index of the block
+		/// @return True if the block was allocated by the array
+		bool keeps_block_(size_t block) const;
+
+		/// @brief Replaces a shared block by its copy; when the array keeps the block, the
+		///  copy and the block trade their slots first, so the elements stay where they are
+		/// @param block The index of the block
+		/// @param copy The copy of the block, holding the shared block afterwards
+		void replace_block_(size_t block, std::shared_ptr<typename Array<element>::block>& copy);
+
+		/// @brief Get the storage of the element at a given index, constructed or not
+		/// @param index The index of the element
+		/// @return A pointer to the storage
+		inline element* slot_(size_t index) const;
+
 		/// @brief Get the element at a given index
 		/// @param index The index of the element
 		/// @return A reference to the element at the given index
 		/// @exception OutOfRangeException If tried to acces an out of range index
 		inline const element& get_(size_t index) const;
 
+		/// @brief Get the element at a given index for writing, unsharing its block first
+		/// @param index The index of the element
+		/// @return A reference to the element at the given index
+		/// @exception OutOfRangeException If tried to acces an out of range index
+		/// @exception UnavailableMemoryException If the shared block cannot be copied
+		element& own_(size_t index);
+
 		/// @brief The actual internal storage used for the elements
 		///  A vector of pointers to blocks ensures that upon growth old pointers are still valid
-		std::vector<std::unique_ptr<element[]>> data_;
+		std::vector<std::shared_ptr<block>> data_;
 
 		/// @brief The size of the blocks used inside the internal storage
 		size_t block_size_;
 
 		/// @brief The number of actual elements inside the array
 		size_t element_count_;
+
+		/// @brief True for every block the array allocated or unshared itself, false for the
+		///  blocks it got from the array it was copied from
+		std::vector<bool> owned_;
+
+		/// @brief True once a copy may share blocks with the array, cleared
+		///  when no block is found shared anymore; spares the arrays that were never copied from
+		///  looking at the reference counts of their blocks
+		mutable std::atomic<bool> sharing_;
+	};
+
+	/// @brief A read-only copy of the elements an array held when it was taken, in blocks no
+	///  array ever writes to. Copies of a frozen copy share its blocks
+	/// @tparam element The element of the array
+	template <typename element>
+	class Array<element>::frozen {
+	public:
+		/// @brief Constructs an empty copy
+		frozen();
+
+		/// @brief Get the number of elements of the copy
+		/// @return The number of elements
+		size_t size() const;
+
+		/// @brief Get the element at a given index
+		/// @param index The index of the element
+		/// @return A reference to the element at the given index
+		/// @exception OutOfRangeException If tried to acces an out of range index
+		const element& operator[](size_t index) const;
+
+	private:
+		/// @brief The copied blocks, nullptr for an empty copy
+		std::shared_ptr<const std::vector<std::shared_ptr<block>>> blocks_;
+
+		/// @brief The size of the blocks
+		size_t block_size_;
+
+		/// @brief The number of elements of the copy
+		size_t element_count_;
+
+		friend Array<element>;
 	};
 
 	/// @brief Iterator for the array
@@ -202,17 +412,36 @@ namespace my_array {
 	}
 
 	template <typename element>
-	Array<element>::Array(size_t block_size) : block_size_(block_size), element_count_(0) {}
+	Array<element>::Array(size_t block_size)
+		: block_size_(block_size), element_count_(0), sharing_(false) {}
+
+	template <typename element>
+	Array<element>::block::block(size_t size) : slots(new slot[size]), constructed(0) {}
+
+	template <typename element>
+	Array<element>::block::~block() {
+		for (size_t i = 0; i < constructed; i++) {
+			reinterpret_cast<element*>(&slots[i])->~element();
+		}
+	}
 
 	template <typename element>
 	size_t Array<element>::free_space_count_() {
 		return data_.size() * block_size_ - element_count_;
 	}
 
+	template <typename element>
+	size_t Array<element>::used_blocks_() const {
+		return (element_count_ + block_size_ - 1) / block_size_;
+	}
+
 	template <typename element>
 	void Array<element>::add_block_() {
 		try {
-			data_.push_back(std::make_unique<element[]>(block_size_));
+			// reserved first, so the block is never added without its flag
+			owned_.reserve(data_.size() + 1);
+			data_.push_back(std::make_shared<block>(block_size_));
+			owned_.push_back(true);
 		}
 		catch (std::bad_alloc& e) {
 			(void)e;
@@ -220,25 +449,74 @@ namespace my_array {
 		}
 	}
 
+	template <typename element>
+	std::shared_ptr<typename Array<element>::block> Array<element>::copy_block_
+			(const block& source) const {
+		std::shared_ptr<block> copy = std::make_shared<block>(block_size_);
+		for (size_t i = 0; i < source.constructed; i++) {
+			new (&copy->slots[i]) element(*reinterpret_cast<const element*>(&source.slots[i]));
+			// counted one by one, so a throwing copy destroys exactly what was copied
+			++copy->constructed;
+		}
+		return copy;
+	}
+
+	template <typename element>
+	bool Array<element>::shared_block_(size_t block) const {
+		if (!sharing_.load(std::memory_order_relaxed)) return false;
+		if (data_[block].use_count() > 1) return true;
+		// pairs with the release of the copy that let go of the block last,
+		// so writing to the block happens after its reads
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return false;
+	}
+
+	template <typename element>
+	bool Array<element>::keeps_block_(size_t block) const {
+		return owned_[block];
+	}
+
+	template <typename element>
+	void Array<element>::replace_block_(size_t block,
+			std::shared_ptr<typename Array<element>::block>& copy) {
+		if (keeps_block_(block)) copy->slots.swap(data_[block]->slots);
+		data_[block].swap(copy);
+		owned_[block] = true;
+	}
+
 	template <typename element>
 	void Array<element>::push_back(const element& item) {
-		if (free_space_count_() == 0) add_block_();
-		data_[element_count_ / block_size_][element_count_ % block_size_] = item;
-		++element_count_;
+		emplace_back(item);
 	}
 
 	template <typename element>
 	void Array<element>::push_back(element&& item) {
+		emplace_back(std::move(item));
+	}
+
+	template <typename element>
+	template <typename... Args>
+	element& Array<element>::emplace_back(Args&&... args) {
 		if (free_space_count_() == 0) add_block_();
-		data_[element_count_ / block_size_][element_count_ % block_size_] = item;
+		else unshare(element_count_);
+		element* constructed = new (slot_(element_count_)) element(std::forward<Args>(args)...);
+		++data_[element_count_ / block_size_]->constructed;
 		++element_count_;
+		return *constructed;
 	}
 
 	template <typename element>
 	void Array<element>::pop_back() {
 		if (element_count_ == 0) throw(EmptyArrayException::array_popping_empty_array());
+		unshare(element_count_ - 1);
 		--element_count_;
-		data_[element_count_ / block_size_][element_count_ % block_size_].~element();
+		slot_(element_count_)->~element();
+		--data_[element_count_ / block_size_]->constructed;
+	}
+
+	template <typename element>
+	inline element* Array<element>::slot_(size_t index) const {
+		return reinterpret_cast<element*>(&data_[index / block_size_]->slots[index % block_size_]);
 	}
 
 	template<typename element>
@@ -246,11 +524,92 @@ namespace my_array {
 		return element_count_;
 	}
 
+	template<typename element>
+	size_t Array<element>::capacity() const {
+		return data_.size() * block_size_;
+	}
+
+	template<typename element>
+	size_t Array<element>::memory_usage() const {
+		return data_.capacity() * sizeof(std::shared_ptr<block>) + owned_.capacity() / 8 +
+			data_.size() * (sizeof(block) + block_size_ * sizeof(slot));
+	}
+
+	template<typename element>
+	size_t Array<element>::shared_memory_usage() const {
+		size_t bytes = 0;
+		for (size_t block = 0; block < data_.size(); block++) {
+			if (shared_block_(block))
+				bytes += sizeof(typename Array<element>::block) + block_size_ * sizeof(slot);
+		}
+		return bytes;
+	}
+
+	template<typename element>
+	size_t Array<element>::block_size() const {
+		return block_size_;
+	}
+
+	template<typename element>
+	bool Array<element>::is_shared(size_t index) const {
+		return shared_block_(index / block_size_);
+	}
+
+	template<typename element>
+	bool Array<element>::is_shared() const {
+		for (size_t block = 0; block < data_.size(); block++) {
+			if (shared_block_(block)) return true;
+		}
+		sharing_.store(false, std::memory_order_relaxed);
+		return false;
+	}
+
+	template<typename element>
+	bool Array<element>::unshare(size_t index) {
+		size_t block = index / block_size_;
+		if (!shared_block_(block)) return false;
+		std::shared_ptr<typename Array<element>::block> copy;
+		try {
+			copy = copy_block_(*data_[block]);
+		}
+		catch (std::bad_alloc& e) {
+			(void)e;
+			throw(UnavailableMemoryException::array_unable_to_insert());
+		}
+		replace_block_(block, copy);
+		return true;
+	}
+
+	template<typename element>
+	bool Array<element>::unshare() {
+		std::vector<std::shared_ptr<block>> copies;
+		try {
+			copies.resize(data_.size());
+			size_t grain = std::max<size_t>(1, PARALLEL_COPY_GRAIN / block_size_);
+			ThreadPool::global().parallel_for(0, data_.size(), [&](size_t block) {
+				if (shared_block_(block)) copies[block] = copy_block_(*data_[block]);
+			}, grain);
+		}
+		catch (std::bad_alloc& e) {
+			(void)e;
+			throw(UnavailableMemoryException::array_unable_to_insert());
+		}
+		// nothing is replaced until every copy succeeded
+		bool copied = false;
+		for (size_t block = 0; block < data_.size(); block++) {
+			if (!copies[block]) continue;
+			replace_block_(block, copies[block]);
+			copied = true;
+		}
+		sharing_.store(false, std::memory_order_relaxed);
+		return copied;
+	}
+
 	template<typename element>
 	void Array<element>::print(std::ostream& os) const {
 		os << "[";
 		for (size_t i = 0; i < element_count_; i++) {
-			os << data_[i / block_size_][i % block_size_];
+			os << *slot_(i);
 			if (i != element_count_ - 1) os << ", ";
 		}
 		os << "]";
@@ -260,12 +619,20 @@ namespace my_array {
 	inline const element& Array<element>::get_(size_t index) const {
 		if (index >= element_count_) 
 			throw OutOfRangeException::array_accessing_invalid_index(index);
-		return data_[index / block_size_][index % block_size_];
+		return *slot_(index);
+	}
+
+	template <typename element>
+	element& Array<element>::own_(size_t index) {
+		if (index >= element_count_)
+			throw OutOfRangeException::array_accessing_invalid_index(index);
+		unshare(index);
+		return *slot_(index);
 	}
 
 	template <typename element>
 	element& Array<element>::at(size_t index) {
-		return const_cast<element&>(get_(index));
+		return own_(index);
 	}
 
 	template <typename element>
@@ -275,7 +642,7 @@ namespace my_array {
 
 	template <typename element>
 	element& Array<element>::operator[](size_t index) {
-		return const_cast<element&>(get_(index));
+		return own_(index);
 	}
 
 	template <typename element>
@@ -284,39 +651,112 @@ namespace my_array {
 	}
 
 	template <typename element>
-	Array<element>::Array(const Array<element>& other) 
-			: block_size_(other.block_size_), element_count_(other.element_count_) {
-		for (size_t i = 0; i < other.data_.size(); i++) {
+	void Array<element>::reserve(size_t capacity) {
+		size_t blocks = (capacity + block_size_ - 1) / block_size_;
+		if (blocks <= data_.size()) return;
+		try {
+			data_.reserve(blocks);
+			owned_.reserve(blocks);
+		}
+		catch (std::bad_alloc& e) {
+			(void)e;
+			throw(UnavailableMemoryException::array_unable_to_insert());
+		}
+		while (data_.size() < blocks) {
 			add_block_();
 		}
-		for (size_t i = 0; i < element_count_; i++) {
-			data_[i / block_size_][i % block_size_] = other.data_[i / block_size_][i % block_size_];
+	}
+
+	template <typename element>
+	template <typename Function>
+	void Array<element>::bind_blocks(Function node_of) const {
+		for (size_t block = 0; block * block_size_ < element_count_; block++) {
+			numa_bind(data_[block]->slots.get(), block_size_ * sizeof(slot),
+				node_of(block * block_size_));
+		}
+	}
+
+	template <typename element>
+	typename Array<element>::frozen Array<element>::freeze() const {
+		frozen copy;
+		try {
+			auto blocks = std::make_shared<std::vector<std::shared_ptr<block>>>(used_blocks_());
+			size_t grain = std::max<size_t>(1, PARALLEL_COPY_GRAIN / block_size_);
+			ThreadPool::global().parallel_for(0, blocks->size(), [&](size_t block) {
+				(*blocks)[block] = copy_block_(*data_[block]);
+			}, grain);
+			copy.blocks_ = std::move(blocks);
+		}
+		catch (std::bad_alloc& e) {
+			(void)e;
+			throw(UnavailableMemoryException::array_unable_to_insert());
+		}
+		copy.block_size_ = block_size_;
+		copy.element_count_ = element_count_;
+		return copy;
+	}
+
+	template <typename element>
+	Array<element>::frozen::frozen() : block_size_(DEFAULT_BLOCK_SIZE), element_count_(0) {}
+
+	template <typename element>
+	size_t Array<element>::frozen::size() const {
+		return element_count_;
+	}
+
+	template <typename element>
+	const element& Array<element>::frozen::operator[](size_t index) const {
+		if (index >= element_count_)
+			throw OutOfRangeException::array_accessing_invalid_index(index);
+		return *reinterpret_cast<const element*>(
+			&(*blocks_)[index / block_size_]->slots[index % block_size_]);
+	}
+
+	template <typename element>
+	Array<element>::Array(const Array<element>& other) 
+			: block_size_(other.block_size_), element_count_(other.element_count_),
+			sharing_(true) {
+		try {
+			data_.assign(other.data_.begin(), other.data_.begin() + other.used_blocks_());
+			owned_.assign(data_.size(), false);
+		}
+		catch (std::bad_alloc& e) {
+			(void)e;
+			throw(UnavailableMemoryException::array_unable_to_insert());
 		}
+		other.sharing_.store(true, std::memory_order_relaxed);
 	}
 
 	template <typename element>
-	Array<element>::Array(Array<element>&& other) noexcept : block_size_(0), element_count_(0) {
+	Array<element>::Array(Array<element>&& other) noexcept
+			: block_size_(0), element_count_(0), sharing_(false) {
 		std::swap(data_, other.data_);
+		std::swap(owned_, other.owned_);
 		std::swap(element_count_, other.element_count_);
 		std::swap(block_size_, other.block_size_);
+		sharing_.store(other.sharing_.exchange(false, std::memory_order_relaxed),
+			std::memory_order_relaxed);
 	}
 
 	template <typename element>
 	Array<element>& Array<element>::operator=(const Array<element>& other) {
-		for (size_t i = 0; i < element_count_; i++) {
-			data_[i / block_size_][i % block_size_].~element();
-		}
-		element_count_ = other.element_count_;
-		if (block_size_ != other.block_size_) {
-			block_size_ = other.block_size_;
-			data_ = std::vector<std::unique_ptr<element[]>>();
-		}
-		while (data_.size() * block_size_ < other.element_count_) {
-			add_block_();
+		if (this == &other) return *this;
+		std::vector<std::shared_ptr<block>> blocks;
+		std::vector<bool> owned;
+		try {
+			blocks.assign(other.data_.begin(), other.data_.begin() + other.used_blocks_());
+			owned.assign(blocks.size(), false);
 		}
-		for (size_t i = 0; i < other.element_count_; i++) {
-			data_[i / block_size_][i % block_size_] = other.data_[i / block_size_][i % block_size_];
+		catch (std::bad_alloc& e) {
+			(void)e;
+			throw(UnavailableMemoryException::array_unable_to_insert());
 		}
+		data_.swap(blocks);
+		owned_.swap(owned);
+		element_count_ = other.element_count_;
+		block_size_ = other.block_size_;
+		sharing_.store(true, std::memory_order_relaxed);
+		other.sharing_.store(true, std::memory_order_relaxed);
 		return *this;
 	}
 
@@ -324,8 +764,11 @@ namespace my_array {
 	Array<element>& Array<element>::operator=(Array<element>&& other) noexcept {
 		if (this != &other) {
 			std::swap(data_, other.data_);
+			std::swap(owned_, other.owned_);
 			std::swap(element_count_, other.element_count_);
 			std::swap(block_size_, other.block_size_);
+			sharing_.store(other.sharing_.exchange(sharing_.load(std::memory_order_relaxed),
+				std::memory_order_relaxed), std::memory_order_relaxed);
 		}
 
 		return *this;
@@ -0,0 +1,154 @@
+#ifndef __BIT_VECTOR_H
+#define __BIT_VECTOR_H
+
+#include <cstdint>
+#include <vector>
+#include "Exceptions.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+/// @file BitVector.h
+/// @brief Contains the BitVector class with constant time rank and logarithmic time select
+///  and its member function definitions
+
+
+/// @brief An append-only vector of bits supporting rank and select queries once it was built
+class BitVector {
+public:
+    /// @brief Constructs an empty bit vector
+    BitVector() = default;
+
+    /// @brief Add a bit to the end of the bit vector, invalidates the rank directory
+    /// @param bit The bit to add
+    void push_back(bool bit);
+
+    /// @brief Get the number of bits inside the bit vector
+    /// @return The number of bits
+    size_t size() const;
+
+    /// @brief Get the bit at a given index, expects the index to be in range
+    /// @param index The index of the bit
+    /// @return The bit at the given index
+    bool operator[](size_t index) const;
+
+    /// @brief Builds the rank directory, has to be called after the last push_back and before
+    ///  the first rank1 or select1
+    void build_rank();
+
+    /// @brief Get the number of set bits before a given index
+    /// @param index The index, at most the size of the bit vector
+    /// @return The number of set bits in [0, index)
+    size_t rank1(size_t index) const;
+
+    /// @brief Get the position of the set bit with the given rank
+    /// @param rank The rank of the set bit, counted from 1
+    /// @return The index of the set bit
+    /// @exception OutOfRangeException If there are fewer set bits than the given rank
+    size_t select1(size_t rank) const;
+
+    /// @brief Get the number of bytes used by the bits and the rank directory
+    /// @return The number of bytes
+    size_t memory_usage() const;
+
+    /// @brief Get the number of set bits inside a 64 bit word
+    /// @param word The word
+    /// @return The number of set bits
+    static size_t popcount(uint64_t word);
+
+private:
+    /// @brief The number of words covered by a single entry of the rank directory
+    static const size_t WORDS_PER_BLOCK = 8;
+
+    /// @brief The bits themselves, bit i is stored in words_[i / 64] at position i % 64
+    std::vector<uint64_t> words_;
+
+    /// @brief The number of set bits before every block of WORDS_PER_BLOCK words
+    std::vector<uint64_t> block_ranks_;
+
+    /// @brief The number of bits
+    size_t size_ = 0;
+};
+
+inline void BitVector::push_back(bool bit) {
+    if (size_ % 64 == 0) words_.push_back(0);
+    if (bit) words_.back() |= uint64_t(1) << (size_ % 64);
+    ++size_;
+}
+
+inline size_t BitVector::size() const {
+    return size_;
+}
+
+inline bool BitVector::operator[](size_t index) const {
+    return (words_[index / 64] >> (index % 64)) & 1;
+}
+
+inline size_t BitVector::popcount(uint64_t word) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<size_t>(__popcnt64(word));
+#elif defined(__GNUC__)
+    return static_cast<size_t>(__builtin_popcountll(word));
+#else
+    size_t count = 0;
+    for (; word != 0; word &= word - 1) ++count;
+    return count;
+#endif
+}
+
+inline void BitVector::build_rank() {
+    block_ranks_.clear();
+    block_ranks_.reserve(words_.size() / WORDS_PER_BLOCK + 1);
+    uint64_t ones = 0;
+    for (size_t i = 0; i < words_.size(); i++) {
+        if (i % WORDS_PER_BLOCK == 0) block_ranks_.push_back(ones);
+        ones += popcount(words_[i]);
+    }
+    block_ranks_.push_back(ones);
+}
+
+inline size_t BitVector::rank1(size_t index) const {
+    size_t word = index / 64;
+    size_t block = word / WORDS_PER_BLOCK;
+    size_t ones = static_cast<size_t>(block_ranks_[block]);
+    for (size_t i = block * WORDS_PER_BLOCK; i < word; i++) {
+        ones += popcount(words_[i]);
+    }
+    if (index % 64 != 0) ones += popcount(words_[word] & ((uint64_t(1) << (index % 64)) - 1));
+    return ones;
+}
+
+inline size_t BitVector::select1(size_t rank) const {
+    if (rank == 0 || rank > block_ranks_.back())
+        throw OutOfRangeException::array_accessing_invalid_index(rank);
+    // the last block whose preceding count is still below rank contains the bit
+    size_t low = 0;
+    size_t high = block_ranks_.size() - 1;
+    while (high - low > 1) {
+        size_t middle = (low + high) / 2;
+        if (block_ranks_[middle] < rank) low = middle;
+        else high = middle;
+    }
+    size_t remaining = rank - static_cast<size_t>(block_ranks_[low]);
+    size_t word = low * WORDS_PER_BLOCK;
+    while (popcount(words_[word]) < remaining) {
+        remaining -= popcount(words_[word]);
+        ++word;
+    }
+    uint64_t bits = words_[word];
+    for (size_t i = 1; i < remaining; i++) {
+        bits &= bits - 1;
+    }
+    size_t offset = 0;
+    while (((bits >> offset) & 1) == 0) ++offset;
+    return word * 64 + offset;
+}
+
+inline size_t BitVector::memory_usage() const {
+    return words_.capacity() * sizeof(uint64_t) + block_ranks_.capacity() * sizeof(uint64_t);
+}
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,235 @@
+#ifndef __BLOOM_FILTER_H
+#define __BLOOM_FILTER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "Exceptions.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BLOOM_FILTER_AVX2
+#endif
+
+
+/// @file BloomFilter.h
+/// @brief Contains the BloomFilter guarding the existence of edges and its member function
+///  definitions
+
+
+/// @brief A blocked Bloom filter over pairs of ids: every pair sets eight bits, one in each of
+///  the eight words of a single block the size of a cache line, so a probe misses the cache at
+///  most once and tests the eight words at once with AVX2. Answers "maybe" for every pair that
+///  was inserted and "no" for most of the others; pairs cannot be removed
+class BloomFilter {
+public:
+    /// @brief Constructs an empty filter with no blocks, which answers "maybe" for every pair
+    BloomFilter();
+
+    /// @brief Constructs an empty filter sized for the given number of pairs
+    /// @param capacity The number of pairs the filter is sized for
+    /// @param bits_per_pair The number of bits per pair, the false positive rate is about 3% at
+    ///  8 bits, 0.4% at 12 and 0.1% at 16
+    /// @exception UnavailableMemoryException If there isn't enough memory for the blocks
+    BloomFilter(size_t capacity, size_t bits_per_pair);
+
+    /// @brief Copy constructor
+    /// @param other The filter to copy
+    BloomFilter(const BloomFilter& other);
+
+    /// @brief Copy assignment
+    /// @param other The filter to copy
+    /// @return The filter that was copied to
+    BloomFilter& operator=(const BloomFilter& other);
+
+    /// @brief Move constructor
+    /// @param other The filter to move
+    BloomFilter(BloomFilter&& other) noexcept = default;
+
+    /// @brief Move assignment
+    /// @param other The filter to move
+    /// @return The filter that was moved to
+    BloomFilter& operator=(BloomFilter&& other) noexcept = default;
+
+    /// @brief Inserts a pair
+    /// @param first The first id of the pair
+    /// @param second The second id of the pair
+    void insert(size_t first, size_t second) noexcept;
+
+    /// @brief Tests if a pair may have been inserted
+    /// @param first The first id of the pair
+    /// @param second The second id of the pair
+    /// @return False if the pair was certainly never inserted, true if it may have been
+    bool may_contain(size_t first, size_t second) const noexcept;
+
+    /// @brief Get the number of pairs inserted
+    /// @return The number of pairs
+    size_t size() const;
+
+    /// @brief Get the number of pairs the filter is sized for, inserting more raises the false
+    ///  positive rate
+    /// @return The number of pairs
+    size_t capacity() const;
+
+    /// @brief Get the number of bits per pair the filter was sized with
+    /// @return The number of bits
+    size_t bits_per_pair() const;
+
+    /// @brief Get the number of bytes allocated by the filter
+    /// @return The number of bytes
+    size_t memory_usage() const;
+
+private:
+    /// @brief The number of 64 bit words of a block, a cache line
+    static const size_t BLOCK_WORDS = 8;
+
+    /// @brief Hashes a pair
+    /// @param first The first id of the pair
+    /// @param second The second id of the pair
+    /// @return The hash
+    static uint64_t hash_(size_t first, size_t second);
+
+    /// @brief Get the block of a hash
+    /// @param hash The hash
+    /// @return The first word of the block
+    const uint64_t* block_(uint64_t hash) const;
+
+    /// @brief Allocates the blocks aligned to a cache line, all of them zero
+    /// @param blocks The number of blocks
+    void allocate_(size_t blocks);
+
+    /// @brief The storage of the blocks, with slack for aligning the first one
+    std::vector<uint64_t> storage_;
+
+    /// @brief The index of the first word of the first block inside the storage
+    size_t offset_;
+
+    /// @brief The number of blocks
+    size_t blocks_;
+
+    /// @brief The number of pairs inserted
+    size_t size_;
+
+    /// @brief The number of bits per pair the filter was sized with
+    size_t bits_per_pair_;
+};
+
+/// @brief The odd multipliers spreading the low half of a hash over the bits of the words of a
+///  block, one per word
+static const uint32_t BLOOM_FILTER_SALTS[8] = { 0x47b6137bu, 0x44974d91u, 0x8824ad5bu,
+    0xa2b7289du, 0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u };
+
+inline BloomFilter::BloomFilter()
+    : offset_(0), blocks_(0), size_(0), bits_per_pair_(0) {}
+
+inline BloomFilter::BloomFilter(size_t capacity, size_t bits_per_pair)
+        : offset_(0), blocks_(0), size_(0), bits_per_pair_(std::max<size_t>(bits_per_pair, 1)) {
+    size_t bits = std::max<size_t>(capacity, 1) * bits_per_pair_;
+    allocate_((bits + 64 * BLOCK_WORDS - 1) / (64 * BLOCK_WORDS));
+}
+
+inline BloomFilter::BloomFilter(const BloomFilter& other)
+        : offset_(0), blocks_(0), size_(other.size_), bits_per_pair_(other.bits_per_pair_) {
+    // the storage of the copy is aligned differently, so the blocks are copied one by one
+    allocate_(other.blocks_);
+    std::copy(other.storage_.begin() + other.offset_,
+        other.storage_.begin() + other.offset_ + other.blocks_ * BLOCK_WORDS,
+        storage_.begin() + offset_);
+}
+
+inline BloomFilter& BloomFilter::operator=(const BloomFilter& other) {
+    if (this != &other) {
+        BloomFilter copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+inline void BloomFilter::allocate_(size_t blocks) {
+    try {
+        storage_.assign(blocks == 0 ? 0 : blocks * BLOCK_WORDS + BLOCK_WORDS - 1, 0);
+    }
+    catch (const std::bad_alloc&) {
+        throw UnavailableMemoryException::bloom_filter_unable_to_allocate();
+    }
+    uintptr_t address = reinterpret_cast<uintptr_t>(storage_.data());
+    size_t line = BLOCK_WORDS * sizeof(uint64_t);
+    offset_ = blocks == 0 ? 0 : ((line - address % line) % line) / sizeof(uint64_t);
+    blocks_ = blocks;
+}
+
+inline uint64_t BloomFilter::hash_(size_t first, size_t second) {
+    // the finalizer of murmur3 over the pair folded into a single word
+    uint64_t hash = static_cast<uint64_t>(first) * 0x9e3779b97f4a7c15ull ^
+        static_cast<uint64_t>(second);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+inline const uint64_t* BloomFilter::block_(uint64_t hash) const {
+    // the high half picks the block by a multiplication instead of a division
+    size_t block = static_cast<size_t>(((hash >> 32) * blocks_) >> 32);
+    return storage_.data() + offset_ + block * BLOCK_WORDS;
+}
+
+inline void BloomFilter::insert(size_t first, size_t second) noexcept {
+    ++size_;
+    if (blocks_ == 0) return;
+    uint64_t hash = hash_(first, second);
+    uint64_t* block = const_cast<uint64_t*>(block_(hash));
+    uint32_t low = static_cast<uint32_t>(hash);
+    for (size_t i = 0; i < BLOCK_WORDS; i++) {
+        block[i] |= uint64_t(1) << (static_cast<uint32_t>(low * BLOOM_FILTER_SALTS[i]) >> 26);
+    }
+}
+
+inline bool BloomFilter::may_contain(size_t first, size_t second) const noexcept {
+    if (blocks_ == 0) return true;
+    uint64_t hash = hash_(first, second);
+    const uint64_t* block = block_(hash);
+    uint32_t low = static_cast<uint32_t>(hash);
+#ifdef BLOOM_FILTER_AVX2
+    // the eight bit positions at once, widened to two vectors of four 64 bit lanes
+    __m256i salts = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(BLOOM_FILTER_SALTS));
+    __m256i positions = _mm256_srli_epi32(
+        _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(low)), salts), 26);
+    __m256i one = _mm256_set1_epi64x(1);
+    __m256i low_masks = _mm256_sllv_epi64(one,
+        _mm256_cvtepu32_epi64(_mm256_castsi256_si128(positions)));
+    __m256i high_masks = _mm256_sllv_epi64(one,
+        _mm256_cvtepu32_epi64(_mm256_extracti128_si256(positions, 1)));
+    __m256i low_words = _mm256_load_si256(reinterpret_cast<const __m256i*>(block));
+    __m256i high_words = _mm256_load_si256(reinterpret_cast<const __m256i*>(block + 4));
+    return _mm256_testc_si256(low_words, low_masks) && _mm256_testc_si256(high_words, high_masks);
+#else
+    uint64_t missing = 0;
+    for (size_t i = 0; i < BLOCK_WORDS; i++) {
+        uint64_t mask = uint64_t(1) << (static_cast<uint32_t>(low * BLOOM_FILTER_SALTS[i]) >> 26);
+        missing |= mask & ~block[i];
+    }
+    return missing == 0;
+#endif
+}
+
+inline size_t BloomFilter::size() const {
+    return size_;
+}
+
+inline size_t BloomFilter::capacity() const {
+    return bits_per_pair_ == 0 ? 0 : blocks_ * BLOCK_WORDS * 64 / bits_per_pair_;
+}
+
+inline size_t BloomFilter::bits_per_pair() const {
+    return bits_per_pair_;
+}
+
+inline size_t BloomFilter::memory_usage() const {
+    return storage_.capacity() * sizeof(uint64_t);
+}
+
+
+#endif
\ No newline at end of file
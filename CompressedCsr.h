@@ -0,0 +1,461 @@
+#ifndef __COMPRESSED_CSR_H
+#define __COMPRESSED_CSR_H
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include "Exceptions.h"
+#include "BitVector.h"
+#include "Graph.h"
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define COMPRESSED_CSR_SSSE3
+#endif
+
+
+/// @file CompressedCsr.h
+/// @brief Contains the read-only CompressedCsr adjacency and its member function definitions
+
+
+/// @brief A read-only compressed adjacency of a graph, stores the sorted neighbor list of every
+///  node as a copy mask over the list of a recent similar node followed by the remaining
+///  neighbors gap-encoded in the stream-vbyte layout
+class CompressedCsr {
+public:
+    /// @brief How many preceding nodes are considered as the reference of a neighbor list
+    static const size_t REFERENCE_WINDOW = 7;
+
+    /// @brief The longest chain of references that has to be followed to decode a list
+    static const size_t MAX_REFERENCE_CHAIN = 1;
+
+    /// @brief Constructs an empty compressed adjacency with no nodes
+    CompressedCsr();
+
+    /// @brief Constructs a compressed adjacency over the given number of nodes with the
+    ///  given entries, duplicate entries are stored once
+    /// @param nodes The number of nodes
+    /// @param entries The pairs of source and target ids, each has to be less than nodes
+    /// @exception NonexistingItemException If an entry refers to a node that does not exist
+    /// @exception InvalidArgumentException If there are too many nodes for 32 bit gaps
+    CompressedCsr(size_t nodes, std::vector<std::pair<size_t, size_t>> entries);
+
+    /// @brief Constructs a compressed adjacency from the adjacency of the given edges
+    /// @tparam NData The data associated with the Graph's nodes
+    /// @tparam EData The data associated with the Graph's edges
+    /// @param edges The edges to construct the compressed adjacency from
+    template <typename NData, typename EData>
+    explicit CompressedCsr(const Edges<NData, EData>& edges);
+
+    /// @brief Get the number of nodes
+    /// @return The number of nodes
+    size_t size() const;
+
+    /// @brief Get the number of entries, each undirected edge counts as two
+    /// @return The number of entries
+    size_t entry_count() const;
+
+    /// @brief Tests the existence of an edge with a given source and target
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    /// @return True if the edge exists, false if it does not
+    /// @exception NonexistingItemException If testing the existence of an edge between a source
+    ///  and or target node that does not exist
+    bool exists(size_t source, size_t target) const;
+
+    /// @brief Get the targets of all edges outgoing from the given source
+    /// @param source The id of the source node
+    /// @return The ids of the target nodes in increasing order
+    /// @exception NonexistingItemException If the source node does not exist
+    std::vector<size_t> neighbors(size_t source) const;
+
+    /// @brief Calls the given function for the target of every edge outgoing from the given
+    ///  source, in the order of increasing target ids
+    /// @tparam Function A callable taking the id of the target node
+    /// @param source The id of the source node
+    /// @param function The function to call
+    /// @exception NonexistingItemException If the source node does not exist
+    template <typename Function>
+    void for_each_neighbor(size_t source, Function function) const;
+
+    /// @brief Get the number of bytes used by the compressed adjacency
+    /// @return The number of bytes
+    size_t memory_usage() const;
+
+private:
+    /// @brief Appends the encoded neighbor list of a node to the data
+    /// @param node The id of the node
+    /// @param list The sorted neighbor list of the node
+    /// @param length The length of the neighbor list
+    /// @param reference How many nodes back the reference list is, 0 for no reference
+    /// @param reference_list The sorted neighbor list of the reference node
+    /// @param reference_length The length of the neighbor list of the reference node
+    void encode_(size_t node, const uint32_t* list, size_t length, size_t reference,
+        const uint32_t* reference_list, size_t reference_length);
+
+    /// @brief Reusable decoding buffers, so decoding a list does not allocate
+    struct Buffers {
+        /// @brief The decoded lists, one for every step of a chain of references
+        std::vector<uint32_t> lists[MAX_REFERENCE_CHAIN + 1];
+
+        /// @brief The neighbors copied from the reference list
+        std::vector<uint32_t> copied;
+
+        /// @brief The neighbors that were not copied
+        std::vector<uint32_t> residuals;
+    };
+
+    /// @brief Lends decoding buffers of the current thread for its lifetime, nested decoding
+    ///  (from inside a for_each_neighbor callback) gets buffers of its own
+    class BuffersLease {
+    public:
+        /// @brief Takes free buffers of the current thread or allocates new ones
+        BuffersLease();
+
+        /// @brief Returns the buffers to the current thread
+        ~BuffersLease();
+
+        /// @brief The lent buffers
+        std::unique_ptr<Buffers> buffers;
+
+    private:
+        /// @brief Get the buffers that are not lent out of the current thread
+        /// @return The free buffers
+        static std::vector<std::unique_ptr<Buffers>>& free_buffers_();
+    };
+
+    /// @brief Decodes the neighbor list of a node into buffers.lists[depth]
+    /// @param node The id of the node
+    /// @param depth The number of references followed to get to this node
+    /// @param buffers The decoding buffers
+    void decode_(size_t node, size_t depth, Buffers& buffers) const;
+
+    /// @brief Appends an unsigned variable length integer, 7 bits per byte
+    /// @param value The value to append
+    void write_varint_(uint64_t value);
+
+    /// @brief Reads an unsigned variable length integer and moves past it
+    /// @param position The position to read from
+    /// @return The value
+    static uint64_t read_varint_(const uint8_t*& position);
+
+    /// @brief Appends values in the stream-vbyte layout, all two bit length codes first,
+    ///  four per control byte, followed by the 1 to 4 little endian bytes of every value
+    /// @param values The values
+    /// @param count The number of values
+    void write_stream_vbyte_(const uint32_t* values, size_t count);
+
+    /// @brief Reads values stored in the stream-vbyte layout, decodes four values per control
+    ///  byte with a single shuffle when SSSE3 is available
+    /// @param position The position to read from
+    /// @param values The array the values are written to
+    /// @param count The number of values
+    /// @return The position after the values
+    static const uint8_t* read_stream_vbyte_(const uint8_t* position, uint32_t* values,
+        size_t count);
+
+    /// @brief The encoded neighbor lists, followed by padding for reading 16 bytes at once
+    std::vector<uint8_t> data_;
+
+    /// @brief The position of the neighbor list of every node inside the data, and its end
+    std::vector<uint64_t> offsets_;
+
+    /// @brief The number of nodes
+    size_t size_;
+
+    /// @brief The number of entries
+    size_t entry_count_;
+};
+
+template <typename NData, typename EData>
+CompressedCsr::CompressedCsr(const Edges<NData, EData>& edges)
+    : CompressedCsr(edges.adjacency().size(), edges.adjacency().entries()) {}
+
+inline CompressedCsr::CompressedCsr() : offsets_(1, 0), size_(0), entry_count_(0) {
+    data_.resize(16, 0);
+}
+
+inline CompressedCsr::CompressedCsr(size_t nodes, std::vector<std::pair<size_t, size_t>> entries)
+        : size_(nodes), entry_count_(0) {
+    if (nodes > UINT32_MAX)
+        throw InvalidArgumentException::compressed_adjacency_too_many_nodes(nodes);
+    for (const auto& entry : entries) {
+        if (entry.first >= nodes || entry.second >= nodes)
+            throw NonexistingItemException::accessing_edge_with_nonexistant_nodes
+            (entry.first, entry.second, nodes);
+    }
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+    entry_count_ = entries.size();
+
+    // plain csr first, so the lists of the preceding nodes can be compared against
+    std::vector<uint32_t> targets(entries.size());
+    std::vector<size_t> starts(nodes + 1, 0);
+    for (size_t i = 0; i < entries.size(); i++) {
+        targets[i] = static_cast<uint32_t>(entries[i].second);
+        ++starts[entries[i].first + 1];
+    }
+    for (size_t i = 0; i < nodes; i++) {
+        starts[i + 1] += starts[i];
+    }
+
+    std::vector<size_t> chain(nodes, 0);
+    offsets_.reserve(nodes + 1);
+    for (size_t node = 0; node < nodes; node++) {
+        const uint32_t* list = targets.data() + starts[node];
+        size_t length = starts[node + 1] - starts[node];
+        size_t best_reference = 0;
+        long long best_gain = 0;
+        for (size_t back = 1; back <= REFERENCE_WINDOW && back <= node && length > 0; back++) {
+            size_t candidate = node - back;
+            if (chain[candidate] >= MAX_REFERENCE_CHAIN) continue;
+            const uint32_t* other = targets.data() + starts[candidate];
+            size_t other_length = starts[candidate + 1] - starts[candidate];
+            if (other_length == 0) continue;
+            size_t common = 0;
+            for (size_t i = 0, j = 0; i < length && j < other_length;) {
+                if (list[i] < other[j]) i++;
+                else if (other[j] < list[i]) j++;
+                else { common++; i++; j++; }
+            }
+            // every copied neighbor saves at least a byte, the mask costs a bit per candidate
+            long long gain = static_cast<long long>(common)
+                - static_cast<long long>((other_length + 7) / 8) - 1;
+            if (gain > best_gain) {
+                best_gain = gain;
+                best_reference = back;
+            }
+        }
+        offsets_.push_back(data_.size());
+        if (best_reference == 0) {
+            encode_(node, list, length, 0, nullptr, 0);
+        }
+        else {
+            size_t reference_node = node - best_reference;
+            chain[node] = chain[reference_node] + 1;
+            encode_(node, list, length, best_reference, targets.data() + starts[reference_node],
+                starts[reference_node + 1] - starts[reference_node]);
+        }
+    }
+    offsets_.push_back(data_.size());
+    data_.resize(data_.size() + 16, 0);
+    data_.shrink_to_fit();
+}
+
+inline void CompressedCsr::encode_(size_t node, const uint32_t* list, size_t length,
+        size_t reference, const uint32_t* reference_list, size_t reference_length) {
+    write_varint_(reference);
+    std::vector<uint32_t> residuals;
+    residuals.reserve(length);
+    if (reference != 0) {
+        std::vector<uint8_t> mask((reference_length + 7) / 8, 0);
+        size_t j = 0;
+        for (size_t i = 0; i < length; i++) {
+            while (j < reference_length && reference_list[j] < list[i]) j++;
+            if (j < reference_length && reference_list[j] == list[i]) {
+                mask[j / 8] |= static_cast<uint8_t>(1 << (j % 8));
+            }
+            else {
+                residuals.push_back(list[i]);
+            }
+        }
+        data_.insert(data_.end(), mask.begin(), mask.end());
+    }
+    else {
+        residuals.assign(list, list + length);
+    }
+    write_varint_(residuals.size());
+    if (residuals.empty()) return;
+    // the first residual relative to the node itself, zig-zag encoded as it may be lower
+    long long first = static_cast<long long>(residuals[0]) - static_cast<long long>(node);
+    write_varint_(first >= 0 ? static_cast<uint64_t>(first) << 1
+        : (static_cast<uint64_t>(-first) << 1) - 1);
+    for (size_t i = residuals.size() - 1; i > 0; i--) {
+        residuals[i] = residuals[i] - residuals[i - 1] - 1;
+    }
+    write_stream_vbyte_(residuals.data() + 1, residuals.size() - 1);
+}
+
+inline CompressedCsr::BuffersLease::BuffersLease() {
+    std::vector<std::unique_ptr<Buffers>>& free = free_buffers_();
+    if (free.empty()) {
+        buffers = std::make_unique<Buffers>();
+    }
+    else {
+        buffers = std::move(free.back());
+        free.pop_back();
+    }
+}
+
+inline CompressedCsr::BuffersLease::~BuffersLease() {
+    try {
+        free_buffers_().push_back(std::move(buffers));
+    }
+    catch (...) {
+        // the buffers are simply freed
+    }
+}
+
+inline std::vector<std::unique_ptr<CompressedCsr::Buffers>>&
+        CompressedCsr::BuffersLease::free_buffers_() {
+    thread_local std::vector<std::unique_ptr<Buffers>> free;
+    return free;
+}
+
+inline void CompressedCsr::decode_(size_t node, size_t depth, Buffers& buffers) const {
+    const uint8_t* position = data_.data() + offsets_[node];
+    size_t reference = static_cast<size_t>(read_varint_(position));
+    std::vector<uint32_t>& copied = buffers.copied;
+    if (reference != 0) {
+        // the reference is decoded first, as it uses the shared copied and residuals buffers
+        decode_(node - reference, depth + 1, buffers);
+    }
+    copied.clear();
+    if (reference != 0) {
+        const std::vector<uint32_t>& reference_list = buffers.lists[depth + 1];
+        size_t mask_bytes = (reference_list.size() + 7) / 8;
+        for (size_t byte = 0; byte < mask_bytes; byte++) {
+            for (unsigned bits = position[byte]; bits != 0; bits &= bits - 1) {
+                size_t bit = BitVector::popcount((bits & (0u - bits)) - 1);
+                copied.push_back(reference_list[byte * 8 + bit]);
+            }
+        }
+        position += mask_bytes;
+    }
+    size_t residual_count = static_cast<size_t>(read_varint_(position));
+    std::vector<uint32_t>& residuals = buffers.residuals;
+    residuals.resize(residual_count);
+    if (residual_count > 0) {
+        uint64_t zigzag = read_varint_(position);
+        long long first = (zigzag & 1) ? -static_cast<long long>((zigzag + 1) >> 1)
+            : static_cast<long long>(zigzag >> 1);
+        residuals[0] = static_cast<uint32_t>(static_cast<long long>(node) + first);
+        read_stream_vbyte_(position, residuals.data() + 1, residual_count - 1);
+        for (size_t i = 1; i < residual_count; i++) {
+            residuals[i] += residuals[i - 1] + 1;
+        }
+    }
+    std::vector<uint32_t>& list = buffers.lists[depth];
+    list.resize(copied.size() + residuals.size());
+    std::merge(copied.begin(), copied.end(), residuals.begin(), residuals.end(), list.begin());
+}
+
+inline void CompressedCsr::write_varint_(uint64_t value) {
+    while (value >= 0x80) {
+        data_.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    data_.push_back(static_cast<uint8_t>(value));
+}
+
+inline uint64_t CompressedCsr::read_varint_(const uint8_t*& position) {
+    uint64_t value = 0;
+    for (unsigned shift = 0;; shift += 7) {
+        uint8_t byte = *position++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return value;
+    }
+}
+
+inline void CompressedCsr::write_stream_vbyte_(const uint32_t* values, size_t count) {
+    size_t control_start = data_.size();
+    data_.resize(data_.size() + (count + 3) / 4, 0);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t value = values[i];
+        uint8_t bytes = value < (1u << 8) ? 1 : value < (1u << 16) ? 2 : value < (1u << 24) ? 3 : 4;
+        data_[control_start + i / 4] |= static_cast<uint8_t>((bytes - 1) << (2 * (i % 4)));
+        for (uint8_t b = 0; b < bytes; b++) {
+            data_.push_back(static_cast<uint8_t>(value >> (8 * b)));
+        }
+    }
+}
+
+inline const uint8_t* CompressedCsr::read_stream_vbyte_(const uint8_t* position,
+        uint32_t* values, size_t count) {
+    const uint8_t* control = position;
+    const uint8_t* data = position + (count + 3) / 4;
+    size_t i = 0;
+#ifdef COMPRESSED_CSR_SSSE3
+    // shuffle masks moving the bytes of four values of the given lengths to 32 bit lanes
+    struct Tables {
+        alignas(16) uint8_t shuffles[256][16];
+        uint8_t lengths[256];
+        Tables() {
+            for (int code = 0; code < 256; code++) {
+                uint8_t offset = 0;
+                for (int lane = 0; lane < 4; lane++) {
+                    int bytes = ((code >> (2 * lane)) & 3) + 1;
+                    for (int b = 0; b < 4; b++) {
+                        shuffles[code][4 * lane + b] = b < bytes ? offset + b : 0x80;
+                    }
+                    offset += static_cast<uint8_t>(bytes);
+                }
+                lengths[code] = offset;
+            }
+        }
+    };
+    static const Tables tables;
+    for (; i + 4 <= count; i += 4) {
+        uint8_t code = control[i / 4];
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(tables.shuffles[code]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), _mm_shuffle_epi8(bytes, shuffle));
+        data += tables.lengths[code];
+    }
+#endif
+    for (; i < count; i++) {
+        int bytes = ((control[i / 4] >> (2 * (i % 4))) & 3) + 1;
+        uint32_t value = 0;
+        for (int b = 0; b < bytes; b++) {
+            value |= static_cast<uint32_t>(data[b]) << (8 * b);
+        }
+        values[i] = value;
+        data += bytes;
+    }
+    return data;
+}
+
+inline size_t CompressedCsr::size() const {
+    return size_;
+}
+
+inline size_t CompressedCsr::entry_count() const {
+    return entry_count_;
+}
+
+inline bool CompressedCsr::exists(size_t source, size_t target) const {
+    if (source >= size_ || target >= size_)
+        throw NonexistingItemException::testing_existence_of_edge_with_nonexistant_nodes(source,
+            target, size_);
+    BuffersLease lease;
+    decode_(source, 0, *lease.buffers);
+    const std::vector<uint32_t>& list = lease.buffers->lists[0];
+    return std::binary_search(list.begin(), list.end(), static_cast<uint32_t>(target));
+}
+
+inline std::vector<size_t> CompressedCsr::neighbors(size_t source) const {
+    std::vector<size_t> result;
+    for_each_neighbor(source, [&](size_t target) { result.push_back(target); });
+    return result;
+}
+
+template <typename Function>
+void CompressedCsr::for_each_neighbor(size_t source, Function function) const {
+    if (source >= size_)
+        throw NonexistingItemException::accessing_edge_nonexistant_source(source, size_);
+    BuffersLease lease;
+    decode_(source, 0, *lease.buffers);
+    for (uint32_t target : lease.buffers->lists[0]) {
+        function(static_cast<size_t>(target));
+    }
+}
+
+inline size_t CompressedCsr::memory_usage() const {
+    return sizeof(*this) + data_.capacity() * sizeof(uint8_t)
+        + offsets_.capacity() * sizeof(uint64_t);
+}
+
+
+#endif
\ No newline at end of file
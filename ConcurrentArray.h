@@ -0,0 +1,236 @@
+#ifndef __CONCURRENT_ARRAY_H
+#define __CONCURRENT_ARRAY_H
+
+#include <atomic>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "Exceptions.h"
+
+
+/// @file ConcurrentArray.h
+/// @brief Contains the ConcurrentArray class used as internal storage for the concurrent graph
+///  and its member function definitions
+
+namespace my_array {
+
+	/// @brief The size of the first segment of a concurrent array
+	const size_t FIRST_SEGMENT_SIZE = 16;
+
+	/// @brief The most segments a concurrent array can have, segment k holds
+	///  FIRST_SEGMENT_SIZE << k elements, so this is never the limit in practice
+	const size_t MAX_SEGMENTS = 48;
+
+	/// @brief An append-only dynamic array that can be read by any number of threads while
+	///  other threads append to it, never moves or invalidates its elements
+	/// @tparam element The element of the array
+	template <typename element>
+	class ConcurrentArray {
+	public:
+		/// @brief Constructs an empty concurrent array
+		ConcurrentArray();
+
+		/// @brief Destroys the elements and frees the segments, no thread may be reading it
+		~ConcurrentArray();
+
+		ConcurrentArray(const ConcurrentArray<element>& other) = delete;
+		ConcurrentArray<element>& operator=(const ConcurrentArray<element>& other) = delete;
+
+		/// @brief Construct an item at the end of the array and publish it to the readers,
+		///  only one thread may be appending at a time
+		/// @tparam Args The types of the constructor arguments of the element
+		/// @param args The constructor arguments of the element
+		/// @return A reference to the constructed element
+		/// @exception UnavailableMemoryException If a new segment cannot be allocated
+		template <typename... Args>
+		element& emplace_back(Args&&... args);
+
+		/// @brief Move an item to the end of the array and publish it to the readers, any number
+		///  of threads may be appending at a time; the index is reserved atomically and the
+		///  items are published in the order of their indices, so every index below size()
+		///  always holds a constructed item; cannot be mixed with emplace_back on the same array
+		/// @param item The item to move
+		/// @return The index of the item
+		/// @exception UnavailableMemoryException If a new segment cannot be allocated,
+		///  nothing is reserved then
+		size_t append(element&& item);
+
+		/// @brief Move an item to the end of the array like append, calling the given function
+		///  with the index once the item is in place but before any reader can see it
+		/// @tparam Function A callable taking the index, must not throw
+		/// @param item The item to move
+		/// @param before_publish The function to call
+		/// @return The index of the item
+		/// @exception UnavailableMemoryException If a new segment cannot be allocated,
+		///  nothing is reserved then
+		template <typename Function>
+		size_t append(element&& item, Function before_publish);
+
+		/// @brief Get the number of published elements
+		/// @return The count of elements of the array
+		size_t size() const;
+
+		/// @brief Get the element at a given index
+		/// @param index The index of the element
+		/// @return A reference to the element at the given index
+		/// @exception OutOfRangeException If tried to acces an index that was not published
+		element& at(size_t index) const;
+
+		/// @brief Get the element at a given index, expects it to be published
+		/// @param index The index of the element
+		/// @return A reference to the element at the given index
+		element& operator[](size_t index) const;
+
+		/// @brief Get the number of bytes allocated by the segments, their free spots included
+		/// @return The number of bytes
+		size_t memory_usage() const;
+
+	private:
+		/// @brief Get the segment and the position inside it of the given index
+		/// @param index The index of the element
+		/// @param segment The segment of the element
+		/// @param offset The position of the element inside its segment
+		static void locate_(size_t index, size_t& segment, size_t& offset);
+
+		/// @brief Allocates the given segment unless it already exists
+		/// @param segment The segment
+		/// @return The segment
+		/// @exception UnavailableMemoryException If the segment cannot be allocated
+		element* ensure_segment_(size_t segment);
+
+		/// @brief The segments of the elements, once set a segment pointer never changes
+		std::atomic<element*> segments_[MAX_SEGMENTS];
+
+		/// @brief The number of published elements
+		std::atomic<size_t> size_;
+
+		/// @brief The number of reserved indices, at least the number of published elements
+		std::atomic<size_t> reserved_;
+	};
+
+	template <typename element>
+	ConcurrentArray<element>::ConcurrentArray() : size_(0), reserved_(0) {
+		for (size_t i = 0; i < MAX_SEGMENTS; i++) {
+			segments_[i].store(nullptr, std::memory_order_relaxed);
+		}
+	}
+
+	template <typename element>
+	ConcurrentArray<element>::~ConcurrentArray() {
+		size_t count = size_.load(std::memory_order_acquire);
+		for (size_t i = 0; i < count; i++) {
+			(*this)[i].~element();
+		}
+		for (size_t i = 0; i < MAX_SEGMENTS; i++) {
+			::operator delete(segments_[i].load(std::memory_order_relaxed));
+		}
+	}
+
+	template <typename element>
+	void ConcurrentArray<element>::locate_(size_t index, size_t& segment, size_t& offset) {
+		// segment k starts at FIRST_SEGMENT_SIZE * (2^k - 1)
+		size_t scaled = index / FIRST_SEGMENT_SIZE + 1;
+		segment = 0;
+		while (scaled >>= 1) ++segment;
+		offset = index - FIRST_SEGMENT_SIZE * ((size_t(1) << segment) - 1);
+	}
+
+	template <typename element>
+	element* ConcurrentArray<element>::ensure_segment_(size_t segment) {
+		if (segment >= MAX_SEGMENTS) throw UnavailableMemoryException::array_unable_to_insert();
+		element* block = segments_[segment].load(std::memory_order_acquire);
+		if (block != nullptr) return block;
+		element* allocated;
+		try {
+			allocated = static_cast<element*>(
+				::operator new(sizeof(element) * (FIRST_SEGMENT_SIZE << segment)));
+		}
+		catch (std::bad_alloc& e) {
+			(void)e;
+			throw UnavailableMemoryException::array_unable_to_insert();
+		}
+		// another appender may have allocated the segment in the meantime
+		if (!segments_[segment].compare_exchange_strong(block, allocated,
+			std::memory_order_acq_rel, std::memory_order_acquire)) {
+			::operator delete(allocated);
+			return block;
+		}
+		return allocated;
+	}
+
+	template <typename element>
+	template <typename... Args>
+	element& ConcurrentArray<element>::emplace_back(Args&&... args) {
+		size_t index = size_.load(std::memory_order_relaxed);
+		size_t segment, offset;
+		locate_(index, segment, offset);
+		element* block = ensure_segment_(segment);
+		element* item = new (block + offset) element(std::forward<Args>(args)...);
+		reserved_.store(index + 1, std::memory_order_relaxed);
+		// the element is fully constructed before any reader can see the new size
+		size_.store(index + 1, std::memory_order_release);
+		return *item;
+	}
+
+	template <typename element>
+	size_t ConcurrentArray<element>::append(element&& item) {
+		return append(std::move(item), [](size_t) {});
+	}
+
+	template <typename element>
+	template <typename Function>
+	size_t ConcurrentArray<element>::append(element&& item, Function before_publish) {
+		static_assert(std::is_nothrow_move_constructible<element>::value,
+			"ConcurrentArray::append needs a nothrow move constructor, "
+			"a reserved index cannot be given back");
+		size_t index = reserved_.load(std::memory_order_relaxed);
+		size_t segment, offset;
+		element* block;
+		// the segment exists before the index is reserved, so nothing can fail afterwards
+		do {
+			locate_(index, segment, offset);
+			block = ensure_segment_(segment);
+		} while (!reserved_.compare_exchange_weak(index, index + 1, std::memory_order_relaxed));
+		new (block + offset) element(std::move(item));
+		before_publish(index);
+		// publish in order, the appenders before this one only have a move left to do
+		while (size_.load(std::memory_order_acquire) != index) std::this_thread::yield();
+		size_.store(index + 1, std::memory_order_release);
+		return index;
+	}
+
+	template <typename element>
+	size_t ConcurrentArray<element>::size() const {
+		return size_.load(std::memory_order_acquire);
+	}
+
+	template <typename element>
+	size_t ConcurrentArray<element>::memory_usage() const {
+		size_t bytes = 0;
+		for (size_t i = 0; i < MAX_SEGMENTS; i++) {
+			if (segments_[i].load(std::memory_order_acquire) != nullptr)
+				bytes += sizeof(element) * (FIRST_SEGMENT_SIZE << i);
+		}
+		return bytes;
+	}
+
+	template <typename element>
+	element& ConcurrentArray<element>::at(size_t index) const {
+		if (index >= size()) throw OutOfRangeException::array_accessing_invalid_index(index);
+		return (*this)[index];
+	}
+
+	template <typename element>
+	element& ConcurrentArray<element>::operator[](size_t index) const {
+		size_t segment, offset;
+		locate_(index, segment, offset);
+		return segments_[segment].load(std::memory_order_acquire)[offset];
+	}
+};
+
+
+
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,534 @@
+#ifndef __CONCURRENT_GRAPH_H
+#define __CONCURRENT_GRAPH_H
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include "Exceptions.h"
+#include "ConcurrentArray.h"
+#include "Epoch.h"
+#include "MemoryUsage.h"
+
+
+/// @file ConcurrentGraph.h
+/// @brief Contains the ConcurrentGraph and Concurrent Directed Graph and Concurrent Undirected
+///  Graph and their member function definitions
+
+
+/// @brief A graph that any number of threads can read without taking locks while one thread adds
+///  nodes and any number of threads add edges; nodes and edges never move once added, adjacency
+///  rows are replaced by updated copies with compare and swap and the old ones are freed once no
+///  reader can be using them. Edge ids are dense and assigned in the order the edges are
+///  reserved, an edge becomes visible to every read at once when edge_count grows over its id
+/// @tparam NData The data associated with the Graph's nodes
+/// @tparam EData The data associated with the Graph's edges, its move constructor must not throw
+template <typename NData, typename EData>
+class ConcurrentGraph {
+public:
+    /// @brief The empty graph constructor
+    ConcurrentGraph() = default;
+
+    /// @brief The virtual destructor, no thread may be reading the graph anymore
+    virtual ~ConcurrentGraph() = 0;
+
+    ConcurrentGraph(const ConcurrentGraph& other) = delete;
+    ConcurrentGraph& operator=(const ConcurrentGraph& other) = delete;
+
+    /// @brief Add a node, only one thread may be adding nodes at a time, edges can be added
+    ///  meanwhile
+    /// @param data The node data of the node to add
+    /// @return The id of the added node
+    /// @exception UnavailableMemoryException If the nodes cannot grow due to running out of memory
+    size_t add_node(const NData& data);
+
+    /// @brief Add an edge, any number of threads may be adding edges at a time; of the threads
+    ///  adding the same edge exactly one succeeds
+    /// @param source The id of the source node of the edge to add
+    /// @param target The id of the target node of the edge to add
+    /// @param data The edge data of the edge to add
+    /// @return The id of the added edge
+    /// @exception NonexistingItemException If attempting to add an edge between nodes that do
+    ///  not exist
+    /// @exception ConflictingItemException If attempting to add an edge between nodes that
+    ///  already have an edge between them
+    /// @exception UnavailableMemoryException If the edges cannot grow due to running out of memory
+    size_t add_edge(size_t source, size_t target, const EData& data);
+
+    /// @brief Returns the number of nodes, also makes the graph an adjacency view
+    /// @return The number of nodes
+    size_t size() const;
+
+    /// @brief Returns the number of edges
+    /// @return The number of edges
+    size_t edge_count() const;
+
+    /// @brief Tests the existence of an edge with a given source and target
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    /// @return True if the edge exists, false if it does not
+    /// @exception NonexistingItemException If testing the existence of an edge between a source
+    ///  and or target node that does not exist
+    bool exists(size_t source, size_t target) const;
+
+    /// @brief Gets the id of the edge with the given source and target
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    /// @return The id of the edge
+    /// @exception NonexistingItemException If the nodes or the edge between them do not exist
+    size_t edge_id(size_t source, size_t target) const;
+
+    /// @brief Gets the node data of the node with the given id
+    /// @param id The id of the node
+    /// @return A reference to the node data, valid as long as the graph
+    /// @exception NonexistingItemException If no node with the given id exists
+    const NData& node_data(size_t id) const;
+
+    /// @brief Gets the edge data of the edge with the given id
+    /// @param id The id of the edge
+    /// @return A reference to the edge data, valid as long as the graph
+    /// @exception NonexistingItemException If no edge with the given id exists
+    const EData& edge_data(size_t id) const;
+
+    /// @brief Gets the source and target of the edge with the given id
+    /// @param id The id of the edge
+    /// @return The ids of the source and target nodes
+    /// @exception NonexistingItemException If no edge with the given id exists
+    std::pair<size_t, size_t> endpoints(size_t id) const;
+
+    /// @brief Calls the given function for the target of every edge outgoing from the given
+    ///  source, in the order of increasing target ids, as of a single point in time
+    /// @tparam Function A callable taking the id of the target node
+    /// @param source The id of the source node
+    /// @param function The function to call
+    /// @exception NonexistingItemException If the source node does not exist
+    template <typename Function>
+    void for_each_neighbor(size_t source, Function function) const;
+
+    /// @brief Pins the current epoch, so a reader doing many reads pays for pinning only once,
+    ///  every read pins on its own otherwise
+    /// @return The guard keeping the epoch pinned
+    EpochManager::Guard pin() const;
+
+    /// @brief Get the epoch manager reclaiming the replaced adjacency rows
+    /// @return The epoch manager
+    EpochManager& epochs() const;
+
+    /// @brief Get the memory used by the graph split by component like Graph::memory_usage,
+    ///  the links of the edges count as edges and the rows as adjacency; rows replaced but not
+    ///  reclaimed yet are not counted. Safe to call while other threads add, the result is then
+    ///  only as exact as a snapshot of the sizes allows
+    /// @return The breakdown in bytes
+    MemoryUsage memory_usage() const;
+
+    /// @brief Returns if the graph is or is not undirected
+    /// @return True if the graph is undirected, false if it is directed
+    virtual bool is_undirected() const = 0;
+
+private:
+    /// @brief The state of an edge shared by its entries in the rows: the id of the edge once
+    ///  it was added, PENDING while it is being added and DEAD if adding it failed
+    using Link = std::atomic<size_t>;
+
+    /// @brief The link state of an edge being added
+    static const size_t PENDING = SIZE_MAX;
+
+    /// @brief The link state of an edge that failed to be added, its entries count as empty
+    ///  and the next thread adding the same edge revives the link
+    static const size_t DEAD = SIZE_MAX - 1;
+
+    /// @brief An edge as stored inside the graph
+    struct EdgeRecord {
+        /// @brief Constructs an edge record
+        /// @param source The id of the source node
+        /// @param target The id of the target node
+        /// @param data The edge data
+        EdgeRecord(size_t source, size_t target, const EData& data);
+
+        /// @brief The id of the source node
+        size_t source;
+
+        /// @brief The id of the target node
+        size_t target;
+
+        /// @brief The edge data
+        EData data;
+
+        /// @brief The link of the edge, owned by the record once the edge is added
+        std::unique_ptr<Link> link;
+    };
+
+    /// @brief An immutable adjacency row, pairs of target id and edge link sorted by target id
+    using Row = std::vector<std::pair<size_t, Link*>>;
+
+    /// @brief Makes the record of an edge about to be added
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    /// @param data The edge data
+    /// @return The record, without a link
+    /// @exception UnavailableMemoryException If copying the edge data fails
+    static EdgeRecord make_record_(size_t source, size_t target, const EData& data);
+
+    /// @brief Finds the entry of the given target inside a row
+    /// @param row The row, may be nullptr for an empty row
+    /// @param target The id of the target node
+    /// @return The link of the entry, nullptr if there is none
+    static Link* find_link_(const Row* row, size_t target);
+
+    /// @brief Finds the edge between the given nodes inside a row
+    /// @param row The row of the source node, may be nullptr for an empty row
+    /// @param target The id of the target node
+    /// @param edges_size The number of visible edges
+    /// @return The id of the edge, SIZE_MAX if there is none or it is not visible yet
+    static size_t find_(const Row* row, size_t target, size_t edges_size);
+
+    /// @brief Makes a copy of the given row with an added entry
+    /// @param row The row to copy, may be nullptr for an empty row
+    /// @param target The id of the target node
+    /// @param link The link of the edge
+    /// @return The new row
+    /// @exception UnavailableMemoryException If there isn't enough memory for the new row
+    static Row* insert_(const Row* row, size_t target, Link* link);
+
+    /// @brief Claims the entry of the given target inside the given row for the given link,
+    ///  retrying with compare and swap until no other thread replaced the row in the meantime
+    /// @param source The id of the node whose row to update
+    /// @param target The id of the target node
+    /// @param link The link to put into the entry
+    /// @return The link holding the entry: the given one, or a dead one that was revived;
+    ///  nullptr if another edge holds the entry
+    /// @exception UnavailableMemoryException If there isn't enough memory for the new row
+    Link* claim_(size_t source, size_t target, Link* link);
+
+    /// @brief The node data of the nodes
+    my_array::ConcurrentArray<NData> nodes_;
+
+    /// @brief The adjacency rows of the nodes, published before the nodes themselves
+    my_array::ConcurrentArray<std::atomic<const Row*>> rows_;
+
+    /// @brief The edges, appended concurrently
+    my_array::ConcurrentArray<EdgeRecord> edges_;
+
+    /// @brief Reclaims the replaced adjacency rows
+    mutable EpochManager epochs_;
+};
+
+/// @brief A concurrent directed graph
+/// @tparam NData The data associated with the Graph's nodes
+/// @tparam EData The data associated with the Graph's edges
+template <typename NData, typename EData>
+class ConcurrentDirectedGraph : public ConcurrentGraph<NData, EData> {
+public:
+    /// @brief Returns if the graph is or is not undirected
+    /// @return False
+    bool is_undirected() const override;
+};
+
+/// @brief A concurrent undirected graph
+/// @tparam NData The data associated with the Graph's nodes
+/// @tparam EData The data associated with the Graph's edges
+template <typename NData, typename EData>
+class ConcurrentUndirectedGraph : public ConcurrentGraph<NData, EData> {
+public:
+    /// @brief Returns if the graph is or is not undirected
+    /// @return True
+    bool is_undirected() const override;
+};
+
+template <typename NData, typename EData>
+ConcurrentGraph<NData, EData>::~ConcurrentGraph() {
+    // the links of added edges belong to their records, dead ones only to the rows
+    std::vector<Link*> dead;
+    for (size_t i = 0; i < rows_.size(); i++) {
+        const Row* row = rows_[i].load(std::memory_order_relaxed);
+        if (row == nullptr) continue;
+        for (const auto& entry : *row) {
+            if (entry.second->load(std::memory_order_relaxed) == DEAD) dead.push_back(entry.second);
+        }
+        delete row;
+    }
+    std::sort(dead.begin(), dead.end());
+    dead.erase(std::unique(dead.begin(), dead.end()), dead.end());
+    for (Link* link : dead) {
+        delete link;
+    }
+}
+
+template <typename NData, typename EData>
+inline bool ConcurrentDirectedGraph<NData, EData>::is_undirected() const {
+    return false;
+}
+
+template <typename NData, typename EData>
+inline bool ConcurrentUndirectedGraph<NData, EData>::is_undirected() const {
+    return true;
+}
+
+template <typename NData, typename EData>
+ConcurrentGraph<NData, EData>::EdgeRecord::EdgeRecord(size_t source, size_t target,
+    const EData& data) : source(source), target(target), data(data) {}
+
+template <typename NData, typename EData>
+typename ConcurrentGraph<NData, EData>::EdgeRecord ConcurrentGraph<NData, EData>::make_record_
+        (size_t source, size_t target, const EData& data) {
+    try {
+        return EdgeRecord(source, target, data);
+    }
+    catch (...) {
+        throw UnavailableMemoryException::edge_container_unable_to_insert();
+    }
+}
+
+template <typename NData, typename EData>
+typename ConcurrentGraph<NData, EData>::Link* ConcurrentGraph<NData, EData>::find_link_
+        (const Row* row, size_t target) {
+    if (row == nullptr) return nullptr;
+    auto it = std::lower_bound(row->begin(), row->end(), target,
+        [](const std::pair<size_t, Link*>& entry, size_t value) {
+            return entry.first < value;
+        });
+    if (it == row->end() || it->first != target) return nullptr;
+    return it->second;
+}
+
+template <typename NData, typename EData>
+size_t ConcurrentGraph<NData, EData>::find_(const Row* row, size_t target, size_t edges_size) {
+    Link* link = find_link_(row, target);
+    if (link == nullptr) return SIZE_MAX;
+    size_t id = link->load(std::memory_order_acquire);
+    return id < edges_size ? id : SIZE_MAX;
+}
+
+template <typename NData, typename EData>
+typename ConcurrentGraph<NData, EData>::Row* ConcurrentGraph<NData, EData>::insert_
+        (const Row* row, size_t target, Link* link) {
+    try {
+        Row* updated = row == nullptr ? new Row() : new Row(*row);
+        auto position = std::lower_bound(updated->begin(), updated->end(), target,
+            [](const std::pair<size_t, Link*>& entry, size_t value) {
+                return entry.first < value;
+            });
+        try {
+            updated->emplace(position, target, link);
+        }
+        catch (...) {
+            delete updated;
+            throw;
+        }
+        return updated;
+    }
+    catch (...) {
+        throw UnavailableMemoryException::adjacency_matrix_unable_to_insert();
+    }
+}
+
+template <typename NData, typename EData>
+size_t ConcurrentGraph<NData, EData>::add_node(const NData& data) {
+    size_t id = nodes_.size();
+    // the row is published first, so a reader that sees the node also sees its row
+    if (rows_.size() == id) rows_.emplace_back(nullptr);
+    try {
+        nodes_.emplace_back(data);
+    }
+    catch (...) {
+        throw UnavailableMemoryException::node_container_unable_to_insert();
+    }
+    return id;
+}
+
+template <typename NData, typename EData>
+typename ConcurrentGraph<NData, EData>::Link* ConcurrentGraph<NData, EData>::claim_
+        (size_t source, size_t target, Link* link) {
+    std::atomic<const Row*>& slot = rows_[source];
+    const Row* current = slot.load(std::memory_order_acquire);
+    while (true) {
+        Link* existing = find_link_(current, target);
+        if (existing != nullptr) {
+            if (existing == link) return link;
+            size_t expected = DEAD;
+            if (existing->compare_exchange_strong(expected, PENDING, std::memory_order_acq_rel))
+                return existing;
+            return nullptr;
+        }
+        Row* updated = insert_(current, target, link);
+        if (slot.compare_exchange_weak(current, updated, std::memory_order_acq_rel,
+            std::memory_order_acquire)) break;
+        delete updated;
+    }
+    if (current != nullptr) {
+        try {
+            epochs_.retire(current);
+        }
+        catch (...) {
+            // leaking the old row beats failing an insert that already happened
+        }
+    }
+    return link;
+}
+
+template <typename NData, typename EData>
+size_t ConcurrentGraph<NData, EData>::add_edge(size_t source, size_t target, const EData& data) {
+    size_t nodes_size = nodes_.size();
+    if (source >= nodes_size || target >= nodes_size)
+        throw NonexistingItemException::adding_edge_with_nonexistant_nodes
+        (source, target, nodes_size);
+    EpochManager::Guard guard = epochs_.pin();
+
+    // copying the data happens before anything is claimed
+    std::unique_ptr<Link> fresh;
+    EdgeRecord record = make_record_(source, target, data);
+    try {
+        fresh.reset(new Link(PENDING));
+    }
+    catch (...) {
+        throw UnavailableMemoryException::edge_container_unable_to_insert();
+    }
+
+    // undirected edges are claimed in the row of the lower id first, so of two threads adding
+    // the same edge from either side the first claim decides
+    bool undirected = is_undirected();
+    size_t home = undirected ? std::min(source, target) : source;
+    size_t away = undirected ? std::max(source, target) : target;
+    Link* link = claim_(home, away, fresh.get());
+    if (link == nullptr)
+        throw ConflictingItemException::adding_edge_with_conflicting_nodes(source, target);
+    if (link == fresh.get()) fresh.release();
+
+    try {
+        if (undirected && home != away) claim_(away, home, link);
+        record.link.reset(link);
+        // the id is assigned when the slot is reserved, so the ids stay dense
+        return edges_.append(std::move(record), [link](size_t id) {
+            link->store(id, std::memory_order_release);
+        });
+    }
+    catch (...) {
+        record.link.release();
+        link->store(DEAD, std::memory_order_release);
+        throw UnavailableMemoryException::edge_container_unable_to_insert();
+    }
+}
+
+template <typename NData, typename EData>
+size_t ConcurrentGraph<NData, EData>::size() const {
+    return nodes_.size();
+}
+
+template <typename NData, typename EData>
+size_t ConcurrentGraph<NData, EData>::edge_count() const {
+    return edges_.size();
+}
+
+template <typename NData, typename EData>
+bool ConcurrentGraph<NData, EData>::exists(size_t source, size_t target) const {
+    size_t nodes_size = nodes_.size();
+    if (source >= nodes_size || target >= nodes_size)
+        throw NonexistingItemException::testing_existence_of_edge_with_nonexistant_nodes(source,
+            target, nodes_size);
+    EpochManager::Guard guard = epochs_.pin();
+    // the edges counted here were all in their rows before they were counted
+    size_t edges_size = edges_.size();
+    return find_(rows_[source].load(std::memory_order_acquire), target, edges_size) != SIZE_MAX;
+}
+
+template <typename NData, typename EData>
+size_t ConcurrentGraph<NData, EData>::edge_id(size_t source, size_t target) const {
+    size_t nodes_size = nodes_.size();
+    if (source >= nodes_size || target >= nodes_size)
+        throw NonexistingItemException::accessing_edge_with_nonexistant_nodes
+        (source, target, nodes_size);
+    EpochManager::Guard guard = epochs_.pin();
+    size_t edges_size = edges_.size();
+    size_t id = find_(rows_[source].load(std::memory_order_acquire), target, edges_size);
+    if (id == SIZE_MAX)
+        throw NonexistingItemException::accessing_nonexistant_edge_with_source_target
+        (source, target);
+    return id;
+}
+
+template <typename NData, typename EData>
+const NData& ConcurrentGraph<NData, EData>::node_data(size_t id) const {
+    size_t nodes_size = nodes_.size();
+    if (id >= nodes_size)
+        throw NonexistingItemException::accessing_nonexistant_node(id, nodes_size);
+    return nodes_[id];
+}
+
+template <typename NData, typename EData>
+const EData& ConcurrentGraph<NData, EData>::edge_data(size_t id) const {
+    size_t edges_size = edges_.size();
+    if (id >= edges_size)
+        throw NonexistingItemException::accessing_nonexistant_edge_with_identifier(id, edges_size);
+    return edges_[id].data;
+}
+
+template <typename NData, typename EData>
+std::pair<size_t, size_t> ConcurrentGraph<NData, EData>::endpoints(size_t id) const {
+    size_t edges_size = edges_.size();
+    if (id >= edges_size)
+        throw NonexistingItemException::accessing_nonexistant_edge_with_identifier(id, edges_size);
+    return { edges_[id].source, edges_[id].target };
+}
+
+template <typename NData, typename EData>
+template <typename Function>
+void ConcurrentGraph<NData, EData>::for_each_neighbor(size_t source, Function function) const {
+    size_t nodes_size = nodes_.size();
+    if (source >= nodes_size)
+        throw NonexistingItemException::accessing_edge_nonexistant_source(source, nodes_size);
+    EpochManager::Guard guard = epochs_.pin();
+    size_t edges_size = edges_.size();
+    const Row* row = rows_[source].load(std::memory_order_acquire);
+    if (row == nullptr) return;
+    for (const auto& entry : *row) {
+        if (entry.second->load(std::memory_order_acquire) < edges_size) function(entry.first);
+    }
+}
+
+template <typename NData, typename EData>
+EpochManager::Guard ConcurrentGraph<NData, EData>::pin() const {
+    return epochs_.pin();
+}
+
+template <typename NData, typename EData>
+EpochManager& ConcurrentGraph<NData, EData>::epochs() const {
+    return epochs_;
+}
+
+template <typename NData, typename EData>
+MemoryUsage ConcurrentGraph<NData, EData>::memory_usage() const {
+    MemoryUsage usage;
+    size_t nodes_size = nodes_.size();
+    size_t edges_size = edges_.size();
+    usage.nodes = nodes_size * sizeof(NData);
+    usage.edges = edges_size * (sizeof(EdgeRecord) + sizeof(Link));
+    size_t rows_size = rows_.size();
+    usage.adjacency = rows_size * sizeof(std::atomic<const Row*>);
+    usage.slack = nodes_.memory_usage() - usage.nodes +
+        edges_.memory_usage() - edges_size * sizeof(EdgeRecord) +
+        rows_.memory_usage() - usage.adjacency;
+    {
+        EpochManager::Guard guard = epochs_.pin();
+        for (size_t i = 0; i < rows_size; i++) {
+            const Row* row = rows_[i].load(std::memory_order_acquire);
+            if (row == nullptr) continue;
+            usage.adjacency += sizeof(Row) + row->size() * sizeof(typename Row::value_type);
+            usage.slack += (row->capacity() - row->size()) * sizeof(typename Row::value_type);
+        }
+    }
+    if (HeapUsage<NData>::owns_heap) {
+        for (size_t i = 0; i < nodes_size; i++) {
+            usage.node_data_heap += HeapUsage<NData>::of(nodes_[i]);
+        }
+    }
+    if (HeapUsage<EData>::owns_heap) {
+        for (size_t i = 0; i < edges_size; i++) {
+            usage.edge_data_heap += HeapUsage<EData>::of(edges_[i].data);
+        }
+    }
+    return usage;
+}
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,168 @@
+#ifndef __COPY_ON_WRITE_H
+#define __COPY_ON_WRITE_H
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+/// @file CopyOnWrite.h
+/// @brief Contains the CopyOnWrite class sharing a value between copies until one of them writes
+///  to it, and its member function definitions
+
+
+/// @brief A value shared by copies until one of them writes to it, the way my_array::Array
+///  shares its blocks: copying costs a pointer, the first write through write() copies the value.
+///  The handle the value was copied from keeps it in place and hands the copy to the handles
+///  sharing it, so references it handed out stay valid and keep reading its own value; references
+///  a copy took follow the shared value, so they are only stable until either side writes. Handles
+///  sharing a value have to be used from one thread at a time
+/// @tparam T The type of the value, copied by its clone() returning a std::unique_ptr if it has
+///  one, by its copy constructor otherwise; a default constructible value is only allocated on
+///  the first write
+template <typename T>
+class CopyOnWrite {
+public:
+    /// @brief Constructs a handle reading a default constructed value, allocating nothing
+    CopyOnWrite() noexcept;
+
+    /// @brief Constructs a handle owning the given value
+    /// @param value The value
+    /// @exception std::bad_alloc If there isn't enough memory
+    explicit CopyOnWrite(std::unique_ptr<T> value);
+
+    /// @brief Constructs a handle sharing the value of another one
+    /// @param other The handle to share the value of
+    CopyOnWrite(const CopyOnWrite<T>& other) noexcept;
+
+    /// @brief Constructs a handle taking the value of another one, which reads a default
+    ///  constructed value afterwards
+    /// @param other The handle to take the value of
+    CopyOnWrite(CopyOnWrite<T>&& other) noexcept;
+
+    /// @brief Shares the value of another handle, letting go of the own one
+    /// @param other The handle to share the value of
+    /// @return The handle
+    CopyOnWrite<T>& operator=(const CopyOnWrite<T>& other) noexcept;
+
+    /// @brief Swaps the values of two handles
+    /// @param other The handle to swap the value with
+    /// @return The handle
+    CopyOnWrite<T>& operator=(CopyOnWrite<T>&& other) noexcept;
+
+    /// @brief Get the value for reading, copies nothing
+    /// @return A const reference to the value
+    const T& get() const noexcept;
+
+    /// @brief Get the value for writing, copying it first if it is shared
+    /// @return A reference to the value
+    /// @exception std::bad_alloc If there isn't enough memory, or what copying the value throws;
+    ///  the value is left shared then
+    T& write();
+
+    /// @brief Tests if the value is shared with another handle
+    /// @return True if it is shared
+    bool is_shared() const noexcept;
+
+private:
+    /// @brief The slot of the value the sharing handles point to, so a handle copying the value
+    ///  away can leave the copy to them
+    std::shared_ptr<std::unique_ptr<T>> slot_;
+
+    /// @brief True if the handle allocated or copied the value itself, false if it got the
+    ///  value from the handle it was copied from
+    bool owned_;
+
+    /// @brief Copies a value
+    /// @param value The value to copy
+    /// @return The copy
+    static std::unique_ptr<T> copy_(const T& value);
+};
+
+template <typename T>
+CopyOnWrite<T>::CopyOnWrite() noexcept : owned_(true) {}
+
+template <typename T>
+CopyOnWrite<T>::CopyOnWrite(std::unique_ptr<T> value)
+    : slot_(std::make_shared<std::unique_ptr<T>>(std::move(value))), owned_(true) {}
+
+template <typename T>
+CopyOnWrite<T>::CopyOnWrite(const CopyOnWrite<T>& other) noexcept
+    : slot_(other.slot_), owned_(other.slot_ == nullptr) {}
+
+template <typename T>
+CopyOnWrite<T>::CopyOnWrite(CopyOnWrite<T>&& other) noexcept : owned_(true) {
+    slot_.swap(other.slot_);
+    std::swap(owned_, other.owned_);
+}
+
+template <typename T>
+CopyOnWrite<T>& CopyOnWrite<T>::operator=(const CopyOnWrite<T>& other) noexcept {
+    if (this != &other) {
+        slot_ = other.slot_;
+        owned_ = other.slot_ == nullptr;
+    }
+    return *this;
+}
+
+template <typename T>
+CopyOnWrite<T>& CopyOnWrite<T>::operator=(CopyOnWrite<T>&& other) noexcept {
+    slot_.swap(other.slot_);
+    std::swap(owned_, other.owned_);
+    return *this;
+}
+
+template <typename T>
+const T& CopyOnWrite<T>::get() const noexcept {
+    if constexpr (std::is_default_constructible<T>::value) {
+        static const T empty{};
+        if (slot_ == nullptr) return empty;
+    }
+    return **slot_;
+}
+
+template <typename T>
+T& CopyOnWrite<T>::write() {
+    if constexpr (std::is_default_constructible<T>::value) {
+        if (slot_ == nullptr) {
+            std::unique_ptr<T> value(new T());
+            slot_ = std::make_shared<std::unique_ptr<T>>(std::move(value));
+            owned_ = true;
+            return **slot_;
+        }
+    }
+    if (is_shared()) {
+        std::shared_ptr<std::unique_ptr<T>> copy =
+            std::make_shared<std::unique_ptr<T>>(copy_(**slot_));
+        // the owner keeps its value in place, the sharing handles get the copy
+        if (owned_) copy->swap(*slot_);
+        slot_.swap(copy);
+        owned_ = true;
+    }
+    return **slot_;
+}
+
+template <typename T>
+bool CopyOnWrite<T>::is_shared() const noexcept {
+    if (slot_ == nullptr) return false;
+    if (slot_.use_count() > 1) return true;
+    // pairs with the release of the handle that let go of the value last,
+    // so writing to the value happens after its reads
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return false;
+}
+
+template <typename T>
+std::unique_ptr<T> CopyOnWrite<T>::copy_(const T& value) {
+    if constexpr (requires { value.clone(); }) {
+        return value.clone();
+    }
+    else {
+        return std::unique_ptr<T>(new T(value));
+    }
+}
+
+
+#endif
\ No newline at end of file
@@ -1,16 +1,17 @@
 #ifndef __EDGE_H
 #define __EDGE_H
 
+#include <cstdint>
 #include <utility>
 #include <iostream>
-#include "Node.h"
 
 
 /// @file Edge.h
 /// @brief Contains the Edge class and its member function definitions
 
 
-/// @brief An individual edge of the graph
+/// @brief An individual edge of the graph; its source and target are kept by the Edges in
+///  columns indexed by the edge id, so the edge holds only its id and data
 /// @tparam NData The data associated with the Graph's nodes
 /// @tparam EData The data associated with the Graph's edges
 template <typename NData, typename EData>
@@ -19,12 +20,17 @@ public:
     /// @brief The default constructor
     Edge() = default;
 
-    /// @brief Construct an edge with the given id, source and target and edge data
+    /// @brief Construct an edge with the given id and edge data
     /// @param id The id of the edge to construct
-    /// @param source A pointer to the source node of the edge
-    /// @param target A pointer to the target node of the edge
     /// @param data The edge data of the edge
-    Edge(size_t id, Node<NData>* source, Node<NData>* target, EData data);
+    Edge(size_t id, EData data);
+
+    /// @brief Construct an edge with the given id, constructing its edge data in place
+    /// @tparam Args The types of the arguments of the edge data's constructor
+    /// @param id The id of the edge to construct
+    /// @param args The arguments forwarded to the edge data's constructor
+    template <typename... Args>
+    Edge(size_t id, std::piecewise_construct_t, Args&&... args);
 
     /// @brief Get the id of the edge
     /// @return The id of the edge
@@ -34,13 +40,9 @@ public:
     /// @return The edge data of the edge
     EData& getData();
 
-    /// @brief Get the source node of the edge
-    /// @return A reference to the source node of the edge
-    Node<NData>& getSource() const;
-
-    /// @brief Get the target node of the edge
-    /// @return A reference to the target node of the edge
-    Node<NData>& getTarget() const;
+    /// @brief Get the edge data of the edge
+    /// @return The edge data of the edge
+    const EData& getData() const;
 
     /// @brief Copy assignment
     /// @param other The edge that will be copied
@@ -63,26 +65,16 @@ public:
     /// @brief Destructor
     ~Edge();
 
-    /// @brief Updates the source and target node pointers to the given values
-    /// @param source A pointer to the source node 
-    /// @param target A pointer to the target node
-    void update_node_pointers(Node<NData>* source, Node<NData>* target);
-
 private:
     /// @brief The id of the edge; values 0...n-1 where n is the number of edges in the given graph
     size_t id_;
 
-    /// @brief A pointer to the source node of this edge
-    Node<NData> *source_;
-
-    /// @brief A pointer to the target node of this edge
-    Node<NData> *target_;
-
     /// @brief The edge data associated with the edge
     EData data_;
 };
 
-/// @brief Prints the given edge to the given output stream and returns the same output stream
+/// @brief Prints the id and the data of the given edge to the given output stream and returns the
+///  same output stream, the Edges print its source and target around it
 /// @tparam NData The data associated with the Graph's nodes
 /// @tparam EData The data associated with the Graph's edges
 /// @param os The output stream to print to 
@@ -90,15 +82,17 @@ private:
 /// @return The same output stream
 template <typename NData, typename EData>
 std::ostream& operator<<(std::ostream& os, const Edge<NData, EData>& edge) {
-    os << "edge (" << edge.getSource().getId() << ")-[" << edge.getId() << " {"
-        << const_cast<Edge<NData, EData>&>(edge).getData() << "}]->("
-        << edge.getTarget().getId() << ")" << std::endl;
+    os << "[" << edge.getId() << " {" << edge.getData() << "}]";
     return os;
 }
 
 template <typename NData, typename EData>
-Edge<NData, EData>::Edge(size_t id, Node<NData>* source, Node<NData>* target, EData data) :
-    id_(id), source_(source), target_(target), data_(data) {}
+Edge<NData, EData>::Edge(size_t id, EData data) : id_(id), data_(std::move(data)) {}
+
+template <typename NData, typename EData>
+template <typename... Args>
+Edge<NData, EData>::Edge(size_t id, std::piecewise_construct_t, Args&&... args) :
+    id_(id), data_(std::forward<Args>(args)...) {}
 
 template <typename NData, typename EData>
 size_t Edge<NData, EData>::getId() const {
@@ -111,68 +105,39 @@ EData& Edge<NData, EData>::getData() {
 }
 
 template <typename NData, typename EData>
-Node<NData>& Edge<NData, EData>::getSource() const {
-    return *source_;
+const EData& Edge<NData, EData>::getData() const {
+    return data_;
 }
 
-template <typename NData, typename EData>
-Node<NData>& Edge<NData, EData>::getTarget() const {
-    return *target_;
-}
-
-
-// when copying edges we need to do so alongside nodes
-// otherwise source/target will point to nonsense
 template <typename NData, typename EData>
 Edge<NData, EData>& Edge<NData, EData>::operator=(const Edge<NData, EData>& other) {
     id_ = other.id_;
-    source_ = other.source_;
-    target_ = other.target_;
     data_ = other.data_;
     return *this;
 }
 
-// when moving edges we need to do so alongside nodes
-// otherwise source/target will point to nonsense
 template <typename NData, typename EData>
 Edge<NData, EData>& Edge<NData, EData>::operator=(Edge<NData, EData>&& other) noexcept {
     if (this != &other) {
         std::swap(id_, other.id_);
-        std::swap(source_, other.source_);
-        std::swap(target_, other.target_);
         std::swap(data_, other.data_);
     }
     return *this;
 }
 
-// when copying edges we need to do so alongside nodes
-// otherwise source/target will point to nonsense
 template <typename NData, typename EData>
 Edge<NData, EData>::Edge(const Edge<NData, EData>& other) 
-    : id_(other.id_), source_(other.source_), target_(other.target_), data_(other.data_) {}
+    : id_(other.id_), data_(other.data_) {}
 
-// when moving edges we need to do so alongside nodes
-// otherwise source/target will point to nonsense
 template <typename NData, typename EData>
-Edge<NData, EData>::Edge(Edge<NData, EData>&& other) noexcept
-        : id_(SIZE_MAX), source_(nullptr), target_(nullptr) {
+Edge<NData, EData>::Edge(Edge<NData, EData>&& other) noexcept : id_(SIZE_MAX) {
     std::swap(id_, other.id_);
-    std::swap(source_, other.source_);
-    std::swap(target_, other.target_);
     std::swap(data_, other.data_);
 }
 
 template <typename NData, typename EData>
 Edge<NData, EData>::~Edge() {
     id_ = SIZE_MAX;
-    source_ = nullptr;
-    target_ = nullptr;
-}
-
-template <typename NData, typename EData>
-void Edge<NData, EData>::update_node_pointers(Node<NData>* source, Node<NData>* target) {
-    source_ = source;
-    target_ = target;
 }
 
 
@@ -0,0 +1,400 @@
+#ifndef __EDGE_INDEX_H
+#define __EDGE_INDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Exceptions.h"
+#include "MemoryUsage.h"
+#include "NodeIndex.h"
+#include "ThreadPool.h"
+
+
+/// @file EdgeIndex.h
+/// @brief Contains the secondary indexes of the edges by a key projected from their data, the
+///  sorted index answering range, count and top-k queries, and their member function definitions
+
+
+/// @brief A secondary index of the edges by a key projected from their data; Edges keeps its
+///  indexes up to date as edges are added, changing the data of an edge afterwards needs
+///  Edges::reindex
+/// @tparam EData The data associated with the edges
+template <typename EData>
+class EdgeIndex {
+public:
+    /// @brief The virtual destructor
+    virtual ~EdgeIndex() = default;
+
+    /// @brief Adds an edge to the index
+    /// @param id The id of the edge
+    /// @param data The edge data
+    /// @exception UnavailableMemoryException If there isn't enough memory, the index is left
+    ///  unchanged then
+    virtual void insert(size_t id, const EData& data) = 0;
+
+    /// @brief Removes an edge from the index, nothing happens if it is not in it
+    /// @param id The id of the edge
+    /// @param data The edge data it was inserted with
+    virtual void erase(size_t id, const EData& data) noexcept = 0;
+
+    /// @brief Removes every edge from the index
+    virtual void clear() noexcept = 0;
+
+    /// @brief Fills the index anew with the given edges at once, in parallel
+    /// @param data The data of every edge, by edge id
+    /// @param pool The thread pool to run on
+    /// @exception UnavailableMemoryException If there isn't enough memory, the index is left
+    ///  as it was then
+    virtual void rebuild(const std::vector<const EData*>& data, ThreadPool& pool) = 0;
+
+    /// @brief Get the number of edges in the index
+    /// @return The number of edges
+    virtual size_t size() const = 0;
+
+    /// @brief Get the memory allocated by the index
+    /// @return The number of bytes
+    virtual size_t memory_usage() const = 0;
+
+    /// @brief Copies the index
+    /// @return The copy
+    virtual std::unique_ptr<EdgeIndex<EData>> clone() const = 0;
+};
+
+/// @brief A sorted index for the edges whose key lies in a range or is among the largest ones,
+///  counting them in logarithmic time. The edges are kept in a sorted array searched by binary
+///  search, the ones added since it was last sorted in a small sorted array beside it that is
+///  merged in once it outgrows the square root of the large one; edges with equal keys are in
+///  the order of their ids
+/// @tparam EData The data associated with the edges
+/// @tparam Projection A copyable callable taking the edge data and returning the key, which has
+///  to be less than comparable
+template <typename EData, typename Projection = IdentityProjection>
+class SortedEdgeIndex : public EdgeIndex<EData> {
+public:
+    /// @brief The type of the key
+    using Key = typename std::decay<decltype(std::declval<const Projection&>()(
+        std::declval<const EData&>()))>::type;
+
+    /// @brief Constructs an empty index
+    /// @param projection The projection of the key from the edge data
+    explicit SortedEdgeIndex(Projection projection = Projection());
+
+    /// @brief Calls the given function for every edge whose key lies in [low, high), in key order
+    /// @tparam Function A callable taking the id of an edge and a const reference to its key
+    /// @param low The lowest key included
+    /// @param high The lowest key excluded
+    /// @param function The function to call
+    template <typename Function>
+    void range(const Key& low, const Key& high, Function function) const;
+
+    /// @brief Calls the given function for every edge whose key is greater than the given one,
+    ///  in key order
+    /// @tparam Function A callable taking the id of an edge and a const reference to its key
+    /// @param key The key the keys have to exceed
+    /// @param function The function to call
+    template <typename Function>
+    void above(const Key& key, Function function) const;
+
+    /// @brief Counts the edges whose key lies in [low, high)
+    /// @param low The lowest key included
+    /// @param high The lowest key excluded
+    /// @return The number of edges
+    size_t count(const Key& low, const Key& high) const;
+
+    /// @brief Counts the edges whose key is greater than the given one
+    /// @param key The key the keys have to exceed
+    /// @return The number of edges
+    size_t count_above(const Key& key) const;
+
+    /// @brief Calls the given function for the edges with the largest keys, largest first;
+    ///  edges with equal keys are visited from the highest id
+    /// @tparam Function A callable taking the id of an edge and a const reference to its key
+    /// @param k The number of edges, all of them are visited if there are fewer
+    /// @param function The function to call
+    template <typename Function>
+    void top(size_t k, Function function) const;
+
+    /// @brief Calls the given function for every edge in key order
+    /// @tparam Function A callable taking the id of an edge and a const reference to its key
+    /// @param function The function to call
+    template <typename Function>
+    void for_each(Function function) const;
+
+    void insert(size_t id, const EData& data) override;
+    void erase(size_t id, const EData& data) noexcept override;
+    void clear() noexcept override;
+    void rebuild(const std::vector<const EData*>& data, ThreadPool& pool) override;
+    size_t size() const override;
+    size_t memory_usage() const override;
+    std::unique_ptr<EdgeIndex<EData>> clone() const override;
+
+private:
+    /// @brief The key of an edge with its id
+    struct Entry {
+        /// @brief The key of the edge
+        Key key;
+
+        /// @brief The id of the edge
+        size_t id;
+    };
+
+    /// @brief Orders the entries by key, then by id
+    /// @param a The first entry
+    /// @param b The second entry
+    /// @return True if a goes before b
+    static bool before_(const Entry& a, const Entry& b);
+
+    /// @brief Finds the first entry of a sorted array whose key is not less than the given one
+    /// @param entries The sorted entries
+    /// @param key The key
+    /// @return The index of the entry, the size if there is none
+    static size_t lower_(const std::vector<Entry>& entries, const Key& key);
+
+    /// @brief Finds the first entry of a sorted array whose key is greater than the given one
+    /// @param entries The sorted entries
+    /// @param key The key
+    /// @return The index of the entry, the size if there is none
+    static size_t upper_(const std::vector<Entry>& entries, const Key& key);
+
+    /// @brief Calls the given function for the entries of two sorted ranges in merged order
+    /// @tparam Iterator The type of the iterators of the ranges
+    /// @tparam Before A callable ordering two entries
+    /// @tparam Function A callable taking the id of an edge and a const reference to its key
+    /// @param a The first entry of the first range
+    /// @param a_end The end of the first range
+    /// @param b The first entry of the second range
+    /// @param b_end The end of the second range
+    /// @param before The order of the ranges
+    /// @param limit The number of entries after which the walk stops
+    /// @param function The function to call
+    template <typename Iterator, typename Before, typename Function>
+    static void walk_(Iterator a, Iterator a_end, Iterator b, Iterator b_end, Before before,
+        size_t limit, Function& function);
+
+    /// @brief Merges the recently added entries into the large sorted array, keeps them apart if
+    ///  there isn't enough memory
+    void merge_() noexcept;
+
+    /// @brief Sorts the entries in parallel, sorting a slice per thread and merging the slices
+    ///  pairwise
+    /// @param entries The entries to sort
+    /// @param pool The thread pool to run on
+    static void sort_(std::vector<Entry>& entries, ThreadPool& pool);
+
+    /// @brief The number of recently added entries below which they are never merged
+    static const size_t MIN_PENDING = 64;
+
+    /// @brief The projection of the key
+    Projection projection_;
+
+    /// @brief The entries sorted at once
+    std::vector<Entry> entries_;
+
+    /// @brief The entries added since, sorted as they are inserted
+    std::vector<Entry> pending_;
+};
+
+template <typename EData, typename Projection>
+SortedEdgeIndex<EData, Projection>::SortedEdgeIndex(Projection projection)
+    : projection_(std::move(projection)) {}
+
+template <typename EData, typename Projection>
+bool SortedEdgeIndex<EData, Projection>::before_(const Entry& a, const Entry& b) {
+    if (a.key < b.key) return true;
+    if (b.key < a.key) return false;
+    return a.id < b.id;
+}
+
+template <typename EData, typename Projection>
+size_t SortedEdgeIndex<EData, Projection>::lower_(const std::vector<Entry>& entries,
+        const Key& key) {
+    return std::lower_bound(entries.begin(), entries.end(), key,
+        [](const Entry& entry, const Key& k) { return entry.key < k; }) - entries.begin();
+}
+
+template <typename EData, typename Projection>
+size_t SortedEdgeIndex<EData, Projection>::upper_(const std::vector<Entry>& entries,
+        const Key& key) {
+    return std::upper_bound(entries.begin(), entries.end(), key,
+        [](const Key& k, const Entry& entry) { return k < entry.key; }) - entries.begin();
+}
+
+template <typename EData, typename Projection>
+template <typename Iterator, typename Before, typename Function>
+void SortedEdgeIndex<EData, Projection>::walk_(Iterator a, Iterator a_end, Iterator b,
+        Iterator b_end, Before before, size_t limit, Function& function) {
+    for (; limit > 0 && (a != a_end || b != b_end); limit--) {
+        if (b == b_end || (a != a_end && before(*a, *b))) {
+            function(a->id, a->key);
+            ++a;
+        } else {
+            function(b->id, b->key);
+            ++b;
+        }
+    }
+}
+
+template <typename EData, typename Projection>
+template <typename Function>
+void SortedEdgeIndex<EData, Projection>::range(const Key& low, const Key& high,
+        Function function) const {
+    if (!(low < high)) return;
+    walk_(entries_.begin() + lower_(entries_, low), entries_.begin() + lower_(entries_, high),
+        pending_.begin() + lower_(pending_, low), pending_.begin() + lower_(pending_, high),
+        before_, SIZE_MAX, function);
+}
+
+template <typename EData, typename Projection>
+template <typename Function>
+void SortedEdgeIndex<EData, Projection>::above(const Key& key, Function function) const {
+    walk_(entries_.begin() + upper_(entries_, key), entries_.end(),
+        pending_.begin() + upper_(pending_, key), pending_.end(), before_, SIZE_MAX, function);
+}
+
+template <typename EData, typename Projection>
+size_t SortedEdgeIndex<EData, Projection>::count(const Key& low, const Key& high) const {
+    if (!(low < high)) return 0;
+    return lower_(entries_, high) - lower_(entries_, low) +
+        lower_(pending_, high) - lower_(pending_, low);
+}
+
+template <typename EData, typename Projection>
+size_t SortedEdgeIndex<EData, Projection>::count_above(const Key& key) const {
+    return entries_.size() - upper_(entries_, key) + pending_.size() - upper_(pending_, key);
+}
+
+template <typename EData, typename Projection>
+template <typename Function>
+void SortedEdgeIndex<EData, Projection>::top(size_t k, Function function) const {
+    walk_(entries_.rbegin(), entries_.rend(), pending_.rbegin(), pending_.rend(),
+        [](const Entry& a, const Entry& b) { return before_(b, a); }, k, function);
+}
+
+template <typename EData, typename Projection>
+template <typename Function>
+void SortedEdgeIndex<EData, Projection>::for_each(Function function) const {
+    walk_(entries_.begin(), entries_.end(), pending_.begin(), pending_.end(), before_, SIZE_MAX,
+        function);
+}
+
+template <typename EData, typename Projection>
+void SortedEdgeIndex<EData, Projection>::insert(size_t id, const EData& data) {
+    try {
+        Entry entry{ projection_(data), id };
+        pending_.insert(std::upper_bound(pending_.begin(), pending_.end(), entry, before_),
+            std::move(entry));
+    }
+    catch (const std::bad_alloc&) {
+        throw UnavailableMemoryException::edge_index_unable_to_insert();
+    }
+    if (pending_.size() >= MIN_PENDING && pending_.size() * pending_.size() > entries_.size())
+        merge_();
+}
+
+template <typename EData, typename Projection>
+void SortedEdgeIndex<EData, Projection>::merge_() noexcept {
+    try {
+        std::vector<Entry> merged;
+        merged.reserve(entries_.size() + pending_.size());
+        // keys are moved only if that cannot throw, a failure leaves both arrays as they were
+        if (std::is_nothrow_move_constructible<Entry>::value) {
+            std::merge(std::make_move_iterator(entries_.begin()),
+                std::make_move_iterator(entries_.end()),
+                std::make_move_iterator(pending_.begin()),
+                std::make_move_iterator(pending_.end()), std::back_inserter(merged), before_);
+        } else {
+            std::merge(entries_.begin(), entries_.end(), pending_.begin(), pending_.end(),
+                std::back_inserter(merged), before_);
+        }
+        entries_.swap(merged);
+        pending_.clear();
+    }
+    catch (...) {
+        // the recent entries stay apart and are searched separately until the next merge
+    }
+}
+
+template <typename EData, typename Projection>
+void SortedEdgeIndex<EData, Projection>::erase(size_t id, const EData& data) noexcept {
+    Entry entry{ projection_(data), id };
+    for (std::vector<Entry>* entries : { &pending_, &entries_ }) {
+        auto found = std::lower_bound(entries->begin(), entries->end(), entry, before_);
+        if (found != entries->end() && found->id == id && !before_(entry, *found)) {
+            entries->erase(found);
+            return;
+        }
+    }
+}
+
+template <typename EData, typename Projection>
+void SortedEdgeIndex<EData, Projection>::clear() noexcept {
+    entries_.clear();
+    pending_.clear();
+}
+
+template <typename EData, typename Projection>
+void SortedEdgeIndex<EData, Projection>::rebuild(const std::vector<const EData*>& data,
+        ThreadPool& pool) {
+    // built aside, so the keys need no default and a failure leaves the index as it was
+    std::vector<Entry> entries;
+    try {
+        entries.reserve(data.size());
+        for (size_t id = 0; id < data.size(); id++) {
+            entries.emplace_back(Entry{ projection_(*data[id]), id });
+        }
+        sort_(entries, pool);
+    }
+    catch (...) {
+        throw UnavailableMemoryException::edge_index_unable_to_insert();
+    }
+    entries_.swap(entries);
+    pending_.clear();
+}
+
+template <typename EData, typename Projection>
+void SortedEdgeIndex<EData, Projection>::sort_(std::vector<Entry>& entries, ThreadPool& pool) {
+    size_t slices = std::min(pool.thread_count() + 1, entries.size() / 4096 + 1);
+    size_t slice = (entries.size() + slices - 1) / slices;
+    auto bound = [&](size_t i) { return entries.begin() + std::min(i * slice, entries.size()); };
+    pool.parallel_for(0, slices, [&](size_t i) {
+        std::sort(bound(i), bound(i + 1), before_);
+    }, 1);
+    for (size_t width = 1; width < slices; width *= 2) {
+        pool.parallel_for(0, (slices + 2 * width - 1) / (2 * width), [&](size_t pair) {
+            size_t first = pair * 2 * width;
+            std::inplace_merge(bound(first), bound(first + width), bound(first + 2 * width),
+                before_);
+        }, 1);
+    }
+}
+
+template <typename EData, typename Projection>
+size_t SortedEdgeIndex<EData, Projection>::size() const {
+    return entries_.size() + pending_.size();
+}
+
+template <typename EData, typename Projection>
+size_t SortedEdgeIndex<EData, Projection>::memory_usage() const {
+    size_t bytes = (entries_.capacity() + pending_.capacity()) * sizeof(Entry);
+    if (HeapUsage<Key>::owns_heap) {
+        for (const std::vector<Entry>* entries : { &entries_, &pending_ }) {
+            for (const Entry& entry : *entries) {
+                bytes += HeapUsage<Key>::of(entry.key);
+            }
+        }
+    }
+    return bytes;
+}
+
+template <typename EData, typename Projection>
+std::unique_ptr<EdgeIndex<EData>> SortedEdgeIndex<EData, Projection>::clone() const {
+    return std::unique_ptr<EdgeIndex<EData>>(new SortedEdgeIndex<EData, Projection>(*this));
+}
+
+
+#endif
\ No newline at end of file
@@ -1,9 +1,21 @@
 #ifndef __EDGES_H
 #define __EDGES_H
 
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
 #include <utility>
 #include "Graph.h"
 #include "Edge.h"
+#include "Adjacency.h"
+#include "BloomFilter.h"
+#include "CopyOnWrite.h"
+#include "EdgeIndex.h"
+#include "MemoryUsage.h"
+#include "Properties.h"
+#include "ThreadPool.h"
 
 
 /// @file Edges.h
@@ -11,7 +23,14 @@
 ///        and their member function definitions
 
 
-/// @brief The Edges of the Graph
+/// @brief The Edges of the Graph; a copy of the graph shares the blocks of edges and of their
+///  endpoints and the rows of the adjacency with the original until either of them writes to
+///  them, see my_array::Array, and the property columns, the indexes and the existence filter
+///  until either of them writes to one, see CopyOnWrite, so copying costs a pointer per block,
+///  row, column and index. The adjacency holds edge ids and the endpoints are kept in columns, so
+///  unsharing a block of edges never touches anything else. The non-const accessors unshare only
+///  the block they return from, the const accessors return const references and never copy
+///  anything
 /// @tparam NData The data associated with the Graph's nodes
 /// @tparam EData The data associated with the Graph's edges
 template <typename NData, typename EData>
@@ -20,19 +39,106 @@ private:
     /// @brief A pointer to the graph these edges belong to
     Graph<NData, EData>* graph_;
 
-    /// @brief Grows adjacency matrix by one new node, with no new edges
-    /// @exception UnavailableMemoryException If there isn't enough memory to grow the matrix
+    /// @brief Grows the adjacency by one new node, with no new edges
+    /// @exception UnavailableMemoryException If there isn't enough memory to grow the adjacency
     void grow_adjacency_matrix();
 
     /// @brief The actual internal storage of the edges themselves
     my_array::Array<Edge<NData, EData>> edges_;
 
-    /// @brief The adjacency matrix of the graph,
-    /// [x][y] points to the edge from x to y if it exists, nullptr otherwise
-    std::vector<std::vector<Edge<NData, EData>*>> adjacency_matrix_;
+    /// @brief The number of endpoints in a block of sources_ and targets_
+    static const size_t ENDPOINT_BLOCK_SIZE = 1024;
+
+    /// @brief The id of the source node of every edge, by edge id; together with targets_ the
+    ///  topology stored apart from the edge data, so scanning it never touches the edges
+    my_array::Array<size_t> sources_;
+
+    /// @brief The id of the target node of every edge, by edge id
+    my_array::Array<size_t> targets_;
+
+    /// @brief The adjacency of the graph,
+    /// [x][y] is the id of the edge from x to y if it exists, Adjacency::NONE otherwise
+    Adjacency adjacency_;
+
+    /// @brief The property columns of the edges
+    Properties properties_;
+
+    /// @brief The secondary indexes by name
+    std::map<std::string, CopyOnWrite<EdgeIndex<EData>>> indexes_;
+
+    /// @brief Adds an edge to every secondary index, copying the indexes shared with a copy first
+    /// @param id The id of the edge
+    /// @exception UnavailableMemoryException If there isn't enough memory, the edge may be left
+    ///  in some of the indexes, unindex_ removes it
+    void index_(size_t id);
+
+    /// @brief Removes an edge from every secondary index it is in
+    /// @param id The id of the edge
+    void unindex_(size_t id) noexcept;
+
+    /// @brief True while added edges are left out of the secondary indexes, until index_from_
+    ///  adds them at once
+    bool indexing_deferred_;
+
+    /// @brief A deferred run of edges goes into the secondary indexes one by one unless it holds
+    ///  at least one edge for every REBUILD_RATIO edges before it, then the indexes are rebuilt
+    static const size_t REBUILD_RATIO = 8;
+
+    /// @brief Starts or stops leaving added edges out of the secondary indexes
+    /// @param deferred True to leave them out
+    void defer_indexing_(bool deferred) noexcept;
+
+    /// @brief Stops deferring and adds the edges from the given id on to every secondary index,
+    ///  rebuilding the indexes once in parallel if they are many
+    /// @param first The id of the first edge left out
+    /// @param pool The thread pool to run on
+    /// @exception UnavailableMemoryException If there isn't enough memory, an index is left
+    ///  either with the edges or as it was; unindex_ removes them from the ones that got them
+    void index_from_(size_t first, ThreadPool& pool);
+
+    /// @brief Empties every secondary index not shared with a copy of the graph, a shared one
+    ///  is left as the copy has it
+    void clear_indexes_() noexcept;
+
+    /// @brief Looks up many edges by their source and target, grouped by source and prefetching
+    ///  a few lookups ahead; queries whose nodes do not exist or that the existence filter
+    ///  rejects find nothing and are answered first, without being grouped
+    /// @tparam Function A callable taking the index of a query and the id of its edge,
+    ///  Adjacency::NONE if there is none
+    /// @param queries The pairs of source and target ids
+    /// @param function The function to call
+    template <typename Function>
+    void for_each_query_(std::span<const std::pair<size_t, size_t>> queries,
+        Function function) const noexcept;
+
+    /// @brief The number of lookups the adjacency is prefetched ahead of by the batch queries
+    static const size_t PREFETCH_DISTANCE = 8;
+
+    /// @brief The Bloom filter of the source and target pairs guarding the existence tests, one
+    ///  with no blocks if there is none
+    CopyOnWrite<BloomFilter> existence_filter_;
+
+    /// @brief Adds the pairs of an edge to the existence filter, if there is one, copying it
+    ///  first if it is shared with a copy; a full filter is filled anew twice as large from the
+    ///  endpoint columns, which have to hold the edge already, or kept full if there isn't
+    ///  enough memory
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    /// @exception UnavailableMemoryException If a filter shared with a copy cannot be copied
+    void filter_insert_(size_t source, size_t target);
+
+    /// @brief Replaces the existence filter by one filled with the pairs of every edge
+    /// @param capacity The number of pairs the filter is sized for
+    /// @param bits_per_pair The number of bits per pair
+    /// @exception UnavailableMemoryException If there isn't enough memory, the filter is left
+    ///  as it was
+    void fill_filter_(size_t capacity, size_t bits_per_pair);
 
     friend Nodes<NData, EData>;
+    friend Graph<NData, EData>;
+    friend GraphSnapshot<NData, EData>;
     class Request;
+    class ConstRequest;
 
 public:
     /// @brief Constructs the Edges for a Graph
@@ -47,6 +153,44 @@ public:
     /// @param os The output stream
     void printMatrix(std::ostream& os = std::cout) const;
 
+    /// @brief Get the adjacency used for looking up edges by their source and target
+    /// @return A const reference to the adjacency
+    const Adjacency& adjacency() const;
+
+    /// @brief Get the ids of the source nodes of all edges, for scans that need only the
+    ///  topology and not the edge data
+    /// @return The id of the source node of every edge, by edge id
+    const my_array::Array<size_t>& sources() const;
+
+    /// @brief Get the ids of the target nodes of all edges, for scans that need only the
+    ///  topology and not the edge data
+    /// @return The id of the target node of every edge, by edge id
+    const my_array::Array<size_t>& targets() const;
+
+    /// @brief Set the density thresholds at which the adjacency switches between a dense matrix
+    ///  and sparse rows
+    /// @param thresholds The new thresholds
+    /// @exception InvalidArgumentException If the thresholds do not leave a gap between
+    ///  sparse_below and dense_above
+    void set_adjacency_thresholds(const AdjacencyThresholds& thresholds);
+
+    /// @brief Guards the existence tests with a blocked Bloom filter of the source and target
+    ///  pairs, so most tests of edges that do not exist answer after a single cache miss without
+    ///  searching the adjacency. The filter is filled from the existing edges, then kept up to
+    ///  date as edges are added and grown twice as large whenever it is full; copies of the
+    ///  graph share it until either of them adds an edge
+    /// @param bits_per_edge The number of bits per pair, see BloomFilter
+    /// @exception UnavailableMemoryException If there isn't enough memory for the filter
+    void enable_existence_filter(size_t bits_per_edge = 12);
+
+    /// @brief Removes the Bloom filter guarding the existence tests, if there is one
+    void disable_existence_filter();
+
+    /// @brief Get the Bloom filter guarding the existence tests
+    /// @return The filter, nullptr if there is none; valid until the filter is enabled,
+    ///  disabled or grown
+    const BloomFilter* existence_filter() const;
+
     /// @brief Add an Edge
     /// @param id The id of the edge to add (should be equal to the size of the edges)
     /// @param source The id of the source node of the edge to add
@@ -72,6 +216,24 @@ public:
     /// @return A reference to the Edge that was just created and added to the Edges
     Edge<NData, EData>& add(size_t source, size_t target, EData data);
 
+    /// @brief Add an Edge, constructing its edge data in place inside the storage of the edges
+    ///  so it is never copied or moved
+    /// @tparam Args The types of the arguments of the edge data's constructor
+    /// @param id The id of the edge to add (should be equal to the size of the edges)
+    /// @param source The id of the source node of the edge to add
+    /// @param target The id of the target node of the edge to add
+    /// @param args The arguments forwarded to the edge data's constructor
+    /// @return A reference to the Edge that was just created and added to the Edges
+    /// @exception InvalidIdentifierException If attempting to add an edge with an invalid id
+    /// @exception ConflictingItemException If attempting to add an edge with a conflicting id
+    ///  or between nodes that already have an edge between them
+    /// @exception NonexistingItemException If attempting to add an edge between nodes that do not
+    ///  exist
+    /// @exception UnavailableMemoryException If the edge cannot be added because the underlying
+    ///  edges structure cannot grow due to running out of memory
+    template <typename... Args>
+    Edge<NData, EData>& emplace(size_t id, size_t source, size_t target, Args&&... args);
+
     /// @brief Returns the number of the contained edges
     /// @return The number of contained edges
     size_t size() const;
@@ -89,19 +251,58 @@ public:
     ///  and or target node that does not exist
     bool exists(size_t source, size_t target) const;
 
+    /// @brief Tests the existence of many edges given by their source and target at once,
+    ///  without throwing for edges or nodes that do not exist; the queries are answered grouped
+    ///  by source, with the adjacency prefetched a few queries ahead
+    /// @param queries The pairs of source and target ids
+    /// @param results The answers, as many as queries, true for the queries whose edge exists,
+    ///  false for the rest, including those whose nodes do not exist
+    /// @exception InvalidArgumentException If there are not as many results as queries, nothing
+    ///  is answered then
+    void exists_batch(std::span<const std::pair<size_t, size_t>> queries,
+        std::span<bool> results) const;
+
     /// @brief Gets the edge with a given id
     /// @param id The id of the edge to get
+    /// @return A const reference to the edge with the given id
+    /// @exception NonexistingItemException If an edge with the given id does not exist
+    const Edge<NData, EData>& get(size_t id) const;
+
+    /// @brief Gets the edge with a given id, copying its block first if it is shared with a copy
+    ///  of the graph
+    /// @param id The id of the edge to get
     /// @return A reference to the edge with the given id
     /// @exception NonexistingItemException If an edge with the given id does not exist
-    Edge<NData, EData>& get(size_t id) const;
+    /// @exception UnavailableMemoryException If there isn't enough memory to copy the block
+    Edge<NData, EData>& get(size_t id);
 
     /// @brief Gets the edge with a given source and target
     /// @param source The id of the source node
     /// @param target The id of the target node
-    /// @return A reference to the edge with the given source and target
+    /// @return A const reference to the edge with the given source and target
     /// @exception NonexistingItemException If the source and or target nodes do not exist
     /// @exceptionNonexistingItemException If no edge exists between the given source and target
-    Edge<NData, EData>& get(size_t source, size_t target) const;
+    const Edge<NData, EData>& get(size_t source, size_t target) const;
+
+    /// @brief Gets the edge with a given source and target, copying its block first if it is
+    ///  shared with a copy of the graph
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    /// @return A reference to the edge with the given source and target
+    /// @exception NonexistingItemException If the nodes or the edge between them do not exist
+    /// @exception UnavailableMemoryException If there isn't enough memory to copy the block
+    Edge<NData, EData>& get(size_t source, size_t target);
+
+    /// @brief Gets many edges given by their source and target at once, without throwing for
+    ///  edges or nodes that do not exist; the queries are answered grouped by source, with the
+    ///  adjacency prefetched a few queries ahead
+    /// @param queries The pairs of source and target ids
+    /// @param results The answers, as many as queries, the pointer to the edge of every query,
+    ///  nullptr if it does not exist or its nodes do not exist
+    /// @exception InvalidArgumentException If there are not as many results as queries, nothing
+    ///  is answered then
+    void get_batch(std::span<const std::pair<size_t, size_t>> queries,
+        std::span<const Edge<NData, EData>*> results) const;
 
     /// @brief First part of the two brackets operator accesing of edges [source][target]
     /// @param source Id of the source node of the edge to access
@@ -113,17 +314,91 @@ public:
     /// @param source Id of the source node of the edge to access
     /// @return Request that remembers the source part of the request
     /// @exception NonexistingItemException If the source node does not exist
-    const Request operator[](size_t source) const;
-
-    /// @brief Returns an iterator to the first edge
+    ConstRequest operator[](size_t source) const;
+
+    /// @brief Calls the given function for every edge in parallel, after copying the blocks
+    ///  shared with a copy of the graph
+    /// @tparam Function A callable taking a reference to a edge
+    /// @param function The function to call
+    /// @param grain The number of edges below which a range is not split any further,
+    ///  0 to choose it from the number of edges and threads
+    /// @param pool The thread pool to run on
+    /// @exception UnavailableMemoryException If there isn't enough memory to copy the blocks
+    /// @exception Any exception thrown by the function
+    template <typename Function>
+    void parallel_for_each(Function function, size_t grain = 0,
+        ThreadPool& pool = ThreadPool::global());
+
+    /// @brief Moves the memory of every edge to the NUMA node of its source's partition and
+    ///  reallocates every adjacency row on a worker of its partition's node, best effort
+    /// @param partitions The partitions of the node ids
+    /// @param pool The thread pool to run on
+    void distribute(const std::vector<NumaPartition>& partitions,
+        ThreadPool& pool = ThreadPool::global());
+
+    /// @brief Adds the memory used by the edges, their endpoint columns, the adjacency, the
+    ///  properties and the indexes to the given breakdown, what is shared with copies to shared
+    ///  as well; walks the edge data only if HeapUsage says it may own heap memory
+    /// @param usage The breakdown to add to
+    void memory_usage(MemoryUsage& usage) const;
+
+    /// @brief Get the property columns of the edges, indexed by edge id; an edge whose property
+    ///  was never set reads the default value. Copies of the graph share the columns until
+    ///  either of them gets one for writing
+    /// @return A reference to the properties
+    Properties& properties();
+
+    /// @brief Get the property columns of the edges, indexed by edge id
+    /// @return A const reference to the properties
+    const Properties& properties() const;
+
+    /// @brief Adds a secondary index filled with the edges added so far, sorting them in
+    ///  parallel; from then on adding an edge adds it to the index too. Changing the data of an
+    ///  edge needs reindex afterwards. Copies of the graph share the indexes until either of
+    ///  them adds an edge or reindexes
+    /// @tparam Index The type of the index, like SortedEdgeIndex
+    /// @param name The name of the index
+    /// @param index The empty index, holding the projection of its key
+    /// @return The index, valid until it is removed
+    /// @exception ConflictingItemException If an index with the name already exists
+    /// @exception UnavailableMemoryException If there isn't enough memory for the index
+    template <typename Index>
+    Index& add_index(const std::string& name, Index index = Index());
+
+    /// @brief Gets a secondary index
+    /// @tparam Index The type of the index
+    /// @param name The name of the index
+    /// @return The index
+    /// @exception NonexistingItemException If no index has the name
+    /// @exception InvalidArgumentException If the index has another type
+    template <typename Index>
+    const Index& index(const std::string& name) const;
+
+    /// @brief Removes a secondary index, if it exists
+    /// @param name The name of the index
+    void remove_index(const std::string& name);
+
+    /// @brief Fills every secondary index anew from the current edge data at once, sorting in
+    ///  parallel; cheaper than adding the edges one by one after a large import
+    /// @param pool The thread pool to run on
+    /// @exception UnavailableMemoryException If there isn't enough memory, the indexes are left
+    ///  empty then
+    void reindex(ThreadPool& pool = ThreadPool::global());
+
+    /// @brief Returns an iterator to the first edge, after copying the blocks shared with a copy
+    ///  of the graph
     /// @return The iterator to the first edge
+    /// @exception UnavailableMemoryException If there isn't enough memory to copy the blocks
     typename my_array::Array<Edge<NData, EData>>::iterator begin();
 
-    /// @brief Returns an iterator to the space after the last edge
+    /// @brief Returns an iterator to the space after the last edge, after copying the blocks
+    ///  shared with a copy of the graph
     /// @return The iterator to the space after the last edge
+    /// @exception UnavailableMemoryException If there isn't enough memory to copy the blocks
     typename my_array::Array<Edge<NData, EData>>::iterator end();
 
-    /// @brief Copy assignment
+    /// @brief Copy assignment, shares the blocks and the adjacency rows of the other edges; the
+    ///  adjacency is only built anew if the graphs differ in being undirected
     /// @param other The edges that will be copied from
     /// @return The edges that was copied to
     Edges<NData, EData>& operator=(const Edges<NData, EData>& other);
@@ -133,7 +408,8 @@ public:
     /// @return The edges that were moved to
     Edges<NData, EData>& operator=(Edges<NData, EData>&& other) noexcept;
 
-    /// @brief Copy constructor with graph
+    /// @brief Copy constructor with graph, shares the blocks and the adjacency rows of the other
+    ///  edges, which costs a pointer per block and row, and copies the endpoint columns
     /// @param other The edges to copy
     /// @param graph The graph the constructed edges will belong to
     Edges(const Edges<NData, EData>& other, Graph<NData, EData>* graph);
@@ -143,11 +419,8 @@ public:
     /// @param graph The graph the constructed edges will belong to
     Edges(Edges<NData, EData>&& other, Graph<NData, EData>* graph) noexcept;
 
-    /// @brief Updates the pointers inside edges to point to the current graph
-    void update_source_and_target_pointers();
-
-    /// @brief Creates the adjacency matrix for these Edges from scratch
-    /// @exception UnavailableMemoryException If there isn't enough memory for the adjacency matrix
+    /// @brief Creates the adjacency for these Edges from scratch, in parallel
+    /// @exception UnavailableMemoryException If there isn't enough memory for the adjacency
     void construct_adjacency_matrix();
 };
 
@@ -157,10 +430,12 @@ public:
 template <typename NData, typename EData>
 class Edges<NData, EData>::Request {
 public:
-    /// @brief Second part of the two brackets operator accesing of edges [source][target]
+    /// @brief Second part of the two brackets operator accesing of edges [source][target], copies
+    ///  the block of the edge first if it is shared with a copy of the graph
     /// @param target Id of the target node of the edge to access
     /// @return A reference too the edge with the given source and target nodes
     /// @exception NonexistingItemException If the target node does not exist
+    /// @exception UnavailableMemoryException If there isn't enough memory to copy the block
     Edge<NData, EData>& operator[](size_t target);
 
     /// @brief Second part of the two brackets operator accesing of edges [source][target]
@@ -173,7 +448,35 @@ private:
     /// @brief Constructs the request used for accesing edges with two brackets [source][target]
     /// @param edges The edges we are making the request upon
     /// @param source Id of the source node of the edge we are trying to access
-    Request(const Edges<NData, EData>& edges, size_t source);
+    Request(Edges<NData, EData>& edges, size_t source);
+
+    /// @brief Reference to the edges we are making a request upon
+    Edges<NData, EData>& edges_;
+
+    /// @brief Id of the source node of the edge we are trying to access
+    size_t source_;
+
+    friend Edges<NData, EData>;
+};
+
+/// @brief Used exclusively for the second part of the two bracket operator accesing of const
+///  edges [source][target]
+/// @tparam NData The data associated with the Graph's nodes
+/// @tparam EData The data associated with the Graph's edges
+template <typename NData, typename EData>
+class Edges<NData, EData>::ConstRequest {
+public:
+    /// @brief Second part of the two brackets operator accesing of edges [source][target]
+    /// @param target Id of the target node of the edge to access
+    /// @return A const reference to the edge with the given source and target nodes
+    /// @exception NonexistingItemException If the target node or the edge do not exist
+    const Edge<NData, EData>& operator[](size_t target) const;
+
+private:
+    /// @brief Constructs the request used for accesing edges with two brackets [source][target]
+    /// @param edges The edges we are making the request upon
+    /// @param source Id of the source node of the edge we are trying to access
+    ConstRequest(const Edges<NData, EData>& edges, size_t source);
 
     /// @brief Reference to the edges we are making a request upon
     const Edges<NData, EData>& edges_;
@@ -197,12 +500,17 @@ std::ostream& operator<<(std::ostream& os, const Edges<NData, EData>& edges) {
 }
 
 template<typename NData, typename EData>
-inline Edges<NData, EData>::Edges(Graph<NData, EData>* graph) : graph_(graph) {}
+inline Edges<NData, EData>::Edges(Graph<NData, EData>* graph)
+    : graph_(graph), sources_(ENDPOINT_BLOCK_SIZE), targets_(ENDPOINT_BLOCK_SIZE),
+    indexing_deferred_(false) {
+    properties_.bound([this] { return edges_.size(); });
+}
 
 template <typename NData, typename EData>
 void Edges<NData, EData>::print(std::ostream& os) const {
     for (size_t i = 0; i < edges_.size(); i++) {
-        os << edges_[i];
+        os << "edge (" << sources_[i] << ")-" << edges_[i] << "->(" << targets_[i] << ")"
+            << std::endl;
     }
 }
 
@@ -211,41 +519,115 @@ void Edges<NData, EData>::printMatrix(std::ostream& os) const {
     char separator = '|';
     char no_edge_symbol = '-';
 
-    for (size_t i = 0; i < adjacency_matrix_.size(); i++) {
-        for (size_t j = 0; j < adjacency_matrix_[i].size(); j++) {
-            if (adjacency_matrix_[i][j] == nullptr) {
+    for (size_t i = 0; i < adjacency_.size(); i++) {
+        for (size_t j = 0; j < adjacency_.size(); j++) {
+            size_t edge = adjacency_.find(i, j);
+            if (edge == Adjacency::NONE) {
                 os << no_edge_symbol;
             }
             else {
-                os << adjacency_matrix_[i][j]->getId();
+                os << edge;
             }
-            if (j < adjacency_matrix_[i].size() - 1) os << separator;
+            if (j < adjacency_.size() - 1) os << separator;
         }
         os << std::endl;
     }
 }
 
 template <typename NData, typename EData>
-void Edges<NData, EData>::grow_adjacency_matrix() {
-    size_t pre_modification_size = adjacency_matrix_.size();
+const Adjacency& Edges<NData, EData>::adjacency() const {
+    return adjacency_;
+}
+
+template <typename NData, typename EData>
+const my_array::Array<size_t>& Edges<NData, EData>::sources() const {
+    return sources_;
+}
+
+template <typename NData, typename EData>
+const my_array::Array<size_t>& Edges<NData, EData>::targets() const {
+    return targets_;
+}
+
+template <typename NData, typename EData>
+void Edges<NData, EData>::set_adjacency_thresholds(const AdjacencyThresholds& thresholds) {
+    adjacency_.set_thresholds(thresholds);
+}
+
+template <typename NData, typename EData>
+void Edges<NData, EData>::enable_existence_filter(size_t bits_per_edge) {
+    size_t pairs = graph_->is_undirected() ? 2 * edges_.size() : edges_.size();
+    fill_filter_(std::max<size_t>(2 * pairs, 1024), bits_per_edge);
+}
+
+template <typename NData, typename EData>
+void Edges<NData, EData>::disable_existence_filter() {
+    existence_filter_ = CopyOnWrite<BloomFilter>();
+}
+
+template <typename NData, typename EData>
+const BloomFilter* Edges<NData, EData>::existence_filter() const {
+    const BloomFilter& filter = existence_filter_.get();
+    return filter.bits_per_pair() == 0 ? nullptr : &filter;
+}
+
+template <typename NData, typename EData>
+void Edges<NData, EData>::fill_filter_(size_t capacity, size_t bits_per_pair) {
+    BloomFilter filter(capacity, bits_per_pair);
+    bool undirected = graph_->is_undirected();
+    for (size_t i = 0; i < sources_.size(); i++) {
+        filter.insert(sources_[i], targets_[i]);
+        if (undirected) filter.insert(targets_[i], sources_[i]);
+    }
     try {
-        for (size_t i = 0; i < pre_modification_size; i++) {
-            adjacency_matrix_[i].push_back(nullptr);
-        }
-        adjacency_matrix_.push_back(
-            std::vector<Edge<NData, EData>*>(pre_modification_size + 1, nullptr));
+        // the copies sharing the old filter keep it
+        existence_filter_ = CopyOnWrite<BloomFilter>(
+            std::unique_ptr<BloomFilter>(new BloomFilter(std::move(filter))));
     }
-    catch (...) {
-        for (size_t i = 0; i < pre_modification_size; i++) {
-            adjacency_matrix_[i].resize(pre_modification_size);
+    catch (const std::bad_alloc&) {
+        throw UnavailableMemoryException::bloom_filter_unable_to_allocate();
+    }
+}
+
+template <typename NData, typename EData>
+void Edges<NData, EData>::filter_insert_(size_t source, size_t target) {
+    const BloomFilter& current = existence_filter_.get();
+    if (current.bits_per_pair() == 0) return;
+    if (current.size() >= current.capacity()) {
+        try {
+            fill_filter_(2 * current.capacity(), current.bits_per_pair());
+            return;
+        }
+        catch (const UnavailableMemoryException&) {
+            // a full filter only answers "maybe" more often
         }
-        adjacency_matrix_.resize(pre_modification_size);
-        throw UnavailableMemoryException::adjacency_matrix_unable_to_insert();
     }
+    BloomFilter* filter;
+    try {
+        filter = &existence_filter_.write();
+    }
+    catch (const std::bad_alloc&) {
+        throw UnavailableMemoryException::bloom_filter_unable_to_allocate();
+    }
+    filter->insert(source, target);
+    if (graph_->is_undirected()) filter->insert(target, source);
+}
+
+template <typename NData, typename EData>
+void Edges<NData, EData>::grow_adjacency_matrix() {
+    adjacency_.grow();
 }
 
 template <typename NData, typename EData>
 Edge<NData, EData>& Edges<NData, EData>::add(size_t id, size_t source, size_t target, EData data) {
+    return emplace(id, source, target, std::move(data));
+}
+
+template <typename NData, typename EData>
+template <typename... Args>
+Edge<NData, EData>& Edges<NData, EData>::emplace(size_t id, size_t source, size_t target,
+        Args&&... args) {
+    if (graph_->in_batch()) throw InvalidOperationException::adding_directly_inside_batch();
     size_t pre_modification_size = edges_.size();
     if (id > pre_modification_size)
         throw InvalidIdentifierException::adding_edge_invalid_identifier(id, pre_modification_size);
@@ -255,28 +637,37 @@ Edge<NData, EData>& Edges<NData, EData>::add(size_t id, size_t source, size_t ta
     if (source >= nodes_size || target >= nodes_size)
         throw NonexistingItemException::adding_edge_with_nonexistant_nodes
         (source, target, nodes_size);
-    if (adjacency_matrix_[source][target] != nullptr)
+    if (adjacency_.find(source, target) != Adjacency::NONE)
         throw ConflictingItemException::adding_edge_with_conflicting_nodes(source, target);
     try {
-        Node<NData>* source_node = &graph_->nodes().get(source);
-        Node<NData>* target_node = &graph_->nodes().get(target);
-        Edge<NData, EData> edge = Edge<NData, EData>(id, source_node, target_node, data);
-        edges_.push_back(edge);
-        adjacency_matrix_[source][target] = &edges_[edges_.size() - 1];
-        if (graph_->is_undirected()) adjacency_matrix_[target][source] = &edges_[edges_.size() - 1];
+        sources_.push_back(source);
+        targets_.push_back(target);
+        // a shared last block is copied by the array before the edge goes in
+        edges_.emplace_back(id, std::piecewise_construct, std::forward<Args>(args)...);
+        adjacency_.set(source, target, id);
+        if (graph_->is_undirected()) adjacency_.set(target, source, id);
+        index_(id);
+        filter_insert_(source, target);
     }
     catch (...) {
-        if (edges_.size() > pre_modification_size) edges_.pop_back();
-        adjacency_matrix_[source][target] = nullptr;
-        if (graph_->is_undirected()) adjacency_matrix_[target][source] = nullptr;
+        if (edges_.size() > pre_modification_size) {
+            unindex_(id);
+            edges_.pop_back();
+        }
+        // the last blocks were unshared by adding, so popping copies nothing
+        if (sources_.size() > pre_modification_size) sources_.pop_back();
+        if (targets_.size() > pre_modification_size) targets_.pop_back();
+        adjacency_.clear(source, target);
+        if (graph_->is_undirected()) adjacency_.clear(target, source);
         throw UnavailableMemoryException::edge_container_unable_to_insert();
     }
+    graph_->mark_changed();
     return edges_[edges_.size() - 1];
 }
 
 template <typename NData, typename EData>
 Edge<NData, EData>& Edges<NData, EData>::add(size_t source, size_t target, EData data) {
-    return add(edges_.size(), source, target, data);
+    return emplace(edges_.size(), source, target, std::move(data));
 }
 
 template <typename NData, typename EData>
@@ -291,56 +682,161 @@ bool Edges<NData, EData>::exists(size_t id) const {
 
 template <typename NData, typename EData>
 bool Edges<NData, EData>::exists(size_t source, size_t target) const {
-    size_t adjacency_matrix_size = adjacency_matrix_.size(); // same size for rows and columns
-    if (source >= adjacency_matrix_size ||
-        target >= adjacency_matrix_size)
+    size_t adjacency_size = adjacency_.size(); // same size for rows and columns
+    if (source >= adjacency_size ||
+        target >= adjacency_size)
         throw NonexistingItemException::testing_existence_of_edge_with_nonexistant_nodes(source,
-            target, adjacency_matrix_size);
-    return adjacency_matrix_[source][target] != nullptr;
+            target, adjacency_size);
+    if (!existence_filter_.get().may_contain(source, target)) return false;
+    return adjacency_.find(source, target) != Adjacency::NONE;
+}
+
+template <typename NData, typename EData>
+void Edges<NData, EData>::exists_batch(std::span<const std::pair<size_t, size_t>> queries,
+        std::span<bool> results) const {
+    if (queries.size() != results.size())
+        throw InvalidArgumentException::batch_results_size_mismatch(queries.size(),
+            results.size());
+    for_each_query_(queries, [&](size_t query, size_t edge) {
+        results[query] = edge != Adjacency::NONE;
+    });
+}
+
+template <typename NData, typename EData>
+void Edges<NData, EData>::get_batch(std::span<const std::pair<size_t, size_t>> queries,
+        std::span<const Edge<NData, EData>*> results) const {
+    if (queries.size() != results.size())
+        throw InvalidArgumentException::batch_results_size_mismatch(queries.size(),
+            results.size());
+    for_each_query_(queries, [&](size_t query, size_t edge) {
+        results[query] = edge == Adjacency::NONE ? nullptr : &edges_[edge];
+    });
 }
 
 template <typename NData, typename EData>
-Edge<NData, EData>& Edges<NData, EData>::get(size_t id) const {
+template <typename Function>
+void Edges<NData, EData>::for_each_query_(std::span<const std::pair<size_t, size_t>> queries,
+        Function function) const noexcept {
+    size_t size = adjacency_.size();
+    const BloomFilter& filter = existence_filter_.get();
+    std::vector<size_t> order;
+    try {
+        order.reserve(queries.size());
+    }
+    catch (const std::bad_alloc&) {
+        // without the memory for grouping the queries are answered in their own order
+        for (size_t i = 0; i < queries.size(); i++) {
+            const std::pair<size_t, size_t>& query = queries[i];
+            bool maybe = query.first < size && query.second < size &&
+                filter.may_contain(query.first, query.second);
+            function(i, maybe ? adjacency_.find(query.first, query.second) : Adjacency::NONE);
+        }
+        return;
+    }
+    // the queries the filter rejects are answered right away, only the rest are grouped
+    for (size_t i = 0; i < queries.size(); i++) {
+        const std::pair<size_t, size_t>& query = queries[i];
+        if (query.first < size && query.second < size &&
+                filter.may_contain(query.first, query.second))
+            order.push_back(i);
+        else function(i, Adjacency::NONE);
+    }
+    try {
+        if (order.size() >= size / 4) {
+            // a counting sort by source, linear once the queries are not much fewer than nodes
+            std::vector<size_t> starts(size + 1, 0);
+            for (size_t i : order) {
+                starts[queries[i].first + 1]++;
+            }
+            for (size_t source = 1; source < starts.size(); source++) {
+                starts[source] += starts[source - 1];
+            }
+            std::vector<size_t> grouped(order.size());
+            for (size_t i : order) {
+                grouped[starts[queries[i].first]++] = i;
+            }
+            order.swap(grouped);
+        } else {
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                return queries[a] < queries[b];
+            });
+        }
+    }
+    catch (const std::bad_alloc&) {
+        // the queries are looked up in their own order then
+    }
+    for (size_t n = 0; n < order.size(); n++) {
+        // the row is loaded twice as far ahead as the entry, which needs the row to be found
+        if (n + 2 * PREFETCH_DISTANCE < order.size())
+            adjacency_.prefetch_row(queries[order[n + 2 * PREFETCH_DISTANCE]].first);
+        if (n + PREFETCH_DISTANCE < order.size()) {
+            const std::pair<size_t, size_t>& ahead = queries[order[n + PREFETCH_DISTANCE]];
+            adjacency_.prefetch(ahead.first, ahead.second);
+        }
+        const std::pair<size_t, size_t>& current = queries[order[n]];
+        function(order[n], adjacency_.find(current.first, current.second));
+    }
+}
+
+template <typename NData, typename EData>
+const Edge<NData, EData>& Edges<NData, EData>::get(size_t id) const {
     if (!exists(id))
         throw NonexistingItemException::accessing_nonexistant_edge_with_identifier(id, size());
-    return const_cast<Edge<NData, EData>&>(edges_[id]);
+    return edges_[id];
 }
 
 template <typename NData, typename EData>
-Edge<NData, EData>& Edges<NData, EData>::get(size_t source, size_t target) const {
-    size_t adjacency_matrix_size = adjacency_matrix_.size(); // same size for rows and columns
-    if (source >= adjacency_matrix_size || target >= adjacency_matrix_size)
+const Edge<NData, EData>& Edges<NData, EData>::get(size_t source, size_t target) const {
+    size_t adjacency_size = adjacency_.size(); // same size for rows and columns
+    if (source >= adjacency_size || target >= adjacency_size)
         throw NonexistingItemException::accessing_edge_with_nonexistant_nodes
-        (source, target, adjacency_matrix_size);
-    if (adjacency_matrix_[source][target] == nullptr)
+        (source, target, adjacency_size);
+    size_t edge = adjacency_.find(source, target);
+    if (edge == Adjacency::NONE)
         throw NonexistingItemException::accessing_nonexistant_edge_with_source_target
         (source, target);
-    return *adjacency_matrix_[source][target];
+    return edges_[edge];
+}
+
+template <typename NData, typename EData>
+Edge<NData, EData>& Edges<NData, EData>::get(size_t id) {
+    if (!exists(id))
+        throw NonexistingItemException::accessing_nonexistant_edge_with_identifier(id, size());
+    return edges_[id];
 }
 
 template <typename NData, typename EData>
-Edges<NData, EData>::Request::Request(const Edges<NData, EData>& edges, size_t source)
+Edge<NData, EData>& Edges<NData, EData>::get(size_t source, size_t target) {
+    return edges_[std::as_const(*this).get(source, target).getId()];
+}
+
+template <typename NData, typename EData>
+Edges<NData, EData>::Request::Request(Edges<NData, EData>& edges, size_t source)
+    : edges_(edges), source_(source) {}
+
+template <typename NData, typename EData>
+Edges<NData, EData>::ConstRequest::ConstRequest(const Edges<NData, EData>& edges, size_t source)
     : edges_(edges), source_(source) {}
 
 template <typename NData, typename EData>
 typename Edges<NData, EData>::Request Edges<NData, EData>::operator[](size_t source) {
-    size_t size = adjacency_matrix_.size();
+    size_t size = adjacency_.size();
     if (source >= size)
         throw NonexistingItemException::accessing_edge_nonexistant_source(source, size);
     return Edges<NData, EData>::Request(*this, source);
 }
 
 template <typename NData, typename EData>
-const typename Edges<NData, EData>::Request Edges<NData, EData>::operator[](size_t source) const {
-    size_t size = edges_.adjacency_matrix_.size();
+typename Edges<NData, EData>::ConstRequest Edges<NData, EData>::operator[](size_t source) const {
+    size_t size = adjacency_.size();
     if (source >= size)
         throw NonexistingItemException::accessing_edge_nonexistant_source(source, size);
-    return Edges<NData, EData>::Request(*this, source);
+    return Edges<NData, EData>::ConstRequest(*this, source);
 }
 
 template <typename NData, typename EData>
 Edge<NData, EData>& Edges<NData, EData>::Request::operator[](size_t target) {
-    size_t size = edges_.adjacency_matrix_.size();
+    size_t size = edges_.adjacency_.size();
     if (target >= size)
         throw NonexistingItemException::accessing_edge_nonexistant_target(target, size);
     return edges_.get(source_, target);
@@ -348,59 +844,253 @@ Edge<NData, EData>& Edges<NData, EData>::Request::operator[](size_t target) {
 
 template <typename NData, typename EData>
 const Edge<NData, EData>& Edges<NData, EData>::Request::operator[](size_t target) const {
-    size_t size = adjacency_matrix_.size();
+    size_t size = edges_.adjacency_.size();
+    if (target >= size)
+        throw NonexistingItemException::accessing_edge_nonexistant_target(target, size);
+    return std::as_const(edges_).get(source_, target);
+}
+
+template <typename NData, typename EData>
+const Edge<NData, EData>& Edges<NData, EData>::ConstRequest::operator[](size_t target) const {
+    size_t size = edges_.adjacency_.size();
     if (target >= size)
         throw NonexistingItemException::accessing_edge_nonexistant_target(target, size);
     return edges_.get(source_, target);
 }
 
 template <typename NData, typename EData>
-typename my_array::Array<Edge<NData, EData>>::iterator Edges<NData, EData>::begin() {
-    return edges_.begin();
+template <typename Function>
+void Edges<NData, EData>::parallel_for_each(Function function, size_t grain, ThreadPool& pool) {
+    edges_.unshare();
+    pool.parallel_for(0, edges_.size(), [&](size_t i) {
+        function(edges_[i]);
+    }, grain);
 }
 
 template <typename NData, typename EData>
-typename my_array::Array<Edge<NData, EData>>::iterator Edges<NData, EData>::end() {
-    return edges_.end();
+void Edges<NData, EData>::distribute(const std::vector<NumaPartition>& partitions,
+        ThreadPool& pool) {
+    edges_.bind_blocks([&](size_t id) {
+        return numa_node_of(partitions, sources_[id]);
+    });
+    // first touch by a worker of the right node places the copy there
+    pool.parallel_for_partitioned(partitions, [&](size_t source) {
+        adjacency_.rehome_row(source);
+    });
 }
 
 template <typename NData, typename EData>
-void Edges<NData, EData>::construct_adjacency_matrix() {
-    adjacency_matrix_ = std::vector<std::vector<Edge<NData, EData>*>>();
-    size_t nodes_size = graph_->nodes().size();
+void Edges<NData, EData>::memory_usage(MemoryUsage& usage) const {
+    size_t used = edges_.size() * sizeof(Edge<NData, EData>);
+    usage.edges += used;
+    usage.slack += edges_.memory_usage() - used;
+    size_t endpoints = (sources_.size() + targets_.size()) * sizeof(size_t);
+    usage.endpoints += endpoints;
+    usage.slack += sources_.memory_usage() + targets_.memory_usage() - endpoints;
+    adjacency_.memory_usage(usage);
+    if (HeapUsage<EData>::owns_heap) {
+        for (size_t i = 0; i < edges_.size(); i++) {
+            usage.edge_data_heap += HeapUsage<EData>::of(
+                edges_[i].getData());
+        }
+    }
+    usage.shared += edges_.shared_memory_usage() + sources_.shared_memory_usage() +
+        targets_.shared_memory_usage() + properties_.shared_memory_usage();
+    usage.properties += properties_.memory_usage();
+    for (const auto& index : indexes_) {
+        usage.indexes += index.second.get().memory_usage();
+        if (index.second.is_shared()) usage.shared += index.second.get().memory_usage();
+    }
+    usage.indexes += existence_filter_.get().memory_usage();
+    if (existence_filter_.is_shared()) usage.shared += existence_filter_.get().memory_usage();
+}
+
+template <typename NData, typename EData>
+Properties& Edges<NData, EData>::properties() {
+    return properties_;
+}
+
+template <typename NData, typename EData>
+const Properties& Edges<NData, EData>::properties() const {
+    return properties_;
+}
+
+template <typename NData, typename EData>
+template <typename Index>
+Index& Edges<NData, EData>::add_index(const std::string& name, Index index) {
+    if (indexes_.find(name) != indexes_.end())
+        throw ConflictingItemException::adding_conflicting_index(name);
     try {
-        for (size_t i = 0; i < nodes_size; i++) {
-            adjacency_matrix_.emplace_back(nodes_size, nullptr);
+        std::unique_ptr<EdgeIndex<EData>> added(new Index(std::move(index)));
+        std::vector<const EData*> data(edges_.size());
+        for (size_t id = 0; id < edges_.size(); id++) {
+            data[id] = &std::as_const(edges_)[id].getData();
+        }
+        added->rebuild(data, ThreadPool::global());
+        Index& result = static_cast<Index&>(*added);
+        indexes_.emplace(name, CopyOnWrite<EdgeIndex<EData>>(std::move(added)));
+        return result;
+    }
+    catch (const std::bad_alloc&) {
+        throw UnavailableMemoryException::edge_index_unable_to_insert();
+    }
+}
+
+template <typename NData, typename EData>
+template <typename Index>
+const Index& Edges<NData, EData>::index(const std::string& name) const {
+    auto found = indexes_.find(name);
+    if (found == indexes_.end()) throw NonexistingItemException::accessing_nonexistant_index(name);
+    const Index* index = dynamic_cast<const Index*>(&found->second.get());
+    if (index == nullptr) throw InvalidArgumentException::index_of_another_type(name);
+    return *index;
+}
+
+template <typename NData, typename EData>
+void Edges<NData, EData>::remove_index(const std::string& name) {
+    indexes_.erase(name);
+}
+
+template <typename NData, typename EData>
+void Edges<NData, EData>::reindex(ThreadPool& pool) {
+    if (indexes_.empty()) return;
+    std::vector<const EData*> data;
+    try {
+        data.resize(edges_.size());
+        for (auto& index : indexes_) {
+            index.second.write();
+        }
+    }
+    catch (const std::bad_alloc&) {
+        clear_indexes_();
+        throw UnavailableMemoryException::edge_index_unable_to_insert();
+    }
+    pool.parallel_for(0, edges_.size(), [&](size_t id) {
+        data[id] = &std::as_const(edges_)[id].getData();
+    });
+    try {
+        for (auto& index : indexes_) {
+            index.second.write().rebuild(data, pool);
         }
     }
     catch (...) {
-        throw UnavailableMemoryException::adjacency_matrix_unable_to_insert();
+        clear_indexes_();
+        throw;
     }
+}
 
-    for (size_t i = 0; i < edges_.size(); i++) {
-        size_t s = edges_[i].getSource().getId();
-        size_t t = edges_[i].getTarget().getId();
-        adjacency_matrix_[s][t] = &edges_[i];
-        if (graph_->is_undirected()) adjacency_matrix_[t][s] = &edges_[i];
+template <typename NData, typename EData>
+void Edges<NData, EData>::clear_indexes_() noexcept {
+    // an index still shared with a copy of the graph could not be copied away
+    for (auto& index : indexes_) {
+        if (!index.second.is_shared()) index.second.write().clear();
     }
 }
 
 template <typename NData, typename EData>
-void Edges<NData, EData>::update_source_and_target_pointers() {
-    for (size_t i = 0; i < edges_.size(); i++) {
-        Node<NData>* updated_source = &graph_->nodes()[edges_[i].getSource().getId()];
-        Node<NData>* updated_target = &graph_->nodes()[edges_[i].getTarget().getId()];
-        edges_[i].update_node_pointers(updated_source, updated_target);
+void Edges<NData, EData>::defer_indexing_(bool deferred) noexcept {
+    indexing_deferred_ = deferred;
+}
+
+template <typename NData, typename EData>
+void Edges<NData, EData>::index_from_(size_t first, ThreadPool& pool) {
+    indexing_deferred_ = false;
+    if (indexes_.empty() || first >= edges_.size()) return;
+    if ((edges_.size() - first) * REBUILD_RATIO < first) {
+        for (size_t id = first; id < edges_.size(); id++) {
+            index_(id);
+        }
+        return;
+    }
+    std::vector<const EData*> data;
+    try {
+        data.resize(edges_.size());
+    }
+    catch (const std::bad_alloc&) {
+        throw UnavailableMemoryException::edge_index_unable_to_insert();
+    }
+    pool.parallel_for(0, edges_.size(), [&](size_t id) {
+        data[id] = &std::as_const(edges_)[id].getData();
+    });
+    for (auto& index : indexes_) {
+        EdgeIndex<EData>* written = nullptr;
+        try {
+            written = &index.second.write();
+        }
+        catch (const std::bad_alloc&) {
+            throw UnavailableMemoryException::edge_index_unable_to_insert();
+        }
+        written->rebuild(data, pool);
     }
 }
 
+template <typename NData, typename EData>
+void Edges<NData, EData>::index_(size_t id) {
+    if (indexes_.empty() || indexing_deferred_) return;
+    const EData& data = std::as_const(edges_)[id].getData();
+    try {
+        for (auto& index : indexes_) {
+            index.second.write().insert(id, data);
+        }
+    }
+    catch (const std::bad_alloc&) {
+        throw UnavailableMemoryException::edge_index_unable_to_insert();
+    }
+}
+
+template <typename NData, typename EData>
+void Edges<NData, EData>::unindex_(size_t id) noexcept {
+    if (indexes_.empty()) return;
+    const EData& data = std::as_const(edges_)[id].getData();
+    for (auto& index : indexes_) {
+        // an index is unshared before the edge goes in, one still shared never got it
+        if (!index.second.is_shared()) index.second.write().erase(id, data);
+    }
+}
+
+template <typename NData, typename EData>
+typename my_array::Array<Edge<NData, EData>>::iterator Edges<NData, EData>::begin() {
+    edges_.unshare();
+    return edges_.begin();
+}
+
+template <typename NData, typename EData>
+typename my_array::Array<Edge<NData, EData>>::iterator Edges<NData, EData>::end() {
+    edges_.unshare();
+    return edges_.end();
+}
+
+template <typename NData, typename EData>
+void Edges<NData, EData>::construct_adjacency_matrix() {
+    size_t nodes_size = graph_->nodes().size();
+    size_t expected_entries = graph_->is_undirected() ? 2 * edges_.size() : edges_.size();
+    adjacency_.reset(nodes_size, expected_entries);
+    adjacency_.fill(sources_, targets_, graph_->is_undirected());
+}
+
 template <typename NData, typename EData>
 Edges<NData, EData>& Edges<NData, EData>::operator=(const Edges<NData, EData>& other) {
+    std::map<std::string, CopyOnWrite<EdgeIndex<EData>>> indexes(other.indexes_);
+    Properties properties(other.properties_);
     edges_ = other.edges_;
-    // upon just copying, the source/target pointers inside individual edges point to other
-    update_source_and_target_pointers();
-    // we can't just copy the adjacency matrix, because the pointers would still point to other
-    construct_adjacency_matrix();
+    sources_ = other.sources_;
+    targets_ = other.targets_;
+    properties_ = std::move(properties);
+    indexes_.swap(indexes);
+    existence_filter_ = other.existence_filter_;
+    // the adjacency holds edge ids, so it stays right whichever blocks either side copies
+    if (graph_->is_undirected() == other.graph_->is_undirected()) {
+        adjacency_ = other.adjacency_;
+    }
+    else {
+        // an undirected adjacency holds every edge twice, a directed one only once
+        adjacency_.set_thresholds(other.adjacency_.thresholds());
+        construct_adjacency_matrix();
+        if (existence_filter() != nullptr) {
+            fill_filter_(existence_filter_.get().capacity(),
+                existence_filter_.get().bits_per_pair());
+        }
+    }
     return *this;
 }
 
@@ -408,24 +1098,36 @@ template <typename NData, typename EData>
 Edges<NData, EData>& Edges<NData, EData>::operator=(Edges<NData, EData>&& other) noexcept {
     if (this != &other) {
         std::swap(edges_, other.edges_);
-        std::swap(adjacency_matrix_, other.adjacency_matrix_);
+        std::swap(sources_, other.sources_);
+        std::swap(targets_, other.targets_);
+        std::swap(adjacency_, other.adjacency_);
+        std::swap(properties_, other.properties_);
+        indexes_.swap(other.indexes_);
+        std::swap(existence_filter_, other.existence_filter_);
     }
     return *this;
 }
 
 template <typename NData, typename EData>
 Edges<NData, EData>::Edges(const Edges<NData, EData>& other, Graph<NData, EData>* graph) 
-        : graph_(graph), edges_(other.edges_) {
-    // upon just copying, the source/target pointers inside individual edges point to other
-    update_source_and_target_pointers();
-    // the adjacency matrix must be constructed inside the child constructors   
+        : graph_(graph), edges_(other.edges_), sources_(other.sources_),
+        targets_(other.targets_), adjacency_(other.adjacency_), properties_(other.properties_),
+        indexes_(other.indexes_), indexing_deferred_(false),
+        existence_filter_(other.existence_filter_) {
+    properties_.bound([this] { return edges_.size(); });
 }
 
 template <typename NData, typename EData>
 Edges<NData, EData>::Edges(Edges<NData, EData>&& other, Graph<NData, EData>* graph) noexcept
-        : graph_(graph) {
+        : graph_(graph), indexing_deferred_(false) {
     std::swap(edges_, other.edges_);
-    std::swap(adjacency_matrix_, other.adjacency_matrix_);
+    std::swap(sources_, other.sources_);
+    std::swap(targets_, other.targets_);
+    std::swap(adjacency_, other.adjacency_);
+    std::swap(properties_, other.properties_);
+    indexes_.swap(other.indexes_);
+    std::swap(existence_filter_, other.existence_filter_);
+    properties_.bound([this] { return edges_.size(); });
 }
 
 
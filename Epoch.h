@@ -0,0 +1,196 @@
+#ifndef __EPOCH_H
+#define __EPOCH_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+/// @file Epoch.h
+/// @brief Contains the EpochManager used for reclaiming memory that readers may still use
+///  and its member function definitions
+
+
+/// @brief Epoch-based reclamation; readers pin the current epoch while they read shared
+///  storage without taking any locks, writers retire the storage they replaced and it is freed
+///  only once every reader that could have seen it has unpinned
+class EpochManager {
+public:
+    /// @brief The number of readers that can be pinned at the same time,
+    ///  further readers wait for a slot to free up
+    static const size_t MAX_READERS = 128;
+
+    /// @brief The number of retired items after which retire tries to free them
+    static const size_t RECLAIM_THRESHOLD = 64;
+
+    /// @brief Keeps the epoch pinned for its lifetime, while pinned the storage the reader
+    ///  loaded stays valid
+    class Guard {
+    public:
+        /// @brief Move constructor
+        /// @param other The guard to move
+        Guard(Guard&& other) noexcept;
+
+        /// @brief Unpins the epoch
+        ~Guard();
+
+        Guard(const Guard& other) = delete;
+        Guard& operator=(const Guard& other) = delete;
+        Guard& operator=(Guard&& other) = delete;
+
+    private:
+        /// @brief Constructs a guard owning the given reader slot
+        /// @param slot The pinned slot, nullptr for a moved from guard
+        explicit Guard(std::atomic<uint64_t>* slot);
+
+        /// @brief The pinned slot
+        std::atomic<uint64_t>* slot_;
+
+        friend EpochManager;
+    };
+
+    /// @brief Constructs an epoch manager with no readers and nothing retired
+    EpochManager();
+
+    /// @brief Frees everything that was retired, no reader may be pinned anymore
+    ~EpochManager();
+
+    EpochManager(const EpochManager& other) = delete;
+    EpochManager& operator=(const EpochManager& other) = delete;
+
+    /// @brief Pins the current epoch for the calling reader, never takes a lock
+    /// @return The guard keeping the epoch pinned
+    Guard pin() const;
+
+    /// @brief Retires storage that was unlinked from the shared structure, it is freed once no
+    ///  reader can be using it anymore
+    /// @tparam T The type of the retired object
+    /// @param object The retired object, allocated with new
+    template <typename T>
+    void retire(const T* object);
+
+    /// @brief Frees all retired items that no pinned reader can be using
+    void reclaim();
+
+    /// @brief Get the number of retired items that were not freed yet
+    /// @return The number of retired items
+    size_t pending() const;
+
+private:
+    /// @brief The value of a slot that no reader is using
+    static const uint64_t FREE = UINT64_MAX;
+
+    /// @brief A reader slot on its own cache line, so readers do not slow each other down
+    struct Slot {
+        /// @brief The epoch pinned by the reader, FREE if unused
+        std::atomic<uint64_t> epoch;
+
+        /// @brief Fills the rest of the cache line
+        char padding[64 - sizeof(std::atomic<uint64_t>)];
+    };
+
+    /// @brief An item waiting to be freed
+    struct Retired {
+        /// @brief The epoch during which the item was retired
+        uint64_t epoch;
+
+        /// @brief Frees the item
+        std::function<void()> free;
+    };
+
+    /// @brief The current epoch
+    mutable std::atomic<uint64_t> epoch_;
+
+    /// @brief The reader slots
+    mutable Slot slots_[MAX_READERS];
+
+    /// @brief The retired items, only ever touched by writers
+    std::vector<Retired> retired_;
+
+    /// @brief Guards the retired items against concurrent writers
+    mutable std::mutex retired_mutex_;
+};
+
+inline EpochManager::Guard::Guard(std::atomic<uint64_t>* slot) : slot_(slot) {}
+
+inline EpochManager::Guard::Guard(Guard&& other) noexcept : slot_(other.slot_) {
+    other.slot_ = nullptr;
+}
+
+inline EpochManager::Guard::~Guard() {
+    if (slot_ != nullptr) slot_->store(FREE, std::memory_order_release);
+}
+
+inline EpochManager::EpochManager() : epoch_(0) {
+    for (size_t i = 0; i < MAX_READERS; i++) {
+        slots_[i].epoch.store(FREE, std::memory_order_relaxed);
+    }
+}
+
+inline EpochManager::~EpochManager() {
+    for (Retired& item : retired_) {
+        item.free();
+    }
+}
+
+inline EpochManager::Guard EpochManager::pin() const {
+    // start at a slot depending on the thread, so readers rarely compete for the same slot
+    size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % MAX_READERS;
+    for (size_t attempt = 0;; attempt++) {
+        Slot& slot = slots_[(start + attempt) % MAX_READERS];
+        uint64_t expected = FREE;
+        uint64_t current = epoch_.load(std::memory_order_seq_cst);
+        // seq_cst, so the pinned epoch is visible to reclaim before the reader loads anything
+        if (slot.epoch.compare_exchange_strong(expected, current, std::memory_order_seq_cst)) {
+            return Guard(&slot.epoch);
+        }
+        if (attempt % MAX_READERS == MAX_READERS - 1) std::this_thread::yield();
+    }
+}
+
+template <typename T>
+void EpochManager::retire(const T* object) {
+    bool should_reclaim;
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        retired_.push_back({ epoch_.load(std::memory_order_seq_cst), [object]() {
+            delete object;
+        } });
+        should_reclaim = retired_.size() >= RECLAIM_THRESHOLD;
+    }
+    if (should_reclaim) reclaim();
+}
+
+inline void EpochManager::reclaim() {
+    std::vector<Retired> freeable;
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        // every reader pinning later sees the storage that replaced the retired items
+        uint64_t oldest = epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+        for (size_t i = 0; i < MAX_READERS; i++) {
+            uint64_t pinned = slots_[i].epoch.load(std::memory_order_seq_cst);
+            if (pinned < oldest) oldest = pinned;
+        }
+        auto kept = retired_.begin();
+        for (auto it = retired_.begin(); it != retired_.end(); ++it) {
+            if (it->epoch < oldest) freeable.push_back(std::move(*it));
+            else *kept++ = std::move(*it);
+        }
+        retired_.erase(kept, retired_.end());
+    }
+    for (Retired& item : freeable) {
+        item.free();
+    }
+}
+
+inline size_t EpochManager::pending() const {
+    std::lock_guard<std::mutex> lock(retired_mutex_);
+    return retired_.size();
+}
+
+
+#endif
\ No newline at end of file
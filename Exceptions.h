@@ -3,6 +3,7 @@
 
 
 #include <string>
+#include <cstdint>
 
 
 /// @file Exceptions.h
@@ -99,6 +100,22 @@ public:
     static NonexistingItemException adding_edge_with_nonexistant_nodes
     (size_t source, size_t target, size_t size);
 
+    /// @brief Returns an exception for attempting to access a property column that does not exist
+    /// @param name The name of the property
+    /// @return The Nonexisting item exception with the appropriate message
+    static NonexistingItemException accessing_nonexistant_property(std::string name);
+
+    /// @brief Returns an exception for attempting to access a secondary index that does not exist
+    /// @param name The name of the index
+    /// @return The Nonexisting item exception with the appropriate message
+    static NonexistingItemException accessing_nonexistant_index(std::string name);
+
+    /// @brief Returns an exception for attempting to set a property of a node or edge that does
+    ///  not exist
+    /// @param id The id of the node or edge
+    /// @param size The number of nodes or edges owning the property
+    /// @return The Nonexisting item exception with the appropriate message
+    static NonexistingItemException setting_property_of_nonexistant_item(size_t id, size_t size);
 };
 
 /// @brief Exceptions relating to conflicting items
@@ -122,6 +139,18 @@ public:
     /// @return The conflicting item exception with the appropriate message
     static ConflictingItemException adding_edge_with_conflicting_nodes
     (size_t source, size_t target);
+
+    /// @brief Returns an exception for attempting to add a property column with a name already
+    ///  used by a column of another type
+    /// @param name The name of the property
+    /// @return The conflicting item exception with the appropriate message
+    static ConflictingItemException adding_conflicting_property(std::string name);
+
+    /// @brief Returns an exception for attempting to add a secondary index with a name already
+    ///  used by another index
+    /// @param name The name of the index
+    /// @return The conflicting item exception with the appropriate message
+    static ConflictingItemException adding_conflicting_index(std::string name);
 };
 
 /// @brief Exceptions related to invalid identifiers
@@ -162,6 +191,42 @@ public:
     /// @brief Returns an exception for being unable to grow the array
     /// @return The unavailable memory exception with the appropriate message
     static UnavailableMemoryException array_unable_to_insert();
+
+    /// @brief Returns an exception for being unable to stage an addition inside a batch
+    /// @return The unavailable memory exception with the appropriate message
+    static UnavailableMemoryException batch_unable_to_stage();
+
+    /// @brief Returns an exception for being unable to apply a batch to the graph
+    /// @return The unavailable memory exception with the appropriate message
+    static UnavailableMemoryException batch_unable_to_commit();
+
+    /// @brief Returns an exception for being unable to intern a new string
+    /// @return The unavailable memory exception with the appropriate message
+    static UnavailableMemoryException string_pool_unable_to_insert();
+
+    /// @brief Returns an exception for being unable to allocate the frames of a page cache
+    /// @return The unavailable memory exception with the appropriate message
+    static UnavailableMemoryException page_cache_unable_to_allocate();
+
+    /// @brief Returns an exception for pinning a page while every frame of the cache is pinned
+    /// @return The unavailable memory exception with the appropriate message
+    static UnavailableMemoryException page_cache_all_frames_pinned();
+
+    /// @brief Returns an exception for being unable to set a value of a property column
+    /// @return The unavailable memory exception with the appropriate message
+    static UnavailableMemoryException property_column_unable_to_insert();
+
+    /// @brief Returns an exception for being unable to insert a node into a secondary index
+    /// @return The unavailable memory exception with the appropriate message
+    static UnavailableMemoryException node_index_unable_to_insert();
+
+    /// @brief Returns an exception for being unable to insert an edge into a secondary index
+    /// @return The unavailable memory exception with the appropriate message
+    static UnavailableMemoryException edge_index_unable_to_insert();
+
+    /// @brief Returns an exception for being unable to allocate the blocks of a Bloom filter
+    /// @return The unavailable memory exception with the appropriate message
+    static UnavailableMemoryException bloom_filter_unable_to_allocate();
 };
 
 /// @brief Exceptions relating problems with files
@@ -178,6 +243,34 @@ public:
     /// @param filename The name of the file
     /// @return The file processing exception with the appropriate message
     static FileProcessingException unable_to_open_input_file(std::string filename);
+
+    /// @brief Returns an exception for being unable to read a page of a paged file
+    /// @param filename The name of the file
+    /// @param page The number of the page
+    /// @return The file processing exception with the appropriate message
+    static FileProcessingException unable_to_read_page(std::string filename, size_t page);
+
+    /// @brief Returns an exception for being unable to write a page of a paged file
+    /// @param filename The name of the file
+    /// @param page The number of the page
+    /// @return The file processing exception with the appropriate message
+    static FileProcessingException unable_to_write_page(std::string filename, size_t page);
+
+    /// @brief Returns an exception for being unable to map a file into memory or to grow it
+    /// @param filename The name of the file
+    /// @return The file processing exception with the appropriate message
+    static FileProcessingException unable_to_map_file(std::string filename);
+
+    /// @brief Returns an exception for being unable to write a mapped file back
+    /// @param filename The name of the file
+    /// @return The file processing exception with the appropriate message
+    static FileProcessingException unable_to_sync_file(std::string filename);
+
+    /// @brief Returns an exception for a file that does not hold the mapped graph asked for
+    /// @param filename The name of the file
+    /// @param reason What is wrong with the file
+    /// @return The file processing exception with the appropriate message
+    static FileProcessingException invalid_mapped_graph(std::string filename, std::string reason);
 };
 
 /// @brief Exceptions relation to problems with streams
@@ -200,6 +293,57 @@ public:
     static ParsingException failed_parsing_number();
 };
 
+/// @brief Exceptions relating to invalid arguments
+class InvalidArgumentException : public Exception {
+public:
+    using Exception::Exception;
+
+    /// @brief Returns an exception for adjacency thresholds that leave no gap between switching
+    ///  to the sparse and to the dense representation
+    /// @param sparse_below The density under which the adjacency becomes sparse
+    /// @param dense_above The density over which the adjacency becomes dense
+    /// @return The invalid argument exception with the appropriate message
+    static InvalidArgumentException adjacency_thresholds_without_gap
+    (double sparse_below, double dense_above);
+
+    /// @brief Returns an exception for compressing an adjacency with more nodes than the
+    ///  compressed format can address
+    /// @param nodes The number of nodes
+    /// @return The invalid argument exception with the appropriate message
+    static InvalidArgumentException compressed_adjacency_too_many_nodes(size_t nodes);
+
+    /// @brief Returns an exception for paging elements larger than a page
+    /// @param element The size of an element
+    /// @param page The size of a page
+    /// @return The invalid argument exception with the appropriate message
+    static InvalidArgumentException paged_element_larger_than_page(size_t element, size_t page);
+
+    /// @brief Returns an exception for accessing a property column as another type than the one
+    ///  it was added with
+    /// @param name The name of the property
+    /// @return The invalid argument exception with the appropriate message
+    static InvalidArgumentException property_of_another_type(std::string name);
+
+    /// @brief Returns an exception for accessing a secondary index as another type than the one
+    ///  it was added with
+    /// @param name The name of the index
+    /// @return The invalid argument exception with the appropriate message
+    static InvalidArgumentException index_of_another_type(std::string name);
+
+    /// @brief Returns an exception for getting a cached algorithm result as another type than
+    ///  the one it was cached with
+    /// @param algorithm The name of the algorithm
+    /// @return The invalid argument exception with the appropriate message
+    static InvalidArgumentException cached_result_of_another_type(std::string algorithm);
+
+    /// @brief Returns an exception for answering a batch of queries into a number of results
+    ///  other than the number of queries
+    /// @param queries The number of queries
+    /// @param results The number of results
+    /// @return The invalid argument exception with the appropriate message
+    static InvalidArgumentException batch_results_size_mismatch(size_t queries, size_t results);
+};
+
 /// @brief Exception relating to accesing array indexes out of range
 class OutOfRangeException : public Exception {
 public:
@@ -221,6 +365,24 @@ public:
     static EmptyArrayException array_popping_empty_array();
 };
 
+/// @brief Exceptions relating to operations that are not allowed in the current state
+class InvalidOperationException : public Exception {
+public:
+    using Exception::Exception;
+
+    /// @brief Returns an exception for beginning a batch while another one is open
+    /// @return The invalid operation exception with the appropriate message
+    static InvalidOperationException beginning_batch_inside_batch();
+
+    /// @brief Returns an exception for staging, committing or rolling back without an open batch
+    /// @return The invalid operation exception with the appropriate message
+    static InvalidOperationException using_batch_without_open_batch();
+
+    /// @brief Returns an exception for adding a node or an edge directly while a batch is open
+    /// @return The invalid operation exception with the appropriate message
+    static InvalidOperationException adding_directly_inside_batch();
+};
+
 
 
 
@@ -315,6 +477,22 @@ NonexistingItemException NonexistingItemException::adding_edge_with_nonexistant_
         + std::to_string(size) + " nodes are available");
 }
 
+NonexistingItemException NonexistingItemException::accessing_nonexistant_property
+(std::string name) {
+    return NonexistingItemException("Attempting to access a nonexisting property " + name);
+}
+
+NonexistingItemException NonexistingItemException::accessing_nonexistant_index(std::string name) {
+    return NonexistingItemException("Attempting to access a nonexisting index " + name);
+}
+
+NonexistingItemException NonexistingItemException::setting_property_of_nonexistant_item
+(size_t id, size_t size) {
+    return NonexistingItemException("Attempting to set a property of a nonexisting item with"
+        + std::string(" identifier ") + std::to_string(id) + ", only " + std::to_string(size)
+        + " items are available");
+}
+
 ConflictingItemException ConflictingItemException::adding_node_conflicting_identifier(size_t id) {
     return ConflictingItemException("Attempting to add a new node with identifier "
         + std::to_string(id) + " which already is associated with another existing node");
@@ -333,6 +511,16 @@ ConflictingItemException ConflictingItemException::adding_edge_with_conflicting_
         + " which already are connected with another existing edge");
 }
 
+ConflictingItemException ConflictingItemException::adding_conflicting_property(std::string name) {
+    return ConflictingItemException("Attempting to add a new property " + name
+        + " whose name already is associated with a property of another type");
+}
+
+ConflictingItemException ConflictingItemException::adding_conflicting_index(std::string name) {
+    return ConflictingItemException("Attempting to add a new index " + name
+        + " whose name already is associated with another existing index");
+}
+
 InvalidIdentifierException InvalidIdentifierException::adding_node_invalid_identifier(size_t id,
     size_t size) {
     return InvalidIdentifierException("Attempting to add a new node with invalid identifier "
@@ -360,6 +548,44 @@ UnavailableMemoryException UnavailableMemoryException::edge_container_unable_to_
     ("Unable to insert a new edge record into the underlying container of edges");
 }
 
+UnavailableMemoryException UnavailableMemoryException::batch_unable_to_stage() {
+    return UnavailableMemoryException("Unable to stage a new addition inside the open batch");
+}
+
+UnavailableMemoryException UnavailableMemoryException::batch_unable_to_commit() {
+    return UnavailableMemoryException
+    ("Unable to apply the open batch to the graph, the graph was left unchanged");
+}
+
+UnavailableMemoryException UnavailableMemoryException::string_pool_unable_to_insert() {
+    return UnavailableMemoryException("Unable to intern a new string into the string pool");
+}
+
+UnavailableMemoryException UnavailableMemoryException::page_cache_unable_to_allocate() {
+    return UnavailableMemoryException("Unable to allocate the frames of a page cache");
+}
+
+UnavailableMemoryException UnavailableMemoryException::page_cache_all_frames_pinned() {
+    return UnavailableMemoryException
+    ("Unable to load a page into the page cache, every frame is pinned");
+}
+
+UnavailableMemoryException UnavailableMemoryException::property_column_unable_to_insert() {
+    return UnavailableMemoryException("Unable to insert a value into a property column");
+}
+
+UnavailableMemoryException UnavailableMemoryException::node_index_unable_to_insert() {
+    return UnavailableMemoryException("Unable to insert a node into a secondary index");
+}
+
+UnavailableMemoryException UnavailableMemoryException::edge_index_unable_to_insert() {
+    return UnavailableMemoryException("Unable to insert an edge into a secondary index");
+}
+
+UnavailableMemoryException UnavailableMemoryException::bloom_filter_unable_to_allocate() {
+    return UnavailableMemoryException("Unable to allocate the blocks of a Bloom filter");
+}
+
 FileProcessingException FileProcessingException::unable_to_open_output_file(std::string filename) {
     return FileProcessingException("Unable to open an output file " + filename);
 }
@@ -368,6 +594,31 @@ FileProcessingException FileProcessingException::unable_to_open_input_file(std::
     return FileProcessingException("Unable to open an input file " + filename);
 }
 
+FileProcessingException FileProcessingException::unable_to_read_page(std::string filename,
+        size_t page) {
+    return FileProcessingException("Unable to read page " + std::to_string(page) + " of file "
+        + filename);
+}
+
+FileProcessingException FileProcessingException::unable_to_write_page(std::string filename,
+        size_t page) {
+    return FileProcessingException("Unable to write page " + std::to_string(page) + " of file "
+        + filename);
+}
+
+FileProcessingException FileProcessingException::unable_to_map_file(std::string filename) {
+    return FileProcessingException("Unable to map file " + filename);
+}
+
+FileProcessingException FileProcessingException::unable_to_sync_file(std::string filename) {
+    return FileProcessingException("Unable to sync file " + filename);
+}
+
+FileProcessingException FileProcessingException::invalid_mapped_graph(std::string filename,
+        std::string reason) {
+    return FileProcessingException("Unable to open mapped graph " + filename + ": " + reason);
+}
+
 
 InvalidStreamException InvalidStreamException::invalid_output_stream() {
     return InvalidStreamException("Unable to print to the specified output stream");
@@ -381,6 +632,62 @@ ParsingException ParsingException::failed_parsing_number() {
     return ParsingException("Failed while parsing a number from the input");
 }
 
+InvalidArgumentException InvalidArgumentException::adjacency_thresholds_without_gap
+(double sparse_below, double dense_above) {
+    return InvalidArgumentException("The adjacency density threshold for becoming sparse "
+        + std::to_string(sparse_below) + " has to be lower than the threshold for becoming dense "
+        + std::to_string(dense_above));
+}
+
+InvalidArgumentException InvalidArgumentException::compressed_adjacency_too_many_nodes
+(size_t nodes) {
+    return InvalidArgumentException("Unable to compress an adjacency of " + std::to_string(nodes)
+        + " nodes, at most " + std::to_string(UINT32_MAX) + " nodes are supported");
+}
+
+InvalidArgumentException InvalidArgumentException::paged_element_larger_than_page
+(size_t element, size_t page) {
+    return InvalidArgumentException("Unable to page elements of " + std::to_string(element)
+        + " bytes in pages of " + std::to_string(page) + " bytes");
+}
+
+InvalidArgumentException InvalidArgumentException::property_of_another_type(std::string name) {
+    return InvalidArgumentException("Attempting to access property " + name
+        + " as another type than it was added with");
+}
+
+InvalidArgumentException InvalidArgumentException::index_of_another_type(std::string name) {
+    return InvalidArgumentException("Attempting to access index " + name
+        + " as another type than it was added with");
+}
+
+InvalidArgumentException InvalidArgumentException::cached_result_of_another_type
+(std::string algorithm) {
+    return InvalidArgumentException("Attempting to get the cached result of algorithm "
+        + algorithm + " as another type than it was cached with");
+}
+
+InvalidArgumentException InvalidArgumentException::batch_results_size_mismatch
+(size_t queries, size_t results) {
+    return InvalidArgumentException("Attempting to answer " + std::to_string(queries)
+        + " queries into " + std::to_string(results) + " results");
+}
+
+InvalidOperationException InvalidOperationException::beginning_batch_inside_batch() {
+    return InvalidOperationException
+    ("Attempting to begin a new batch while the previous one was not committed or rolled back");
+}
+
+InvalidOperationException InvalidOperationException::using_batch_without_open_batch() {
+    return InvalidOperationException
+    ("Attempting to stage, commit or roll back a batch without beginning one first");
+}
+
+InvalidOperationException InvalidOperationException::adding_directly_inside_batch() {
+    return InvalidOperationException
+    ("Attempting to add a node or an edge directly while a batch is open, stage it instead");
+}
+
 
 
 #endif
\ No newline at end of file
@@ -7,10 +7,15 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <set>
 #include "Array.h"
 #include "Exceptions.h"
+#include "MemoryUsage.h"
 #include "Nodes.h"
 #include "Edges.h"
+#include "GraphSnapshot.h"
+#include "Pipeline.h"
+#include "ResultCache.h"
 
 
 /// @file Graph.h
@@ -18,6 +23,16 @@
 ///  and their member function definition
 
 
+// forward declarations
+template <typename NData, typename EData>
+struct ImportRecord;
+
+#ifdef GRAPH_COROUTINES
+template <typename T>
+class Generator;
+#endif
+
+
 /// @brief The class representing the graph
 /// @tparam NData The data associated with the Graph's nodes
 /// @tparam EData The data associated with the Graph's edges
@@ -38,6 +53,114 @@ public:
     /// @return A reference to the graph's edges
     Edges<NData, EData>& edges();
 
+    /// @brief Get a const reference to the nodes of the graph
+    /// @return A const reference to the graph's nodes
+    const Nodes<NData, EData>& nodes() const;
+
+    /// @brief Get a const reference to the edges of the graph
+    /// @return A const reference to the graph's edges
+    const Edges<NData, EData>& edges() const;
+
+    /// @brief Takes a read-only snapshot of the graph as it is now, copying the nodes and edges
+    ///  and sharing the adjacency rows; later writes are not visible through it and it may be
+    ///  read from another thread meanwhile
+    /// @return The snapshot
+    /// @exception UnavailableMemoryException If there isn't enough memory for the snapshot
+    GraphSnapshot<NData, EData> snapshot() const;
+
+    /// @brief Splits the nodes into one contiguous range per NUMA node of the pool, balanced by
+    ///  the number of edges, and moves the nodes, the edges and the adjacency rows of every range
+    ///  to its NUMA node; nodes added later belong to the last range. Only worth it on a NUMA
+    ///  machine with a pool created with the numa option, anywhere else there is a single range
+    ///  and nothing moves
+    /// @param pool The thread pool whose NUMA nodes the graph is split between
+    void distribute(ThreadPool& pool = ThreadPool::global());
+
+    /// @brief Get the ranges of node ids and their NUMA nodes, so the algorithms can process
+    ///  every range on its own node with ThreadPool::parallel_for_partitioned
+    /// @return The ranges set by distribute, covering all current nodes, or a single range on
+    ///  NUMA node 0 if the graph was never distributed; copies are not distributed
+    std::vector<NumaPartition> partitions() const;
+
+    /// @brief Get the memory used by the graph split by component: the node and edge blocks,
+    ///  the endpoint columns, the adjacency in whichever representation it is stored, an open
+    ///  batch, the property columns, the secondary indexes, the cached algorithm results and
+    ///  the unused capacity of all of them. Walks the blocks and the adjacency rows, the node
+    ///  and edge data only if their HeapUsage says they may own heap memory. What the graph
+    ///  shares with its copies or snapshots is counted by each of them, see MemoryUsage::shared
+    /// @return The breakdown in bytes
+    MemoryUsage memory_usage() const;
+
+    /// @brief Get the mutation version of the graph, bumped by every added node or edge and by
+    ///  every committed batch
+    /// @return The version
+    uint64_t version() const;
+
+    /// @brief Bumps the mutation version, so the cached results are computed anew; call it after
+    ///  changing the data of nodes or edges in place, adding them bumps it already
+    void mark_changed();
+
+    /// @brief Gets the result of an algorithm run on the graph from its result cache, running
+    ///  the algorithm only if the result of the same parameters is not cached for the current
+    ///  version. Many threads may get results at once while the graph is not being changed
+    /// @tparam Result The type of the result
+    /// @tparam Compute A callable taking no arguments and returning the result
+    /// @tparam Parameters The types of the parameters, printable to an output stream
+    /// @param algorithm The name of the algorithm
+    /// @param compute The function running the algorithm
+    /// @param parameters The parameters of the algorithm
+    /// @return The shared result
+    /// @exception InvalidArgumentException If the result was cached as another type
+    /// @exception Any exception thrown by compute
+    template <typename Result, typename Compute, typename... Parameters>
+    std::shared_ptr<const Result> cached(const std::string& algorithm, Compute compute,
+        const Parameters&... parameters) const;
+
+    /// @brief Get the result cache of the graph, to set its memory limit or read its counters
+    /// @return The result cache
+    ResultCache& result_cache() const;
+
+    /// @brief Opens a batch; until it is committed or rolled back, nodes and edges are only
+    ///  staged on the side and the graph stays unchanged. Adding directly is not allowed meanwhile
+    /// @exception InvalidOperationException If a batch is already open
+    void begin_batch();
+
+    /// @brief Stages a node for the open batch
+    /// @param data The node data of the node
+    /// @return The id the node will have once the batch is committed
+    /// @exception InvalidOperationException If no batch is open
+    /// @exception UnavailableMemoryException If there isn't enough memory to stage the node
+    size_t stage_node(NData data);
+
+    /// @brief Stages an edge for the open batch, its nodes may be staged as well
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    /// @param data The edge data of the edge
+    /// @return The id the edge will have once the batch is committed
+    /// @exception InvalidOperationException If no batch is open
+    /// @exception NonexistingItemException If the source or target node neither exists nor is
+    ///  staged
+    /// @exception ConflictingItemException If the nodes are already connected by an existing
+    ///  or staged edge
+    /// @exception UnavailableMemoryException If there isn't enough memory to stage the edge
+    size_t stage_edge(size_t source, size_t target, EData data);
+
+    /// @brief Applies the open batch in one pass and closes it; the storage and the adjacency
+    ///  grow once for the whole batch, the secondary indexes of the edges take the staged edges
+    ///  at once, rebuilt in parallel if they are many. All or nothing, if it fails the graph is left unchanged
+    ///  and the batch stays open
+    /// @exception InvalidOperationException If no batch is open
+    /// @exception UnavailableMemoryException If there isn't enough memory to apply the batch
+    void commit();
+
+    /// @brief Discards everything staged inside the open batch and closes it
+    /// @exception InvalidOperationException If no batch is open
+    void rollback();
+
+    /// @brief Tests if a batch is open
+    /// @return True if a batch is open, false if it is not
+    bool in_batch() const;
+
     /// @brief Prints the graph to the specified output stream
     /// @param os The output stream
     /// @exception InvalidStreamException If the output stream is not good
@@ -48,9 +171,12 @@ public:
     /// @exception FileProcessingException If the output file is not good
     void print(const std::string& filename) const;
 
-    /// @brief Imports the graph from the given input stream
+    /// @brief Imports the graph from the given input stream; the imported edges go into the
+    ///  secondary indexes of the edges at once at the end
     /// @param is The input stream   
     /// @exception InvalidStreamException If the input stream is not good
+    /// @exception UnavailableMemoryException If the indexes cannot take the imported edges, they
+    ///  are left empty then, like after a failed Edges::reindex
     void import(std::istream& is = std::cin);
 
     /// @brief Impots the graph from a file with the given filename
@@ -58,7 +184,44 @@ public:
     /// @exception FileProcessingException If the input file is not good
     void import(const std::string& filename);
 
-    /// @brief Copy constructor
+    /// @brief Parses a line of the import format without adding anything to the graph
+    /// @param line The line
+    /// @param record The record to parse the node or edge into
+    /// @return True if the line was a node or an edge, false if it was neither
+    /// @exception ParsingException If parsing an id failed
+    static bool parse_record(const std::string& line, ImportRecord<NData, EData>& record);
+
+    /// @brief Reads the next batch of parsed records from the given input stream
+    /// @param is The input stream
+    /// @param batch The batch to read into, cleared first
+    /// @param batch_size The maximum number of records in the batch
+    /// @return True if anything was read, false at the end of the stream
+    /// @exception ParsingException If parsing an id failed
+    static bool read_batch(std::istream& is, std::vector<ImportRecord<NData, EData>>& batch,
+        size_t batch_size);
+
+#ifdef GRAPH_COROUTINES
+    /// @brief Lazily parses the given input stream, every resumption reads the next batch
+    /// @param is The input stream, has to outlive the generator
+    /// @param batch_size The maximum number of records in a batch
+    /// @return The generator yielding the batches
+    /// @exception ParsingException If parsing an id failed, thrown when resuming
+    static Generator<std::vector<ImportRecord<NData, EData>>> import_batches(std::istream& is,
+        size_t batch_size);
+#endif
+
+    /// @brief Adds the node or edge of a parsed record
+    /// @param record The record
+    /// @exception The exceptions of Nodes::add and Edges::add with an id
+    void apply(const ImportRecord<NData, EData>& record);
+
+    /// @brief Adds the node or edge of a parsed record, moving its data into the graph
+    /// @param record The record, its data is left moved from
+    /// @exception The exceptions of Nodes::add and Edges::add with an id
+    void apply(ImportRecord<NData, EData>&& record);
+
+    /// @brief Copy constructor, shares the storage of the nodes, the edges and the adjacency with
+    ///  the other graph until either of them writes to it, see Nodes and Edges
     /// @param other The graph to copy from
     Graph(const Graph& other);
 
@@ -66,7 +229,7 @@ public:
     /// @param other The graph to move
     Graph(Graph&& other) noexcept;
 
-    /// @brief Copy assignment
+    /// @brief Copy assignment, shares the storage like the copy constructor
     /// @param other The graph to copy
     /// @return The graph copied to
     Graph& operator=(const Graph& other);
@@ -87,24 +250,66 @@ private:
     /// @brief The edged og the grapg
     Edges<NData, EData> edges_;
 
+    /// @brief The ranges of node ids set by distribute, empty if never distributed
+    std::vector<NumaPartition> partitions_;
+
+    /// @brief The mutation version
+    uint64_t version_;
+
+    /// @brief The cached results of algorithms, computed by const member functions
+    mutable ResultCache cache_;
+
+    /// @brief An edge staged inside the open batch
+    struct StagedEdge {
+        /// @brief The id of the source node
+        size_t source;
+
+        /// @brief The id of the target node
+        size_t target;
+
+        /// @brief The edge data
+        EData data;
+    };
+
+    /// @brief True while a batch is open
+    bool batching_;
+
+    /// @brief The data of the nodes staged inside the open batch
+    std::vector<NData> staged_nodes_;
+
+    /// @brief The edges staged inside the open batch
+    std::vector<StagedEdge> staged_edges_;
+
+    /// @brief The source and target of every staged edge, the smaller id first if undirected
+    std::set<std::pair<size_t, size_t>> staged_pairs_;
+
+    /// @brief Discards everything staged inside the open batch and closes it
+    void discard_batch_() noexcept;
+
     /// @brief Import a line from the specified input string stream
     /// @param iss The input string stream
-    void import_line(std::istringstream& iss);
+    /// @param record The record to import into
+    /// @return True if the line was a node or an edge
+    static bool import_line(std::istringstream& iss, ImportRecord<NData, EData>& record);
 
     /// @brief Import a node from the specified input string stream
     /// @param iss The input string stream
-    void import_node(std::istringstream& iss);
+    /// @param record The record to import into
+    /// @return True if anything was left to import
+    static bool import_node(std::istringstream& iss, ImportRecord<NData, EData>& record);
 
     /// @brief Import an edge from the specified input string stream
     /// @param iss The input string stream
-    void import_edge(std::istringstream& iss);
+    /// @param record The record to import into
+    /// @return True if anything was left to import
+    static bool import_edge(std::istringstream& iss, ImportRecord<NData, EData>& record);
 
     /// @brief Parse an id from the specified input string stream with a given delimiter
     /// @param iss The input string stream
     /// @param delim The delimiter
     /// @return The id
     /// @exception ParsingException If the parsing of the id failed
-    size_t parse_id(std::istringstream& iss, char delim);
+    static size_t parse_id(std::istringstream& iss, char delim);
 };
 
 /// @brief A directed graph
@@ -156,7 +361,7 @@ std::ostream& operator<<(std::ostream& os, const Graph<NData, EData>& graph) {
 }
 
 template <typename NData, typename EData>
-Graph<NData, EData>::Graph() : nodes_(this), edges_(this) {}
+Graph<NData, EData>::Graph() : nodes_(this), edges_(this), version_(0), batching_(false) {}
 
 template <typename NData, typename EData> 
 Graph<NData, EData>::~Graph() {}
@@ -181,6 +386,216 @@ Edges<NData, EData>& Graph<NData, EData>::edges() {
     return edges_;
 }
 
+template <typename NData, typename EData>
+const Nodes<NData, EData>& Graph<NData, EData>::nodes() const {
+    return nodes_;
+}
+
+template <typename NData, typename EData>
+const Edges<NData, EData>& Graph<NData, EData>::edges() const {
+    return edges_;
+}
+
+template <typename NData, typename EData>
+GraphSnapshot<NData, EData> Graph<NData, EData>::snapshot() const {
+    return GraphSnapshot<NData, EData>(*this);
+}
+
+template <typename NData, typename EData>
+void Graph<NData, EData>::begin_batch() {
+    if (batching_) throw InvalidOperationException::beginning_batch_inside_batch();
+    batching_ = true;
+}
+
+template <typename NData, typename EData>
+size_t Graph<NData, EData>::stage_node(NData data) {
+    if (!batching_) throw InvalidOperationException::using_batch_without_open_batch();
+    try {
+        staged_nodes_.push_back(std::move(data));
+    }
+    catch (...) {
+        throw UnavailableMemoryException::batch_unable_to_stage();
+    }
+    return nodes_.size() + staged_nodes_.size() - 1;
+}
+
+template <typename NData, typename EData>
+size_t Graph<NData, EData>::stage_edge(size_t source, size_t target, EData data) {
+    if (!batching_) throw InvalidOperationException::using_batch_without_open_batch();
+    size_t existing = nodes_.size();
+    size_t nodes_size = existing + staged_nodes_.size();
+    if (source >= nodes_size || target >= nodes_size)
+        throw NonexistingItemException::adding_edge_with_nonexistant_nodes
+        (source, target, nodes_size);
+    std::pair<size_t, size_t> key(source, target);
+    if (is_undirected() && target < source) std::swap(key.first, key.second);
+    if ((source < existing && target < existing &&
+            edges_.adjacency().find(source, target) != Adjacency::NONE) ||
+            staged_pairs_.count(key) != 0)
+        throw ConflictingItemException::adding_edge_with_conflicting_nodes(source, target);
+    bool pushed = false;
+    try {
+        staged_edges_.push_back({ source, target, std::move(data) });
+        pushed = true;
+        staged_pairs_.insert(key);
+    }
+    catch (...) {
+        if (pushed) staged_edges_.pop_back();
+        throw UnavailableMemoryException::batch_unable_to_stage();
+    }
+    return edges_.size() + staged_edges_.size() - 1;
+}
+
+template <typename NData, typename EData>
+void Graph<NData, EData>::commit() {
+    if (!batching_) throw InvalidOperationException::using_batch_without_open_batch();
+    my_array::Array<Node<NData>>& nodes = nodes_.nodes_;
+    my_array::Array<Edge<NData, EData>>& edges = edges_.edges_;
+    my_array::Array<size_t>& sources = edges_.sources_;
+    my_array::Array<size_t>& targets = edges_.targets_;
+    Adjacency& adjacency = edges_.adjacency_;
+    size_t nodes_before = nodes.size();
+    size_t edges_before = edges.size();
+    bool undirected = is_undirected();
+    // the edges go into the secondary indexes at once, after the last of them is added
+    edges_.defer_indexing_(true);
+    try {
+        nodes.reserve(nodes_before + staged_nodes_.size());
+        edges.reserve(edges_before + staged_edges_.size());
+        sources.reserve(edges_before + staged_edges_.size());
+        targets.reserve(edges_before + staged_edges_.size());
+        adjacency.grow(staged_nodes_.size());
+        for (size_t i = 0; i < staged_nodes_.size(); i++) {
+            // the staged data is copied, not moved, so a failed commit can be retried
+            nodes.emplace_back(nodes_before + i, std::piecewise_construct, staged_nodes_[i]);
+            nodes_.index_(nodes_before + i);
+        }
+        for (size_t i = 0; i < staged_edges_.size(); i++) {
+            const StagedEdge& staged = staged_edges_[i];
+            sources.push_back(staged.source);
+            targets.push_back(staged.target);
+            edges.emplace_back(edges_before + i, std::piecewise_construct, staged.data);
+            adjacency.set(staged.source, staged.target, edges_before + i);
+            if (undirected) adjacency.set(staged.target, staged.source, edges_before + i);
+            edges_.filter_insert_(staged.source, staged.target);
+        }
+        edges_.index_from_(edges_before, ThreadPool::global());
+    }
+    catch (...) {
+        edges_.defer_indexing_(false);
+        // clear the entries before shrinking, rows of existing nodes may hold new targets
+        for (size_t i = 0; edges_before + i < edges.size(); i++) {
+            const StagedEdge& staged = staged_edges_[i];
+            adjacency.clear(staged.source, staged.target);
+            if (undirected) adjacency.clear(staged.target, staged.source);
+        }
+        while (edges.size() > edges_before) {
+            edges_.unindex_(edges.size() - 1);
+            edges.pop_back();
+        }
+        // the last blocks were unshared by adding, so popping copies nothing
+        while (sources.size() > edges_before) sources.pop_back();
+        while (targets.size() > edges_before) targets.pop_back();
+        while (nodes.size() > nodes_before) {
+            nodes_.unindex_(nodes.size() - 1);
+            nodes.pop_back();
+        }
+        adjacency.truncate(nodes_before);
+        throw UnavailableMemoryException::batch_unable_to_commit();
+    }
+    if (!staged_nodes_.empty() || !staged_edges_.empty()) mark_changed();
+    discard_batch_();
+}
+
+template <typename NData, typename EData>
+void Graph<NData, EData>::rollback() {
+    if (!batching_) throw InvalidOperationException::using_batch_without_open_batch();
+    discard_batch_();
+}
+
+template <typename NData, typename EData>
+bool Graph<NData, EData>::in_batch() const {
+    return batching_;
+}
+
+template <typename NData, typename EData>
+void Graph<NData, EData>::discard_batch_() noexcept {
+    // swap with empty containers, so the memory of a large batch is given back
+    std::vector<NData>().swap(staged_nodes_);
+    std::vector<StagedEdge>().swap(staged_edges_);
+    staged_pairs_.clear();
+    batching_ = false;
+}
+
+template <typename NData, typename EData>
+void Graph<NData, EData>::distribute(ThreadPool& pool) {
+    std::vector<size_t> weights(nodes_.size(), 1);
+    const Adjacency& adjacency = edges_.adjacency();
+    pool.parallel_for(0, weights.size(), [&](size_t source) {
+        adjacency.for_each_neighbor(source, [&](size_t, size_t) {
+            ++weights[source];
+        });
+    });
+    partitions_ = numa_partitions(weights, pool.numa_node_count());
+    nodes_.distribute(partitions_);
+    edges_.distribute(partitions_, pool);
+}
+
+template <typename NData, typename EData>
+std::vector<NumaPartition> Graph<NData, EData>::partitions() const {
+    if (partitions_.empty()) return { { 0, nodes_.size(), 0 } };
+    std::vector<NumaPartition> partitions(partitions_);
+    partitions.back().end = std::max(partitions.back().end, nodes_.size());
+    return partitions;
+}
+
+template <typename NData, typename EData>
+MemoryUsage Graph<NData, EData>::memory_usage() const {
+    MemoryUsage usage;
+    nodes_.memory_usage(usage);
+    edges_.memory_usage(usage);
+    usage.staged += staged_nodes_.size() * sizeof(NData) +
+        staged_edges_.size() * sizeof(StagedEdge) +
+        // a tree node holds the pair, the two children, the parent and the color
+        staged_pairs_.size() * (sizeof(std::pair<size_t, size_t>) + 4 * sizeof(void*));
+    usage.slack += (staged_nodes_.capacity() - staged_nodes_.size()) * sizeof(NData) +
+        (staged_edges_.capacity() - staged_edges_.size()) * sizeof(StagedEdge);
+    if (HeapUsage<NData>::owns_heap) {
+        for (const NData& data : staged_nodes_) {
+            usage.node_data_heap += HeapUsage<NData>::of(data);
+        }
+    }
+    if (HeapUsage<EData>::owns_heap) {
+        for (const StagedEdge& staged : staged_edges_) {
+            usage.edge_data_heap += HeapUsage<EData>::of(staged.data);
+        }
+    }
+    usage.results += cache_.memory_usage();
+    return usage;
+}
+
+template <typename NData, typename EData>
+uint64_t Graph<NData, EData>::version() const {
+    return version_;
+}
+
+template <typename NData, typename EData>
+void Graph<NData, EData>::mark_changed() {
+    ++version_;
+}
+
+template <typename NData, typename EData>
+template <typename Result, typename Compute, typename... Parameters>
+std::shared_ptr<const Result> Graph<NData, EData>::cached(const std::string& algorithm,
+        Compute compute, const Parameters&... parameters) const {
+    return cache_.template get<Result>(version_, algorithm, std::move(compute), parameters...);
+}
+
+template <typename NData, typename EData>
+ResultCache& Graph<NData, EData>::result_cache() const {
+    return cache_;
+}
+
 template <typename NData, typename EData>
 void Graph<NData, EData>::print(std::ostream& os) const {
     if (!os.good()) throw InvalidStreamException::invalid_output_stream();
@@ -217,8 +632,9 @@ size_t  Graph<NData, EData>::parse_id(std::istringstream& iss, char delim) {
 // assumes node prefix was already consumed
 // also assumes correct format ($ID {$DATA})
 template <typename NData, typename EData>
-void Graph<NData, EData>::import_node(std::istringstream& iss) {
-    if (!iss.good()) return;
+bool Graph<NData, EData>::import_node(std::istringstream& iss,
+        ImportRecord<NData, EData>& record) {
+    if (!iss.good()) return false;
     iss.get(); // skip (
     size_t id = parse_id(iss, ' ');
     iss.get(); // skip {
@@ -226,14 +642,18 @@ void Graph<NData, EData>::import_node(std::istringstream& iss) {
     std::getline(iss, data_string, '}');
     NData data;
     std::istringstream(data_string) >> data;
-    nodes_.add(id, data);
+    record.is_edge = false;
+    record.id = id;
+    record.node_data = std::move(data);
+    return true;
 }
 
 // assumes edge prefix was already consumed
 // also assumes correct format ($SOURCE_ID)-[$EDGE_ID {$DATA}]->($TARGET_ID)
 template <typename NData, typename EData>
-void Graph<NData, EData>::import_edge(std::istringstream& iss) {
-    if (!iss.good()) return;
+bool Graph<NData, EData>::import_edge(std::istringstream& iss,
+        ImportRecord<NData, EData>& record) {
+    if (!iss.good()) return false;
     iss.get(); // skip (
     size_t source_id = parse_id(iss, ')');
     iss.get(); // skip -
@@ -249,32 +669,104 @@ void Graph<NData, EData>::import_edge(std::istringstream& iss) {
     iss.get(); // skip >
     iss.get(); // skip (
     size_t target_id = parse_id(iss, ')');
-    edges_.add(edge_id, source_id, target_id, data);
+    record.is_edge = true;
+    record.id = edge_id;
+    record.source = source_id;
+    record.target = target_id;
+    record.edge_data = std::move(data);
+    return true;
 }
 
 template <typename NData, typename EData>
-void Graph<NData, EData>::import_line(std::istringstream& iss) {
-    if (!iss.good()) return;
+bool Graph<NData, EData>::import_line(std::istringstream& iss,
+        ImportRecord<NData, EData>& record) {
+    if (!iss.good()) return false;
     const std::string node_prefix = "node";
     const std::string edge_prefix = "edge";
     const char prefix_delim = ' ';
     std::string prefix;
     std::getline(iss, prefix, prefix_delim);
     if (prefix == node_prefix) {
-        import_node(iss);
+        return import_node(iss, record);
     } else if (prefix == edge_prefix) {
-        import_edge(iss);
+        return import_edge(iss, record);
     }
     // else do nothing
+    return false;
+}
+
+template <typename NData, typename EData>
+bool Graph<NData, EData>::parse_record(const std::string& line,
+        ImportRecord<NData, EData>& record) {
+    std::istringstream iss(line);
+    return import_line(iss, record);
+}
+
+template <typename NData, typename EData>
+bool Graph<NData, EData>::read_batch(std::istream& is,
+        std::vector<ImportRecord<NData, EData>>& batch, size_t batch_size) {
+    batch.clear();
+    std::string line;
+    ImportRecord<NData, EData> record;
+    while (batch.size() < batch_size && std::getline(is, line)) {
+        if (parse_record(line, record)) batch.push_back(std::move(record));
+    }
+    return !batch.empty();
+}
+
+#ifdef GRAPH_COROUTINES
+template <typename NData, typename EData>
+Generator<std::vector<ImportRecord<NData, EData>>> Graph<NData, EData>::import_batches(
+        std::istream& is, size_t batch_size) {
+    std::vector<ImportRecord<NData, EData>> batch;
+    while (read_batch(is, batch, batch_size)) {
+        co_yield batch;
+    }
+}
+#endif
+
+template <typename NData, typename EData>
+void Graph<NData, EData>::apply(const ImportRecord<NData, EData>& record) {
+    if (record.is_edge) edges_.add(record.id, record.source, record.target, record.edge_data);
+    else nodes_.add(record.id, record.node_data);
+}
+
+template <typename NData, typename EData>
+void Graph<NData, EData>::apply(ImportRecord<NData, EData>&& record) {
+    if (record.is_edge)
+        edges_.emplace(record.id, record.source, record.target, std::move(record.edge_data));
+    else nodes_.emplace(record.id, std::move(record.node_data));
 }
 
 template <typename NData, typename EData>
 void Graph<NData, EData>::import(std::istream& is) {
     if (!is.good()) throw InvalidStreamException::invalid_input_stream();
     std::string line;
-    while (std::getline(is, line)) {
-        std::istringstream iss(line);
-        import_line(iss);
+    ImportRecord<NData, EData> record;
+    // the edges go into the secondary indexes at once, after the last of them is imported
+    size_t first = edges_.size();
+    edges_.defer_indexing_(true);
+    try {
+        while (std::getline(is, line)) {
+            if (parse_record(line, record)) apply(std::move(record));
+        }
+    }
+    catch (...) {
+        // the edges imported before the failure stay, so the indexes take them too
+        try {
+            edges_.index_from_(first, ThreadPool::global());
+        }
+        catch (...) {
+            edges_.clear_indexes_();
+        }
+        throw;
+    }
+    try {
+        edges_.index_from_(first, ThreadPool::global());
+    }
+    catch (...) {
+        edges_.clear_indexes_();
+        throw;
     }
 }
 
@@ -288,38 +780,47 @@ void Graph<NData, EData>::import(const std::string& filename) {
 
 template <typename NData, typename EData>
 Graph<NData, EData>::Graph(const Graph<NData, EData>& other)
-     : nodes_(other.nodes_, this), edges_(other.edges_, this) {} 
+     : nodes_(other.nodes_, this), edges_(other.edges_, this), version_(other.version_),
+     batching_(false) {} 
 
 
 template <typename NData, typename EData>
 UndirectedGraph<NData, EData>::UndirectedGraph(const UndirectedGraph<NData, EData>& other)
      : Graph<NData, EData>(other) {
-    // we can't just copy the adjacency matrix, because the pointers would still point to other
-    // we also can't construct it inside Graph's constructor, because we can't yet call
-    // is_undirected() inside the parent constructor
-    Graph<NData, EData>::edges().construct_adjacency_matrix();
+    // the adjacency rows are shared with other, they hold edge ids so they stay right
 }
 
 template <typename NData, typename EData>
 DirectedGraph<NData, EData>::DirectedGraph(const DirectedGraph<NData, EData>& other)
     : Graph<NData, EData>(other) {
-    // we can't just copy the adjacency matrix, because the pointers would still point to other
-    // we also can't construct it inside Graph's constructor, because we can't yet call
-    // is_undirected() inside the parent constructor
-    Graph<NData, EData>::edges().construct_adjacency_matrix();
+    // the adjacency rows are shared with other, they hold edge ids so they stay right
 }
 
 
 template <typename NData, typename EData>
-Graph<NData, EData>::Graph(Graph<NData, EData>&& other) noexcept : nodes_(this), edges_(this) {
+Graph<NData, EData>::Graph(Graph<NData, EData>&& other) noexcept
+    : nodes_(this), edges_(this), version_(0), batching_(false) {
     std::swap(nodes_, other.nodes_);
     std::swap(edges_, other.edges_);
+    std::swap(partitions_, other.partitions_);
+    std::swap(version_, other.version_);
+    cache_.swap(other.cache_);
+    std::swap(batching_, other.batching_);
+    std::swap(staged_nodes_, other.staged_nodes_);
+    std::swap(staged_edges_, other.staged_edges_);
+    std::swap(staged_pairs_, other.staged_pairs_);
 }
 
 template <typename NData, typename EData>
 Graph<NData, EData>& Graph<NData, EData>::operator=(const Graph<NData, EData>& other) {
     nodes_ = other.nodes_;
     edges_ = other.edges_;
+    partitions_.clear();
+    // the version only ever grows, so no result cached before can be taken for the new contents
+    version_ = std::max(version_, other.version_) + 1;
+    cache_.clear();
+    // the staged ids were handed out for the old contents
+    discard_batch_();
     return *this;
 }
 
@@ -328,6 +829,13 @@ Graph<NData, EData>& Graph<NData, EData>::operator=(Graph<NData, EData>&& other)
     if (this != &other) {
         std::swap(nodes_, other.nodes_);
         std::swap(edges_, other.edges_);
+        std::swap(partitions_, other.partitions_);
+        std::swap(version_, other.version_);
+        cache_.swap(other.cache_);
+        std::swap(batching_, other.batching_);
+        std::swap(staged_nodes_, other.staged_nodes_);
+        std::swap(staged_edges_, other.staged_edges_);
+        std::swap(staged_pairs_, other.staged_pairs_);
     }
     return *this;
 }
@@ -0,0 +1,162 @@
+#ifndef __GRAPH_SNAPSHOT_H
+#define __GRAPH_SNAPSHOT_H
+
+#include "Adjacency.h"
+#include "Array.h"
+#include "Exceptions.h"
+#include "Graph.h"
+
+
+/// @file GraphSnapshot.h
+/// @brief Contains the GraphSnapshot class and its member function definitions
+
+
+// forward declaration
+template <typename NData, typename EData>
+class Graph;
+
+/// @brief A read-only view of a graph as it was when the snapshot was taken. The nodes and
+///  edges are copied in parallel into blocks of the snapshot's own, see my_array::Array::freeze,
+///  so the elements of the graph never move and writes through references the graph handed out
+///  never show in the snapshot; the rows of the adjacency are shared, the graph copies a shared
+///  row the first time it writes to it. Taking a snapshot costs a copy of every node and edge
+///  and a pointer per adjacency row. The snapshot never changes and may be read from another
+///  thread while the graph is written to; it has to be taken on the thread writing the graph
+///  and it outlives the graph
+/// @tparam NData The data associated with the Graph's nodes
+/// @tparam EData The data associated with the Graph's edges
+template <typename NData, typename EData>
+class GraphSnapshot {
+public:
+    /// @brief Constructs a snapshot of the given graph as it is now
+    /// @param graph The graph to take the snapshot of
+    /// @exception UnavailableMemoryException If there isn't enough memory for the snapshot
+    explicit GraphSnapshot(const Graph<NData, EData>& graph);
+
+    /// @brief Returns the number of nodes at the time of the snapshot,
+    ///  also makes the snapshot an adjacency view
+    /// @return The number of nodes
+    size_t size() const;
+
+    /// @brief Returns the number of edges at the time of the snapshot
+    /// @return The number of edges
+    size_t edge_count() const;
+
+    /// @brief Tests the existence of an edge with a given source and target
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    /// @return True if the edge existed at the time of the snapshot, false if it did not
+    /// @exception NonexistingItemException If testing the existence of an edge between a source
+    ///  and or target node that did not exist at the time of the snapshot
+    bool exists(size_t source, size_t target) const;
+
+    /// @brief Gets the node with the given id
+    /// @param id The id of the node to get
+    /// @return A const reference to the node as it was at the time of the snapshot
+    /// @exception NonexistingItemException If no node with the given id existed at the time of
+    ///  the snapshot
+    const Node<NData>& node(size_t id) const;
+
+    /// @brief Gets the edge with the given id
+    /// @param id The id of the edge to get
+    /// @return A const reference to the edge as it was at the time of the snapshot
+    /// @exception NonexistingItemException If no edge with the given id existed at the time of
+    ///  the snapshot
+    const Edge<NData, EData>& edge(size_t id) const;
+
+    /// @brief Gets the edge with a given source and target
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    /// @return A const reference to the edge as it was at the time of the snapshot
+    /// @exception NonexistingItemException If the source and or target nodes or the edge between
+    ///  them did not exist at the time of the snapshot
+    const Edge<NData, EData>& edge(size_t source, size_t target) const;
+
+    /// @brief Calls the given function for the target of every edge outgoing from the given
+    ///  source that existed at the time of the snapshot, in the order of increasing target ids
+    /// @tparam Function A callable taking the id of the target node
+    /// @param source The id of the source node
+    /// @param function The function to call
+    /// @exception NonexistingItemException If the source node did not exist at the time of
+    ///  the snapshot
+    template <typename Function>
+    void for_each_neighbor(size_t source, Function function) const;
+
+private:
+    /// @brief The copy of the nodes
+    typename my_array::Array<Node<NData>>::frozen nodes_;
+
+    /// @brief The copy of the edges
+    typename my_array::Array<Edge<NData, EData>>::frozen edges_;
+
+    /// @brief The adjacency at the time of the snapshot, sharing its rows with the graph
+    Adjacency adjacency_;
+};
+
+template <typename NData, typename EData>
+GraphSnapshot<NData, EData>::GraphSnapshot(const Graph<NData, EData>& graph)
+    : nodes_(graph.nodes().nodes_.freeze()), edges_(graph.edges().edges_.freeze()) {
+    try {
+        adjacency_ = graph.edges().adjacency();
+    }
+    catch (std::bad_alloc& e) {
+        (void)e;
+        throw UnavailableMemoryException::adjacency_matrix_unable_to_insert();
+    }
+}
+
+template <typename NData, typename EData>
+size_t GraphSnapshot<NData, EData>::size() const {
+    return nodes_.size();
+}
+
+template <typename NData, typename EData>
+size_t GraphSnapshot<NData, EData>::edge_count() const {
+    return edges_.size();
+}
+
+template <typename NData, typename EData>
+bool GraphSnapshot<NData, EData>::exists(size_t source, size_t target) const {
+    if (source >= size() || target >= size())
+        throw NonexistingItemException::testing_existence_of_edge_with_nonexistant_nodes(source,
+            target, size());
+    return adjacency_.find(source, target) != Adjacency::NONE;
+}
+
+template <typename NData, typename EData>
+const Node<NData>& GraphSnapshot<NData, EData>::node(size_t id) const {
+    if (id >= size())
+        throw NonexistingItemException::accessing_nonexistant_node(id, size());
+    return nodes_[id];
+}
+
+template <typename NData, typename EData>
+const Edge<NData, EData>& GraphSnapshot<NData, EData>::edge(size_t id) const {
+    if (id >= edge_count())
+        throw NonexistingItemException::accessing_nonexistant_edge_with_identifier(id,
+            edge_count());
+    return edges_[id];
+}
+
+template <typename NData, typename EData>
+const Edge<NData, EData>& GraphSnapshot<NData, EData>::edge(size_t source, size_t target) const {
+    if (source >= size() || target >= size())
+        throw NonexistingItemException::accessing_edge_with_nonexistant_nodes
+        (source, target, size());
+    size_t edge = adjacency_.find(source, target);
+    if (edge == Adjacency::NONE)
+        throw NonexistingItemException::accessing_nonexistant_edge_with_source_target
+        (source, target);
+    return edges_[edge];
+}
+
+template <typename NData, typename EData>
+template <typename Function>
+void GraphSnapshot<NData, EData>::for_each_neighbor(size_t source, Function function) const {
+    if (source >= size())
+        throw NonexistingItemException::accessing_edge_nonexistant_source(source, size());
+    adjacency_.for_each_neighbor(source, [&](size_t target, size_t) { function(target); });
+}
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,370 @@
+#ifndef __INTERNED_STRING_H
+#define __INTERNED_STRING_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ConcurrentArray.h"
+#include "Exceptions.h"
+
+
+/// @file InternedString.h
+/// @brief Contains the StringPool interning strings into arenas, the InternedString handle
+///  usable as node or edge data, and their member function definitions
+
+
+/// @brief A concurrent table of distinct strings; every string is stored once inside an arena
+///  and identified by a 4-byte id. Interning locks only one of the shards of the table, looking
+///  up the characters of an id never locks. Strings are never removed
+class StringPool {
+public:
+    /// @brief The id of the empty string
+    static const uint32_t EMPTY = 0;
+
+    /// @brief The number of independently locked shards of the table
+    static const size_t SHARDS = 64;
+
+    /// @brief The size of the arena chunks the characters are stored in, longer strings get
+    ///  their own chunk
+    static const size_t ARENA_CHUNK_SIZE = 64 * 1024;
+
+    /// @brief Constructs a pool holding only the empty string
+    StringPool();
+
+    StringPool(const StringPool& other) = delete;
+    StringPool& operator=(const StringPool& other) = delete;
+
+    /// @brief Interns a string, any number of threads may be interning at a time
+    /// @param data The characters of the string
+    /// @param length The number of characters
+    /// @return The id of the string, the same for equal strings
+    /// @exception UnavailableMemoryException If there isn't enough memory or all ids are taken
+    uint32_t intern(const char* data, size_t length);
+
+    /// @brief Interns a string, any number of threads may be interning at a time
+    /// @param string The string
+    /// @return The id of the string, the same for equal strings
+    /// @exception UnavailableMemoryException If there isn't enough memory or all ids are taken
+    uint32_t intern(const std::string& string);
+
+    /// @brief Get the characters of an interned string, null terminated
+    /// @param id The id of the string, returned by intern
+    /// @return The characters, valid as long as the pool
+    const char* data(uint32_t id) const;
+
+    /// @brief Get the length of an interned string
+    /// @param id The id of the string, returned by intern
+    /// @return The number of characters
+    size_t length(uint32_t id) const;
+
+    /// @brief Get the number of distinct strings
+    /// @return The number of distinct strings, the empty string included
+    size_t size() const;
+
+    /// @brief Get the pool shared by all InternedStrings
+    /// @return The pool
+    static StringPool& global();
+
+private:
+    /// @brief The characters of an interned string
+    struct Entry {
+        /// @brief The characters, null terminated
+        const char* data;
+
+        /// @brief The number of characters
+        size_t length;
+    };
+
+    /// @brief The key of the table, points either into the arena or to a string being looked up
+    struct Key {
+        /// @brief The characters
+        const char* data;
+
+        /// @brief The number of characters
+        size_t length;
+
+        /// @brief The hash of the characters
+        uint64_t hash;
+    };
+
+    /// @brief Returns the hash computed once for the key
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    /// @brief Compares the characters of two keys
+    struct KeyEqual {
+        bool operator()(const Key& first, const Key& second) const;
+    };
+
+    /// @brief A part of the table with its own lock and arena
+    struct Shard {
+        /// @brief Constructs an empty shard
+        Shard();
+
+        /// @brief Guards the shard
+        std::mutex mutex;
+
+        /// @brief The ids of the strings of the shard
+        std::unordered_map<Key, uint32_t, KeyHash, KeyEqual> ids;
+
+        /// @brief The chunks of the arena
+        std::vector<std::unique_ptr<char[]>> chunks;
+
+        /// @brief The first free character of the last chunk
+        char* cursor;
+
+        /// @brief The number of free characters of the last chunk
+        size_t left;
+    };
+
+    /// @brief Hashes the characters of a string, FNV-1a
+    /// @param data The characters
+    /// @param length The number of characters
+    /// @return The hash
+    static uint64_t hash_(const char* data, size_t length);
+
+    /// @brief Copies the characters of a string into the arena of a shard, null terminated
+    /// @param shard The shard, locked by the caller
+    /// @param data The characters
+    /// @param length The number of characters
+    /// @return The copied characters
+    /// @exception std::bad_alloc If a chunk cannot be allocated
+    static const char* store_(Shard& shard, const char* data, size_t length);
+
+    /// @brief The shards of the table
+    Shard shards_[SHARDS];
+
+    /// @brief The characters of every id
+    my_array::ConcurrentArray<Entry> entries_;
+};
+
+/// @brief A 4-byte handle of a string interned in the global StringPool; equal strings have equal
+///  handles, so comparing them for equality is a single integer compare. Reads and prints like a
+///  std::string, so it can replace it as the node or edge data of a graph
+class InternedString {
+public:
+    /// @brief Constructs the empty string
+    InternedString();
+
+    /// @brief Interns the given string
+    /// @param string The string
+    /// @exception UnavailableMemoryException If the string cannot be interned
+    InternedString(const std::string& string);
+
+    /// @brief Interns the given string
+    /// @param string The null terminated string
+    /// @exception UnavailableMemoryException If the string cannot be interned
+    InternedString(const char* string);
+
+    /// @brief Get the id of the string inside the global pool
+    /// @return The id
+    uint32_t id() const;
+
+    /// @brief Get the characters of the string
+    /// @return The null terminated characters, valid for the lifetime of the program
+    const char* c_str() const;
+
+    /// @brief Get the length of the string
+    /// @return The number of characters
+    size_t size() const;
+
+    /// @brief Tests if the string is empty
+    /// @return True if the string is empty
+    bool empty() const;
+
+    /// @brief Copies the string out of the pool
+    /// @return The string
+    std::string str() const;
+
+    /// @brief Compares two strings, a single integer compare
+    /// @param other The other string
+    /// @return True if the strings are equal
+    bool operator==(const InternedString& other) const;
+
+    /// @brief Compares two strings, a single integer compare
+    /// @param other The other string
+    /// @return True if the strings differ
+    bool operator!=(const InternedString& other) const;
+
+    /// @brief Compares two strings lexicographically like std::string
+    /// @param other The other string
+    /// @return True if this string comes first
+    bool operator<(const InternedString& other) const;
+
+private:
+    /// @brief The id inside the global pool
+    uint32_t id_;
+};
+
+/// @brief Prints the characters of an interned string to the given output stream
+/// @param os The output stream
+/// @param string The interned string
+/// @return The output stream
+std::ostream& operator<<(std::ostream& os, const InternedString& string);
+
+/// @brief Reads a whitespace delimited word like for a std::string and interns it
+/// @param is The input stream
+/// @param string The interned string to read into
+/// @return The input stream
+std::istream& operator>>(std::istream& is, InternedString& string);
+
+namespace std {
+    /// @brief Hashes an interned string by its id
+    template <>
+    struct hash<InternedString> {
+        size_t operator()(const InternedString& string) const {
+            return std::hash<uint32_t>()(string.id());
+        }
+    };
+}
+
+inline size_t StringPool::KeyHash::operator()(const Key& key) const {
+    return static_cast<size_t>(key.hash);
+}
+
+inline bool StringPool::KeyEqual::operator()(const Key& first, const Key& second) const {
+    return first.length == second.length && std::memcmp(first.data, second.data, first.length) == 0;
+}
+
+inline StringPool::Shard::Shard() : cursor(nullptr), left(0) {}
+
+inline StringPool::StringPool() {
+    intern("", 0);
+}
+
+inline uint64_t StringPool::hash_(const char* data, size_t length) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+inline const char* StringPool::store_(Shard& shard, const char* data, size_t length) {
+    char* stored;
+    if (length + 1 > ARENA_CHUNK_SIZE / 4) {
+        // a long string would waste most of a shared chunk
+        shard.chunks.emplace_back(new char[length + 1]);
+        stored = shard.chunks.back().get();
+    }
+    else {
+        if (shard.left < length + 1) {
+            shard.chunks.emplace_back(new char[ARENA_CHUNK_SIZE]);
+            shard.cursor = shard.chunks.back().get();
+            shard.left = ARENA_CHUNK_SIZE;
+        }
+        stored = shard.cursor;
+        shard.cursor += length + 1;
+        shard.left -= length + 1;
+    }
+    std::memcpy(stored, data, length);
+    stored[length] = '\0';
+    return stored;
+}
+
+inline uint32_t StringPool::intern(const char* data, size_t length) {
+    Key key = { data, length, hash_(data, length) };
+    // the top bits pick the shard, the table uses the low ones
+    Shard& shard = shards_[key.hash >> 58 & (SHARDS - 1)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.ids.find(key);
+    if (found != shard.ids.end()) return found->second;
+    try {
+        if (entries_.size() >= UINT32_MAX) throw std::bad_alloc();
+        key.data = store_(shard, data, length);
+        uint32_t id = static_cast<uint32_t>(entries_.append({ key.data, length }));
+        shard.ids.emplace(key, id);
+        return id;
+    }
+    catch (const std::bad_alloc&) {
+        // at worst the copied characters stay unused in the arena
+        throw UnavailableMemoryException::string_pool_unable_to_insert();
+    }
+}
+
+inline uint32_t StringPool::intern(const std::string& string) {
+    return intern(string.data(), string.size());
+}
+
+inline const char* StringPool::data(uint32_t id) const {
+    return entries_[id].data;
+}
+
+inline size_t StringPool::length(uint32_t id) const {
+    return entries_[id].length;
+}
+
+inline size_t StringPool::size() const {
+    return entries_.size();
+}
+
+inline StringPool& StringPool::global() {
+    static StringPool pool;
+    return pool;
+}
+
+inline InternedString::InternedString() : id_(StringPool::EMPTY) {}
+
+inline InternedString::InternedString(const std::string& string)
+    : id_(StringPool::global().intern(string)) {}
+
+inline InternedString::InternedString(const char* string)
+    : id_(StringPool::global().intern(string, std::strlen(string))) {}
+
+inline uint32_t InternedString::id() const {
+    return id_;
+}
+
+inline const char* InternedString::c_str() const {
+    return StringPool::global().data(id_);
+}
+
+inline size_t InternedString::size() const {
+    return StringPool::global().length(id_);
+}
+
+inline bool InternedString::empty() const {
+    return id_ == StringPool::EMPTY;
+}
+
+inline std::string InternedString::str() const {
+    return std::string(c_str(), size());
+}
+
+inline bool InternedString::operator==(const InternedString& other) const {
+    return id_ == other.id_;
+}
+
+inline bool InternedString::operator!=(const InternedString& other) const {
+    return id_ != other.id_;
+}
+
+inline bool InternedString::operator<(const InternedString& other) const {
+    if (id_ == other.id_) return false;
+    size_t length = size();
+    size_t other_length = other.size();
+    int compared = std::memcmp(c_str(), other.c_str(), std::min(length, other_length));
+    return compared < 0 || (compared == 0 && length < other_length);
+}
+
+inline std::ostream& operator<<(std::ostream& os, const InternedString& string) {
+    return os.write(string.c_str(), static_cast<std::streamsize>(string.size()));
+}
+
+inline std::istream& operator>>(std::istream& is, InternedString& string) {
+    std::string word;
+    if (is >> word) string = InternedString(word);
+    return is;
+}
+
+
+#endif
\ No newline at end of file
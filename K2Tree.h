@@ -0,0 +1,331 @@
+#ifndef __K2_TREE_H
+#define __K2_TREE_H
+
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include "Exceptions.h"
+#include "BitVector.h"
+#include "Graph.h"
+
+
+/// @file K2Tree.h
+/// @brief Contains the read-only K2Tree compressed adjacency and its member function definitions
+
+
+/// @brief A read-only compressed adjacency of a graph, recursively splits the adjacency matrix
+///  into K*K submatrices and stores one bit per submatrix telling if it contains any edge,
+///  only the nonempty submatrices are split further
+/// @tparam K The number of parts every side of a submatrix is split into
+template <size_t K = 2>
+class K2Tree {
+public:
+    /// @brief Constructs an empty k2-tree with no nodes
+    K2Tree();
+
+    /// @brief Constructs a k2-tree over the given number of nodes with the given entries
+    /// @param nodes The number of nodes
+    /// @param entries The pairs of source and target ids, each has to be less than nodes
+    /// @exception NonexistingItemException If an entry refers to a node that does not exist
+    K2Tree(size_t nodes, std::vector<std::pair<size_t, size_t>> entries);
+
+    /// @brief Constructs a k2-tree from the adjacency of the given edges
+    /// @tparam NData The data associated with the Graph's nodes
+    /// @tparam EData The data associated with the Graph's edges
+    /// @param edges The edges to construct the k2-tree from
+    template <typename NData, typename EData>
+    explicit K2Tree(const Edges<NData, EData>& edges);
+
+    /// @brief Get the number of nodes
+    /// @return The number of nodes
+    size_t size() const;
+
+    /// @brief Get the number of entries, each undirected edge counts as two
+    /// @return The number of entries
+    size_t entry_count() const;
+
+    /// @brief Tests the existence of an edge with a given source and target
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    /// @return True if the edge exists, false if it does not
+    /// @exception NonexistingItemException If testing the existence of an edge between a source
+    ///  and or target node that does not exist
+    bool exists(size_t source, size_t target) const;
+
+    /// @brief Get the targets of all edges outgoing from the given source
+    /// @param source The id of the source node
+    /// @return The ids of the target nodes in increasing order
+    /// @exception NonexistingItemException If the source node does not exist
+    std::vector<size_t> neighbors(size_t source) const;
+
+    /// @brief Get the sources of all edges incoming to the given target
+    /// @param target The id of the target node
+    /// @return The ids of the source nodes in increasing order
+    /// @exception NonexistingItemException If the target node does not exist
+    std::vector<size_t> reverse_neighbors(size_t target) const;
+
+    /// @brief Calls the given function for the target of every edge outgoing from the given
+    ///  source, in the order of increasing target ids
+    /// @tparam Function A callable taking the id of the target node
+    /// @param source The id of the source node
+    /// @param function The function to call
+    /// @exception NonexistingItemException If the source node does not exist
+    template <typename Function>
+    void for_each_neighbor(size_t source, Function function) const;
+
+    /// @brief Calls the given function for the source of every edge incoming to the given
+    ///  target, in the order of increasing source ids
+    /// @tparam Function A callable taking the id of the source node
+    /// @param target The id of the target node
+    /// @param function The function to call
+    /// @exception NonexistingItemException If the target node does not exist
+    template <typename Function>
+    void for_each_reverse_neighbor(size_t target, Function function) const;
+
+    /// @brief Get the number of bytes used by the k2-tree
+    /// @return The number of bytes
+    size_t memory_usage() const;
+
+private:
+    /// @brief Marks the position of the implicit root, which has no bit of its own
+    static const size_t ROOT = SIZE_MAX;
+
+    /// @brief Builds the bit vectors from the given entries
+    /// @param entries The pairs of source and target ids
+    void build_(std::vector<std::pair<size_t, size_t>>& entries);
+
+    /// @brief Appends the bits of the children of a nonempty submatrix to the levels and
+    ///  recurses into the nonempty children
+    /// @param levels The bits of every level of the tree
+    /// @param depth The depth of the children of the submatrix
+    /// @param first The first entry inside the submatrix
+    /// @param last The position after the last entry inside the submatrix
+    /// @param row The first row of the submatrix
+    /// @param column The first column of the submatrix
+    /// @param side The side of the submatrix
+    void build_level_(std::vector<std::vector<bool>>& levels, size_t depth,
+        std::vector<std::pair<size_t, size_t>>::iterator first,
+        std::vector<std::pair<size_t, size_t>>::iterator last,
+        size_t row, size_t column, size_t side);
+
+    /// @brief Get the position of the first child of the node at the given position
+    /// @param position The position of the node, ROOT for the root
+    /// @return The position of its first child
+    size_t first_child_(size_t position) const;
+
+    /// @brief Tests if the bit at the given position inside the tree and leaves is set
+    /// @param position The position
+    /// @return True if the bit is set
+    bool bit_(size_t position) const;
+
+    /// @brief Recursively reports the columns of a row inside a submatrix
+    /// @tparam Function A callable taking the id of the target node
+    /// @param side The side of the submatrix
+    /// @param row The row relative to the submatrix
+    /// @param column The first column of the submatrix
+    /// @param position The position of the submatrix, ROOT for the whole matrix
+    /// @param function The function to call
+    template <typename Function>
+    void direct_(size_t side, size_t row, size_t column, size_t position,
+        Function& function) const;
+
+    /// @brief Recursively reports the rows of a column inside a submatrix
+    /// @tparam Function A callable taking the id of the source node
+    /// @param side The side of the submatrix
+    /// @param column The column relative to the submatrix
+    /// @param row The first row of the submatrix
+    /// @param position The position of the submatrix, ROOT for the whole matrix
+    /// @param function The function to call
+    template <typename Function>
+    void reverse_(size_t side, size_t column, size_t row, size_t position,
+        Function& function) const;
+
+    /// @brief The bits of all levels but the last, with a rank directory
+    BitVector tree_;
+
+    /// @brief The bits of the last level, each stands for a single cell of the matrix
+    BitVector leaves_;
+
+    /// @brief The number of nodes
+    size_t size_;
+
+    /// @brief The side of the whole matrix, the lowest power of K not less than size_
+    size_t side_;
+
+    /// @brief The number of entries
+    size_t entry_count_;
+};
+
+template <size_t K>
+K2Tree<K>::K2Tree() : size_(0), side_(K), entry_count_(0) {
+    std::vector<std::pair<size_t, size_t>> entries;
+    build_(entries);
+}
+
+template <size_t K>
+K2Tree<K>::K2Tree(size_t nodes, std::vector<std::pair<size_t, size_t>> entries)
+        : size_(nodes), side_(K), entry_count_(entries.size()) {
+    for (const auto& entry : entries) {
+        if (entry.first >= nodes || entry.second >= nodes)
+            throw NonexistingItemException::accessing_edge_with_nonexistant_nodes
+            (entry.first, entry.second, nodes);
+    }
+    while (side_ < size_) side_ *= K;
+    build_(entries);
+}
+
+template <size_t K>
+template <typename NData, typename EData>
+K2Tree<K>::K2Tree(const Edges<NData, EData>& edges)
+    : K2Tree(edges.adjacency().size(), edges.adjacency().entries()) {}
+
+template <size_t K>
+void K2Tree<K>::build_(std::vector<std::pair<size_t, size_t>>& entries) {
+    size_t height = 1;
+    for (size_t side = K; side < side_; side *= K) ++height;
+    std::vector<std::vector<bool>> levels(height);
+    build_level_(levels, 0, entries.begin(), entries.end(), 0, 0, side_);
+    for (size_t depth = 0; depth + 1 < height; depth++) {
+        for (bool bit : levels[depth]) tree_.push_back(bit);
+    }
+    for (bool bit : levels[height - 1]) leaves_.push_back(bit);
+    tree_.build_rank();
+}
+
+template <size_t K>
+void K2Tree<K>::build_level_(std::vector<std::vector<bool>>& levels, size_t depth,
+        std::vector<std::pair<size_t, size_t>>::iterator first,
+        std::vector<std::pair<size_t, size_t>>::iterator last,
+        size_t row, size_t column, size_t side) {
+    size_t child_side = side / K;
+    auto child_of = [&](const std::pair<size_t, size_t>& entry) {
+        return ((entry.first - row) / child_side) * K + (entry.second - column) / child_side;
+    };
+    std::sort(first, last, [&](const std::pair<size_t, size_t>& a,
+        const std::pair<size_t, size_t>& b) {
+            return child_of(a) < child_of(b);
+        });
+    // the bits of all children are appended before recursing, so every level stays in the
+    // left to right order of its parents
+    std::vector<std::pair<size_t, size_t>>::iterator bounds[K * K + 1];
+    auto current = first;
+    for (size_t child = 0; child < K * K; child++) {
+        bounds[child] = current;
+        while (current != last && child_of(*current) == child) ++current;
+        levels[depth].push_back(current != bounds[child]);
+    }
+    bounds[K * K] = last;
+    if (child_side == 1) return;
+    for (size_t child = 0; child < K * K; child++) {
+        if (bounds[child] == bounds[child + 1]) continue;
+        build_level_(levels, depth + 1, bounds[child], bounds[child + 1],
+            row + (child / K) * child_side, column + (child % K) * child_side, child_side);
+    }
+}
+
+template <size_t K>
+size_t K2Tree<K>::size() const {
+    return size_;
+}
+
+template <size_t K>
+size_t K2Tree<K>::entry_count() const {
+    return entry_count_;
+}
+
+template <size_t K>
+size_t K2Tree<K>::first_child_(size_t position) const {
+    if (position == ROOT) return 0;
+    return tree_.rank1(position + 1) * K * K;
+}
+
+template <size_t K>
+bool K2Tree<K>::bit_(size_t position) const {
+    if (position < tree_.size()) return tree_[position];
+    return leaves_[position - tree_.size()];
+}
+
+template <size_t K>
+bool K2Tree<K>::exists(size_t source, size_t target) const {
+    if (source >= size_ || target >= size_)
+        throw NonexistingItemException::testing_existence_of_edge_with_nonexistant_nodes(source,
+            target, size_);
+    size_t position = ROOT;
+    for (size_t side = side_ / K; side > 0; side /= K) {
+        position = first_child_(position) + (source / side) * K + target / side;
+        if (!bit_(position)) return false;
+        source %= side;
+        target %= side;
+    }
+    return true;
+}
+
+template <size_t K>
+template <typename Function>
+void K2Tree<K>::direct_(size_t side, size_t row, size_t column, size_t position,
+        Function& function) const {
+    if (position != ROOT && position >= tree_.size()) {
+        if (leaves_[position - tree_.size()]) function(column);
+        return;
+    }
+    if (position != ROOT && !tree_[position]) return;
+    size_t child_side = side / K;
+    size_t first = first_child_(position) + (row / child_side) * K;
+    for (size_t j = 0; j < K; j++) {
+        direct_(child_side, row % child_side, column + child_side * j, first + j, function);
+    }
+}
+
+template <size_t K>
+template <typename Function>
+void K2Tree<K>::reverse_(size_t side, size_t column, size_t row, size_t position,
+        Function& function) const {
+    if (position != ROOT && position >= tree_.size()) {
+        if (leaves_[position - tree_.size()]) function(row);
+        return;
+    }
+    if (position != ROOT && !tree_[position]) return;
+    size_t child_side = side / K;
+    size_t first = first_child_(position) + column / child_side;
+    for (size_t j = 0; j < K; j++) {
+        reverse_(child_side, column % child_side, row + child_side * j, first + j * K, function);
+    }
+}
+
+template <size_t K>
+template <typename Function>
+void K2Tree<K>::for_each_neighbor(size_t source, Function function) const {
+    if (source >= size_)
+        throw NonexistingItemException::accessing_edge_nonexistant_source(source, size_);
+    direct_(side_, source, 0, ROOT, function);
+}
+
+template <size_t K>
+template <typename Function>
+void K2Tree<K>::for_each_reverse_neighbor(size_t target, Function function) const {
+    if (target >= size_)
+        throw NonexistingItemException::accessing_edge_nonexistant_target(target, size_);
+    reverse_(side_, target, 0, ROOT, function);
+}
+
+template <size_t K>
+std::vector<size_t> K2Tree<K>::neighbors(size_t source) const {
+    std::vector<size_t> result;
+    for_each_neighbor(source, [&](size_t target) { result.push_back(target); });
+    return result;
+}
+
+template <size_t K>
+std::vector<size_t> K2Tree<K>::reverse_neighbors(size_t target) const {
+    std::vector<size_t> result;
+    for_each_reverse_neighbor(target, [&](size_t source) { result.push_back(source); });
+    return result;
+}
+
+template <size_t K>
+size_t K2Tree<K>::memory_usage() const {
+    return sizeof(*this) + tree_.memory_usage() + leaves_.memory_usage();
+}
+
+
+#endif
\ No newline at end of file
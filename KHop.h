@@ -0,0 +1,334 @@
+#ifndef __K_HOP_H
+#define __K_HOP_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "Exceptions.h"
+#include "BitVector.h"
+#include "ThreadPool.h"
+
+
+/// @file KHop.h
+/// @brief Contains the KHop extractor of the nodes within k hops of seed nodes, the induced view
+///  of what it reached and their member function definitions; they work over any adjacency view,
+///  see AdjacencyView.h
+
+
+template <typename View>
+class KHop;
+
+/// @brief An adjacency view of the subgraph induced by the nodes a KHop reached: an edge is in it
+///  if both of its nodes were reached. Refers to the KHop, so it is valid until the KHop runs again
+/// @tparam View The adjacency view the KHop runs over
+template <typename View>
+class InducedView {
+public:
+    /// @brief Get the number of nodes of the underlying view, the nodes that were not reached
+    ///  have no edges
+    /// @return The number of nodes
+    size_t size() const;
+
+    /// @brief Tests if a node was reached
+    /// @param node The id of the node
+    /// @return True if the node is in the induced subgraph
+    bool contains(size_t node) const;
+
+    /// @brief Calls the given function for the target of every edge outgoing from the given
+    ///  source that has both nodes in the induced subgraph, in the order of increasing target ids
+    /// @tparam Function A callable taking the id of the target node
+    /// @param source The id of the source node
+    /// @param function The function to call
+    template <typename Function>
+    void for_each_neighbor(size_t source, Function function) const;
+
+private:
+    /// @brief Constructs the view of what a KHop reached
+    /// @param hop The KHop
+    explicit InducedView(const KHop<View>& hop);
+
+    /// @brief The KHop whose reached nodes induce the subgraph
+    const KHop<View>& hop_;
+
+    friend KHop<View>;
+};
+
+/// @brief Extracts the nodes within k hops of seed nodes, following the edges forward. A node is
+///  deduplicated across hops by a bit per node of the view; each hop is kept as a sparse list of
+///  the nodes first reached by it, put into id order by sorting while it is small and through a
+///  bitset of the whole view once sorting would cost more than scanning the bitset, so a large
+///  frontier is then expanded in id order. Holds its buffers between runs, so running one KHop
+///  for many seeds only clears what the previous run touched. Not thread safe, use one per thread
+///  or k_hop_batch
+/// @tparam View The adjacency view, see AdjacencyView.h
+template <typename View>
+class KHop {
+public:
+    /// @brief Constructs the extractor over a view, the view has to outlive it
+    /// @param view The adjacency view
+    explicit KHop(const View& view);
+
+    /// @brief Extracts the nodes within k hops of a single seed, replacing the previous result
+    /// @param seed The id of the seed node
+    /// @param k The number of hops
+    /// @exception NonexistingItemException If the seed does not exist
+    void run(size_t seed, size_t k);
+
+    /// @brief Extracts the nodes within k hops of any of the seeds, replacing the previous result
+    /// @param seeds The ids of the seed nodes, duplicates are counted once
+    /// @param k The number of hops
+    /// @exception NonexistingItemException If a seed does not exist, the result is empty then
+    void run(const std::vector<size_t>& seeds, size_t k);
+
+    /// @brief Get the reached nodes of the last run grouped by hop, the seeds first; the nodes
+    ///  of a hop are in id order
+    /// @return The ids of the nodes
+    const std::vector<size_t>& nodes() const;
+
+    /// @brief Get the number of nodes first reached by every hop of the last run, the seeds
+    ///  being hop 0; ends early if no hop reached anything new
+    /// @return The counts by hop
+    const std::vector<size_t>& counts() const;
+
+    /// @brief Get the reached nodes of the last run in id order
+    /// @return The ids of the nodes
+    std::vector<size_t> sorted_nodes() const;
+
+    /// @brief Tests if the last run reached a node
+    /// @param node The id of the node
+    /// @return True if the node is within k hops of a seed
+    bool contains(size_t node) const;
+
+    /// @brief Get the subgraph induced by the nodes the last run reached
+    /// @return The view, valid until the next run
+    InducedView<View> induced() const;
+
+    /// @brief Get the adjacency view the extractor runs over
+    /// @return The view
+    const View& view() const;
+
+private:
+    /// @brief Clears the bits of the nodes the last run reached, word by word if they are many
+    void reset_();
+
+    /// @brief Puts the nodes of a hop into id order, through the frontier bitset if that is
+    ///  cheaper than sorting them
+    /// @param first The index of the first node of the hop inside nodes_
+    void order_(size_t first);
+
+    /// @brief Tests a bit of a bitset
+    /// @param bits The bitset
+    /// @param node The index of the bit
+    /// @return True if the bit is set
+    static bool test_(const std::vector<uint64_t>& bits, size_t node);
+
+    /// @brief Sets a bit of a bitset
+    /// @param bits The bitset
+    /// @param node The index of the bit
+    static void set_(std::vector<uint64_t>& bits, size_t node);
+
+    /// @brief The adjacency view
+    const View& view_;
+
+    /// @brief A bit per node of the view, set for the nodes reached by the last run
+    std::vector<uint64_t> visited_;
+
+    /// @brief A bit per node of the view, used for putting a large hop into id order
+    std::vector<uint64_t> frontier_;
+
+    /// @brief The reached nodes grouped by hop
+    std::vector<size_t> nodes_;
+
+    /// @brief The number of nodes reached by every hop
+    std::vector<size_t> counts_;
+};
+
+/// @brief Extracts the nodes within k hops of the given seeds
+/// @tparam View The adjacency view, see AdjacencyView.h
+/// @param view The adjacency view
+/// @param seeds The ids of the seed nodes
+/// @param k The number of hops
+/// @return The ids of the reached nodes in id order
+/// @exception NonexistingItemException If a seed does not exist
+template <typename View>
+std::vector<size_t> k_hop(const View& view, const std::vector<size_t>& seeds, size_t k);
+
+/// @brief Extracts the nodes within k hops of every seed separately, in parallel; a KHop is
+///  made per subrange of the seeds, so its buffers are reused for all the seeds of the subrange
+/// @tparam View The adjacency view, see AdjacencyView.h
+/// @tparam Function A callable taking the index of a seed and a const reference to the KHop
+///  that ran from it, called from many threads at once
+/// @param view The adjacency view
+/// @param seeds The ids of the seed nodes
+/// @param k The number of hops
+/// @param function The function to call
+/// @param pool The thread pool to run on
+/// @param grain The number of seeds below which a range is not split any further, 0 to choose it
+///  from the number of seeds and threads
+/// @exception NonexistingItemException If a seed does not exist
+/// @exception Any exception thrown by the function
+template <typename View, typename Function>
+void k_hop_batch(const View& view, const std::vector<size_t>& seeds, size_t k, Function function,
+    ThreadPool& pool = ThreadPool::global(), size_t grain = 0);
+
+template <typename View>
+InducedView<View>::InducedView(const KHop<View>& hop) : hop_(hop) {}
+
+template <typename View>
+size_t InducedView<View>::size() const {
+    return hop_.view().size();
+}
+
+template <typename View>
+bool InducedView<View>::contains(size_t node) const {
+    return hop_.contains(node);
+}
+
+template <typename View>
+template <typename Function>
+void InducedView<View>::for_each_neighbor(size_t source, Function function) const {
+    if (!hop_.contains(source)) return;
+    hop_.view().for_each_neighbor(source, [&](size_t target) {
+        if (hop_.contains(target)) function(target);
+    });
+}
+
+template <typename View>
+KHop<View>::KHop(const View& view)
+    : view_(view), visited_((view.size() + 63) / 64, 0), frontier_((view.size() + 63) / 64, 0) {}
+
+template <typename View>
+bool KHop<View>::test_(const std::vector<uint64_t>& bits, size_t node) {
+    return (bits[node / 64] >> (node % 64)) & 1;
+}
+
+template <typename View>
+void KHop<View>::set_(std::vector<uint64_t>& bits, size_t node) {
+    bits[node / 64] |= uint64_t(1) << (node % 64);
+}
+
+template <typename View>
+void KHop<View>::run(size_t seed, size_t k) {
+    run(std::vector<size_t>(1, seed), k);
+}
+
+template <typename View>
+void KHop<View>::run(const std::vector<size_t>& seeds, size_t k) {
+    reset_();
+    size_t size = view_.size();
+    for (size_t seed : seeds) {
+        if (seed >= size) {
+            reset_();
+            throw NonexistingItemException::accessing_nonexistant_node(seed, size);
+        }
+        if (test_(visited_, seed)) continue;
+        set_(visited_, seed);
+        nodes_.push_back(seed);
+    }
+    order_(0);
+    counts_.push_back(nodes_.size());
+    for (size_t hop = 1, first = 0; hop <= k; hop++) {
+        size_t last = nodes_.size();
+        if (first == last) break;
+        for (size_t i = first; i < last; i++) {
+            view_.for_each_neighbor(nodes_[i], [&](size_t target) {
+                if (test_(visited_, target)) return;
+                set_(visited_, target);
+                nodes_.push_back(target);
+            });
+        }
+        if (nodes_.size() == last) break;
+        order_(last);
+        counts_.push_back(nodes_.size() - last);
+        first = last;
+    }
+}
+
+template <typename View>
+void KHop<View>::order_(size_t first) {
+    size_t count = nodes_.size() - first;
+    size_t log = 1;
+    while ((size_t(1) << log) < count) log++;
+    // sorting costs about count * log, rebuilding from the bitset a pass over its words
+    if (count * log <= frontier_.size()) {
+        std::sort(nodes_.begin() + first, nodes_.end());
+        return;
+    }
+    for (size_t i = first; i < nodes_.size(); i++) {
+        set_(frontier_, nodes_[i]);
+    }
+    size_t next = first;
+    for (size_t word = 0; word < frontier_.size(); word++) {
+        for (uint64_t bits = frontier_[word]; bits != 0; bits &= bits - 1) {
+            nodes_[next++] = word * 64 + BitVector::popcount((bits & (~bits + 1)) - 1);
+        }
+        frontier_[word] = 0;
+    }
+}
+
+template <typename View>
+void KHop<View>::reset_() {
+    if (nodes_.size() > visited_.size()) {
+        std::fill(visited_.begin(), visited_.end(), 0);
+    } else {
+        for (size_t node : nodes_) {
+            visited_[node / 64] = 0;
+        }
+    }
+    nodes_.clear();
+    counts_.clear();
+}
+
+template <typename View>
+const std::vector<size_t>& KHop<View>::nodes() const {
+    return nodes_;
+}
+
+template <typename View>
+const std::vector<size_t>& KHop<View>::counts() const {
+    return counts_;
+}
+
+template <typename View>
+std::vector<size_t> KHop<View>::sorted_nodes() const {
+    std::vector<size_t> sorted(nodes_);
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+template <typename View>
+bool KHop<View>::contains(size_t node) const {
+    return node < view_.size() && test_(visited_, node);
+}
+
+template <typename View>
+InducedView<View> KHop<View>::induced() const {
+    return InducedView<View>(*this);
+}
+
+template <typename View>
+const View& KHop<View>::view() const {
+    return view_;
+}
+
+template <typename View>
+std::vector<size_t> k_hop(const View& view, const std::vector<size_t>& seeds, size_t k) {
+    KHop<View> hop(view);
+    hop.run(seeds, k);
+    return hop.sorted_nodes();
+}
+
+template <typename View, typename Function>
+void k_hop_batch(const View& view, const std::vector<size_t>& seeds, size_t k, Function function,
+        ThreadPool& pool, size_t grain) {
+    pool.parallel_for_ranges(0, seeds.size(), [&](size_t first, size_t last) {
+        KHop<View> hop(view);
+        for (size_t i = first; i < last; i++) {
+            hop.run(seeds[i], k);
+            function(i, static_cast<const KHop<View>&>(hop));
+        }
+    }, grain);
+}
+
+
+#endif
\ No newline at end of file
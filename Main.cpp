@@ -1,9 +1,10 @@
 #include "Graph.h"
+#include "InternedString.h"
 
 int main() {
-	DirectedGraph<std::string, std::string> sneed;
+	DirectedGraph<InternedString, InternedString> sneed;
 	sneed.import("input.txt");
-	DirectedGraph<std::string, std::string> bar;
+	DirectedGraph<InternedString, InternedString> bar;
 	bar = std::move(sneed);
 	//std::cout << sneed << std::endl;
 	//sneed.edges().printMatrix();
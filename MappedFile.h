@@ -0,0 +1,239 @@
+#ifndef __MAPPED_FILE_H
+#define __MAPPED_FILE_H
+
+#include <cstdint>
+#include <string>
+#include "Exceptions.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+/// @file MappedFile.h
+/// @brief Contains the MappedFile mapping a whole file into memory for reading and writing
+
+
+/// @brief A file mapped into memory as a whole, shared with the file so writes reach it; growing
+///  the file maps it again, so the address of its bytes may change and whatever is stored inside
+///  has to refer to other parts by their offsets. Not copyable
+class MappedFile {
+public:
+    /// @brief Opens a file and maps it, creating it empty if it does not exist
+    /// @param filename The name of the file
+    /// @exception FileProcessingException If the file cannot be opened or mapped
+    explicit MappedFile(const std::string& filename);
+
+    /// @brief Unmaps and closes the file, without syncing it first
+    ~MappedFile();
+
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator=(const MappedFile& other) = delete;
+
+    /// @brief Get the bytes of the file
+    /// @return The start of the mapping, null while the file is empty
+    uint8_t* data() const;
+
+    /// @brief Get the size of the file
+    /// @return The number of bytes
+    size_t size() const;
+
+    /// @brief Get the name of the file
+    /// @return The name the file was opened with
+    const std::string& filename() const;
+
+    /// @brief Grows the file and maps it again, the added bytes read as zeros
+    /// @param bytes The new size, nothing happens if it is not larger than the current one
+    /// @exception FileProcessingException If the file cannot grow or cannot be mapped again, the
+    ///  old mapping stays in place then
+    void grow(size_t bytes);
+
+    /// @brief Writes the changed pages back and waits until the file holds them
+    /// @exception FileProcessingException If the pages cannot be written
+    void sync();
+
+    /// @brief Writes the changed pages of a range back and waits until the file holds them
+    /// @param offset The start of the range, a multiple of the page size of the system
+    /// @param bytes The length of the range
+    /// @exception FileProcessingException If the pages cannot be written
+    void sync(size_t offset, size_t bytes);
+
+private:
+    /// @brief Maps the given number of bytes of the file, replacing the current mapping only
+    ///  once the new one is in place
+    /// @param bytes The number of bytes, nothing is mapped for zero
+    /// @exception FileProcessingException If the file cannot be mapped, the current mapping
+    ///  stays then
+    void map_(size_t bytes);
+
+    /// @brief Unmaps the file
+    void unmap_() noexcept;
+
+    /// @brief The name of the file
+    std::string filename_;
+
+    /// @brief The start of the mapping
+    uint8_t* data_;
+
+    /// @brief The size of the file
+    size_t size_;
+
+#if defined(_WIN32)
+    /// @brief The handle of the file
+    HANDLE file_;
+
+    /// @brief The handle of the mapping
+    HANDLE mapping_;
+#else
+    /// @brief The descriptor of the file
+    int file_;
+#endif
+};
+
+inline MappedFile::MappedFile(const std::string& filename)
+        : filename_(filename), data_(nullptr), size_(0) {
+#if defined(_WIN32)
+    mapping_ = nullptr;
+    file_ = CreateFileA(filename.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+        OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+        throw FileProcessingException::unable_to_map_file(filename);
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size)) {
+        CloseHandle(file_);
+        throw FileProcessingException::unable_to_map_file(filename);
+    }
+    size_t bytes = static_cast<size_t>(size.QuadPart);
+#else
+    file_ = ::open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    if (file_ < 0) throw FileProcessingException::unable_to_map_file(filename);
+    struct stat status;
+    if (fstat(file_, &status) != 0) {
+        ::close(file_);
+        throw FileProcessingException::unable_to_map_file(filename);
+    }
+    size_t bytes = static_cast<size_t>(status.st_size);
+#endif
+    try {
+        map_(bytes);
+    }
+    catch (...) {
+#if defined(_WIN32)
+        CloseHandle(file_);
+#else
+        ::close(file_);
+#endif
+        throw;
+    }
+}
+
+inline MappedFile::~MappedFile() {
+    unmap_();
+#if defined(_WIN32)
+    CloseHandle(file_);
+#else
+    ::close(file_);
+#endif
+}
+
+inline uint8_t* MappedFile::data() const {
+    return data_;
+}
+
+inline size_t MappedFile::size() const {
+    return size_;
+}
+
+inline const std::string& MappedFile::filename() const {
+    return filename_;
+}
+
+inline void MappedFile::map_(size_t bytes) {
+    // an empty file cannot be mapped, it has no bytes to hand out either
+    if (bytes == 0) return;
+#if defined(_WIN32)
+    HANDLE mapping = CreateFileMappingA(file_, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(static_cast<uint64_t>(bytes) >> 32),
+        static_cast<DWORD>(bytes & 0xFFFFFFFFu), nullptr);
+    if (mapping == nullptr) throw FileProcessingException::unable_to_map_file(filename_);
+    uint8_t* data = static_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0,
+        bytes));
+    if (data == nullptr) {
+        CloseHandle(mapping);
+        throw FileProcessingException::unable_to_map_file(filename_);
+    }
+#else
+    void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file_, 0);
+    if (mapped == MAP_FAILED) throw FileProcessingException::unable_to_map_file(filename_);
+    uint8_t* data = static_cast<uint8_t*>(mapped);
+#endif
+    unmap_();
+    data_ = data;
+    size_ = bytes;
+#if defined(_WIN32)
+    mapping_ = mapping;
+#endif
+}
+
+inline void MappedFile::unmap_() noexcept {
+    if (data_ == nullptr) return;
+#if defined(_WIN32)
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_);
+    mapping_ = nullptr;
+#else
+    munmap(data_, size_);
+#endif
+    data_ = nullptr;
+}
+
+inline void MappedFile::grow(size_t bytes) {
+    if (bytes <= size_) return;
+#if !defined(_WIN32)
+    // windows extends the file to the size of the new mapping by itself
+    if (ftruncate(file_, static_cast<off_t>(bytes)) != 0)
+        throw FileProcessingException::unable_to_map_file(filename_);
+#endif
+    try {
+        map_(bytes);
+    }
+    catch (...) {
+#if !defined(_WIN32)
+        // the old mapping is still in place; should the file not shrink back, the bytes past
+        // the mapping are never read
+        int shrunk = ftruncate(file_, static_cast<off_t>(size_));
+        (void)shrunk;
+#endif
+        throw;
+    }
+}
+
+inline void MappedFile::sync() {
+    sync(0, size_);
+}
+
+inline void MappedFile::sync(size_t offset, size_t bytes) {
+    if (data_ == nullptr || offset >= size_) return;
+    if (bytes > size_ - offset) bytes = size_ - offset;
+#if defined(_WIN32)
+    if (!FlushViewOfFile(data_ + offset, bytes) || !FlushFileBuffers(file_))
+        throw FileProcessingException::unable_to_sync_file(filename_);
+#else
+    if (msync(data_ + offset, bytes, MS_SYNC) != 0)
+        throw FileProcessingException::unable_to_sync_file(filename_);
+#endif
+}
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,752 @@
+#ifndef __MAPPED_GRAPH_H
+#define __MAPPED_GRAPH_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <type_traits>
+#include "Exceptions.h"
+#include "Graph.h"
+#include "MappedFile.h"
+#include "MemoryUsage.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+/// @file MappedGraph.h
+/// @brief Contains the MappedGraph keeping a graph inside a memory mapped file that outlives the
+///  process, and its member function definitions
+
+
+/// @brief A persistent graph living in a memory mapped file: the nodes, the edges and the lists
+///  of the edges leaving and entering every node are records of the file, linked by ids instead
+///  of pointers, so opening an existing file maps it and checks its header without reading or
+///  building anything. The records sit in chunks that double in size, their offsets are kept in
+///  the header, so the file grows a logarithmic number of times and records never move inside
+///  it. Changes are durable once sync returns; until then the header marks the file as changed.
+///  Its pages may have reached the disk in any order, so opening a file that was not synced
+///  after its last change rolls it back to the nodes and edges counted at the last sync and
+///  links their lists anew; data set since then may or may not be there. Only adding and
+///  setting are changes, reading never marks the file. Nodes and edges are identified by their
+///  ids, the graph imports and prints the format of Graph. Not copyable
+/// @tparam NData The data associated with the nodes, trivially copyable and not pointing into
+///  memory, so not InternedString
+/// @tparam EData The data associated with the edges, trivially copyable and not pointing into
+///  memory, so not InternedString
+template <typename NData, typename EData>
+class MappedGraph {
+    static_assert(std::is_trivially_copyable<NData>::value,
+        "the node data of a mapped graph has to be trivially copyable");
+    static_assert(std::is_trivially_copyable<EData>::value,
+        "the edge data of a mapped graph has to be trivially copyable");
+
+public:
+    /// @brief The number of records in the first chunk of nodes or edges, every next chunk holds
+    ///  twice as many as the one before it
+    static const size_t FIRST_CHUNK = 1024;
+
+    /// @brief The number of chunks of nodes and of edges the header has room for
+    static const size_t CHUNKS = 48;
+
+    /// @brief Opens the graph stored in the given file, or creates it if the file does not exist
+    ///  or is empty
+    /// @param filename The name of the file
+    /// @param undirected True if every edge connects its nodes both ways, an existing file has to
+    ///  have been created with the same direction
+    /// @exception FileProcessingException If the file cannot be mapped, or it does not hold a
+    ///  graph with the direction and the node and edge data sizes asked for, or it was not synced
+    ///  after its last change and cannot be rolled back
+    explicit MappedGraph(const std::string& filename, bool undirected = false);
+
+    /// @brief Syncs the file and closes it, errors are swallowed, call sync first to see them
+    ~MappedGraph();
+
+    MappedGraph(const MappedGraph& other) = delete;
+    MappedGraph& operator=(const MappedGraph& other) = delete;
+
+    /// @brief Returns if the graph is or is not undirected
+    /// @return True if the graph is undirected, false if it is directed
+    bool is_undirected() const;
+
+    /// @brief Returns the number of the nodes
+    /// @return The number of nodes
+    size_t node_count() const;
+
+    /// @brief Returns the number of the edges
+    /// @return The number of edges
+    size_t edge_count() const;
+
+    /// @brief Add a node; the file may be mapped again, moving every record in memory
+    /// @param data The node data
+    /// @return The id of the node
+    /// @exception FileProcessingException If the file cannot grow
+    size_t add_node(const NData& data);
+
+    /// @brief Add an edge; the file may be mapped again, moving every record in memory
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    /// @param data The edge data
+    /// @return The id of the edge
+    /// @exception NonexistingItemException If the source or target node does not exist
+    /// @exception ConflictingItemException If an edge between the nodes already exists
+    /// @exception FileProcessingException If the file cannot grow
+    size_t add_edge(size_t source, size_t target, const EData& data);
+
+    /// @brief Tests if an edge between two nodes exists, walking the edges leaving the source
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    /// @return True if the edge exists
+    /// @exception NonexistingItemException If the source or target node does not exist
+    bool exists(size_t source, size_t target) const;
+
+    /// @brief Finds the edge between two nodes
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    /// @return The id of the edge
+    /// @exception NonexistingItemException If the nodes or the edge between them do not exist
+    size_t find(size_t source, size_t target) const;
+
+    /// @brief Gets the data of a node
+    /// @param id The id of the node
+    /// @return A reference to the node data inside the file, valid until the next addition
+    /// @exception NonexistingItemException If no node with the given id exists
+    const NData& node(size_t id) const;
+
+    /// @brief Gets the data of an edge
+    /// @param id The id of the edge
+    /// @return A reference to the edge data inside the file, valid until the next addition
+    /// @exception NonexistingItemException If no edge with the given id exists
+    const EData& edge(size_t id) const;
+
+    /// @brief Sets the data of a node, a change to sync
+    /// @param id The id of the node
+    /// @param data The new node data
+    /// @exception NonexistingItemException If no node with the given id exists
+    /// @exception FileProcessingException If the file cannot be marked as changed
+    void set_node(size_t id, const NData& data);
+
+    /// @brief Sets the data of an edge, a change to sync
+    /// @param id The id of the edge
+    /// @param data The new edge data
+    /// @exception NonexistingItemException If no edge with the given id exists
+    /// @exception FileProcessingException If the file cannot be marked as changed
+    void set_edge(size_t id, const EData& data);
+
+    /// @brief Gets the source node of an edge
+    /// @param id The id of the edge
+    /// @return The id of the source node
+    /// @exception NonexistingItemException If no edge with the given id exists
+    size_t source(size_t id) const;
+
+    /// @brief Gets the target node of an edge
+    /// @param id The id of the edge
+    /// @return The id of the target node
+    /// @exception NonexistingItemException If no edge with the given id exists
+    size_t target(size_t id) const;
+
+    /// @brief Calls the given function for every neighbor of a node, the most recently added
+    ///  edge first; an undirected graph also follows the edges entering the node
+    /// @tparam Function A callable taking the id of the neighbor and the id of the edge
+    /// @param source The id of the node
+    /// @param function The function to call, it must not add nodes or edges
+    /// @exception NonexistingItemException If the node does not exist
+    template <typename Function>
+    void for_each_neighbor(size_t source, Function function) const;
+
+    /// @brief Prints the graph in the format of Graph::print
+    /// @param os The output stream
+    /// @exception InvalidStreamException If the output stream is not good
+    void print(std::ostream& os = std::cout) const;
+
+    /// @brief Prints the graph to a file with the specified filename
+    /// @param filename The name of the file to print to
+    /// @exception FileProcessingException If the output file is not good
+    void print(const std::string& filename) const;
+
+    /// @brief Imports the format of Graph::import from the given input stream; the ids of the
+    ///  nodes and edges have to continue the ones already in the file, in order
+    /// @param is The input stream
+    /// @exception InvalidStreamException If the input stream is not good
+    /// @exception InvalidIdentifierException If an id skips ahead
+    /// @exception ConflictingItemException If an id or the nodes of an edge are already taken
+    /// @exception NonexistingItemException If an edge connects nodes that do not exist
+    void import(std::istream& is);
+
+    /// @brief Imports the graph from a file with the given filename
+    /// @param filename The name of the file to import from
+    /// @exception FileProcessingException If the input file is not good
+    void import(const std::string& filename);
+
+    /// @brief Writes every change back to the file and waits until it holds them, then marks
+    ///  the file as unchanged
+    /// @exception FileProcessingException If the file cannot be written
+    void sync();
+
+    /// @brief Get the memory the mapping of the file takes by component: the node and edge data,
+    ///  the endpoints, the heads and links of the lists as the adjacency, and the header, the
+    ///  padding of the records and the unused room of the chunks as slack; the system keeps only
+    ///  the pages in use resident, so the resident memory may be less
+    /// @return The memory usage by component
+    MemoryUsage memory_usage() const;
+
+private:
+    /// @brief The id ending a list of edges
+    static const uint64_t NONE = UINT64_MAX;
+
+    /// @brief The bytes reserved for the header at the start of the file, a page
+    static const size_t HEADER_SIZE = 4096;
+
+    /// @brief The version of the layout of the file
+    static const uint32_t VERSION = 2;
+
+    /// @brief A node inside the file
+    struct NodeRecord {
+        /// @brief The node data
+        NData data;
+
+        /// @brief The id of the last edge added leaving the node
+        uint64_t first_out;
+
+        /// @brief The id of the last edge added entering the node
+        uint64_t first_in;
+    };
+
+    /// @brief An edge inside the file
+    struct EdgeRecord {
+        /// @brief The id of the source node
+        uint64_t source;
+
+        /// @brief The id of the target node
+        uint64_t target;
+
+        /// @brief The id of the edge added before it leaving the same source
+        uint64_t next_out;
+
+        /// @brief The id of the edge added before it entering the same target
+        uint64_t next_in;
+
+        /// @brief The edge data
+        EData data;
+    };
+
+    /// @brief The start of the file, in fixed width fields
+    struct Header {
+        /// @brief Tells the file apart from others
+        char magic[8];
+
+        /// @brief The version of the layout
+        uint32_t version;
+
+        /// @brief Nonzero if the graph is undirected
+        uint32_t undirected;
+
+        /// @brief The size of the node data, telling apart node data types of other sizes
+        uint32_t node_size;
+
+        /// @brief The alignment of the node data, fixing the layout of a node record
+        uint32_t node_alignment;
+
+        /// @brief The size of the edge data, telling apart edge data types of other sizes
+        uint32_t edge_size;
+
+        /// @brief The alignment of the edge data, fixing the layout of an edge record
+        uint32_t edge_alignment;
+
+        /// @brief Nonzero from the first change after a sync until the next sync
+        uint32_t changed;
+
+        /// @brief Keeps the counts aligned
+        uint32_t reserved;
+
+        /// @brief The number of nodes
+        uint64_t node_count;
+
+        /// @brief The number of edges
+        uint64_t edge_count;
+
+        /// @brief The number of nodes at the last sync
+        uint64_t synced_node_count;
+
+        /// @brief The number of edges at the last sync
+        uint64_t synced_edge_count;
+
+        /// @brief The offset of every chunk of nodes, zero while not allocated
+        uint64_t node_chunks[CHUNKS];
+
+        /// @brief The offset of every chunk of edges, zero while not allocated
+        uint64_t edge_chunks[CHUNKS];
+    };
+
+    static_assert(sizeof(Header) <= HEADER_SIZE, "the header of a mapped graph has to fit a page");
+    static_assert(alignof(NodeRecord) <= HEADER_SIZE && alignof(EdgeRecord) <= HEADER_SIZE,
+        "the records of a mapped graph have to be aligned within a page");
+
+    /// @brief The mapped file
+    mutable MappedFile file_;
+
+    /// @brief Get the header
+    /// @return The header at the start of the mapping
+    Header& header_() const;
+
+    /// @brief Finds the chunk holding the record with the given id
+    /// @param id The id of the record
+    /// @param index Set to the index of the record inside the chunk
+    /// @return The number of the chunk
+    static size_t chunk_of_(size_t id, size_t& index);
+
+    /// @brief Counts the chunks holding the given number of records
+    /// @param count The number of records
+    /// @return The number of chunks
+    static size_t chunk_count_(uint64_t count);
+
+    /// @brief Get the node record with the given id, which has to be allocated
+    /// @param id The id of the node
+    /// @return The record inside the file
+    NodeRecord& node_record_(size_t id) const;
+
+    /// @brief Get the edge record with the given id, which has to be allocated
+    /// @param id The id of the edge
+    /// @return The record inside the file
+    EdgeRecord& edge_record_(size_t id) const;
+
+    /// @brief Appends a chunk to the file if the record with the given id has none
+    /// @param edges True for an edge record, false for a node record
+    /// @param id The id of the record
+    /// @exception FileProcessingException If the file cannot grow or has no room for the chunk
+    void reserve_(bool edges, size_t id);
+
+    /// @brief Marks the file as changed on the first change after a sync, writing the mark to
+    ///  the file before the change may reach it
+    /// @exception FileProcessingException If the header cannot be written
+    void mark_changed_();
+
+    /// @brief Checks the header of an existing file
+    /// @param undirected The direction asked for
+    /// @exception FileProcessingException If the header does not match
+    void check_(bool undirected) const;
+
+    /// @brief Rolls a file that was not synced after its last change back to the counts of the
+    ///  last sync: forgets the chunks allocated since, links the lists of the nodes anew from
+    ///  the edges and syncs
+    /// @exception FileProcessingException If the file cannot be synced
+    void recover_();
+
+    /// @brief Adds a node or an edge parsed from the import format
+    /// @param record The record
+    void apply_(const ImportRecord<NData, EData>& record);
+};
+
+/// @brief Prints the given mapped graph to the given output stream and returns the same stream
+/// @tparam NData The data associated with the nodes
+/// @tparam EData The data associated with the edges
+/// @param os The output stream
+/// @param graph The graph to print
+/// @return The same output stream
+template <typename NData, typename EData>
+std::ostream& operator<<(std::ostream& os, const MappedGraph<NData, EData>& graph) {
+    graph.print(os);
+    return os;
+}
+
+template <typename NData, typename EData>
+MappedGraph<NData, EData>::MappedGraph(const std::string& filename, bool undirected)
+    : file_(filename) {
+    if (file_.size() != 0) {
+        check_(undirected);
+        if (header_().changed != 0) recover_();
+        return;
+    }
+    file_.grow(HEADER_SIZE);
+    Header& header = header_();
+    std::memcpy(header.magic, "GRAPHMAP", sizeof(header.magic));
+    header.version = VERSION;
+    header.undirected = undirected ? 1 : 0;
+    header.node_size = static_cast<uint32_t>(sizeof(NData));
+    header.node_alignment = static_cast<uint32_t>(alignof(NData));
+    header.edge_size = static_cast<uint32_t>(sizeof(EData));
+    header.edge_alignment = static_cast<uint32_t>(alignof(EData));
+    file_.sync();
+}
+
+template <typename NData, typename EData>
+MappedGraph<NData, EData>::~MappedGraph() {
+    try {
+        sync();
+    }
+    catch (...) {}
+}
+
+template <typename NData, typename EData>
+void MappedGraph<NData, EData>::check_(bool undirected) const {
+    const std::string& filename = file_.filename();
+    if (file_.size() < HEADER_SIZE)
+        throw FileProcessingException::invalid_mapped_graph(filename, "too short for a header");
+    const Header& header = header_();
+    if (std::memcmp(header.magic, "GRAPHMAP", sizeof(header.magic)) != 0)
+        throw FileProcessingException::invalid_mapped_graph(filename, "not a mapped graph");
+    if (header.version != VERSION)
+        throw FileProcessingException::invalid_mapped_graph(filename, "unknown version");
+    if (header.node_size != sizeof(NData) || header.node_alignment != alignof(NData) ||
+        header.edge_size != sizeof(EData) || header.edge_alignment != alignof(EData))
+        throw FileProcessingException::invalid_mapped_graph(filename,
+            "node or edge data of another size");
+    if ((header.undirected != 0) != undirected)
+        throw FileProcessingException::invalid_mapped_graph(filename,
+            undirected ? "directed graph" : "undirected graph");
+    // every record counted has to lie inside a chunk inside the file, a file not synced after
+    // its last change is only trusted up to the counts of the last sync
+    auto covered = [&](const uint64_t* chunks, size_t record_size, uint64_t count) {
+        size_t last = chunk_count_(count);
+        if (last > CHUNKS) return false;
+        for (size_t chunk = 0; chunk < last; chunk++) {
+            uint64_t bytes = (static_cast<uint64_t>(FIRST_CHUNK) << chunk) * record_size;
+            if (chunks[chunk] < HEADER_SIZE || chunks[chunk] % HEADER_SIZE != 0 ||
+                chunks[chunk] > file_.size() || bytes > file_.size() - chunks[chunk]) return false;
+        }
+        return true;
+    };
+    bool synced = header.changed == 0;
+    if (!covered(header.node_chunks, sizeof(NodeRecord),
+            synced ? header.node_count : header.synced_node_count) ||
+        !covered(header.edge_chunks, sizeof(EdgeRecord),
+            synced ? header.edge_count : header.synced_edge_count))
+        throw FileProcessingException::invalid_mapped_graph(filename, "records outside the file");
+}
+
+template <typename NData, typename EData>
+void MappedGraph<NData, EData>::recover_() {
+    Header& header = header_();
+    header.node_count = header.synced_node_count;
+    header.edge_count = header.synced_edge_count;
+    // the chunks allocated since the sync may not have reached the file, they are allocated anew
+    for (size_t chunk = chunk_count_(header.node_count); chunk < CHUNKS; chunk++) {
+        header.node_chunks[chunk] = 0;
+    }
+    for (size_t chunk = chunk_count_(header.edge_count); chunk < CHUNKS; chunk++) {
+        header.edge_chunks[chunk] = 0;
+    }
+    // an edge added since the sync may have linked itself into the lists of synced nodes, so the
+    // lists are linked anew from the synced edges in the order they were added
+    size_t nodes = node_count();
+    for (size_t id = 0; id < nodes; id++) {
+        NodeRecord& node = node_record_(id);
+        node.first_out = NONE;
+        node.first_in = NONE;
+    }
+    size_t edges = edge_count();
+    for (size_t id = 0; id < edges; id++) {
+        EdgeRecord& edge = edge_record_(id);
+        if (edge.source >= nodes || edge.target >= nodes)
+            throw FileProcessingException::invalid_mapped_graph(file_.filename(),
+                "edge between nodes outside the file");
+        NodeRecord& from = node_record_(edge.source);
+        NodeRecord& to = node_record_(edge.target);
+        edge.next_out = from.first_out;
+        edge.next_in = to.first_in;
+        from.first_out = id;
+        to.first_in = id;
+    }
+    sync();
+}
+
+template <typename NData, typename EData>
+typename MappedGraph<NData, EData>::Header& MappedGraph<NData, EData>::header_() const {
+    return *reinterpret_cast<Header*>(file_.data());
+}
+
+template <typename NData, typename EData>
+size_t MappedGraph<NData, EData>::chunk_of_(size_t id, size_t& index) {
+    // chunk k starts at FIRST_CHUNK * (2^k - 1), so k is the highest bit of id / FIRST_CHUNK + 1
+    uint64_t position = static_cast<uint64_t>(id / FIRST_CHUNK) + 1;
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long bit;
+    _BitScanReverse64(&bit, position);
+    size_t chunk = static_cast<size_t>(bit);
+#elif defined(__GNUC__)
+    size_t chunk = static_cast<size_t>(63 - __builtin_clzll(position));
+#else
+    size_t chunk = 0;
+    while ((position >> (chunk + 1)) != 0) ++chunk;
+#endif
+    index = id - FIRST_CHUNK * ((size_t(1) << chunk) - 1);
+    return chunk;
+}
+
+template <typename NData, typename EData>
+size_t MappedGraph<NData, EData>::chunk_count_(uint64_t count) {
+    size_t index;
+    return count == 0 ? 0 : chunk_of_(static_cast<size_t>(count - 1), index) + 1;
+}
+
+template <typename NData, typename EData>
+typename MappedGraph<NData, EData>::NodeRecord&
+MappedGraph<NData, EData>::node_record_(size_t id) const {
+    size_t index;
+    size_t chunk = chunk_of_(id, index);
+    return reinterpret_cast<NodeRecord*>(file_.data() + header_().node_chunks[chunk])[index];
+}
+
+template <typename NData, typename EData>
+typename MappedGraph<NData, EData>::EdgeRecord&
+MappedGraph<NData, EData>::edge_record_(size_t id) const {
+    size_t index;
+    size_t chunk = chunk_of_(id, index);
+    return reinterpret_cast<EdgeRecord*>(file_.data() + header_().edge_chunks[chunk])[index];
+}
+
+template <typename NData, typename EData>
+void MappedGraph<NData, EData>::reserve_(bool edges, size_t id) {
+    size_t index;
+    size_t chunk = chunk_of_(id, index);
+    if (index != 0) return;
+    if (chunk >= CHUNKS)
+        throw FileProcessingException::invalid_mapped_graph(file_.filename(), "too many records");
+    if ((edges ? header_().edge_chunks : header_().node_chunks)[chunk] != 0) return;
+    // chunks start on a page, the bytes past the end of the last one are never touched
+    size_t record_size = edges ? sizeof(EdgeRecord) : sizeof(NodeRecord);
+    size_t offset = (file_.size() + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE;
+    file_.grow(offset + (FIRST_CHUNK << chunk) * record_size);
+    // growing maps the file again, the header moved with it
+    (edges ? header_().edge_chunks : header_().node_chunks)[chunk] = offset;
+}
+
+template <typename NData, typename EData>
+void MappedGraph<NData, EData>::mark_changed_() {
+    Header& header = header_();
+    if (header.changed != 0) return;
+    header.changed = 1;
+    file_.sync(0, HEADER_SIZE);
+}
+
+template <typename NData, typename EData>
+bool MappedGraph<NData, EData>::is_undirected() const {
+    return header_().undirected != 0;
+}
+
+template <typename NData, typename EData>
+size_t MappedGraph<NData, EData>::node_count() const {
+    return static_cast<size_t>(header_().node_count);
+}
+
+template <typename NData, typename EData>
+size_t MappedGraph<NData, EData>::edge_count() const {
+    return static_cast<size_t>(header_().edge_count);
+}
+
+template <typename NData, typename EData>
+size_t MappedGraph<NData, EData>::add_node(const NData& data) {
+    mark_changed_();
+    size_t id = node_count();
+    reserve_(false, id);
+    new (&node_record_(id)) NodeRecord{ data, NONE, NONE };
+    header_().node_count = id + 1;
+    return id;
+}
+
+template <typename NData, typename EData>
+size_t MappedGraph<NData, EData>::add_edge(size_t source, size_t target, const EData& data) {
+    size_t nodes = node_count();
+    if (source >= nodes || target >= nodes)
+        throw NonexistingItemException::adding_edge_with_nonexistant_nodes(source, target, nodes);
+    if (exists(source, target))
+        throw ConflictingItemException::adding_edge_with_conflicting_nodes(source, target);
+    mark_changed_();
+    size_t id = edge_count();
+    reserve_(true, id);
+    // the edge goes to the front of the lists of its nodes
+    NodeRecord& from = node_record_(source);
+    NodeRecord& to = node_record_(target);
+    new (&edge_record_(id)) EdgeRecord{ source, target, from.first_out, to.first_in, data };
+    from.first_out = id;
+    to.first_in = id;
+    header_().edge_count = id + 1;
+    return id;
+}
+
+template <typename NData, typename EData>
+bool MappedGraph<NData, EData>::exists(size_t source, size_t target) const {
+    size_t nodes = node_count();
+    if (source >= nodes || target >= nodes)
+        throw NonexistingItemException::testing_existence_of_edge_with_nonexistant_nodes(source,
+            target, nodes);
+    bool found = false;
+    for_each_neighbor(source, [&](size_t neighbor, size_t) {
+        if (neighbor == target) found = true;
+    });
+    return found;
+}
+
+template <typename NData, typename EData>
+size_t MappedGraph<NData, EData>::find(size_t source, size_t target) const {
+    size_t nodes = node_count();
+    if (source >= nodes || target >= nodes)
+        throw NonexistingItemException::accessing_edge_with_nonexistant_nodes(source, target,
+            nodes);
+    size_t found = NONE;
+    for_each_neighbor(source, [&](size_t neighbor, size_t id) {
+        if (neighbor == target) found = id;
+    });
+    if (found == NONE)
+        throw NonexistingItemException::accessing_nonexistant_edge_with_source_target(source,
+            target);
+    return found;
+}
+
+template <typename NData, typename EData>
+const NData& MappedGraph<NData, EData>::node(size_t id) const {
+    if (id >= node_count())
+        throw NonexistingItemException::accessing_nonexistant_node(id, node_count());
+    return node_record_(id).data;
+}
+
+template <typename NData, typename EData>
+const EData& MappedGraph<NData, EData>::edge(size_t id) const {
+    if (id >= edge_count())
+        throw NonexistingItemException::accessing_nonexistant_edge_with_identifier(id,
+            edge_count());
+    return edge_record_(id).data;
+}
+
+template <typename NData, typename EData>
+void MappedGraph<NData, EData>::set_node(size_t id, const NData& data) {
+    if (id >= node_count())
+        throw NonexistingItemException::accessing_nonexistant_node(id, node_count());
+    mark_changed_();
+    node_record_(id).data = data;
+}
+
+template <typename NData, typename EData>
+void MappedGraph<NData, EData>::set_edge(size_t id, const EData& data) {
+    if (id >= edge_count())
+        throw NonexistingItemException::accessing_nonexistant_edge_with_identifier(id,
+            edge_count());
+    mark_changed_();
+    edge_record_(id).data = data;
+}
+
+template <typename NData, typename EData>
+size_t MappedGraph<NData, EData>::source(size_t id) const {
+    if (id >= edge_count())
+        throw NonexistingItemException::accessing_nonexistant_edge_with_identifier(id,
+            edge_count());
+    return static_cast<size_t>(edge_record_(id).source);
+}
+
+template <typename NData, typename EData>
+size_t MappedGraph<NData, EData>::target(size_t id) const {
+    if (id >= edge_count())
+        throw NonexistingItemException::accessing_nonexistant_edge_with_identifier(id,
+            edge_count());
+    return static_cast<size_t>(edge_record_(id).target);
+}
+
+template <typename NData, typename EData>
+template <typename Function>
+void MappedGraph<NData, EData>::for_each_neighbor(size_t source, Function function) const {
+    if (source >= node_count())
+        throw NonexistingItemException::accessing_edge_nonexistant_source(source, node_count());
+    const NodeRecord& node = node_record_(source);
+    for (uint64_t id = node.first_out; id != NONE; id = edge_record_(id).next_out) {
+        function(static_cast<size_t>(edge_record_(id).target), static_cast<size_t>(id));
+    }
+    if (!is_undirected()) return;
+    for (uint64_t id = node.first_in; id != NONE; id = edge_record_(id).next_in) {
+        const EdgeRecord& edge = edge_record_(id);
+        // a loop was already met leaving the node
+        if (edge.source != source) function(static_cast<size_t>(edge.source),
+            static_cast<size_t>(id));
+    }
+}
+
+template <typename NData, typename EData>
+void MappedGraph<NData, EData>::print(std::ostream& os) const {
+    if (!os.good()) throw InvalidStreamException::invalid_output_stream();
+    for (size_t id = 0; id < node_count(); id++) {
+        os << "node (" << id << " {" << node_record_(id).data << "})" << '\n';
+    }
+    for (size_t id = 0; id < edge_count(); id++) {
+        const EdgeRecord& edge = edge_record_(id);
+        os << "edge (" << edge.source << ")-[" << id << " {" << edge.data << "}]->("
+            << edge.target << ")" << '\n';
+    }
+    os.flush();
+}
+
+template <typename NData, typename EData>
+void MappedGraph<NData, EData>::print(const std::string& filename) const {
+    std::ofstream ofs(filename);
+    if (!ofs.good()) throw FileProcessingException::unable_to_open_output_file(filename);
+    print(ofs);
+    ofs.close();
+}
+
+template <typename NData, typename EData>
+void MappedGraph<NData, EData>::apply_(const ImportRecord<NData, EData>& record) {
+    if (record.is_edge) {
+        if (record.id > edge_count())
+            throw InvalidIdentifierException::adding_edge_invalid_identifier(record.id,
+                edge_count());
+        if (record.id < edge_count())
+            throw ConflictingItemException::adding_edge_conflicting_identifier(record.id);
+        add_edge(record.source, record.target, record.edge_data);
+    }
+    else {
+        if (record.id > node_count())
+            throw InvalidIdentifierException::adding_node_invalid_identifier(record.id,
+                node_count());
+        if (record.id < node_count())
+            throw ConflictingItemException::adding_node_conflicting_identifier(record.id);
+        add_node(record.node_data);
+    }
+}
+
+template <typename NData, typename EData>
+void MappedGraph<NData, EData>::import(std::istream& is) {
+    if (!is.good()) throw InvalidStreamException::invalid_input_stream();
+    std::string line;
+    ImportRecord<NData, EData> record;
+    while (std::getline(is, line)) {
+        if (Graph<NData, EData>::parse_record(line, record)) apply_(record);
+    }
+}
+
+template <typename NData, typename EData>
+void MappedGraph<NData, EData>::import(const std::string& filename) {
+    std::ifstream ifs(filename);
+    if (!ifs.good()) throw FileProcessingException::unable_to_open_input_file(filename);
+    import(ifs);
+    ifs.close();
+}
+
+template <typename NData, typename EData>
+void MappedGraph<NData, EData>::sync() {
+    Header& header = header_();
+    if (header.changed == 0) return;
+    // the records first, the header clears the mark only once they are in the file
+    file_.sync();
+    header.synced_node_count = header.node_count;
+    header.synced_edge_count = header.edge_count;
+    header.changed = 0;
+    file_.sync(0, HEADER_SIZE);
+}
+
+template <typename NData, typename EData>
+MemoryUsage MappedGraph<NData, EData>::memory_usage() const {
+    MemoryUsage usage;
+    size_t nodes = node_count();
+    size_t edges = edge_count();
+    usage.nodes = nodes * sizeof(NData);
+    usage.edges = edges * sizeof(EData);
+    usage.endpoints = edges * 2 * sizeof(uint64_t);
+    usage.adjacency = (nodes + edges) * 2 * sizeof(uint64_t);
+    usage.slack = file_.size() - usage.nodes - usage.edges - usage.endpoints - usage.adjacency;
+    return usage;
+}
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,132 @@
+#ifndef __MEMORY_USAGE_H
+#define __MEMORY_USAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/// @file MemoryUsage.h
+/// @brief Contains the MemoryUsage breakdown of a graph and the HeapUsage trait estimating the
+///  heap memory owned by node and edge data
+
+
+/// @brief The memory used by a graph in bytes, split by component; allocated but unused
+///  capacity is counted only as slack, so the fields but shared add up to the total without
+///  overlap. Blocks, rows, columns and indexes a graph shares with its copies or snapshots are
+///  counted by every graph holding them, shared tells how many of the bytes those are
+struct MemoryUsage {
+    /// @brief The bytes of the constructed nodes inside the blocks of the nodes
+    size_t nodes = 0;
+
+    /// @brief The bytes of the constructed edges inside the blocks of the edges
+    size_t edges = 0;
+
+    /// @brief The bytes of the source and target columns of the edges
+    size_t endpoints = 0;
+
+    /// @brief The bytes of the adjacency, the dense matrix or the sparse rows with the table
+    ///  pointing to them
+    size_t adjacency = 0;
+
+    /// @brief The bytes of the nodes and edges staged by an open batch
+    size_t staged = 0;
+
+    /// @brief The bytes allocated but not used yet: free spots of the blocks, spare capacity
+    ///  of vectors, rows and tables; and the tables pointing to the blocks of nodes and edges
+    size_t slack = 0;
+
+    /// @brief The estimated heap memory owned by the node data, see HeapUsage
+    size_t node_data_heap = 0;
+
+    /// @brief The estimated heap memory owned by the edge data, see HeapUsage
+    size_t edge_data_heap = 0;
+
+    /// @brief The bytes of the property columns of the nodes and the edges
+    size_t properties = 0;
+
+    /// @brief The estimated bytes of the secondary indexes of the nodes and the edges and of the
+    ///  existence filter of the edges
+    size_t indexes = 0;
+
+    /// @brief The estimated bytes of the cached algorithm results, see ResultCache
+    size_t results = 0;
+
+    /// @brief The bytes of the frames of a page cache and of its tables, see PagedGraph; what
+    ///  is paged through it lies in a file and is not counted otherwise
+    size_t page_cache = 0;
+
+    /// @brief The bytes of the components above shared with copies or snapshots of the graph,
+    ///  counted by them as well and not added to the total; summing the usages of graphs that
+    ///  share storage counts these bytes more than once
+    size_t shared = 0;
+
+    /// @brief Get the sum of all the components but shared
+    /// @return The total number of bytes
+    size_t total() const;
+};
+
+/// @brief Estimates the heap memory owned by a value on top of its own size; the default assumes
+///  there is none, specialize it for node or edge data owning heap memory. Graphs only walk their
+///  data when owns_heap is true, so accounting stays cheap for plain data
+/// @tparam T The type of the value
+template <typename T>
+struct HeapUsage {
+    /// @brief True if values of the type may own heap memory
+    static const bool owns_heap = false;
+
+    /// @brief Estimates the heap memory owned by a value
+    /// @param value The value
+    /// @return The number of bytes
+    static size_t of(const T& value);
+};
+
+/// @brief Estimates the heap memory of a string, none while it fits the small string buffer
+template <>
+struct HeapUsage<std::string> {
+    static const bool owns_heap = true;
+    static size_t of(const std::string& value);
+};
+
+/// @brief Estimates the heap memory of a vector, its capacity and what its elements own
+/// @tparam T The element of the vector
+/// @tparam Allocator The allocator of the vector
+template <typename T, typename Allocator>
+struct HeapUsage<std::vector<T, Allocator>> {
+    static const bool owns_heap = true;
+    static size_t of(const std::vector<T, Allocator>& value);
+};
+
+inline size_t MemoryUsage::total() const {
+    return nodes + edges + endpoints + adjacency + staged + slack + node_data_heap +
+        edge_data_heap + properties + indexes + results + page_cache;
+}
+
+template <typename T>
+size_t HeapUsage<T>::of(const T& value) {
+    (void)value;
+    return 0;
+}
+
+inline size_t HeapUsage<std::string>::of(const std::string& value) {
+    uintptr_t data = reinterpret_cast<uintptr_t>(value.data());
+    uintptr_t object = reinterpret_cast<uintptr_t>(&value);
+    // a short string keeps its characters inside the object itself
+    if (data >= object && data < object + sizeof(std::string)) return 0;
+    return value.capacity() + 1;
+}
+
+template <typename T, typename Allocator>
+size_t HeapUsage<std::vector<T, Allocator>>::of(const std::vector<T, Allocator>& value) {
+    size_t bytes = value.capacity() * sizeof(T);
+    if (HeapUsage<T>::owns_heap) {
+        for (const T& element : value) {
+            bytes += HeapUsage<T>::of(element);
+        }
+    }
+    return bytes;
+}
+
+
+#endif
\ No newline at end of file
@@ -21,6 +21,13 @@ public:
     /// @param data The node data of the node
     Node(size_t id, NData data);
 
+    /// @brief Construct a node with the given id, constructing its node data in place
+    /// @tparam Args The types of the arguments of the node data's constructor
+    /// @param id The id of the node to construct
+    /// @param args The arguments forwarded to the node data's constructor
+    template <typename... Args>
+    Node(size_t id, std::piecewise_construct_t, Args&&... args);
+
     /// @brief Get the id of the node
     /// @return The id of the node
     size_t getId() const;
@@ -29,6 +36,10 @@ public:
     /// @return The node data of the node
     NData& getData();
 
+    /// @brief Get the node data of the node
+    /// @return The node data of the node
+    const NData& getData() const;
+
     /// @brief Copy assignment
     /// @param other The node that will be copied
     /// @return The node that was copied to
@@ -64,13 +75,17 @@ private:
 /// @return The same output stream
 template <typename NData>
 std::ostream& operator<<(std::ostream& os, const Node<NData>& node) {
-    os << "node (" << node.getId() << " {" << const_cast<Node<NData>&>(node).getData()
-        << "})" << std::endl;
+    os << "node (" << node.getId() << " {" << node.getData() << "})" << std::endl;
     return os;
 }
 
 template <typename NData>
-Node<NData>::Node(size_t id, NData data) : id_(id), data_(data) {}
+Node<NData>::Node(size_t id, NData data) : id_(id), data_(std::move(data)) {}
+
+template <typename NData>
+template <typename... Args>
+Node<NData>::Node(size_t id, std::piecewise_construct_t, Args&&... args)
+    : id_(id), data_(std::forward<Args>(args)...) {}
 
 template <typename NData>
 size_t Node<NData>::getId() const {
@@ -82,6 +97,11 @@ NData& Node<NData>::getData() {
     return data_;
 }
 
+template <typename NData>
+const NData& Node<NData>::getData() const {
+    return data_;
+}
+
 template <typename NData>
 Node<NData>& Node<NData>::operator=(const Node<NData>& other) {
     id_ = other.id_;
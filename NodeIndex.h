@@ -0,0 +1,450 @@
+#ifndef __NODE_INDEX_H
+#define __NODE_INDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Exceptions.h"
+#include "MemoryUsage.h"
+
+
+/// @file NodeIndex.h
+/// @brief Contains the secondary indexes looking up nodes by their data, a hash index for
+///  equality and a sorted index for ranges, and their member function definitions
+
+
+/// @brief A projection indexing the whole node data
+struct IdentityProjection {
+    /// @brief Returns the data itself
+    /// @tparam T The type of the data
+    /// @param data The data
+    /// @return The same data
+    template <typename T>
+    const T& operator()(const T& data) const;
+};
+
+/// @brief A secondary index of the nodes by a key projected from their data; Nodes keeps its
+///  indexes up to date as nodes are added, changing the data of a node afterwards needs
+///  Nodes::reindex
+/// @tparam NData The data associated with the nodes
+template <typename NData>
+class NodeIndex {
+public:
+    /// @brief The id returned when no node has the key
+    static const size_t NONE = SIZE_MAX;
+
+    /// @brief The virtual destructor
+    virtual ~NodeIndex() = default;
+
+    /// @brief Adds a node to the index
+    /// @param id The id of the node
+    /// @param data The node data
+    /// @exception UnavailableMemoryException If there isn't enough memory, the index is left
+    ///  unchanged then
+    virtual void insert(size_t id, const NData& data) = 0;
+
+    /// @brief Removes a node from the index, nothing happens if it is not in it
+    /// @param id The id of the node
+    /// @param data The node data it was inserted with
+    virtual void erase(size_t id, const NData& data) noexcept = 0;
+
+    /// @brief Removes every node from the index
+    virtual void clear() noexcept = 0;
+
+    /// @brief Fills the index anew with the given nodes, built aside and swapped in at the end
+    /// @param data The data of every node, by node id
+    /// @exception UnavailableMemoryException If there isn't enough memory, the index is left
+    ///  as it was then
+    virtual void rebuild(const std::vector<const NData*>& data) = 0;
+
+    /// @brief Get the number of nodes in the index
+    /// @return The number of nodes
+    virtual size_t size() const = 0;
+
+    /// @brief Finds a node by its whole data, if the key of the index is the whole data
+    /// @param data The node data
+    /// @param id Set to the lowest id of the nodes with the data, NONE if there is none
+    /// @return True if the index could look the data up, false if its key is a projection
+    virtual bool find_data(const NData& data, size_t& id) const = 0;
+
+    /// @brief Get the memory allocated by the index, estimated for the nodes of the containers
+    /// @return The number of bytes
+    virtual size_t memory_usage() const = 0;
+
+    /// @brief Copies the index
+    /// @return The copy
+    virtual std::unique_ptr<NodeIndex<NData>> clone() const = 0;
+};
+
+/// @brief A hash index for looking up the nodes whose key equals a value in constant time; the
+///  ids of the nodes with equal keys are kept in order, so finding the lowest one does not walk
+///  the others
+/// @tparam NData The data associated with the nodes
+/// @tparam Projection A copyable callable taking the node data and returning the key, which has
+///  to be hashable and equality comparable
+template <typename NData, typename Projection = IdentityProjection>
+class HashNodeIndex : public NodeIndex<NData> {
+public:
+    /// @brief The type of the key
+    using Key = typename std::decay<decltype(std::declval<const Projection&>()(
+        std::declval<const NData&>()))>::type;
+
+    using NodeIndex<NData>::NONE;
+
+    /// @brief Constructs an empty index
+    /// @param projection The projection of the key from the node data
+    explicit HashNodeIndex(Projection projection = Projection());
+
+    /// @brief Finds a node with the given key
+    /// @param key The key
+    /// @return The lowest id of the nodes with the key, NONE if there is none
+    size_t find(const Key& key) const;
+
+    /// @brief Counts the nodes with the given key
+    /// @param key The key
+    /// @return The number of nodes
+    size_t count(const Key& key) const;
+
+    /// @brief Calls the given function for every node with the given key, in the order of their ids
+    /// @tparam Function A callable taking the id of a node
+    /// @param key The key
+    /// @param function The function to call
+    template <typename Function>
+    void for_each(const Key& key, Function function) const;
+
+    void insert(size_t id, const NData& data) override;
+    void erase(size_t id, const NData& data) noexcept override;
+    void clear() noexcept override;
+    void rebuild(const std::vector<const NData*>& data) override;
+    size_t size() const override;
+    bool find_data(const NData& data, size_t& id) const override;
+    size_t memory_usage() const override;
+    std::unique_ptr<NodeIndex<NData>> clone() const override;
+
+private:
+    /// @brief Looks the whole data up, the key is the data
+    /// @param data The node data
+    /// @param id Set to the lowest id of the nodes with the data
+    /// @return True
+    bool find_data_(const NData& data, size_t& id, std::true_type) const;
+
+    /// @brief Refuses to look the whole data up, the key is a projection
+    /// @return False
+    bool find_data_(const NData& data, size_t& id, std::false_type) const;
+
+    /// @brief The projection of the key
+    Projection projection_;
+
+    /// @brief The ids of the nodes by key, in ascending order
+    std::unordered_map<Key, std::vector<size_t>> ids_;
+
+    /// @brief The number of nodes in the index
+    size_t size_;
+};
+
+/// @brief A sorted index for looking up the nodes whose key lies in a range in logarithmic time
+///  and visiting them in key order; nodes with equal keys are kept in the order of their ids
+/// @tparam NData The data associated with the nodes
+/// @tparam Projection A copyable callable taking the node data and returning the key, which has
+///  to be less than comparable
+template <typename NData, typename Projection = IdentityProjection>
+class SortedNodeIndex : public NodeIndex<NData> {
+public:
+    /// @brief The type of the key
+    using Key = typename std::decay<decltype(std::declval<const Projection&>()(
+        std::declval<const NData&>()))>::type;
+
+    using NodeIndex<NData>::NONE;
+
+    /// @brief Constructs an empty index
+    /// @param projection The projection of the key from the node data
+    explicit SortedNodeIndex(Projection projection = Projection());
+
+    /// @brief Finds a node with the given key
+    /// @param key The key
+    /// @return The lowest id of the nodes with the key, NONE if there is none
+    size_t find(const Key& key) const;
+
+    /// @brief Calls the given function for every node whose key lies in [low, high), in key order
+    /// @tparam Function A callable taking the id of a node and a const reference to its key
+    /// @param low The lowest key included
+    /// @param high The lowest key excluded
+    /// @param function The function to call
+    template <typename Function>
+    void range(const Key& low, const Key& high, Function function) const;
+
+    /// @brief Counts the nodes whose key lies in [low, high), walking them
+    /// @param low The lowest key included
+    /// @param high The lowest key excluded
+    /// @return The number of nodes
+    size_t count(const Key& low, const Key& high) const;
+
+    /// @brief Calls the given function for every node in key order
+    /// @tparam Function A callable taking the id of a node and a const reference to its key
+    /// @param function The function to call
+    template <typename Function>
+    void for_each(Function function) const;
+
+    void insert(size_t id, const NData& data) override;
+    void erase(size_t id, const NData& data) noexcept override;
+    void clear() noexcept override;
+    void rebuild(const std::vector<const NData*>& data) override;
+    size_t size() const override;
+    bool find_data(const NData& data, size_t& id) const override;
+    size_t memory_usage() const override;
+    std::unique_ptr<NodeIndex<NData>> clone() const override;
+
+private:
+    /// @brief Looks the whole data up, the key is the data
+    /// @param data The node data
+    /// @param id Set to the lowest id of the nodes with the data
+    /// @return True
+    bool find_data_(const NData& data, size_t& id, std::true_type) const;
+
+    /// @brief Refuses to look the whole data up, the key is a projection
+    /// @return False
+    bool find_data_(const NData& data, size_t& id, std::false_type) const;
+
+    /// @brief The projection of the key
+    Projection projection_;
+
+    /// @brief The ids of the nodes ordered by key, a balanced search tree
+    std::multimap<Key, size_t> ids_;
+};
+
+template <typename T>
+const T& IdentityProjection::operator()(const T& data) const {
+    return data;
+}
+
+template <typename NData, typename Projection>
+HashNodeIndex<NData, Projection>::HashNodeIndex(Projection projection)
+    : projection_(std::move(projection)), size_(0) {}
+
+template <typename NData, typename Projection>
+size_t HashNodeIndex<NData, Projection>::find(const Key& key) const {
+    auto found = ids_.find(key);
+    return found == ids_.end() ? NONE : found->second.front();
+}
+
+template <typename NData, typename Projection>
+size_t HashNodeIndex<NData, Projection>::count(const Key& key) const {
+    auto found = ids_.find(key);
+    return found == ids_.end() ? 0 : found->second.size();
+}
+
+template <typename NData, typename Projection>
+template <typename Function>
+void HashNodeIndex<NData, Projection>::for_each(const Key& key, Function function) const {
+    auto found = ids_.find(key);
+    if (found == ids_.end()) return;
+    for (size_t id : found->second) {
+        function(id);
+    }
+}
+
+template <typename NData, typename Projection>
+void HashNodeIndex<NData, Projection>::insert(size_t id, const NData& data) {
+    try {
+        const Key& key = projection_(data);
+        auto found = ids_.find(key);
+        if (found == ids_.end()) {
+            ids_.emplace(key, std::vector<size_t>(1, id));
+        }
+        else {
+            // nodes are added in the order of their ids, so this mostly appends
+            std::vector<size_t>& ids = found->second;
+            ids.insert(std::upper_bound(ids.begin(), ids.end(), id), id);
+        }
+        ++size_;
+    }
+    catch (const std::bad_alloc&) {
+        throw UnavailableMemoryException::node_index_unable_to_insert();
+    }
+}
+
+template <typename NData, typename Projection>
+void HashNodeIndex<NData, Projection>::erase(size_t id, const NData& data) noexcept {
+    auto found = ids_.find(projection_(data));
+    if (found == ids_.end()) return;
+    std::vector<size_t>& ids = found->second;
+    auto position = std::lower_bound(ids.begin(), ids.end(), id);
+    if (position == ids.end() || *position != id) return;
+    ids.erase(position);
+    if (ids.empty()) ids_.erase(found);
+    --size_;
+}
+
+template <typename NData, typename Projection>
+void HashNodeIndex<NData, Projection>::clear() noexcept {
+    ids_.clear();
+    size_ = 0;
+}
+
+template <typename NData, typename Projection>
+void HashNodeIndex<NData, Projection>::rebuild(const std::vector<const NData*>& data) {
+    HashNodeIndex<NData, Projection> built(projection_);
+    for (size_t id = 0; id < data.size(); id++) {
+        built.insert(id, *data[id]);
+    }
+    ids_.swap(built.ids_);
+    size_ = built.size_;
+}
+
+template <typename NData, typename Projection>
+size_t HashNodeIndex<NData, Projection>::size() const {
+    return size_;
+}
+
+template <typename NData, typename Projection>
+bool HashNodeIndex<NData, Projection>::find_data(const NData& data, size_t& id) const {
+    return find_data_(data, id, std::is_same<Projection, IdentityProjection>());
+}
+
+template <typename NData, typename Projection>
+bool HashNodeIndex<NData, Projection>::find_data_(const NData& data, size_t& id,
+        std::true_type) const {
+    id = find(data);
+    return true;
+}
+
+template <typename NData, typename Projection>
+bool HashNodeIndex<NData, Projection>::find_data_(const NData&, size_t&, std::false_type) const {
+    return false;
+}
+
+template <typename NData, typename Projection>
+size_t HashNodeIndex<NData, Projection>::memory_usage() const {
+    // a node of the hash table per key, a pointer to the next one inside it
+    size_t bytes = ids_.bucket_count() * sizeof(void*) +
+        ids_.size() * (sizeof(std::pair<const Key, std::vector<size_t>>) + sizeof(void*));
+    for (const auto& entry : ids_) {
+        bytes += entry.second.capacity() * sizeof(size_t);
+        if (HeapUsage<Key>::owns_heap) bytes += HeapUsage<Key>::of(entry.first);
+    }
+    return bytes;
+}
+
+template <typename NData, typename Projection>
+std::unique_ptr<NodeIndex<NData>> HashNodeIndex<NData, Projection>::clone() const {
+    return std::unique_ptr<NodeIndex<NData>>(new HashNodeIndex<NData, Projection>(*this));
+}
+
+template <typename NData, typename Projection>
+SortedNodeIndex<NData, Projection>::SortedNodeIndex(Projection projection)
+    : projection_(std::move(projection)) {}
+
+template <typename NData, typename Projection>
+size_t SortedNodeIndex<NData, Projection>::find(const Key& key) const {
+    // equal keys are in insertion order, which is the order of the ids
+    auto found = ids_.lower_bound(key);
+    if (found == ids_.end() || key < found->first) return NONE;
+    return found->second;
+}
+
+template <typename NData, typename Projection>
+template <typename Function>
+void SortedNodeIndex<NData, Projection>::range(const Key& low, const Key& high,
+        Function function) const {
+    for (auto it = ids_.lower_bound(low); it != ids_.end() && it->first < high; ++it) {
+        function(it->second, it->first);
+    }
+}
+
+template <typename NData, typename Projection>
+size_t SortedNodeIndex<NData, Projection>::count(const Key& low, const Key& high) const {
+    size_t count = 0;
+    range(low, high, [&](size_t, const Key&) { ++count; });
+    return count;
+}
+
+template <typename NData, typename Projection>
+template <typename Function>
+void SortedNodeIndex<NData, Projection>::for_each(Function function) const {
+    for (const auto& entry : ids_) {
+        function(entry.second, entry.first);
+    }
+}
+
+template <typename NData, typename Projection>
+void SortedNodeIndex<NData, Projection>::insert(size_t id, const NData& data) {
+    try {
+        ids_.emplace(projection_(data), id);
+    }
+    catch (const std::bad_alloc&) {
+        throw UnavailableMemoryException::node_index_unable_to_insert();
+    }
+}
+
+template <typename NData, typename Projection>
+void SortedNodeIndex<NData, Projection>::erase(size_t id, const NData& data) noexcept {
+    auto range = ids_.equal_range(projection_(data));
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == id) {
+            ids_.erase(it);
+            return;
+        }
+    }
+}
+
+template <typename NData, typename Projection>
+void SortedNodeIndex<NData, Projection>::clear() noexcept {
+    ids_.clear();
+}
+
+template <typename NData, typename Projection>
+void SortedNodeIndex<NData, Projection>::rebuild(const std::vector<const NData*>& data) {
+    SortedNodeIndex<NData, Projection> built(projection_);
+    for (size_t id = 0; id < data.size(); id++) {
+        built.insert(id, *data[id]);
+    }
+    ids_.swap(built.ids_);
+}
+
+template <typename NData, typename Projection>
+size_t SortedNodeIndex<NData, Projection>::size() const {
+    return ids_.size();
+}
+
+template <typename NData, typename Projection>
+bool SortedNodeIndex<NData, Projection>::find_data(const NData& data, size_t& id) const {
+    return find_data_(data, id, std::is_same<Projection, IdentityProjection>());
+}
+
+template <typename NData, typename Projection>
+bool SortedNodeIndex<NData, Projection>::find_data_(const NData& data, size_t& id,
+        std::true_type) const {
+    id = find(data);
+    return true;
+}
+
+template <typename NData, typename Projection>
+bool SortedNodeIndex<NData, Projection>::find_data_(const NData&, size_t&, std::false_type) const {
+    return false;
+}
+
+template <typename NData, typename Projection>
+size_t SortedNodeIndex<NData, Projection>::memory_usage() const {
+    // a node of the tree per entry, with three pointers and a color
+    size_t bytes = ids_.size() * (sizeof(std::pair<const Key, size_t>) + 4 * sizeof(void*));
+    if (HeapUsage<Key>::owns_heap) {
+        for (const auto& entry : ids_) {
+            bytes += HeapUsage<Key>::of(entry.first);
+        }
+    }
+    return bytes;
+}
+
+template <typename NData, typename Projection>
+std::unique_ptr<NodeIndex<NData>> SortedNodeIndex<NData, Projection>::clone() const {
+    return std::unique_ptr<NodeIndex<NData>>(new SortedNodeIndex<NData, Projection>(*this));
+}
+
+
+#endif
\ No newline at end of file
@@ -1,20 +1,38 @@
 #ifndef __NODES_H  
 #define __NODES_H
 
+#include <map>
+#include <memory>
+#include <string>
 #include <utility>
+#include "CopyOnWrite.h"
 #include "Graph.h"
 #include "Node.h"
+#include "MemoryUsage.h"
+#include "NodeIndex.h"
+#include "Properties.h"
+#include "ThreadPool.h"
 
 
 /// @file Edges.h
 /// @brief Contains the Nodes class and its member function definitions
 
 
-// forward declaration
+// forward declarations
 template <typename NData, typename EData>
 class Graph;
 
-/// @brief The Nodes of the Graph
+template <typename NData, typename EData>
+class Edges;
+
+template <typename NData, typename EData>
+class GraphSnapshot;
+
+/// @brief The Nodes of the Graph; a copy of the graph shares the blocks of nodes with the original
+///  until either of them writes to them, see my_array::Array, and the property columns and the
+///  indexes until either of them writes to one, see CopyOnWrite. The non-const accessors unshare
+///  only the block they return from, the edges refer to their endpoints by id so they are left
+///  alone; the const accessors return const references and never copy anything
 /// @tparam NData The data associated with the Graph's nodes
 /// @tparam EData The data associated with the Graph's edges 
 template <typename NData, typename EData>
@@ -43,6 +61,19 @@ public:
     /// @return A reference to the node that was just created and added to the nodes 
     Node<NData>& add(NData data);
 
+    /// @brief Add a Node, constructing its node data in place inside the storage of the nodes
+    ///  so it is never copied or moved
+    /// @tparam Args The types of the arguments of the node data's constructor
+    /// @param id Id of the node to add (should be equal to the size of the nodes)
+    /// @param args The arguments forwarded to the node data's constructor
+    /// @return A reference to the node that was just created and added to the nodes
+    /// @exception InvalidIdentifierException If id was invalid (higher than size of edges)
+    /// @exception ConflictingItemException If id is already taken (lower than size of edges)
+    /// @exception UnavailableMemoryException If the underlying nodes contained cannot grow due to
+    ///  running out of memory
+    template <typename... Args>
+    Node<NData>& emplace(size_t id, Args&&... args);
+
     /// @brief Returns the number of the contained nodes
     /// @return The number of contained nodes
     size_t size() const;
@@ -54,21 +85,112 @@ public:
 
     /// @brief Gets the node with the given id
     /// @param id The id of the node to get
+    /// @return A const reference to the node with the given id
+    /// @exception NonexistingItemException If no node with the given id exists
+    const Node<NData>& get(size_t id) const;
+
+    /// @brief Gets the node with the given id, copying its block first if it is shared with a
+    ///  copy of the graph
+    /// @param id The id of the node to get
     /// @return A reference to the node with the given id
     /// @exception NonexistingItemException If no node with the given id exists
-    Node<NData>& get(size_t id) const;
+    /// @exception UnavailableMemoryException If there isn't enough memory to copy the block
+    Node<NData>& get(size_t id);
 
     /// @brief Gets the node with the given id
     /// @param id The id of the node to get
-    /// @return A reference to the node with the given id 
-    Node<NData>& operator[](size_t id) const;
+    /// @return A const reference to the node with the given id
+    /// @exception NonexistingItemException If no node with the given id exists
+    const Node<NData>& operator[](size_t id) const;
 
-    /// @brief Returns an iterator to the first node
+    /// @brief Gets the node with the given id, copying its block first if it is shared with a
+    ///  copy of the graph
+    /// @param id The id of the node to get
+    /// @return A reference to the node with the given id
+    /// @exception NonexistingItemException If no node with the given id exists
+    /// @exception UnavailableMemoryException If there isn't enough memory to copy the block
+    Node<NData>& operator[](size_t id);
+
+    /// @brief Calls the given function for every node in parallel, after copying the blocks
+    ///  shared with a copy of the graph
+    /// @tparam Function A callable taking a reference to a node
+    /// @param function The function to call
+    /// @param grain The number of nodes below which a range is not split any further,
+    ///  0 to choose it from the number of nodes and threads
+    /// @param pool The thread pool to run on
+    /// @exception UnavailableMemoryException If there isn't enough memory for the copies
+    /// @exception Any exception thrown by the function
+    template <typename Function>
+    void parallel_for_each(Function function, size_t grain = 0,
+        ThreadPool& pool = ThreadPool::global());
+
+    /// @brief Moves the memory of every node to the NUMA node of its partition, best effort
+    /// @param partitions The partitions of the node ids
+    void distribute(const std::vector<NumaPartition>& partitions) const;
+
+    /// @brief Adds the memory used by the nodes to the nodes, slack, node data heap, properties,
+    ///  indexes and shared of the given breakdown; walks the node data only if HeapUsage says it
+    ///  may own heap memory
+    /// @param usage The breakdown to add to
+    void memory_usage(MemoryUsage& usage) const;
+
+    /// @brief Get the property columns of the nodes, indexed by node id; a node whose property
+    ///  was never set reads the default value. Copies of the graph share the columns until
+    ///  either of them gets one for writing
+    /// @return A reference to the properties
+    Properties& properties();
+
+    /// @brief Get the property columns of the nodes, indexed by node id
+    /// @return A const reference to the properties
+    const Properties& properties() const;
+
+    /// @brief Adds a secondary index filled with the nodes added so far; from then on adding a
+    ///  node adds it to the index too. Changing the data of a node needs reindex afterwards.
+    ///  Copies of the graph share the indexes until either of them adds a node or reindexes
+    /// @tparam Index The type of the index, like HashNodeIndex or SortedNodeIndex
+    /// @param name The name of the index
+    /// @param index The empty index, holding the projection of its key
+    /// @return The index, valid until it is removed
+    /// @exception ConflictingItemException If an index with the name already exists
+    /// @exception UnavailableMemoryException If there isn't enough memory for the index
+    template <typename Index>
+    Index& add_index(const std::string& name, Index index = Index());
+
+    /// @brief Gets a secondary index
+    /// @tparam Index The type of the index
+    /// @param name The name of the index
+    /// @return The index
+    /// @exception NonexistingItemException If no index has the name
+    /// @exception InvalidArgumentException If the index has another type
+    template <typename Index>
+    const Index& index(const std::string& name) const;
+
+    /// @brief Removes a secondary index, if it exists
+    /// @param name The name of the index
+    void remove_index(const std::string& name);
+
+    /// @brief Fills every secondary index anew from the current node data, each built aside and
+    ///  swapped in at the end
+    /// @exception UnavailableMemoryException If there isn't enough memory, the indexes not
+    ///  rebuilt yet are left as they were then, so find still looks up every indexed data
+    void reindex();
+
+    /// @brief Finds a node by its data, in constant time with a HashNodeIndex of the whole node
+    ///  data, in logarithmic time with a SortedNodeIndex of it, and scanning the nodes otherwise
+    /// @param data The node data to look for
+    /// @return The node with the lowest id having the data, nullptr if there is none
+    const Node<NData>* find(const NData& data) const;
+
+    /// @brief Returns an iterator to the first node, after copying the blocks shared with a copy
+    ///  of the graph
     /// @return The iterator to the first node
+    /// @exception UnavailableMemoryException If there isn't enough memory for the copies
     typename my_array::Array<Node<NData>>::iterator begin();
 
-    /// @brief Returns an iterator to the space after the last node
+    /// @brief Returns an iterator to the space after the last node, after copying the blocks
+    ///  shared with a copy of the graph
     /// @return The iterator to the space after the last node
+    /// @exception UnavailableMemoryException If there isn't enough memory for the copies
     typename my_array::Array<Node<NData>>::iterator end();
 
     /// @brief Copy assignment
@@ -81,7 +203,7 @@ public:
     /// @return The nodes that were moved to
     Nodes<NData, EData>& operator=(Nodes<NData, EData>&& other) noexcept;
 
-    /// @brief Copy constructor with graph
+    /// @brief Copy constructor with graph, shares the blocks of the other nodes
     /// @param other Nodes to copy from
     /// @param graph Pointer to the graph these nodes should belong to
     Nodes(const Nodes<NData, EData>& other, Graph<NData, EData> *graph);
@@ -97,6 +219,25 @@ private:
 
     /// @brief The actual internal storage of the nodes themselves
     my_array::Array<Node<NData>> nodes_;
+
+    /// @brief The property columns of the nodes
+    Properties properties_;
+
+    /// @brief The secondary indexes by name
+    std::map<std::string, CopyOnWrite<NodeIndex<NData>>> indexes_;
+
+    /// @brief Adds a node to every secondary index, copying the indexes shared with a copy first
+    /// @param id The id of the node
+    /// @exception UnavailableMemoryException If there isn't enough memory, the node may be left
+    ///  in some of the indexes, unindex_ removes it
+    void index_(size_t id);
+
+    /// @brief Removes a node from every secondary index it is in
+    /// @param id The id of the node
+    void unindex_(size_t id) noexcept;
+
+    friend Graph<NData, EData>;
+    friend GraphSnapshot<NData, EData>;
 };
 
 /// @brief Prints the given nodes to the given output stream and return the same stream
@@ -112,7 +253,9 @@ std::ostream& operator<<(std::ostream& os, const Nodes<NData, EData>& nodes) {
 }
 
 template<typename NData, typename EData>
-inline Nodes<NData, EData>::Nodes(Graph<NData, EData>* graph) : graph_(graph) {}
+inline Nodes<NData, EData>::Nodes(Graph<NData, EData>* graph) : graph_(graph) {
+    properties_.bound([this] { return nodes_.size(); });
+}
 
 template <typename NData, typename EData>
 void Nodes<NData, EData>::print(std::ostream& os) const {
@@ -123,6 +266,13 @@ void Nodes<NData, EData>::print(std::ostream& os) const {
 
 template <typename NData, typename EData>
 Node<NData>& Nodes<NData, EData>::add(size_t id, NData data) {
+    return emplace(id, std::move(data));
+}
+
+template <typename NData, typename EData>
+template <typename... Args>
+Node<NData>& Nodes<NData, EData>::emplace(size_t id, Args&&... args) {
+    if (graph_->in_batch()) throw InvalidOperationException::adding_directly_inside_batch();
     size_t pre_modification_size = nodes_.size();
     if (id > pre_modification_size)
         throw InvalidIdentifierException::adding_node_invalid_identifier(id, pre_modification_size);
@@ -130,20 +280,26 @@ Node<NData>& Nodes<NData, EData>::add(size_t id, NData data) {
     if (id < pre_modification_size)
         throw ConflictingItemException::adding_node_conflicting_identifier(id);
     try {
-        nodes_.push_back(Node<NData>(id, data));
+        // a shared last block is copied by the array before the node goes in
+        nodes_.emplace_back(id, std::piecewise_construct, std::forward<Args>(args)...);
+        index_(id);
         graph_->edges().grow_adjacency_matrix();
     }
     catch (...) {
-        if (nodes_.size() > pre_modification_size) nodes_.pop_back();
+        if (nodes_.size() > pre_modification_size) {
+            unindex_(id);
+            nodes_.pop_back();
+        }
         throw UnavailableMemoryException::node_container_unable_to_insert();
     }
+    graph_->mark_changed();
 
     return nodes_[nodes_.size() - 1];
 }
 
 template <typename NData, typename EData>
 Node<NData>& Nodes<NData, EData>::add(NData data) {
-    return add(nodes_.size(), data);
+    return emplace(nodes_.size(), std::move(data));
 }
 
 template <typename NData, typename EData>
@@ -157,30 +313,186 @@ bool Nodes<NData, EData>::exists(size_t id) const {
 }
 
 template <typename NData, typename EData>
-Node<NData>& Nodes<NData, EData>::get(size_t id) const {
+const Node<NData>& Nodes<NData, EData>::get(size_t id) const {
     if (!exists(id))
         throw NonexistingItemException::accessing_nonexistant_node(id, size());
-    return const_cast<Node<NData>&>(nodes_[id]);
+    return nodes_[id];
 }
 
 template <typename NData, typename EData>
-Node<NData>& Nodes<NData, EData>::operator[](size_t id) const {
+Node<NData>& Nodes<NData, EData>::get(size_t id) {
+    if (!exists(id))
+        throw NonexistingItemException::accessing_nonexistant_node(id, size());
+    return nodes_[id];
+}
+
+template <typename NData, typename EData>
+const Node<NData>& Nodes<NData, EData>::operator[](size_t id) const {
     return get(id);
 }
 
+template <typename NData, typename EData>
+Node<NData>& Nodes<NData, EData>::operator[](size_t id) {
+    return get(id);
+}
+
+template <typename NData, typename EData>
+template <typename Function>
+void Nodes<NData, EData>::parallel_for_each(Function function, size_t grain, ThreadPool& pool) {
+    nodes_.unshare();
+    pool.parallel_for(0, nodes_.size(), [&](size_t i) {
+        function(nodes_[i]);
+    }, grain);
+}
+
+template <typename NData, typename EData>
+void Nodes<NData, EData>::distribute(const std::vector<NumaPartition>& partitions) const {
+    nodes_.bind_blocks([&](size_t id) { return numa_node_of(partitions, id); });
+}
+
+template <typename NData, typename EData>
+void Nodes<NData, EData>::memory_usage(MemoryUsage& usage) const {
+    size_t used = nodes_.size() * sizeof(Node<NData>);
+    usage.nodes += used;
+    usage.slack += nodes_.memory_usage() - used;
+    if (HeapUsage<NData>::owns_heap) {
+        for (size_t i = 0; i < nodes_.size(); i++) {
+            usage.node_data_heap += HeapUsage<NData>::of(
+                nodes_[i].getData());
+        }
+    }
+    usage.shared += nodes_.shared_memory_usage() + properties_.shared_memory_usage();
+    usage.properties += properties_.memory_usage();
+    for (const auto& index : indexes_) {
+        usage.indexes += index.second.get().memory_usage();
+        if (index.second.is_shared()) usage.shared += index.second.get().memory_usage();
+    }
+}
+
+template <typename NData, typename EData>
+Properties& Nodes<NData, EData>::properties() {
+    return properties_;
+}
+
+template <typename NData, typename EData>
+const Properties& Nodes<NData, EData>::properties() const {
+    return properties_;
+}
+
+template <typename NData, typename EData>
+template <typename Index>
+Index& Nodes<NData, EData>::add_index(const std::string& name, Index index) {
+    if (indexes_.find(name) != indexes_.end())
+        throw ConflictingItemException::adding_conflicting_index(name);
+    std::unique_ptr<NodeIndex<NData>> added(new Index(std::move(index)));
+    for (size_t id = 0; id < nodes_.size(); id++) {
+        added->insert(id, std::as_const(nodes_)[id].getData());
+    }
+    Index& result = static_cast<Index&>(*added);
+    try {
+        indexes_.emplace(name, CopyOnWrite<NodeIndex<NData>>(std::move(added)));
+    }
+    catch (const std::bad_alloc&) {
+        throw UnavailableMemoryException::node_index_unable_to_insert();
+    }
+    return result;
+}
+
+template <typename NData, typename EData>
+template <typename Index>
+const Index& Nodes<NData, EData>::index(const std::string& name) const {
+    auto found = indexes_.find(name);
+    if (found == indexes_.end()) throw NonexistingItemException::accessing_nonexistant_index(name);
+    const Index* index = dynamic_cast<const Index*>(&found->second.get());
+    if (index == nullptr) throw InvalidArgumentException::index_of_another_type(name);
+    return *index;
+}
+
+template <typename NData, typename EData>
+void Nodes<NData, EData>::remove_index(const std::string& name) {
+    indexes_.erase(name);
+}
+
+template <typename NData, typename EData>
+void Nodes<NData, EData>::reindex() {
+    if (indexes_.empty()) return;
+    std::vector<const NData*> data;
+    try {
+        data.reserve(nodes_.size());
+        for (auto& index : indexes_) {
+            index.second.write();
+        }
+    }
+    catch (const std::bad_alloc&) {
+        // an index still shared with a copy of the graph could not be copied away, it is left
+        // as the copy has it
+        throw UnavailableMemoryException::node_index_unable_to_insert();
+    }
+    for (size_t id = 0; id < nodes_.size(); id++) {
+        data.push_back(&std::as_const(nodes_)[id].getData());
+    }
+    for (auto& index : indexes_) {
+        index.second.write().rebuild(data);
+    }
+}
+
+template <typename NData, typename EData>
+const Node<NData>* Nodes<NData, EData>::find(const NData& data) const {
+    size_t id;
+    for (const auto& index : indexes_) {
+        if (!index.second.get().find_data(data, id)) continue;
+        return id == NodeIndex<NData>::NONE ? nullptr : &nodes_[id];
+    }
+    for (id = 0; id < nodes_.size(); id++) {
+        const Node<NData>& node = nodes_[id];
+        if (node.getData() == data) return &node;
+    }
+    return nullptr;
+}
+
+template <typename NData, typename EData>
+void Nodes<NData, EData>::index_(size_t id) {
+    if (indexes_.empty()) return;
+    const NData& data = std::as_const(nodes_)[id].getData();
+    try {
+        for (auto& index : indexes_) {
+            index.second.write().insert(id, data);
+        }
+    }
+    catch (const std::bad_alloc&) {
+        throw UnavailableMemoryException::node_index_unable_to_insert();
+    }
+}
+
+template <typename NData, typename EData>
+void Nodes<NData, EData>::unindex_(size_t id) noexcept {
+    if (indexes_.empty()) return;
+    const NData& data = std::as_const(nodes_)[id].getData();
+    for (auto& index : indexes_) {
+        // an index is unshared before the node goes in, one still shared never got it
+        if (!index.second.is_shared()) index.second.write().erase(id, data);
+    }
+}
+
 template <typename NData, typename EData>
 typename my_array::Array<Node<NData>>::iterator Nodes<NData, EData>::begin() {
+    nodes_.unshare();
     return nodes_.begin();
 }
 
 template <typename NData, typename EData>
 typename my_array::Array<Node<NData>>::iterator Nodes<NData, EData>::end() {
+    nodes_.unshare();
     return nodes_.end();
 }
 
 template <typename NData, typename EData>
 Nodes<NData, EData>& Nodes<NData, EData>::operator=(const Nodes<NData, EData>& other) {
+    std::map<std::string, CopyOnWrite<NodeIndex<NData>>> indexes(other.indexes_);
+    Properties properties(other.properties_);
     nodes_ = other.nodes_;
+    properties_ = std::move(properties);
+    indexes_.swap(indexes);
     return *this;
 }
 
@@ -188,18 +500,26 @@ template <typename NData, typename EData>
 Nodes<NData, EData>& Nodes<NData, EData>::operator=(Nodes<NData, EData>&& other) noexcept{
     if (this != &other) {
         std::swap(nodes_, other.nodes_);
+        std::swap(properties_, other.properties_);
+        indexes_.swap(other.indexes_);
     }
     return *this;
 }
 
 template <typename NData, typename EData>
 Nodes<NData, EData>::Nodes(const Nodes<NData, EData>& other, Graph<NData, EData>* graph)
-        : graph_(graph), nodes_(other.nodes_) {}
+        : graph_(graph), nodes_(other.nodes_), properties_(other.properties_),
+        indexes_(other.indexes_) {
+    properties_.bound([this] { return nodes_.size(); });
+}
 
 template <typename NData, typename EData>
 Nodes<NData, EData>::Nodes(Nodes<NData, EData>&& other, Graph<NData, EData>* graph) noexcept 
         : graph_(graph) {
     std::swap(nodes_, other.nodes_);
+    std::swap(properties_, other.properties_);
+    indexes_.swap(other.indexes_);
+    properties_.bound([this] { return nodes_.size(); });
 }
 
 
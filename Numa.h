@@ -0,0 +1,246 @@
+#ifndef __NUMA_H
+#define __NUMA_H
+
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <algorithm>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+/// @file Numa.h
+/// @brief Contains the NUMA topology, memory binding and the NumaPartition used for splitting
+///  node ranges between the NUMA nodes
+
+
+/// @brief A range of graph node ids stored on and processed by a single NUMA node
+struct NumaPartition {
+    /// @brief The first node id of the range
+    size_t begin;
+
+    /// @brief The node id after the last node id of the range
+    size_t end;
+
+    /// @brief The NUMA node of the range
+    size_t numa_node;
+};
+
+/// @brief The NUMA nodes of the machine and their hardware threads
+class NumaTopology {
+public:
+    /// @brief Get the topology of the machine, read once on first use; a machine without
+    ///  NUMA support is a single node with all hardware threads
+    /// @return The topology
+    static const NumaTopology& get();
+
+    /// @brief Get the number of NUMA nodes
+    /// @return The number of NUMA nodes, at least one
+    size_t node_count() const;
+
+    /// @brief Get the hardware threads of a NUMA node
+    /// @param node The index of the NUMA node
+    /// @return The ids of the hardware threads
+    const std::vector<size_t>& cpus(size_t node) const;
+
+    /// @brief Get the system id of a NUMA node, the ids do not have to be contiguous
+    /// @param node The index of the NUMA node
+    /// @return The system id of the node
+    size_t system_id(size_t node) const;
+
+private:
+    /// @brief Reads the topology of the machine
+    NumaTopology();
+
+    /// @brief Parses a linux cpu or node list like 0-3,8-11
+    /// @param list The list
+    /// @return The ids inside the list
+    static std::vector<size_t> parse_list_(const std::string& list);
+
+    /// @brief The system ids of the nodes
+    std::vector<size_t> ids_;
+
+    /// @brief The hardware threads of every node
+    std::vector<std::vector<size_t>> cpus_;
+};
+
+/// @brief Moves the pages of the given memory to the given NUMA node and keeps them there, the
+///  whole pages overlapping the memory move, memory sharing those pages included
+/// @param memory The start of the memory
+/// @param bytes The size of the memory
+/// @param node The index of the NUMA node
+/// @return True if the memory was bound, false if binding is not supported or failed,
+///  the memory stays where the first thread touching it put it then
+bool numa_bind(const void* memory, size_t bytes, size_t node);
+
+/// @brief Splits the ids 0...n-1 into contiguous ranges of about the same total weight,
+///  one range per NUMA node
+/// @param weights The weight of every id, like its degree
+/// @param parts The number of ranges
+/// @return The ranges, range i belongs to NUMA node i; ranges may be empty
+std::vector<NumaPartition> numa_partitions(const std::vector<size_t>& weights, size_t parts);
+
+/// @brief Finds the NUMA node of the range containing an id
+/// @param partitions The contiguous ranges, sorted by their ids
+/// @param id The id
+/// @return The NUMA node of the range containing the id, of the last range for ids past it
+///  and 0 if there are no ranges
+size_t numa_node_of(const std::vector<NumaPartition>& partitions, size_t id);
+
+inline NumaTopology::NumaTopology() {
+#if defined(_WIN32)
+    ULONG highest = 0;
+    if (GetNumaHighestNodeNumber(&highest)) {
+        for (ULONG node = 0; node <= highest; node++) {
+            ULONGLONG mask = 0;
+            if (!GetNumaNodeProcessorMask(static_cast<UCHAR>(node), &mask) || mask == 0) continue;
+            std::vector<size_t> cpus;
+            for (size_t cpu = 0; cpu < 64; cpu++) {
+                if ((mask >> cpu) & 1) cpus.push_back(cpu);
+            }
+            ids_.push_back(node);
+            cpus_.push_back(cpus);
+        }
+    }
+#elif defined(__linux__)
+    std::ifstream online("/sys/devices/system/node/online");
+    std::string list;
+    if (online.good() && std::getline(online, list)) {
+        for (size_t node : parse_list_(list)) {
+            std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(node) +
+                "/cpulist");
+            std::string cpus;
+            if (!cpulist.good() || !std::getline(cpulist, cpus)) continue;
+            std::vector<size_t> parsed = parse_list_(cpus);
+            // memory-only nodes have no threads to run the partitions on
+            if (parsed.empty()) continue;
+            ids_.push_back(node);
+            cpus_.push_back(parsed);
+        }
+    }
+#endif
+    if (ids_.empty()) {
+        size_t hardware = std::max(std::thread::hardware_concurrency(), 1u);
+        std::vector<size_t> cpus;
+        for (size_t cpu = 0; cpu < hardware; cpu++) {
+            cpus.push_back(cpu);
+        }
+        ids_.push_back(0);
+        cpus_.push_back(cpus);
+    }
+}
+
+inline const NumaTopology& NumaTopology::get() {
+    static NumaTopology topology;
+    return topology;
+}
+
+inline size_t NumaTopology::node_count() const {
+    return ids_.size();
+}
+
+inline const std::vector<size_t>& NumaTopology::cpus(size_t node) const {
+    return cpus_[node];
+}
+
+inline size_t NumaTopology::system_id(size_t node) const {
+    return ids_[node];
+}
+
+inline std::vector<size_t> NumaTopology::parse_list_(const std::string& list) {
+    std::vector<size_t> ids;
+    std::istringstream iss(list);
+    std::string range;
+    while (std::getline(iss, range, ',')) {
+        try {
+            size_t dash = range.find('-');
+            size_t first = std::stoul(range.substr(0, dash));
+            size_t last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+            for (size_t id = first; id <= last; id++) {
+                ids.push_back(id);
+            }
+        }
+        catch (...) {
+            // skip what cannot be parsed
+        }
+    }
+    return ids;
+}
+
+inline bool numa_bind(const void* memory, size_t bytes, size_t node) {
+    if (memory == nullptr || bytes == 0) return false;
+    const NumaTopology& topology = NumaTopology::get();
+    if (topology.node_count() < 2 || node >= topology.node_count()) return false;
+#if defined(__linux__) && defined(SYS_mbind)
+    const unsigned long MPOL_PREFERRED_MODE = 1;
+    const unsigned long MPOL_MF_MOVE_FLAG = 1 << 1;
+    const size_t MASK_BITS = 1024;
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t start = reinterpret_cast<uintptr_t>(memory) & ~(uintptr_t(page) - 1);
+    uintptr_t end = (reinterpret_cast<uintptr_t>(memory) + bytes + page - 1) &
+        ~(uintptr_t(page) - 1);
+    size_t id = topology.system_id(node);
+    if (id >= MASK_BITS) return false;
+    unsigned long mask[MASK_BITS / (8 * sizeof(unsigned long))] = {};
+    mask[id / (8 * sizeof(unsigned long))] = 1ul << (id % (8 * sizeof(unsigned long)));
+    return syscall(SYS_mbind, start, end - start, MPOL_PREFERRED_MODE, mask, MASK_BITS + 1,
+        MPOL_MF_MOVE_FLAG) == 0;
+#else
+    // windows can only place memory when allocating it, first touch does the job there
+    return false;
+#endif
+}
+
+inline std::vector<NumaPartition> numa_partitions(const std::vector<size_t>& weights,
+        size_t parts) {
+    parts = std::max<size_t>(parts, 1);
+    double total = 0;
+    for (size_t weight : weights) {
+        total += static_cast<double>(weight);
+    }
+    std::vector<NumaPartition> partitions;
+    size_t begin = 0;
+    double seen = 0;
+    for (size_t part = 0; part < parts; part++) {
+        size_t end = begin;
+        if (part + 1 == parts) {
+            end = weights.size();
+        }
+        else {
+            double target = total * static_cast<double>(part + 1) / static_cast<double>(parts);
+            while (end < weights.size() && seen + static_cast<double>(weights[end]) / 2 < target) {
+                seen += static_cast<double>(weights[end]);
+                ++end;
+            }
+        }
+        partitions.push_back({ begin, end, part });
+        begin = end;
+    }
+    return partitions;
+}
+
+inline size_t numa_node_of(const std::vector<NumaPartition>& partitions, size_t id) {
+    if (partitions.empty()) return 0;
+    auto it = std::upper_bound(partitions.begin(), partitions.end(), id,
+        [](size_t value, const NumaPartition& partition) { return value < partition.end; });
+    if (it == partitions.end()) --it;
+    return it->numa_node;
+}
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,576 @@
+#ifndef __PAGE_CACHE_H
+#define __PAGE_CACHE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "Exceptions.h"
+
+
+/// @file PageCache.h
+/// @brief Contains the PageCache keeping the pages of a file inside a bounded pool of frames,
+///  the PagedArray storing trivially copyable elements in those pages and their member
+///  function definitions
+
+
+/// @brief The input and output done by a page cache, for checking that a workload reads and
+///  writes what it is expected to
+struct PageCacheStats {
+    /// @brief The number of pins finding their page inside a frame
+    size_t hits = 0;
+
+    /// @brief The number of pins loading their page first
+    size_t misses = 0;
+
+    /// @brief The number of pages loaded by prefetch hints
+    size_t prefetched = 0;
+
+    /// @brief The number of pages dropped from their frame to make room for another
+    size_t evictions = 0;
+
+    /// @brief The number of pages read from the file
+    size_t reads = 0;
+
+    /// @brief The number of pages written to the file
+    size_t writes = 0;
+};
+
+/// @brief Keeps the pages of a scratch file inside a fixed number of frames, so data larger than
+///  the memory is read and written a page at a time. The frame of a page is chosen by CLOCK
+///  eviction: a hand sweeps the frames, skips pinned ones, clears the reference bit of recently
+///  used ones and takes the first unreferenced one, writing it back if it is dirty. Not thread
+///  safe, like the graph itself
+class PageCache {
+public:
+    /// @brief The default size of a page in bytes
+    static const size_t DEFAULT_PAGE_SIZE = 64 * 1024;
+
+    /// @brief The default number of frames, 16 MiB with the default page size
+    static const size_t DEFAULT_FRAMES = 256;
+
+    /// @brief Creates the scratch file, replacing an existing one, and allocates the frames
+    /// @param filename The name of the file, removed again when the cache is destroyed
+    /// @param frames The number of pages kept in memory at a time, at least 2
+    /// @param page_size The size of a page in bytes
+    /// @exception FileProcessingException If the file cannot be created
+    /// @exception UnavailableMemoryException If the frames cannot be allocated
+    PageCache(const std::string& filename, size_t frames = DEFAULT_FRAMES,
+        size_t page_size = DEFAULT_PAGE_SIZE);
+
+    /// @brief Closes and removes the scratch file, the dirty pages are dropped
+    ~PageCache();
+
+    PageCache(const PageCache& other) = delete;
+    PageCache& operator=(const PageCache& other) = delete;
+
+    /// @brief Adds a new zeroed page to the file, it is written once it is evicted
+    /// @return The number of the page
+    size_t allocate();
+
+    /// @brief Keeps a page inside a frame until it is unpinned, loading it first if needed
+    /// @param page The number of the page, returned by allocate
+    /// @return The bytes of the page, valid until the page is unpinned
+    /// @exception UnavailableMemoryException If every frame is pinned
+    /// @exception FileProcessingException If the page cannot be read, or a dirty page cannot be
+    ///  written back to make room for it
+    uint8_t* pin(size_t page);
+
+    /// @brief Lets a pinned page be evicted again
+    /// @param page The number of the page
+    /// @param dirty True if the bytes of the page were changed and have to be written back
+    void unpin(size_t page, bool dirty);
+
+    /// @brief Hints that pages will be pinned soon, so they are read ahead in file order; loads
+    ///  what fits into unpinned frames and ignores the rest, a hint never fails
+    /// @param first The number of the first page
+    /// @param count The number of pages
+    void prefetch(size_t first, size_t count);
+
+    /// @brief Writes every dirty page back to the file
+    /// @exception FileProcessingException If a page cannot be written
+    void flush();
+
+    /// @brief Get the size of a page
+    /// @return The number of bytes of a page
+    size_t page_size() const;
+
+    /// @brief Get the number of frames
+    /// @return The number of pages kept in memory at a time
+    size_t frame_count() const;
+
+    /// @brief Get the number of allocated pages
+    /// @return The number of pages
+    size_t page_count() const;
+
+    /// @brief Estimates the memory held by the cache, its frames and its tables
+    /// @return The number of bytes
+    size_t memory_usage() const;
+
+    /// @brief Get the input and output done so far
+    /// @return The counters
+    const PageCacheStats& stats() const;
+
+private:
+    /// @brief The state of a frame
+    struct Frame {
+        /// @brief The page inside the frame, only meaningful if used
+        size_t page = 0;
+
+        /// @brief The number of pins keeping the page inside the frame
+        size_t pins = 0;
+
+        /// @brief True if the frame holds a page
+        bool used = false;
+
+        /// @brief Set on every use, cleared by the sweeping hand
+        bool referenced = false;
+
+        /// @brief True if the page has to be written back before the frame is reused
+        bool dirty = false;
+    };
+
+    /// @brief Sweeps the hand until it finds a frame that can be reused, writing its page back
+    ///  if it is dirty
+    /// @param frame The frame found
+    /// @return False if every frame is pinned
+    /// @exception FileProcessingException If the dirty page cannot be written
+    bool find_victim_(size_t& frame);
+
+    /// @brief Reads a page into a frame, a page never written reads as zeros
+    /// @param frame The frame
+    /// @param page The number of the page
+    /// @exception FileProcessingException If the page cannot be read
+    void load_(size_t frame, size_t page);
+
+    /// @brief Writes the page of a frame back to the file if it is dirty
+    /// @param frame The frame
+    /// @exception FileProcessingException If the page cannot be written
+    void write_back_(size_t frame);
+
+    /// @brief Get the bytes of a frame
+    /// @param frame The frame
+    /// @return The bytes
+    uint8_t* bytes_(size_t frame) const;
+
+    /// @brief The name of the scratch file
+    std::string filename_;
+
+    /// @brief The scratch file
+    std::fstream file_;
+
+    /// @brief The size of a page
+    size_t page_size_;
+
+    /// @brief The memory of all frames, one page after another
+    std::unique_ptr<uint8_t[]> memory_;
+
+    /// @brief The state of every frame
+    std::vector<Frame> frames_;
+
+    /// @brief The frame of every page inside the pool
+    std::unordered_map<size_t, size_t> table_;
+
+    /// @brief The frame the sweeping hand points to
+    size_t hand_;
+
+    /// @brief The number of allocated pages
+    size_t page_count_;
+
+    /// @brief The number of pages the file holds, pages past it read as zeros
+    size_t pages_on_disk_;
+
+    /// @brief The input and output done so far
+    PageCacheStats stats_;
+};
+
+/// @brief An append-only array of trivially copyable elements stored in the pages of a
+///  PageCache; elements are copied in and out, since a page may be evicted as soon as it is
+///  unpinned. The table of its pages stays in memory, 8 bytes per page
+/// @tparam element The element of the array
+template <typename element>
+class PagedArray {
+public:
+    static_assert(std::is_trivially_copyable<element>::value,
+        "paged elements are copied to and from the file byte by byte");
+
+    /// @brief The number of pages read ahead by sequential scans
+    static const size_t READAHEAD = 8;
+
+    /// @brief Constructs an empty array inside the given cache
+    /// @param cache The cache, has to outlive the array
+    /// @exception InvalidArgumentException If an element does not fit a page
+    explicit PagedArray(PageCache& cache);
+
+    /// @brief Add an element to the end of the array
+    /// @param item The element
+    /// @exception The exceptions of PageCache::pin
+    void push_back(const element& item);
+
+    /// @brief Get the element at a given index
+    /// @param index The index, smaller than the size
+    /// @return A copy of the element
+    /// @exception The exceptions of PageCache::pin
+    element get(size_t index) const;
+
+    /// @brief Replace the element at a given index
+    /// @param index The index, smaller than the size
+    /// @param item The new element
+    /// @exception The exceptions of PageCache::pin
+    void set(size_t index, const element& item);
+
+    /// @brief Get the number of elements inside the array
+    /// @return The count of elements of the array
+    size_t size() const;
+
+    /// @brief Removes the last element, its page is kept
+    void pop_back();
+
+    /// @brief Removes all elements, the pages are kept and filled again by push_back
+    void clear();
+
+    /// @brief Get the number of elements stored inside a page
+    /// @return The number of elements
+    size_t per_page() const;
+
+    /// @brief Get the memory held by the table of the pages, the elements live in the cache
+    /// @return The number of bytes
+    size_t memory_usage() const;
+
+    /// @brief Hints that a range of elements will be read soon
+    /// @param first The index of the first element
+    /// @param count The number of elements
+    void prefetch(size_t first, size_t count) const;
+
+    /// @brief Calls the given function for a range of elements in order, pinning each page once
+    ///  and reading up to READAHEAD pages of the range ahead of the scan
+    /// @tparam Function A callable taking the index and a const reference to an element
+    /// @param first The index of the first element
+    /// @param last The index after the last element
+    /// @param function The function to call, it may use the cache while the scan keeps one
+    ///  page pinned
+    /// @exception The exceptions of PageCache::pin and of the function
+    template <typename Function>
+    void scan(size_t first, size_t last, Function function) const;
+
+private:
+    /// @brief Pins the page of an element, unpinning it when destroyed
+    class Pinned;
+
+    /// @brief The cache holding the pages
+    PageCache* cache_;
+
+    /// @brief The pages of the array in order
+    std::vector<size_t> pages_;
+
+    /// @brief The number of elements stored inside a page
+    size_t per_page_;
+
+    /// @brief The number of elements inside the array
+    size_t size_;
+};
+
+template <typename element>
+class PagedArray<element>::Pinned {
+public:
+    /// @brief Pins a page
+    /// @param cache The cache
+    /// @param page The number of the page
+    Pinned(PageCache& cache, size_t page);
+
+    /// @brief Unpins the page, dirty if it was written
+    ~Pinned();
+
+    Pinned(const Pinned& other) = delete;
+    Pinned& operator=(const Pinned& other) = delete;
+
+    /// @brief The element at a given position of the page
+    /// @param slot The position
+    /// @return The bytes of the element
+    uint8_t* at(size_t slot) const;
+
+    /// @brief True if the page has to be written back
+    bool dirty;
+
+private:
+    /// @brief The cache
+    PageCache& cache_;
+
+    /// @brief The number of the page
+    size_t page_;
+
+    /// @brief The bytes of the page
+    uint8_t* bytes_;
+};
+
+inline PageCache::PageCache(const std::string& filename, size_t frames, size_t page_size)
+        : filename_(filename), page_size_(page_size), hand_(0), page_count_(0),
+        pages_on_disk_(0) {
+    frames = std::max<size_t>(frames, 2);
+    try {
+        memory_.reset(new uint8_t[frames * page_size_]);
+        frames_.resize(frames);
+        table_.reserve(frames);
+    }
+    catch (const std::bad_alloc&) {
+        throw UnavailableMemoryException::page_cache_unable_to_allocate();
+    }
+    file_.open(filename_, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file_.good()) throw FileProcessingException::unable_to_open_output_file(filename_);
+}
+
+inline PageCache::~PageCache() {
+    file_.close();
+    std::remove(filename_.c_str());
+}
+
+inline uint8_t* PageCache::bytes_(size_t frame) const {
+    return memory_.get() + frame * page_size_;
+}
+
+inline size_t PageCache::allocate() {
+    return page_count_++;
+}
+
+inline void PageCache::write_back_(size_t frame) {
+    Frame& state = frames_[frame];
+    if (!state.used || !state.dirty) return;
+    // writing past the end of the file fills the gap with zeros
+    file_.seekp(static_cast<std::streamoff>(state.page * page_size_));
+    file_.write(reinterpret_cast<const char*>(bytes_(frame)),
+        static_cast<std::streamsize>(page_size_));
+    if (!file_.good()) {
+        file_.clear();
+        throw FileProcessingException::unable_to_write_page(filename_, state.page);
+    }
+    state.dirty = false;
+    pages_on_disk_ = std::max(pages_on_disk_, state.page + 1);
+    ++stats_.writes;
+}
+
+inline void PageCache::load_(size_t frame, size_t page) {
+    if (page < pages_on_disk_) {
+        file_.seekg(static_cast<std::streamoff>(page * page_size_));
+        file_.read(reinterpret_cast<char*>(bytes_(frame)),
+            static_cast<std::streamsize>(page_size_));
+        if (!file_.good()) {
+            file_.clear();
+            throw FileProcessingException::unable_to_read_page(filename_, page);
+        }
+        ++stats_.reads;
+    }
+    else {
+        std::memset(bytes_(frame), 0, page_size_);
+    }
+    Frame& state = frames_[frame];
+    state.page = page;
+    state.used = true;
+    state.referenced = true;
+    state.dirty = false;
+    table_[page] = frame;
+}
+
+inline bool PageCache::find_victim_(size_t& frame) {
+    // two full sweeps clear every reference bit, a third finds nothing only if all are pinned
+    for (size_t step = 0; step < 3 * frames_.size(); step++) {
+        size_t candidate = hand_;
+        hand_ = (hand_ + 1) % frames_.size();
+        Frame& state = frames_[candidate];
+        if (state.pins != 0) continue;
+        if (state.referenced) {
+            state.referenced = false;
+            continue;
+        }
+        if (state.used) {
+            write_back_(candidate);
+            table_.erase(state.page);
+            state.used = false;
+            ++stats_.evictions;
+        }
+        frame = candidate;
+        return true;
+    }
+    return false;
+}
+
+inline uint8_t* PageCache::pin(size_t page) {
+    auto found = table_.find(page);
+    if (found != table_.end()) {
+        Frame& state = frames_[found->second];
+        ++state.pins;
+        state.referenced = true;
+        ++stats_.hits;
+        return bytes_(found->second);
+    }
+    size_t frame = 0;
+    if (!find_victim_(frame)) throw UnavailableMemoryException::page_cache_all_frames_pinned();
+    load_(frame, page);
+    ++frames_[frame].pins;
+    ++stats_.misses;
+    return bytes_(frame);
+}
+
+inline void PageCache::unpin(size_t page, bool dirty) {
+    Frame& state = frames_[table_.at(page)];
+    --state.pins;
+    state.dirty = state.dirty || dirty;
+}
+
+inline void PageCache::prefetch(size_t first, size_t count) {
+    // never take more than half of the frames, so a hint cannot push out the working set
+    size_t budget = frames_.size() / 2;
+    for (size_t page = first; page < first + count && page < page_count_ && budget > 0; page++) {
+        if (table_.count(page) != 0) continue;
+        size_t frame = 0;
+        try {
+            if (!find_victim_(frame)) return;
+            load_(frame, page);
+        }
+        catch (const FileProcessingException&) {
+            // the pin will report it
+            return;
+        }
+        ++stats_.prefetched;
+        --budget;
+    }
+}
+
+inline void PageCache::flush() {
+    for (size_t frame = 0; frame < frames_.size(); frame++) {
+        write_back_(frame);
+    }
+    file_.flush();
+}
+
+inline size_t PageCache::page_size() const {
+    return page_size_;
+}
+
+inline size_t PageCache::frame_count() const {
+    return frames_.size();
+}
+
+inline size_t PageCache::page_count() const {
+    return page_count_;
+}
+
+inline size_t PageCache::memory_usage() const {
+    // a node of the table holds the entry and the link to the next node
+    return frames_.size() * page_size_ + frames_.capacity() * sizeof(Frame) +
+        table_.bucket_count() * sizeof(void*) +
+        table_.size() * (sizeof(std::pair<const size_t, size_t>) + sizeof(void*));
+}
+
+inline const PageCacheStats& PageCache::stats() const {
+    return stats_;
+}
+
+template <typename element>
+PagedArray<element>::Pinned::Pinned(PageCache& cache, size_t page)
+    : dirty(false), cache_(cache), page_(page), bytes_(cache.pin(page)) {}
+
+template <typename element>
+PagedArray<element>::Pinned::~Pinned() {
+    cache_.unpin(page_, dirty);
+}
+
+template <typename element>
+uint8_t* PagedArray<element>::Pinned::at(size_t slot) const {
+    return bytes_ + slot * sizeof(element);
+}
+
+template <typename element>
+PagedArray<element>::PagedArray(PageCache& cache)
+        : cache_(&cache), per_page_(cache.page_size() / sizeof(element)), size_(0) {
+    if (per_page_ == 0)
+        throw InvalidArgumentException::paged_element_larger_than_page(sizeof(element),
+            cache.page_size());
+}
+
+template <typename element>
+void PagedArray<element>::push_back(const element& item) {
+    if (size_ == pages_.size() * per_page_) pages_.push_back(cache_->allocate());
+    Pinned pinned(*cache_, pages_[size_ / per_page_]);
+    std::memcpy(pinned.at(size_ % per_page_), &item, sizeof(element));
+    pinned.dirty = true;
+    ++size_;
+}
+
+template <typename element>
+element PagedArray<element>::get(size_t index) const {
+    Pinned pinned(*cache_, pages_[index / per_page_]);
+    // trivially copyable elements need not be default constructible
+    typename std::aligned_storage<sizeof(element), alignof(element)>::type storage;
+    std::memcpy(&storage, pinned.at(index % per_page_), sizeof(element));
+    return *reinterpret_cast<element*>(&storage);
+}
+
+template <typename element>
+void PagedArray<element>::set(size_t index, const element& item) {
+    Pinned pinned(*cache_, pages_[index / per_page_]);
+    std::memcpy(pinned.at(index % per_page_), &item, sizeof(element));
+    pinned.dirty = true;
+}
+
+template <typename element>
+size_t PagedArray<element>::size() const {
+    return size_;
+}
+
+template <typename element>
+void PagedArray<element>::pop_back() {
+    --size_;
+}
+
+template <typename element>
+void PagedArray<element>::clear() {
+    size_ = 0;
+}
+
+template <typename element>
+size_t PagedArray<element>::per_page() const {
+    return per_page_;
+}
+
+template <typename element>
+size_t PagedArray<element>::memory_usage() const {
+    return pages_.capacity() * sizeof(size_t);
+}
+
+template <typename element>
+void PagedArray<element>::prefetch(size_t first, size_t count) const {
+    if (count == 0 || first >= size_) return;
+    size_t last = std::min(first + count, size_) - 1;
+    // the pages of an array are allocated in order, but other arrays may sit in between
+    for (size_t page = first / per_page_; page <= last / per_page_; page++) {
+        cache_->prefetch(pages_[page], 1);
+    }
+}
+
+template <typename element>
+template <typename Function>
+void PagedArray<element>::scan(size_t first, size_t last, Function function) const {
+    last = std::min(last, size_);
+    typename std::aligned_storage<sizeof(element), alignof(element)>::type storage;
+    element& item = *reinterpret_cast<element*>(&storage);
+    for (size_t index = first; index < last;) {
+        size_t page = index / per_page_;
+        Pinned pinned(*cache_, pages_[page]);
+        size_t end = std::min(last, (page + 1) * per_page_);
+        // pinned first, so reading ahead cannot evict the page being scanned
+        prefetch(end, std::min(last - end, READAHEAD * per_page_));
+        for (; index < end; index++) {
+            std::memcpy(&storage, pinned.at(index % per_page_), sizeof(element));
+            function(index, static_cast<const element&>(item));
+        }
+    }
+}
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,549 @@
+#ifndef __PAGED_GRAPH_H
+#define __PAGED_GRAPH_H
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Exceptions.h"
+#include "Graph.h"
+#include "MemoryUsage.h"
+#include "PageCache.h"
+
+
+/// @file PagedGraph.h
+/// @brief Contains the PagedGraph keeping a graph larger than the memory inside a file paged
+///  through a PageCache, and its member function definitions
+
+
+/// @brief A graph stored out of core: the node data, the endpoint and data columns of the edges
+///  and a compressed sparse row index of the neighbors all live in the pages of a scratch file,
+///  only the frames of its PageCache and the tables of the pages stay in memory. Nodes and edges
+///  are identified by their ids and copied in and out, as a page may be evicted at any time.
+///  Imports and prints the format of Graph, scans read their pages ahead, so the input and
+///  output of a scan is one read per page, and the index is built by scans alone. Unlike Graph,
+///  adding an edge does not look for an existing edge between the same nodes
+/// @tparam NData The data associated with the nodes, trivially copyable like InternedString
+/// @tparam EData The data associated with the edges, trivially copyable like InternedString
+template <typename NData, typename EData>
+class PagedGraph {
+public:
+    /// @brief Constructs an empty graph inside a new scratch file
+    /// @param filename The name of the scratch file, removed again with the graph
+    /// @param undirected True if every edge connects its nodes both ways
+    /// @param frames The number of pages kept in memory at a time
+    /// @param page_size The size of a page in bytes
+    /// @exception FileProcessingException If the file cannot be created
+    /// @exception UnavailableMemoryException If the frames cannot be allocated
+    PagedGraph(const std::string& filename, bool undirected = false,
+        size_t frames = PageCache::DEFAULT_FRAMES, size_t page_size = PageCache::DEFAULT_PAGE_SIZE);
+
+    /// @brief Returns if the graph is or is not undirected
+    /// @return True if the graph is undirected, false if it is directed
+    bool is_undirected() const;
+
+    /// @brief Add a node
+    /// @param data The node data
+    /// @return The id of the node
+    /// @exception The exceptions of PageCache::pin
+    size_t add_node(const NData& data);
+
+    /// @brief Add an edge, the index of the neighbors is built again before the next traversal
+    /// @param source The id of the source node
+    /// @param target The id of the target node
+    /// @param data The edge data
+    /// @return The id of the edge
+    /// @exception NonexistingItemException If the source or target node does not exist
+    /// @exception The exceptions of PageCache::pin
+    size_t add_edge(size_t source, size_t target, const EData& data);
+
+    /// @brief Returns the number of the nodes
+    /// @return The number of nodes
+    size_t node_count() const;
+
+    /// @brief Returns the number of the edges
+    /// @return The number of edges
+    size_t edge_count() const;
+
+    /// @brief Gets the data of a node
+    /// @param id The id of the node
+    /// @return A copy of the node data
+    /// @exception NonexistingItemException If no node with the given id exists
+    NData node(size_t id) const;
+
+    /// @brief Replaces the data of a node
+    /// @param id The id of the node
+    /// @param data The new node data
+    /// @exception NonexistingItemException If no node with the given id exists
+    void set_node(size_t id, const NData& data);
+
+    /// @brief Gets the data of an edge
+    /// @param id The id of the edge
+    /// @return A copy of the edge data
+    /// @exception NonexistingItemException If no edge with the given id exists
+    EData edge(size_t id) const;
+
+    /// @brief Replaces the data of an edge
+    /// @param id The id of the edge
+    /// @param data The new edge data
+    /// @exception NonexistingItemException If no edge with the given id exists
+    void set_edge(size_t id, const EData& data);
+
+    /// @brief Gets the source node of an edge
+    /// @param id The id of the edge
+    /// @return The id of the source node
+    /// @exception NonexistingItemException If no edge with the given id exists
+    size_t source(size_t id) const;
+
+    /// @brief Gets the target node of an edge
+    /// @param id The id of the edge
+    /// @return The id of the target node
+    /// @exception NonexistingItemException If no edge with the given id exists
+    size_t target(size_t id) const;
+
+    /// @brief Calls the given function for every node in id order, reading ahead
+    /// @tparam Function A callable taking the id and a const reference to the node data
+    /// @param function The function to call
+    template <typename Function>
+    void for_each_node(Function function) const;
+
+    /// @brief Calls the given function for every edge in id order, reading ahead
+    /// @tparam Function A callable taking the id, the source, the target and a const reference
+    ///  to the edge data
+    /// @param function The function to call
+    template <typename Function>
+    void for_each_edge(Function function) const;
+
+    /// @brief Builds the compressed sparse row index of the neighbors from the endpoint columns
+    ///  by a bucket sort: a scan of the edges appends every neighbor to the run of a range of
+    ///  source nodes, then every run is read, sorted by its source in memory and appended to the
+    ///  index, so every page is read and written in order. A run takes about as many bytes as
+    ///  the frames hold, up to a quarter as many runs as frames; the pages of the runs are kept
+    ///  for the next build
+    /// @exception std::bad_alloc If a run does not fit into the memory
+    /// @exception The exceptions of PageCache::pin
+    void build_index();
+
+    /// @brief Calls the given function for every neighbor of a node, in the order the edges were
+    ///  added; builds the index first if edges were added since it was last built
+    /// @tparam Function A callable taking the id of the neighbor and the id of the edge
+    /// @param source The id of the node
+    /// @param function The function to call
+    /// @exception NonexistingItemException If the node does not exist
+    template <typename Function>
+    void for_each_neighbor(size_t source, Function function);
+
+    /// @brief Visits the nodes reachable from a node in breadth first order, a level at a time;
+    ///  every level is sorted by id, so the index is read in file order. Keeps a bit per node and
+    ///  the current and next levels in memory
+    /// @tparam Function A callable taking the id of a node and its distance from the start
+    /// @param start The id of the node to start from
+    /// @param visit The function to call
+    /// @exception NonexistingItemException If the node does not exist
+    template <typename Function>
+    void breadth_first(size_t start, Function visit);
+
+    /// @brief Prints the graph in the format of Graph::print, reading ahead
+    /// @param os The output stream
+    /// @exception InvalidStreamException If the output stream is not good
+    void print(std::ostream& os = std::cout) const;
+
+    /// @brief Prints the graph to a file with the specified filename
+    /// @param filename The name of the file to print to
+    /// @exception FileProcessingException If the output file is not good
+    void print(const std::string& filename) const;
+
+    /// @brief Imports the format of Graph::import from the given input stream; the ids of the
+    ///  nodes and edges have to come in order, like when adding them to a Graph
+    /// @param is The input stream
+    /// @exception InvalidStreamException If the input stream is not good
+    /// @exception InvalidIdentifierException If an id skips ahead
+    /// @exception ConflictingItemException If an id is already taken
+    /// @exception NonexistingItemException If an edge connects nodes that do not exist
+    void import(std::istream& is);
+
+    /// @brief Imports the graph from a file with the given filename
+    /// @param filename The name of the file to import from
+    /// @exception FileProcessingException If the input file is not good
+    void import(const std::string& filename);
+
+    /// @brief Writes every changed page back to the scratch file
+    /// @exception FileProcessingException If a page cannot be written
+    void flush();
+
+    /// @brief Get the input and output done so far
+    /// @return The counters of the page cache
+    const PageCacheStats& stats() const;
+
+    /// @brief Get the memory used by the graph: the frames of the page cache and its tables,
+    ///  and the tables of the pages of the columns as slack; the nodes, edges and the index lie
+    ///  in the scratch file and only take memory while their pages are inside the frames
+    /// @return The memory usage by component
+    MemoryUsage memory_usage() const;
+
+private:
+    /// @brief A neighbor of a node on its way into the index
+    struct IndexEntry {
+        /// @brief The id of the node
+        size_t node;
+
+        /// @brief The id of the neighbor
+        size_t neighbor;
+
+        /// @brief The id of the edge leading to the neighbor
+        size_t edge;
+    };
+
+    /// @brief The pages of all the columns
+    PageCache cache_;
+
+    /// @brief True if every edge connects its nodes both ways
+    bool undirected_;
+
+    /// @brief The data of every node, by node id
+    PagedArray<NData> node_data_;
+
+    /// @brief The id of the source node of every edge, by edge id
+    PagedArray<size_t> sources_;
+
+    /// @brief The id of the target node of every edge, by edge id
+    PagedArray<size_t> targets_;
+
+    /// @brief The data of every edge, by edge id
+    PagedArray<EData> edge_data_;
+
+    /// @brief Where the neighbors of every node start inside neighbors_, and the end after them
+    PagedArray<size_t> offsets_;
+
+    /// @brief The neighbors of every node one after another
+    PagedArray<size_t> neighbors_;
+
+    /// @brief The edge leading to every neighbor
+    PagedArray<size_t> neighbor_edges_;
+
+    /// @brief The runs of the neighbors of a range of nodes between the passes of build_index
+    std::vector<PagedArray<IndexEntry>> runs_;
+
+    /// @brief True if the index covers every edge
+    bool indexed_;
+
+    /// @brief Adds a node or an edge parsed from the import format
+    /// @param record The record
+    void apply_(const ImportRecord<NData, EData>& record);
+};
+
+/// @brief Prints the given paged graph to the given output stream and returns the same stream
+/// @tparam NData The data associated with the nodes
+/// @tparam EData The data associated with the edges
+/// @param os The output stream
+/// @param graph The graph to print
+/// @return The same output stream
+template <typename NData, typename EData>
+std::ostream& operator<<(std::ostream& os, const PagedGraph<NData, EData>& graph) {
+    graph.print(os);
+    return os;
+}
+
+template <typename NData, typename EData>
+PagedGraph<NData, EData>::PagedGraph(const std::string& filename, bool undirected, size_t frames,
+        size_t page_size)
+    : cache_(filename, frames, page_size), undirected_(undirected), node_data_(cache_),
+    sources_(cache_), targets_(cache_), edge_data_(cache_), offsets_(cache_), neighbors_(cache_),
+    neighbor_edges_(cache_), indexed_(false) {}
+
+template <typename NData, typename EData>
+bool PagedGraph<NData, EData>::is_undirected() const {
+    return undirected_;
+}
+
+template <typename NData, typename EData>
+size_t PagedGraph<NData, EData>::add_node(const NData& data) {
+    node_data_.push_back(data);
+    // a new node has no neighbors, but the offsets have to cover it
+    indexed_ = false;
+    return node_data_.size() - 1;
+}
+
+template <typename NData, typename EData>
+size_t PagedGraph<NData, EData>::add_edge(size_t source, size_t target, const EData& data) {
+    size_t nodes = node_data_.size();
+    if (source >= nodes || target >= nodes)
+        throw NonexistingItemException::adding_edge_with_nonexistant_nodes(source, target, nodes);
+    // the columns grow together, a failure leaves the longer ones cut back
+    size_t id = sources_.size();
+    try {
+        sources_.push_back(source);
+        targets_.push_back(target);
+        edge_data_.push_back(data);
+    }
+    catch (...) {
+        while (sources_.size() > id) sources_.pop_back();
+        while (targets_.size() > id) targets_.pop_back();
+        throw;
+    }
+    indexed_ = false;
+    return id;
+}
+
+template <typename NData, typename EData>
+size_t PagedGraph<NData, EData>::node_count() const {
+    return node_data_.size();
+}
+
+template <typename NData, typename EData>
+size_t PagedGraph<NData, EData>::edge_count() const {
+    return edge_data_.size();
+}
+
+template <typename NData, typename EData>
+NData PagedGraph<NData, EData>::node(size_t id) const {
+    if (id >= node_count())
+        throw NonexistingItemException::accessing_nonexistant_node(id, node_count());
+    return node_data_.get(id);
+}
+
+template <typename NData, typename EData>
+void PagedGraph<NData, EData>::set_node(size_t id, const NData& data) {
+    if (id >= node_count())
+        throw NonexistingItemException::accessing_nonexistant_node(id, node_count());
+    node_data_.set(id, data);
+}
+
+template <typename NData, typename EData>
+EData PagedGraph<NData, EData>::edge(size_t id) const {
+    if (id >= edge_count())
+        throw NonexistingItemException::accessing_nonexistant_edge_with_identifier(id,
+            edge_count());
+    return edge_data_.get(id);
+}
+
+template <typename NData, typename EData>
+void PagedGraph<NData, EData>::set_edge(size_t id, const EData& data) {
+    if (id >= edge_count())
+        throw NonexistingItemException::accessing_nonexistant_edge_with_identifier(id,
+            edge_count());
+    edge_data_.set(id, data);
+}
+
+template <typename NData, typename EData>
+size_t PagedGraph<NData, EData>::source(size_t id) const {
+    if (id >= edge_count())
+        throw NonexistingItemException::accessing_nonexistant_edge_with_identifier(id,
+            edge_count());
+    return sources_.get(id);
+}
+
+template <typename NData, typename EData>
+size_t PagedGraph<NData, EData>::target(size_t id) const {
+    if (id >= edge_count())
+        throw NonexistingItemException::accessing_nonexistant_edge_with_identifier(id,
+            edge_count());
+    return targets_.get(id);
+}
+
+template <typename NData, typename EData>
+template <typename Function>
+void PagedGraph<NData, EData>::for_each_node(Function function) const {
+    node_data_.scan(0, node_data_.size(), function);
+}
+
+template <typename NData, typename EData>
+template <typename Function>
+void PagedGraph<NData, EData>::for_each_edge(Function function) const {
+    // the three columns advance together, each one reading its own pages ahead
+    sources_.scan(0, sources_.size(), [&](size_t id, const size_t& source) {
+        if (id % targets_.per_page() == 0) targets_.prefetch(id, PagedArray<size_t>::READAHEAD *
+            targets_.per_page());
+        if (id % edge_data_.per_page() == 0) edge_data_.prefetch(id,
+            PagedArray<EData>::READAHEAD * edge_data_.per_page());
+        function(id, source, targets_.get(id), edge_data_.get(id));
+    });
+}
+
+template <typename NData, typename EData>
+void PagedGraph<NData, EData>::build_index() {
+    size_t nodes = node_data_.size();
+    size_t edges = sources_.size();
+    offsets_.clear();
+    neighbors_.clear();
+    neighbor_edges_.clear();
+    // a run is sorted in memory, so it gets about what the frames hold; every run appends to a
+    // page of its own, so the frames still leave room for the scans next to them
+    size_t entries = undirected_ ? 2 * edges : edges;
+    size_t budget = cache_.frame_count() * cache_.page_size();
+    size_t runs = (entries * sizeof(IndexEntry) + budget - 1) / budget;
+    runs = std::max<size_t>(1, std::min(runs, cache_.frame_count() / 4));
+    size_t span = std::max<size_t>(1, (nodes + runs - 1) / runs);
+    while (runs_.size() < runs) {
+        runs_.emplace_back(cache_);
+    }
+    for (PagedArray<IndexEntry>& run : runs_) {
+        run.clear();
+    }
+    sources_.scan(0, edges, [&](size_t id, const size_t& source) {
+        if (id % targets_.per_page() == 0) targets_.prefetch(id, PagedArray<size_t>::READAHEAD *
+            targets_.per_page());
+        size_t target = targets_.get(id);
+        runs_[source / span].push_back(IndexEntry{ source, target, id });
+        if (undirected_ && target != source)
+            runs_[target / span].push_back(IndexEntry{ target, source, id });
+    });
+    // a counting sort keeps the neighbors of a node in the order of their edges
+    std::vector<IndexEntry> run;
+    std::vector<IndexEntry> sorted;
+    std::vector<size_t> starts;
+    size_t position = 0;
+    for (size_t first = 0; first < nodes; first += span) {
+        size_t last = std::min(nodes, first + span);
+        const PagedArray<IndexEntry>& unsorted = runs_[first / span];
+        run.resize(unsorted.size());
+        unsorted.scan(0, unsorted.size(), [&](size_t i, const IndexEntry& entry) {
+            run[i] = entry;
+        });
+        starts.assign(last - first + 1, 0);
+        for (const IndexEntry& entry : run) {
+            ++starts[entry.node - first + 1];
+        }
+        for (size_t node = first; node < last; node++) {
+            starts[node - first + 1] += starts[node - first];
+            offsets_.push_back(position + starts[node - first]);
+        }
+        sorted.resize(run.size());
+        for (const IndexEntry& entry : run) {
+            sorted[starts[entry.node - first]++] = entry;
+        }
+        for (const IndexEntry& entry : sorted) {
+            neighbors_.push_back(entry.neighbor);
+            neighbor_edges_.push_back(entry.edge);
+        }
+        position += sorted.size();
+    }
+    offsets_.push_back(position);
+    indexed_ = true;
+}
+
+template <typename NData, typename EData>
+template <typename Function>
+void PagedGraph<NData, EData>::for_each_neighbor(size_t source, Function function) {
+    if (source >= node_count())
+        throw NonexistingItemException::accessing_edge_nonexistant_source(source, node_count());
+    if (!indexed_) build_index();
+    size_t first = offsets_.get(source);
+    size_t last = offsets_.get(source + 1);
+    neighbors_.scan(first, last, [&](size_t position, const size_t& target) {
+        function(target, neighbor_edges_.get(position));
+    });
+}
+
+template <typename NData, typename EData>
+template <typename Function>
+void PagedGraph<NData, EData>::breadth_first(size_t start, Function visit) {
+    if (start >= node_count())
+        throw NonexistingItemException::accessing_nonexistant_node(start, node_count());
+    if (!indexed_) build_index();
+    std::vector<bool> visited(node_count(), false);
+    std::vector<size_t> level(1, start);
+    std::vector<size_t> next;
+    visited[start] = true;
+    for (size_t depth = 0; !level.empty(); depth++) {
+        for (size_t node : level) {
+            visit(node, depth);
+            for_each_neighbor(node, [&](size_t target, size_t) {
+                if (visited[target]) return;
+                visited[target] = true;
+                next.push_back(target);
+            });
+        }
+        std::sort(next.begin(), next.end());
+        level.swap(next);
+        next.clear();
+    }
+}
+
+template <typename NData, typename EData>
+void PagedGraph<NData, EData>::print(std::ostream& os) const {
+    if (!os.good()) throw InvalidStreamException::invalid_output_stream();
+    for_each_node([&](size_t id, const NData& data) {
+        os << "node (" << id << " {" << data << "})" << '\n';
+    });
+    for_each_edge([&](size_t id, size_t source, size_t target, const EData& data) {
+        os << "edge (" << source << ")-[" << id << " {" << data << "}]->(" << target << ")"
+            << '\n';
+    });
+    os.flush();
+}
+
+template <typename NData, typename EData>
+void PagedGraph<NData, EData>::print(const std::string& filename) const {
+    std::ofstream ofs(filename);
+    if (!ofs.good()) throw FileProcessingException::unable_to_open_output_file(filename);
+    print(ofs);
+    ofs.close();
+}
+
+template <typename NData, typename EData>
+void PagedGraph<NData, EData>::apply_(const ImportRecord<NData, EData>& record) {
+    if (record.is_edge) {
+        if (record.id > edge_count())
+            throw InvalidIdentifierException::adding_edge_invalid_identifier(record.id,
+                edge_count());
+        if (record.id < edge_count())
+            throw ConflictingItemException::adding_edge_conflicting_identifier(record.id);
+        add_edge(record.source, record.target, record.edge_data);
+    }
+    else {
+        if (record.id > node_count())
+            throw InvalidIdentifierException::adding_node_invalid_identifier(record.id,
+                node_count());
+        if (record.id < node_count())
+            throw ConflictingItemException::adding_node_conflicting_identifier(record.id);
+        add_node(record.node_data);
+    }
+}
+
+template <typename NData, typename EData>
+void PagedGraph<NData, EData>::import(std::istream& is) {
+    if (!is.good()) throw InvalidStreamException::invalid_input_stream();
+    std::string line;
+    ImportRecord<NData, EData> record;
+    while (std::getline(is, line)) {
+        if (Graph<NData, EData>::parse_record(line, record)) apply_(record);
+    }
+}
+
+template <typename NData, typename EData>
+void PagedGraph<NData, EData>::import(const std::string& filename) {
+    std::ifstream ifs(filename);
+    if (!ifs.good()) throw FileProcessingException::unable_to_open_input_file(filename);
+    import(ifs);
+    ifs.close();
+}
+
+template <typename NData, typename EData>
+void PagedGraph<NData, EData>::flush() {
+    cache_.flush();
+}
+
+template <typename NData, typename EData>
+const PageCacheStats& PagedGraph<NData, EData>::stats() const {
+    return cache_.stats();
+}
+
+template <typename NData, typename EData>
+MemoryUsage PagedGraph<NData, EData>::memory_usage() const {
+    MemoryUsage usage;
+    usage.page_cache = cache_.memory_usage();
+    usage.slack = node_data_.memory_usage() + sources_.memory_usage() +
+        targets_.memory_usage() + edge_data_.memory_usage() + offsets_.memory_usage() +
+        neighbors_.memory_usage() + neighbor_edges_.memory_usage() +
+        runs_.capacity() * sizeof(PagedArray<IndexEntry>);
+    for (const PagedArray<IndexEntry>& run : runs_) {
+        usage.slack += run.memory_usage();
+    }
+    return usage;
+}
+
+
+#endif
\ No newline at end of file
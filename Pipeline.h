@@ -0,0 +1,603 @@
+#ifndef __PIPELINE_H
+#define __PIPELINE_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// the coroutines are only there when compiling as C++20, the pipeline runs on plain threads
+// either way
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#include <iterator>
+#define GRAPH_COROUTINES
+#endif
+#endif
+
+#include "Exceptions.h"
+#include "Graph.h"
+
+
+/// @file Pipeline.h
+/// @brief Contains the ImportRecord, the Generator, the BoundedQueue and the GraphPipeline
+///  overlapping the import, processing and export of a graph, and their member function
+///  definitions
+
+
+// forward declaration
+template <typename NData, typename EData>
+class Graph;
+
+/// @brief A node or an edge parsed from a line of the import format
+/// @tparam NData The data associated with the Graph's nodes
+/// @tparam EData The data associated with the Graph's edges
+template <typename NData, typename EData>
+struct ImportRecord {
+    /// @brief True for an edge, false for a node
+    bool is_edge = false;
+
+    /// @brief The id of the node or edge
+    size_t id = 0;
+
+    /// @brief The id of the source node, edges only
+    size_t source = 0;
+
+    /// @brief The id of the target node, edges only
+    size_t target = 0;
+
+    /// @brief The node data, nodes only
+    NData node_data;
+
+    /// @brief The edge data, edges only
+    EData edge_data;
+};
+
+#ifdef GRAPH_COROUTINES
+/// @brief A lazily evaluated sequence produced by a coroutine, the coroutine runs until its
+///  next co_yield whenever the iterator is advanced
+/// @tparam T The type of the yielded values
+template <typename T>
+class Generator {
+public:
+    /// @brief The promise of the coroutine, keeps the last yielded value
+    struct promise_type {
+        /// @brief The last yielded value, it lives inside the suspended coroutine
+        T* current = nullptr;
+
+        /// @brief The exception that escaped the coroutine
+        std::exception_ptr exception;
+
+        Generator get_return_object() {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        std::suspend_always final_suspend() noexcept { return {}; }
+
+        std::suspend_always yield_value(T& value) noexcept {
+            current = std::addressof(value);
+            return {};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() { exception = std::current_exception(); }
+    };
+
+    /// @brief The input iterator over the yielded values
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        /// @brief Get the current value
+        /// @return A reference to the current value, valid until the iterator is advanced
+        T& operator*() const;
+
+        /// @brief Resumes the coroutine until it yields the next value or finishes
+        /// @return The advanced iterator
+        /// @exception Any exception that escaped the coroutine
+        iterator& operator++();
+
+        /// @brief Tests if the coroutine finished
+        /// @return True if there are no more values
+        bool operator==(std::default_sentinel_t) const;
+
+    private:
+        /// @brief Constructs an iterator of the given coroutine
+        /// @param handle The coroutine
+        explicit iterator(std::coroutine_handle<promise_type> handle);
+
+        /// @brief The coroutine
+        std::coroutine_handle<promise_type> handle_;
+
+        friend Generator;
+    };
+
+    /// @brief Move constructor
+    /// @param other The generator to move
+    Generator(Generator&& other) noexcept;
+
+    /// @brief Destroys the coroutine, wherever it is suspended
+    ~Generator();
+
+    Generator(const Generator& other) = delete;
+    Generator& operator=(const Generator& other) = delete;
+    Generator& operator=(Generator&& other) = delete;
+
+    /// @brief Runs the coroutine until its first value, can only be called once
+    /// @return The iterator to the first value
+    /// @exception Any exception that escaped the coroutine
+    iterator begin();
+
+    /// @brief Returns the sentinel marking the finished coroutine
+    /// @return The sentinel
+    std::default_sentinel_t end() const;
+
+private:
+    /// @brief Constructs the generator owning the given coroutine
+    /// @param handle The coroutine
+    explicit Generator(std::coroutine_handle<promise_type> handle);
+
+    /// @brief Resumes the coroutine and rethrows what escaped it
+    /// @param handle The coroutine
+    static void resume_(std::coroutine_handle<promise_type> handle);
+
+    /// @brief The coroutine, empty for a moved from generator
+    std::coroutine_handle<promise_type> handle_;
+};
+#endif
+
+/// @brief A queue between two threads holding at most a fixed number of items; the producer
+///  waits while it is full, which keeps a fast stage from running away from a slow one
+/// @tparam T The type of the items
+template <typename T>
+class BoundedQueue {
+public:
+    /// @brief Constructs an empty queue
+    /// @param capacity The maximum number of items, at least one
+    explicit BoundedQueue(size_t capacity);
+
+    /// @brief Adds an item, waiting while the queue is full
+    /// @param item The item
+    /// @return False if the queue was closed and the item was dropped
+    bool push(T&& item);
+
+    /// @brief Takes the oldest item, waiting while the queue is empty
+    /// @param item Where to move the item to
+    /// @return False if the queue was closed and there are no items left
+    bool pop(T& item);
+
+    /// @brief Closes the queue, the items inside can still be taken
+    void close();
+
+    /// @brief Closes the queue and drops the items inside, used when the pipeline fails
+    void abort();
+
+private:
+    /// @brief The items
+    std::deque<T> items_;
+
+    /// @brief The maximum number of items
+    size_t capacity_;
+
+    /// @brief True once the queue was closed
+    bool closed_;
+
+    /// @brief Guards the items
+    std::mutex mutex_;
+
+    /// @brief Signalled when an item was taken
+    std::condition_variable not_full_;
+
+    /// @brief Signalled when an item was added
+    std::condition_variable not_empty_;
+};
+
+/// @brief The options of a GraphPipeline
+struct PipelineOptions {
+    /// @brief The number of records or printed items handed from one stage to the next at once
+    size_t batch_size = 1024;
+
+    /// @brief The number of batches that may wait between two stages
+    size_t queue_capacity = 4;
+};
+
+/// @brief Overlaps importing, processing and exporting a graph; the input is read and parsed on
+///  its own thread, every transform stage runs on its own thread, the records are added to the
+///  graph on the calling thread and every observer runs on its own thread, all connected by
+///  bounded queues. Stages run in the order they were added and see the batches in the order
+///  of the input
+/// @tparam NData The data associated with the Graph's nodes
+/// @tparam EData The data associated with the Graph's edges
+template <typename NData, typename EData>
+class GraphPipeline {
+public:
+    /// @brief A batch of parsed records
+    using Batch = std::vector<ImportRecord<NData, EData>>;
+
+    /// @brief Constructs a pipeline feeding the given graph
+    /// @param graph The graph, has to outlive the pipeline
+    /// @param options The options
+    explicit GraphPipeline(Graph<NData, EData>& graph,
+        const PipelineOptions& options = PipelineOptions());
+
+    /// @brief Adds a stage between parsing and adding to the graph, like validation; it may
+    ///  change, add or remove records of the batch
+    /// @param stage The stage, called with every batch on its own thread
+    /// @return A reference to the pipeline
+    GraphPipeline& transform(std::function<void(Batch&)> stage);
+
+    /// @brief Adds a stage after adding to the graph, like incremental statistics; it runs
+    ///  while the next batches are being added, so it must not touch the graph
+    /// @param stage The stage, called with every added batch on its own thread
+    /// @return A reference to the pipeline
+    GraphPipeline& observe(std::function<void(const Batch&)> stage);
+
+    /// @brief Imports the graph from the given input stream through the stages
+    /// @param is The input stream
+    /// @exception InvalidStreamException If the input stream is not good
+    /// @exception The first exception thrown by parsing, a stage or adding to the graph, after
+    ///  all stages stopped; the records added until then stay in the graph
+    void import(std::istream& is);
+
+    /// @brief Imports the graph from a file with the given filename through the stages
+    /// @param filename The name of the file to import from
+    /// @exception FileProcessingException If the input file is not good
+    void import(const std::string& filename);
+
+    /// @brief Prints the graph to the given output stream in the format of Graph::print,
+    ///  formatting the next batch while the previous one is being written
+    /// @param os The output stream
+    /// @exception InvalidStreamException If the output stream is not good
+    void export_to(std::ostream& os) const;
+
+    /// @brief Prints the graph to a file with the given filename
+    /// @param filename The name of the file to print to
+    /// @exception FileProcessingException If the output file is not good
+    void export_to(const std::string& filename) const;
+
+private:
+    /// @brief Runs a stage on its own thread and stops the whole pipeline if it fails
+    /// @param threads The threads of the pipeline
+    /// @param body The stage
+    void start_(std::vector<std::thread>& threads, std::function<void()> body);
+
+    /// @brief Remembers the first exception and aborts every queue, called from a catch block
+    void fail_();
+
+    /// @brief Joins the threads and rethrows the first exception
+    /// @param threads The threads of the pipeline
+    void finish_(std::vector<std::thread>& threads);
+
+    /// @brief The graph
+    Graph<NData, EData>* graph_;
+
+    /// @brief The options
+    PipelineOptions options_;
+
+    /// @brief The transform stages
+    std::vector<std::function<void(Batch&)>> transforms_;
+
+    /// @brief The observer stages
+    std::vector<std::function<void(const Batch&)>> observers_;
+
+    /// @brief The queues of the running import, aborted when a stage fails
+    std::vector<std::unique_ptr<BoundedQueue<Batch>>> queues_;
+
+    /// @brief The first exception of the running import or export
+    std::exception_ptr error_;
+
+    /// @brief Guards the first exception
+    std::mutex error_mutex_;
+};
+
+#ifdef GRAPH_COROUTINES
+template <typename T>
+Generator<T>::Generator(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+template <typename T>
+Generator<T>::Generator(Generator&& other) noexcept : handle_(other.handle_) {
+    other.handle_ = nullptr;
+}
+
+template <typename T>
+Generator<T>::~Generator() {
+    if (handle_) handle_.destroy();
+}
+
+template <typename T>
+void Generator<T>::resume_(std::coroutine_handle<promise_type> handle) {
+    handle.resume();
+    if (handle.promise().exception) std::rethrow_exception(handle.promise().exception);
+}
+
+template <typename T>
+typename Generator<T>::iterator Generator<T>::begin() {
+    resume_(handle_);
+    return iterator(handle_);
+}
+
+template <typename T>
+std::default_sentinel_t Generator<T>::end() const {
+    return std::default_sentinel;
+}
+
+template <typename T>
+Generator<T>::iterator::iterator(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+template <typename T>
+T& Generator<T>::iterator::operator*() const {
+    return *handle_.promise().current;
+}
+
+template <typename T>
+typename Generator<T>::iterator& Generator<T>::iterator::operator++() {
+    resume_(handle_);
+    return *this;
+}
+
+template <typename T>
+bool Generator<T>::iterator::operator==(std::default_sentinel_t) const {
+    return handle_.done();
+}
+#endif
+
+template <typename T>
+BoundedQueue<T>::BoundedQueue(size_t capacity)
+    : capacity_(capacity == 0 ? 1 : capacity), closed_(false) {}
+
+template <typename T>
+bool BoundedQueue<T>::push(T&& item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this]() { return closed_ || items_.size() < capacity_; });
+    if (closed_) return false;
+    items_.push_back(std::move(item));
+    lock.unlock();
+    not_empty_.notify_one();
+    return true;
+}
+
+template <typename T>
+bool BoundedQueue<T>::pop(T& item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this]() { return closed_ || !items_.empty(); });
+    if (items_.empty()) return false;
+    item = std::move(items_.front());
+    items_.pop_front();
+    lock.unlock();
+    not_full_.notify_one();
+    return true;
+}
+
+template <typename T>
+void BoundedQueue<T>::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    not_full_.notify_all();
+    not_empty_.notify_all();
+}
+
+template <typename T>
+void BoundedQueue<T>::abort() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        items_.clear();
+    }
+    not_full_.notify_all();
+    not_empty_.notify_all();
+}
+
+template <typename NData, typename EData>
+GraphPipeline<NData, EData>::GraphPipeline(Graph<NData, EData>& graph,
+        const PipelineOptions& options)
+    : graph_(&graph), options_(options) {
+    if (options_.batch_size == 0) options_.batch_size = 1;
+}
+
+template <typename NData, typename EData>
+GraphPipeline<NData, EData>& GraphPipeline<NData, EData>::transform(
+        std::function<void(Batch&)> stage) {
+    transforms_.push_back(std::move(stage));
+    return *this;
+}
+
+template <typename NData, typename EData>
+GraphPipeline<NData, EData>& GraphPipeline<NData, EData>::observe(
+        std::function<void(const Batch&)> stage) {
+    observers_.push_back(std::move(stage));
+    return *this;
+}
+
+template <typename NData, typename EData>
+void GraphPipeline<NData, EData>::start_(std::vector<std::thread>& threads,
+        std::function<void()> body) {
+    threads.emplace_back([this, body]() {
+        try {
+            body();
+        }
+        catch (...) {
+            fail_();
+        }
+    });
+}
+
+template <typename NData, typename EData>
+void GraphPipeline<NData, EData>::fail_() {
+    {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        if (!error_) error_ = std::current_exception();
+    }
+    for (auto& queue : queues_) {
+        queue->abort();
+    }
+}
+
+template <typename NData, typename EData>
+void GraphPipeline<NData, EData>::finish_(std::vector<std::thread>& threads) {
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    queues_.clear();
+    std::exception_ptr error;
+    std::swap(error, error_);
+    if (error) std::rethrow_exception(error);
+}
+
+template <typename NData, typename EData>
+void GraphPipeline<NData, EData>::import(std::istream& is) {
+    if (!is.good()) throw InvalidStreamException::invalid_input_stream();
+    // queues_[i] feeds transform i, the last but the observers' feeds the graph, and every
+    // observer has its own queue after that
+    size_t stages = transforms_.size();
+    for (size_t i = 0; i <= stages + observers_.size(); i++) {
+        queues_.emplace_back(new BoundedQueue<Batch>(options_.queue_capacity));
+    }
+    std::vector<std::thread> threads;
+    try {
+        start_(threads, [this, &is]() {
+            BoundedQueue<Batch>& output = *queues_.front();
+#ifdef GRAPH_COROUTINES
+            for (Batch& batch : Graph<NData, EData>::import_batches(is, options_.batch_size)) {
+                if (!output.push(std::move(batch))) return;
+            }
+#else
+            Batch batch;
+            while (Graph<NData, EData>::read_batch(is, batch, options_.batch_size)) {
+                if (!output.push(std::move(batch))) return;
+            }
+#endif
+            output.close();
+        });
+        for (size_t i = 0; i < stages; i++) {
+            start_(threads, [this, i]() {
+                BoundedQueue<Batch>& input = *queues_[i];
+                BoundedQueue<Batch>& output = *queues_[i + 1];
+                Batch batch;
+                while (input.pop(batch)) {
+                    transforms_[i](batch);
+                    if (!output.push(std::move(batch))) return;
+                }
+                output.close();
+            });
+        }
+        for (size_t i = 0; i < observers_.size(); i++) {
+            start_(threads, [this, stages, i]() {
+                BoundedQueue<Batch>& input = *queues_[stages + 1 + i];
+                Batch batch;
+                while (input.pop(batch)) {
+                    observers_[i](batch);
+                }
+            });
+        }
+        BoundedQueue<Batch>& input = *queues_[stages];
+        Batch batch;
+        while (input.pop(batch)) {
+            if (observers_.empty()) {
+                // nobody looks at the batch afterwards, so its data can move into the graph
+                for (ImportRecord<NData, EData>& record : batch) {
+                    graph_->apply(std::move(record));
+                }
+            }
+            else {
+                for (const ImportRecord<NData, EData>& record : batch) {
+                    graph_->apply(record);
+                }
+            }
+            // every observer but the last one gets a copy
+            for (size_t i = 0; i < observers_.size(); i++) {
+                Batch observed = i + 1 == observers_.size() ? std::move(batch) : batch;
+                if (!queues_[stages + 1 + i]->push(std::move(observed))) break;
+            }
+        }
+        for (size_t i = 0; i < observers_.size(); i++) {
+            queues_[stages + 1 + i]->close();
+        }
+    }
+    catch (...) {
+        fail_();
+    }
+    finish_(threads);
+}
+
+template <typename NData, typename EData>
+void GraphPipeline<NData, EData>::import(const std::string& filename) {
+    std::ifstream ifs(filename);
+    if (!ifs.good()) throw FileProcessingException::unable_to_open_input_file(filename);
+    import(ifs);
+}
+
+template <typename NData, typename EData>
+void GraphPipeline<NData, EData>::export_to(std::ostream& os) const {
+    if (!os.good()) throw InvalidStreamException::invalid_output_stream();
+    BoundedQueue<std::string> chunks(options_.queue_capacity);
+    // only written by the writer before it stops, read after joining it
+    bool failed = false;
+    std::thread writer([&os, &chunks, &failed]() {
+        std::string chunk;
+        while (chunks.pop(chunk)) {
+            os << chunk;
+            if (!os.good()) {
+                failed = true;
+                chunks.abort();
+                return;
+            }
+        }
+    });
+    try {
+        const Nodes<NData, EData>& nodes = graph_->nodes();
+        const Edges<NData, EData>& edges = graph_->edges();
+        size_t count = nodes.size() + edges.size();
+        for (size_t begin = 0; begin < count; begin += options_.batch_size) {
+            std::ostringstream chunk;
+            size_t end = std::min(count, begin + options_.batch_size);
+            for (size_t i = begin; i < end; i++) {
+                if (i < nodes.size()) {
+                    chunk << nodes.get(i);
+                    continue;
+                }
+                // the edge knows only its id and data, the endpoints are kept in columns
+                size_t id = i - nodes.size();
+                chunk << "edge (" << edges.sources()[id] << ")-" << edges.get(id) << "->("
+                    << edges.targets()[id] << ")" << std::endl;
+            }
+            if (!chunks.push(chunk.str())) break;
+        }
+        chunks.close();
+    }
+    catch (...) {
+        chunks.abort();
+        writer.join();
+        throw;
+    }
+    writer.join();
+    if (failed) throw InvalidStreamException::invalid_output_stream();
+}
+
+template <typename NData, typename EData>
+void GraphPipeline<NData, EData>::export_to(const std::string& filename) const {
+    std::ofstream ofs(filename);
+    if (!ofs.good()) throw FileProcessingException::unable_to_open_output_file(filename);
+    export_to(ofs);
+}
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,792 @@
+#ifndef __PROPERTIES_H
+#define __PROPERTIES_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+#include "CopyOnWrite.h"
+#include "Exceptions.h"
+#include "MemoryUsage.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+/// @file Properties.h
+/// @brief Contains the Properties of nodes or edges stored as named typed columns, the column
+///  types and their member function definitions
+
+
+/// @brief A column of properties indexed by the id of the node or edge they belong to; rows
+///  never set read as the default value of the type. A column handed out by Properties bound to
+///  the nodes or edges owning it can only set the rows of the ones that exist
+class PropertyColumn {
+public:
+    /// @brief The virtual destructor
+    virtual ~PropertyColumn() = default;
+
+    /// @brief Get the number of rows stored, one past the highest id set
+    /// @return The number of rows
+    virtual size_t size() const = 0;
+
+    /// @brief Get the memory allocated by the column
+    /// @return The number of bytes
+    virtual size_t memory_usage() const = 0;
+
+    /// @brief Copies the column
+    /// @return The copy
+    virtual std::unique_ptr<PropertyColumn> clone() const = 0;
+
+protected:
+    /// @brief Checks that a row belongs to an existing node or edge
+    /// @param index The id of the node or edge
+    /// @exception NonexistingItemException If the row lies past the nodes or edges owning the
+    ///  column
+    void check_(size_t index) const;
+
+private:
+    /// @brief Counts the nodes or edges of the owner of the properties that handed the column
+    ///  out for writing last, none if they are not bound
+    const std::function<size_t()>* rows_ = nullptr;
+
+    friend class Properties;
+};
+
+/// @brief A column of integers packed into as few bits as the widest value needs; signed values
+///  are zigzag encoded so small negative values stay small. Storing a wider value repacks the
+///  column, at most once per bit of width
+/// @tparam T The integral type of the values
+template <typename T>
+class PackedColumn : public PropertyColumn {
+    static_assert(std::is_integral<T>::value, "a packed column holds integers");
+
+public:
+    /// @brief Constructs an empty column zero bits wide
+    PackedColumn();
+
+    /// @brief Get the value of a row
+    /// @param index The id of the node or edge
+    /// @return The value, zero if it was never set
+    T get(size_t index) const;
+
+    /// @brief Sets the value of a row, adding the rows before it as zeros
+    /// @param index The id of the node or edge
+    /// @param value The value
+    /// @exception UnavailableMemoryException If there isn't enough memory, the column is left
+    ///  unchanged then
+    void set(size_t index, T value);
+
+    /// @brief Get the number of bits a value takes
+    /// @return The width of the widest value stored so far
+    unsigned bits() const;
+
+    /// @brief Calls the given function for every row in order, unpacking the words sequentially
+    /// @tparam Function A callable taking the index and the value
+    /// @param function The function to call
+    template <typename Function>
+    void for_each(Function function) const;
+
+    size_t size() const override;
+    size_t memory_usage() const override;
+    std::unique_ptr<PropertyColumn> clone() const override;
+
+private:
+    /// @brief Maps a value to the unsigned code stored for it
+    /// @param value The value
+    /// @return The code
+    static uint64_t encode_(T value);
+
+    /// @brief Maps a stored code back to its value
+    /// @param code The code
+    /// @return The value
+    static T decode_(uint64_t code);
+
+    /// @brief Get the number of bits a code needs
+    /// @param code The code
+    /// @return The position of its highest set bit plus one, zero for zero
+    static unsigned width_(uint64_t code);
+
+    /// @brief Reads the code of a row inside the given words
+    /// @param words The packed words
+    /// @param bits The width of a code
+    /// @param index The row
+    /// @return The code
+    static uint64_t load_(const std::vector<uint64_t>& words, unsigned bits, size_t index);
+
+    /// @brief Writes the code of a row inside the given words
+    /// @param words The packed words
+    /// @param bits The width of a code
+    /// @param index The row
+    /// @param code The code, fitting the width
+    static void store_(std::vector<uint64_t>& words, unsigned bits, size_t index, uint64_t code);
+
+    /// @brief The codes packed one after another, a code may span two words
+    std::vector<uint64_t> words_;
+
+    /// @brief The number of rows
+    size_t size_;
+
+    /// @brief The width of a code
+    unsigned bits_;
+};
+
+/// @brief A column of strings stored once each in a dictionary, the rows keep only the packed
+///  codes of their strings; algorithms can compare the codes instead of the strings. Code 0 is
+///  the empty string
+class DictionaryColumn : public PropertyColumn {
+public:
+    /// @brief The code returned for a string that is not in the dictionary
+    static const uint32_t NONE = UINT32_MAX;
+
+    /// @brief Constructs an empty column with only the empty string in the dictionary
+    DictionaryColumn();
+
+    /// @brief Copy constructor, the lookup of the copy reads its own strings
+    /// @param other The column to copy
+    /// @exception std::bad_alloc If there isn't enough memory
+    DictionaryColumn(const DictionaryColumn& other);
+
+    DictionaryColumn& operator=(const DictionaryColumn& other) = delete;
+
+    /// @brief Get the string of a row
+    /// @param index The id of the node or edge
+    /// @return The string inside the dictionary, empty if it was never set
+    const std::string& get(size_t index) const;
+
+    /// @brief Sets the string of a row, adding it to the dictionary if it is not there yet
+    /// @param index The id of the node or edge
+    /// @param value The string
+    /// @exception UnavailableMemoryException If there isn't enough memory
+    void set(size_t index, const std::string& value);
+
+    /// @brief Get the code of the string of a row
+    /// @param index The id of the node or edge
+    /// @return The code
+    uint32_t code(size_t index) const;
+
+    /// @brief Looks up the code of a string
+    /// @param value The string
+    /// @return The code, NONE if no row was ever set to the string
+    uint32_t find(const std::string& value) const;
+
+    /// @brief Get the string of a code
+    /// @param code The code, lower than the cardinality
+    /// @return The string
+    const std::string& value(uint32_t code) const;
+
+    /// @brief Get the number of distinct strings, the empty string included
+    /// @return The size of the dictionary
+    size_t cardinality() const;
+
+    /// @brief Get the codes of all rows to scan them without touching the strings
+    /// @return The packed codes
+    const PackedColumn<uint32_t>& codes() const;
+
+    /// @brief Calls the given function for every row in order
+    /// @tparam Function A callable taking the index and a const reference to the string
+    /// @param function The function to call
+    template <typename Function>
+    void for_each(Function function) const;
+
+    size_t size() const override;
+    size_t memory_usage() const override;
+    std::unique_ptr<PropertyColumn> clone() const override;
+
+private:
+    /// @brief The code of every row
+    PackedColumn<uint32_t> codes_;
+
+    /// @brief Hashes a code by its string, or a string looked up
+    struct Hash {
+        using is_transparent = void;
+
+        size_t operator()(uint32_t code) const;
+        size_t operator()(std::string_view value) const;
+
+        /// @brief The strings of the codes
+        const std::vector<std::string>* values;
+    };
+
+    /// @brief Compares codes and strings looked up by their strings
+    struct Equal {
+        using is_transparent = void;
+
+        bool operator()(uint32_t a, uint32_t b) const;
+        bool operator()(std::string_view a, uint32_t b) const;
+        bool operator()(uint32_t a, std::string_view b) const;
+
+        /// @brief The strings of the codes
+        const std::vector<std::string>* values;
+    };
+
+    /// @brief The string of every code
+    std::vector<std::string> values_;
+
+    /// @brief The codes of the strings, hashed by the strings inside values_, so every string is
+    ///  stored once
+    std::unordered_set<uint32_t, Hash, Equal> lookup_;
+};
+
+/// @brief A column of values stored one after another in a contiguous array
+/// @tparam T The type of the values, default constructible
+template <typename T>
+class PlainColumn : public PropertyColumn {
+public:
+    /// @brief Get the value of a row
+    /// @param index The id of the node or edge
+    /// @return The value, the default value if it was never set
+    const T& get(size_t index) const;
+
+    /// @brief Sets the value of a row, adding the rows before it as default values
+    /// @param index The id of the node or edge
+    /// @param value The value
+    /// @exception UnavailableMemoryException If there isn't enough memory
+    void set(size_t index, const T& value);
+
+    /// @brief Get the values to read them contiguously
+    /// @return The first of size() values
+    const T* data() const;
+
+    /// @brief Calls the given function for every row in order
+    /// @tparam Function A callable taking the index and a const reference to the value
+    /// @param function The function to call
+    template <typename Function>
+    void for_each(Function function) const;
+
+    size_t size() const override;
+    size_t memory_usage() const override;
+    std::unique_ptr<PropertyColumn> clone() const override;
+
+private:
+    /// @brief The values
+    std::vector<T> values_;
+};
+
+/// @brief Chooses the column storing a property type: integers and bools are bit packed,
+///  strings dictionary encoded and anything else stored plainly
+/// @tparam T The type of the property
+template <typename T, typename Enable = void>
+struct PropertyColumnOf {
+    using type = PlainColumn<T>;
+};
+
+template <typename T>
+struct PropertyColumnOf<T, typename std::enable_if<std::is_integral<T>::value>::type> {
+    using type = PackedColumn<T>;
+};
+
+template <>
+struct PropertyColumnOf<std::string> {
+    using type = DictionaryColumn;
+};
+
+/// @brief Named typed columns of properties of the nodes or of the edges, optional next to their
+///  data: a property is read by the id of its node or edge, and an algorithm that needs only one
+///  of the properties reads only its column. Copies share the columns until either of them gets
+///  a column for writing, which copies only that column, see CopyOnWrite
+class Properties {
+public:
+    /// @brief Constructs the properties without any columns
+    Properties() = default;
+
+    /// @brief Copy constructor, shares every column, without a bound
+    /// @param other The properties to copy
+    /// @exception std::bad_alloc If there isn't enough memory for the names of the columns
+    Properties(const Properties& other);
+
+    /// @brief Move constructor, takes the columns, without a bound
+    /// @param other The properties to move
+    Properties(Properties&& other) noexcept;
+
+    /// @brief Copy assignment, shares every column and keeps the own bound
+    /// @param other The properties to copy
+    /// @return The properties copied to
+    /// @exception std::bad_alloc If there isn't enough memory for the names of the columns
+    Properties& operator=(const Properties& other);
+
+    /// @brief Move assignment, takes the columns and keeps the own bound
+    /// @param other The properties to move
+    /// @return The properties moved to
+    Properties& operator=(Properties&& other) noexcept;
+
+    /// @brief Adds an empty column, or gets it for writing if it already exists with the same
+    ///  type
+    /// @tparam T The type of the property
+    /// @param name The name of the property
+    /// @return The column, valid until it is removed
+    /// @exception ConflictingItemException If a column of another type has the name
+    /// @exception UnavailableMemoryException If a column shared with a copy cannot be copied
+    template <typename T>
+    typename PropertyColumnOf<T>::type& add(const std::string& name);
+
+    /// @brief Gets a column for writing, copying it first if it is shared with a copy
+    /// @tparam T The type of the property
+    /// @param name The name of the property
+    /// @return The column
+    /// @exception NonexistingItemException If no column has the name
+    /// @exception InvalidArgumentException If the column has another type
+    /// @exception UnavailableMemoryException If a column shared with a copy cannot be copied
+    template <typename T>
+    typename PropertyColumnOf<T>::type& column(const std::string& name);
+
+    /// @brief Gets a column
+    /// @tparam T The type of the property
+    /// @param name The name of the property
+    /// @return The column
+    /// @exception NonexistingItemException If no column has the name
+    /// @exception InvalidArgumentException If the column has another type
+    template <typename T>
+    const typename PropertyColumnOf<T>::type& column(const std::string& name) const;
+
+    /// @brief Tests the existence of a column
+    /// @param name The name of the property
+    /// @return True if a column has the name
+    bool contains(const std::string& name) const;
+
+    /// @brief Removes a column, if it exists
+    /// @param name The name of the property
+    void remove(const std::string& name);
+
+    /// @brief Get the names of the columns
+    /// @return The names in order
+    std::vector<std::string> names() const;
+
+    /// @brief Get the memory allocated by the columns; a column shared with copies is counted by
+    ///  each of them
+    /// @return The number of bytes
+    size_t memory_usage() const;
+
+    /// @brief Get the memory of the columns shared with copies, the part of memory_usage every
+    ///  copy sharing them counts as well
+    /// @return The number of bytes
+    size_t shared_memory_usage() const;
+
+    /// @brief Bounds the rows the columns handed out for writing can set by the number of nodes
+    ///  or edges owning the properties; copies and moves keep their own bound
+    /// @param rows Counts the nodes or edges
+    void bound(std::function<size_t()> rows);
+
+private:
+    /// @brief Finds a column of the given type
+    /// @tparam Column The type of the column
+    /// @param name The name of the property
+    /// @return The column
+    /// @exception NonexistingItemException If no column has the name
+    /// @exception InvalidArgumentException If the column has another type
+    template <typename Column>
+    const Column& find_(const std::string& name) const;
+
+    /// @brief Finds a column of the given type for writing, copying it first if it is shared
+    /// @tparam Column The type of the column
+    /// @param name The name of the property
+    /// @return The column
+    /// @exception NonexistingItemException If no column has the name
+    /// @exception InvalidArgumentException If the column has another type
+    /// @exception UnavailableMemoryException If the column cannot be copied
+    template <typename Column>
+    Column& own_(const std::string& name);
+
+    /// @brief The columns by name, shared with the copies of the properties
+    std::map<std::string, CopyOnWrite<PropertyColumn>> columns_;
+
+    /// @brief Counts the nodes or edges owning the properties, empty if there is no bound
+    std::function<size_t()> rows_;
+};
+
+inline void PropertyColumn::check_(size_t index) const {
+    if (rows_ == nullptr || !*rows_) return;
+    size_t rows = (*rows_)();
+    if (index >= rows)
+        throw NonexistingItemException::setting_property_of_nonexistant_item(index, rows);
+}
+
+template <typename T>
+PackedColumn<T>::PackedColumn() : size_(0), bits_(0) {}
+
+template <typename T>
+uint64_t PackedColumn<T>::encode_(T value) {
+    if (!std::is_signed<T>::value) return static_cast<uint64_t>(value);
+    // zigzag: 0, -1, 1, -2, ... become 0, 1, 2, 3, ...
+    int64_t signed_value = static_cast<int64_t>(value);
+    return (static_cast<uint64_t>(signed_value) << 1) ^ static_cast<uint64_t>(signed_value >> 63);
+}
+
+template <typename T>
+T PackedColumn<T>::decode_(uint64_t code) {
+    if (!std::is_signed<T>::value) return static_cast<T>(code);
+    return static_cast<T>(static_cast<int64_t>((code >> 1) ^ (0 - (code & 1))));
+}
+
+template <typename T>
+unsigned PackedColumn<T>::width_(uint64_t code) {
+    if (code == 0) return 0;
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long bit;
+    _BitScanReverse64(&bit, code);
+    return static_cast<unsigned>(bit) + 1;
+#elif defined(__GNUC__)
+    return static_cast<unsigned>(64 - __builtin_clzll(code));
+#else
+    unsigned width = 0;
+    for (; code != 0; code >>= 1) ++width;
+    return width;
+#endif
+}
+
+template <typename T>
+uint64_t PackedColumn<T>::load_(const std::vector<uint64_t>& words, unsigned bits,
+        size_t index) {
+    if (bits == 0) return 0;
+    size_t bit = index * bits;
+    size_t word = bit / 64;
+    unsigned shift = static_cast<unsigned>(bit % 64);
+    uint64_t code = words[word] >> shift;
+    if (shift + bits > 64) code |= words[word + 1] << (64 - shift);
+    return bits == 64 ? code : code & ((uint64_t(1) << bits) - 1);
+}
+
+template <typename T>
+void PackedColumn<T>::store_(std::vector<uint64_t>& words, unsigned bits, size_t index,
+        uint64_t code) {
+    if (bits == 0) return;
+    uint64_t mask = bits == 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+    size_t bit = index * bits;
+    size_t word = bit / 64;
+    unsigned shift = static_cast<unsigned>(bit % 64);
+    words[word] = (words[word] & ~(mask << shift)) | (code << shift);
+    if (shift + bits > 64) {
+        words[word + 1] = (words[word + 1] & ~(mask >> (64 - shift))) | (code >> (64 - shift));
+    }
+}
+
+template <typename T>
+T PackedColumn<T>::get(size_t index) const {
+    if (index >= size_) return T();
+    return decode_(load_(words_, bits_, index));
+}
+
+template <typename T>
+void PackedColumn<T>::set(size_t index, T value) {
+    check_(index);
+    uint64_t code = encode_(value);
+    unsigned bits = width_(code);
+    size_t size = index >= size_ ? index + 1 : size_;
+    try {
+        if (bits > bits_) {
+            // repack every row at the new width, the column stays as it was until the swap
+            std::vector<uint64_t> words((size * bits + 63) / 64, 0);
+            for (size_t i = 0; i < size_; i++) {
+                store_(words, bits, i, load_(words_, bits_, i));
+            }
+            words_.swap(words);
+            bits_ = bits;
+        }
+        else if (size > size_) {
+            words_.resize((size * bits_ + 63) / 64, 0);
+        }
+    }
+    catch (const std::bad_alloc&) {
+        throw UnavailableMemoryException::property_column_unable_to_insert();
+    }
+    size_ = size;
+    store_(words_, bits_, index, code);
+}
+
+template <typename T>
+unsigned PackedColumn<T>::bits() const {
+    return bits_;
+}
+
+template <typename T>
+template <typename Function>
+void PackedColumn<T>::for_each(Function function) const {
+    for (size_t i = 0; i < size_; i++) {
+        function(i, decode_(load_(words_, bits_, i)));
+    }
+}
+
+template <typename T>
+size_t PackedColumn<T>::size() const {
+    return size_;
+}
+
+template <typename T>
+size_t PackedColumn<T>::memory_usage() const {
+    return words_.capacity() * sizeof(uint64_t);
+}
+
+template <typename T>
+std::unique_ptr<PropertyColumn> PackedColumn<T>::clone() const {
+    return std::unique_ptr<PropertyColumn>(new PackedColumn<T>(*this));
+}
+
+inline DictionaryColumn::DictionaryColumn()
+    : values_(1), lookup_(0, Hash{ &values_ }, Equal{ &values_ }) {
+    lookup_.insert(0);
+}
+
+inline DictionaryColumn::DictionaryColumn(const DictionaryColumn& other)
+    : PropertyColumn(other), codes_(other.codes_), values_(other.values_),
+    lookup_(other.lookup_.bucket_count(), Hash{ &values_ }, Equal{ &values_ }) {
+    for (uint32_t code = 0; code < values_.size(); code++) {
+        lookup_.insert(code);
+    }
+}
+
+inline size_t DictionaryColumn::Hash::operator()(uint32_t code) const {
+    return std::hash<std::string_view>()((*values)[code]);
+}
+
+inline size_t DictionaryColumn::Hash::operator()(std::string_view value) const {
+    return std::hash<std::string_view>()(value);
+}
+
+inline bool DictionaryColumn::Equal::operator()(uint32_t a, uint32_t b) const {
+    return a == b;
+}
+
+inline bool DictionaryColumn::Equal::operator()(std::string_view a, uint32_t b) const {
+    return a == (*values)[b];
+}
+
+inline bool DictionaryColumn::Equal::operator()(uint32_t a, std::string_view b) const {
+    return (*values)[a] == b;
+}
+
+inline const std::string& DictionaryColumn::get(size_t index) const {
+    return values_[codes_.get(index)];
+}
+
+inline void DictionaryColumn::set(size_t index, const std::string& value) {
+    check_(index);
+    uint32_t code = find(value);
+    if (code == NONE) {
+        if (values_.size() >= NONE)
+            throw UnavailableMemoryException::property_column_unable_to_insert();
+        code = static_cast<uint32_t>(values_.size());
+        try {
+            // the string goes in first, the lookup hashes the code by it
+            values_.push_back(value);
+            try {
+                lookup_.insert(code);
+            }
+            catch (...) {
+                values_.pop_back();
+                throw;
+            }
+        }
+        catch (const std::bad_alloc&) {
+            throw UnavailableMemoryException::property_column_unable_to_insert();
+        }
+    }
+    // a string that ends up unused stays in the dictionary, like after overwriting it
+    codes_.set(index, code);
+}
+
+inline uint32_t DictionaryColumn::code(size_t index) const {
+    return codes_.get(index);
+}
+
+inline uint32_t DictionaryColumn::find(const std::string& value) const {
+    auto found = lookup_.find(std::string_view(value));
+    return found == lookup_.end() ? NONE : *found;
+}
+
+inline const std::string& DictionaryColumn::value(uint32_t code) const {
+    return values_[code];
+}
+
+inline size_t DictionaryColumn::cardinality() const {
+    return values_.size();
+}
+
+inline const PackedColumn<uint32_t>& DictionaryColumn::codes() const {
+    return codes_;
+}
+
+template <typename Function>
+void DictionaryColumn::for_each(Function function) const {
+    codes_.for_each([&](size_t index, uint32_t code) {
+        function(index, values_[code]);
+    });
+}
+
+inline size_t DictionaryColumn::size() const {
+    return codes_.size();
+}
+
+inline size_t DictionaryColumn::memory_usage() const {
+    // a node per string holding its code, the hash of its string and the link to the next node
+    return codes_.memory_usage() + HeapUsage<std::vector<std::string>>::of(values_) +
+        lookup_.bucket_count() * sizeof(void*) +
+        lookup_.size() * (sizeof(uint32_t) + sizeof(size_t) + sizeof(void*));
+}
+
+inline std::unique_ptr<PropertyColumn> DictionaryColumn::clone() const {
+    return std::unique_ptr<PropertyColumn>(new DictionaryColumn(*this));
+}
+
+template <typename T>
+const T& PlainColumn<T>::get(size_t index) const {
+    static const T none = T();
+    return index < values_.size() ? values_[index] : none;
+}
+
+template <typename T>
+void PlainColumn<T>::set(size_t index, const T& value) {
+    check_(index);
+    try {
+        if (index >= values_.size()) values_.resize(index + 1);
+    }
+    catch (const std::bad_alloc&) {
+        throw UnavailableMemoryException::property_column_unable_to_insert();
+    }
+    values_[index] = value;
+}
+
+template <typename T>
+const T* PlainColumn<T>::data() const {
+    return values_.data();
+}
+
+template <typename T>
+template <typename Function>
+void PlainColumn<T>::for_each(Function function) const {
+    for (size_t i = 0; i < values_.size(); i++) {
+        function(i, values_[i]);
+    }
+}
+
+template <typename T>
+size_t PlainColumn<T>::size() const {
+    return values_.size();
+}
+
+template <typename T>
+size_t PlainColumn<T>::memory_usage() const {
+    return HeapUsage<std::vector<T>>::of(values_);
+}
+
+template <typename T>
+std::unique_ptr<PropertyColumn> PlainColumn<T>::clone() const {
+    return std::unique_ptr<PropertyColumn>(new PlainColumn<T>(*this));
+}
+
+template <typename Column>
+const Column& Properties::find_(const std::string& name) const {
+    auto found = columns_.find(name);
+    if (found == columns_.end())
+        throw NonexistingItemException::accessing_nonexistant_property(name);
+    const Column* column = dynamic_cast<const Column*>(&found->second.get());
+    if (column == nullptr) throw InvalidArgumentException::property_of_another_type(name);
+    return *column;
+}
+
+template <typename Column>
+Column& Properties::own_(const std::string& name) {
+    // the type is checked before a shared column is copied
+    find_<Column>(name);
+    Column* column = nullptr;
+    try {
+        column = &static_cast<Column&>(columns_.find(name)->second.write());
+    }
+    catch (const std::bad_alloc&) {
+        throw UnavailableMemoryException::property_column_unable_to_insert();
+    }
+    column->rows_ = &rows_;
+    return *column;
+}
+
+template <typename T>
+typename PropertyColumnOf<T>::type& Properties::add(const std::string& name) {
+    using Column = typename PropertyColumnOf<T>::type;
+    auto found = columns_.find(name);
+    if (found != columns_.end()) {
+        if (dynamic_cast<const Column*>(&found->second.get()) == nullptr)
+            throw ConflictingItemException::adding_conflicting_property(name);
+        return own_<Column>(name);
+    }
+    try {
+        std::unique_ptr<PropertyColumn> column(new Column());
+        Column& added = static_cast<Column&>(*column);
+        added.rows_ = &rows_;
+        columns_.emplace(name, CopyOnWrite<PropertyColumn>(std::move(column)));
+        return added;
+    }
+    catch (const std::bad_alloc&) {
+        throw UnavailableMemoryException::property_column_unable_to_insert();
+    }
+}
+
+template <typename T>
+typename PropertyColumnOf<T>::type& Properties::column(const std::string& name) {
+    return own_<typename PropertyColumnOf<T>::type>(name);
+}
+
+template <typename T>
+const typename PropertyColumnOf<T>::type& Properties::column(const std::string& name) const {
+    return find_<typename PropertyColumnOf<T>::type>(name);
+}
+
+inline bool Properties::contains(const std::string& name) const {
+    return columns_.find(name) != columns_.end();
+}
+
+inline void Properties::remove(const std::string& name) {
+    columns_.erase(name);
+}
+
+inline std::vector<std::string> Properties::names() const {
+    std::vector<std::string> names;
+    names.reserve(columns_.size());
+    for (const auto& column : columns_) {
+        names.push_back(column.first);
+    }
+    return names;
+}
+
+inline Properties::Properties(const Properties& other) : columns_(other.columns_) {}
+
+inline Properties::Properties(Properties&& other) noexcept
+    : columns_(std::move(other.columns_)) {}
+
+inline Properties& Properties::operator=(const Properties& other) {
+    columns_ = other.columns_;
+    return *this;
+}
+
+inline Properties& Properties::operator=(Properties&& other) noexcept {
+    columns_ = std::move(other.columns_);
+    return *this;
+}
+
+inline void Properties::bound(std::function<size_t()> rows) {
+    rows_ = std::move(rows);
+}
+
+inline size_t Properties::memory_usage() const {
+    size_t bytes = 0;
+    for (const auto& column : columns_) {
+        bytes += column.second.get().memory_usage();
+    }
+    return bytes;
+}
+
+inline size_t Properties::shared_memory_usage() const {
+    size_t bytes = 0;
+    for (const auto& column : columns_) {
+        if (column.second.is_shared()) bytes += column.second.get().memory_usage();
+    }
+    return bytes;
+}
+
+
+#endif
\ No newline at end of file
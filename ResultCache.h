@@ -0,0 +1,335 @@
+#ifndef __RESULT_CACHE_H
+#define __RESULT_CACHE_H
+
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include "Exceptions.h"
+#include "MemoryUsage.h"
+
+
+/// @file ResultCache.h
+/// @brief Contains the ResultCache keeping the results of algorithms run on a graph and its
+///  member function definitions
+
+
+/// @brief Counters of the lookups and evictions of a ResultCache
+struct ResultCacheStats {
+    /// @brief The number of lookups answered from the cache
+    size_t hits = 0;
+
+    /// @brief The number of lookups that had to compute the result
+    size_t misses = 0;
+
+    /// @brief The number of results evicted to stay within the memory limit
+    size_t evictions = 0;
+
+    /// @brief The number of times the cache was emptied because the graph changed
+    size_t invalidations = 0;
+};
+
+/// @brief A cache of the results of algorithms keyed by the name of the algorithm and its
+///  parameters. Every result belongs to the version of the graph it was computed on; looking up
+///  with another version empties the cache first. The least recently used results are evicted
+///  once the estimated memory of the results exceeds the limit. Safe to use from many threads
+///  at once, the results are computed outside the lock and shared as immutable values
+class ResultCache {
+public:
+    /// @brief The memory limit of a cache constructed without one
+    static const size_t DEFAULT_MEMORY_LIMIT = size_t(64) << 20;
+
+    /// @brief Constructs an empty cache
+    /// @param memory_limit The number of bytes the results may take together
+    explicit ResultCache(size_t memory_limit = DEFAULT_MEMORY_LIMIT);
+
+    ResultCache(const ResultCache& other) = delete;
+    ResultCache& operator=(const ResultCache& other) = delete;
+
+    /// @brief Gets the result of an algorithm from the cache, computing and caching it if it is
+    ///  not there; the memory of a result is estimated as its size plus what HeapUsage says it
+    ///  owns, a result larger than the whole limit is returned without being cached
+    /// @tparam Result The type of the result, copyable or movable
+    /// @tparam Compute A callable taking no arguments and returning the result
+    /// @tparam Parameters The types of the parameters, printable to an output stream
+    /// @param version The version of the graph the result is for
+    /// @param algorithm The name of the algorithm
+    /// @param compute The function computing the result
+    /// @param parameters The parameters of the algorithm, part of the key
+    /// @return The shared result
+    /// @exception InvalidArgumentException If the key is cached with a result of another type
+    /// @exception Any exception thrown by compute, nothing is cached then
+    template <typename Result, typename Compute, typename... Parameters>
+    std::shared_ptr<const Result> get(uint64_t version, const std::string& algorithm,
+        Compute compute, const Parameters&... parameters);
+
+    /// @brief Removes every result
+    void clear();
+
+    /// @brief Set the memory limit, evicting the least recently used results above it
+    /// @param bytes The number of bytes the results may take together
+    void set_memory_limit(size_t bytes);
+
+    /// @brief Get the memory limit
+    /// @return The number of bytes the results may take together
+    size_t memory_limit() const;
+
+    /// @brief Get the estimated memory of the cached results
+    /// @return The number of bytes
+    size_t memory_usage() const;
+
+    /// @brief Get the number of cached results
+    /// @return The number of results
+    size_t size() const;
+
+    /// @brief Get the counters of the lookups and evictions
+    /// @return The counters
+    ResultCacheStats stats() const;
+
+    /// @brief Swaps the results, the limits and the counters with another cache
+    /// @param other The other cache
+    void swap(ResultCache& other) noexcept;
+
+private:
+    /// @brief A cached result
+    struct Entry {
+        /// @brief The key of the result
+        std::string key;
+
+        /// @brief The result, of the type given by type
+        std::shared_ptr<const void> result;
+
+        /// @brief The type of the result
+        std::type_index type;
+
+        /// @brief The estimated memory of the result
+        size_t bytes;
+    };
+
+    /// @brief Builds the key of a result
+    /// @tparam Parameters The types of the parameters
+    /// @param algorithm The name of the algorithm
+    /// @param parameters The parameters
+    /// @return The name followed by the printed parameters, each prefixed by its length so no
+    ///  printout can run into the next one
+    template <typename... Parameters>
+    static std::string key_(const std::string& algorithm, const Parameters&... parameters);
+
+    /// @brief Appends a printed parameter to a key, prefixed by its length; floating point
+    ///  parameters are printed with every digit telling them apart
+    /// @tparam Parameter The type of the parameter
+    /// @param key The key to append to
+    /// @param parameter The parameter
+    template <typename Parameter>
+    static void append_(std::string& key, const Parameter& parameter);
+
+    /// @brief Looks a result up, emptying the cache first if the version changed; expects the
+    ///  lock to be held
+    /// @param version The version of the graph
+    /// @param key The key of the result
+    /// @param type The type of the result
+    /// @param algorithm The name of the algorithm, for the exception
+    /// @return The result, nullptr if it is not cached
+    /// @exception InvalidArgumentException If the key is cached with a result of another type
+    std::shared_ptr<const void> find_(uint64_t version, const std::string& key,
+        std::type_index type, const std::string& algorithm);
+
+    /// @brief Caches a result unless the version changed meanwhile or it exceeds the limit;
+    ///  expects the lock to be held
+    /// @param version The version of the graph the result was computed on
+    /// @param entry The result
+    void insert_(uint64_t version, Entry entry);
+
+    /// @brief Evicts the least recently used results until they fit the limit; expects the
+    ///  lock to be held
+    void evict_() noexcept;
+
+    /// @brief Removes every result; expects the lock to be held
+    void clear_() noexcept;
+
+    /// @brief Guards everything below
+    mutable std::mutex mutex_;
+
+    /// @brief The results, the most recently used first
+    std::list<Entry> entries_;
+
+    /// @brief The results by key
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+
+    /// @brief The version of the graph the results belong to
+    uint64_t version_;
+
+    /// @brief The memory limit in bytes
+    size_t memory_limit_;
+
+    /// @brief The estimated memory of the results
+    size_t memory_usage_;
+
+    /// @brief The counters
+    ResultCacheStats stats_;
+};
+
+inline ResultCache::ResultCache(size_t memory_limit)
+    : version_(0), memory_limit_(memory_limit), memory_usage_(0) {}
+
+template <typename Result, typename Compute, typename... Parameters>
+std::shared_ptr<const Result> ResultCache::get(uint64_t version, const std::string& algorithm,
+        Compute compute, const Parameters&... parameters) {
+    std::string key = key_(algorithm, parameters...);
+    std::type_index type(typeid(Result));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::shared_ptr<const void> found = find_(version, key, type, algorithm);
+        if (found != nullptr) {
+            ++stats_.hits;
+            return std::static_pointer_cast<const Result>(found);
+        }
+        ++stats_.misses;
+    }
+    // computed without the lock, so other results can be looked up meanwhile
+    std::shared_ptr<const Result> result = std::make_shared<const Result>(compute());
+    size_t bytes = sizeof(Result) + HeapUsage<Result>::of(*result) + key.capacity() +
+        sizeof(Entry);
+    std::lock_guard<std::mutex> lock(mutex_);
+    try {
+        insert_(version, Entry{ std::move(key), result, type, bytes });
+    }
+    catch (const std::bad_alloc&) {
+        // the result is returned anyway, it is only not cached
+    }
+    return result;
+}
+
+template <typename... Parameters>
+std::string ResultCache::key_(const std::string& algorithm, const Parameters&... parameters) {
+    std::string key;
+    append_(key, algorithm);
+    // the pack expansion inside an initializer list appends the parameters in order
+    int expand[] = { 0, (append_(key, parameters), 0)... };
+    (void)expand;
+    return key;
+}
+
+template <typename Parameter>
+void ResultCache::append_(std::string& key, const Parameter& parameter) {
+    std::ostringstream printed;
+    printed << std::setprecision(std::numeric_limits<long double>::max_digits10) << parameter;
+    std::string text = printed.str();
+    key += std::to_string(text.size());
+    key += ':';
+    key += text;
+}
+
+inline std::shared_ptr<const void> ResultCache::find_(uint64_t version, const std::string& key,
+        std::type_index type, const std::string& algorithm) {
+    if (version != version_) {
+        if (!entries_.empty()) ++stats_.invalidations;
+        clear_();
+        version_ = version;
+        return nullptr;
+    }
+    auto found = index_.find(key);
+    if (found == index_.end()) return nullptr;
+    if (found->second->type != type)
+        throw InvalidArgumentException::cached_result_of_another_type(algorithm);
+    // the result becomes the most recently used one
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return found->second->result;
+}
+
+inline void ResultCache::insert_(uint64_t version, Entry entry) {
+    // a result of an older version is stale already, one of a newer version empties the cache
+    if (version != version_) {
+        if (version < version_) return;
+        if (!entries_.empty()) ++stats_.invalidations;
+        clear_();
+        version_ = version;
+    }
+    if (entry.bytes > memory_limit_) return;
+    auto found = index_.find(entry.key);
+    if (found != index_.end()) {
+        // another thread computed the same result meanwhile
+        entries_.splice(entries_.begin(), entries_, found->second);
+        return;
+    }
+    entries_.push_front(std::move(entry));
+    try {
+        index_.emplace(entries_.front().key, entries_.begin());
+    }
+    catch (...) {
+        entries_.pop_front();
+        throw;
+    }
+    memory_usage_ += entries_.front().bytes;
+    evict_();
+}
+
+inline void ResultCache::evict_() noexcept {
+    while (memory_usage_ > memory_limit_ && !entries_.empty()) {
+        memory_usage_ -= entries_.back().bytes;
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+        ++stats_.evictions;
+    }
+}
+
+inline void ResultCache::clear_() noexcept {
+    entries_.clear();
+    index_.clear();
+    memory_usage_ = 0;
+}
+
+inline void ResultCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    clear_();
+}
+
+inline void ResultCache::set_memory_limit(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    memory_limit_ = bytes;
+    evict_();
+}
+
+inline size_t ResultCache::memory_limit() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return memory_limit_;
+}
+
+inline size_t ResultCache::memory_usage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return memory_usage_;
+}
+
+inline size_t ResultCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+inline ResultCacheStats ResultCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+inline void ResultCache::swap(ResultCache& other) noexcept {
+    if (this == &other) return;
+    std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+    std::unique_lock<std::mutex> other_lock(other.mutex_, std::defer_lock);
+    std::lock(lock, other_lock);
+    entries_.swap(other.entries_);
+    index_.swap(other.index_);
+    std::swap(version_, other.version_);
+    std::swap(memory_limit_, other.memory_limit_);
+    std::swap(memory_usage_, other.memory_usage_);
+    std::swap(stats_, other.stats_);
+}
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,840 @@
+#ifndef __THREAD_POOL_H
+#define __THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include "Numa.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+/// @file ThreadPool.h
+/// @brief Contains the work-stealing ThreadPool shared by the graph algorithms, its
+///  WorkStealingDeque and their member function definitions
+
+
+/// @brief The options of a thread pool
+struct ThreadPoolOptions {
+    /// @brief The number of worker threads, the thread calling parallel_for works as well,
+    ///  so the default leaves exactly one thread per hardware thread
+    size_t threads = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+
+    /// @brief Pin worker i to hardware thread (i + 1) % hardware threads,
+    ///  leaving the first one to the calling thread
+    bool pin = false;
+
+    /// @brief Spread the workers over the NUMA nodes round robin and pin every worker to a
+    ///  hardware thread of its node, so parallel_for_partitioned keeps partitions on their node
+    bool numa = false;
+};
+
+/// @brief A work-stealing thread pool; every worker owns a Chase-Lev deque, splits the ranges
+///  it runs in halves pushing the upper half to its own deque and idle workers steal the oldest,
+///  therefore biggest, halves. The thread calling parallel_for helps until its range is done,
+///  so parallel_for can be nested and a pool with no workers just runs everything inline
+class ThreadPool {
+public:
+    /// @brief Constructs a thread pool and starts its workers
+    /// @param options The options of the thread pool
+    explicit ThreadPool(const ThreadPoolOptions& options = ThreadPoolOptions());
+
+    /// @brief Stops and joins the workers, no parallel_for may be running anymore
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool& other) = delete;
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+
+    /// @brief Get the number of worker threads
+    /// @return The number of worker threads, not counting the calling thread
+    size_t thread_count() const;
+
+    /// @brief Calls the given function for every index of the given range in parallel and
+    ///  returns once all calls are done
+    /// @tparam Function A callable taking an index
+    /// @param begin The first index of the range
+    /// @param end The index after the last index of the range
+    /// @param function The function to call
+    /// @param grain The size of the ranges that are not split any further, 0 to choose it from
+    ///  the size of the range and the number of threads
+    /// @exception Any exception thrown by the function, rethrown after the range is done; the
+    ///  indices that were not started yet are skipped once the function throws
+    template <typename Function>
+    void parallel_for(size_t begin, size_t end, Function function, size_t grain = 0);
+
+    /// @brief Calls the given function for disjoint subranges covering the given range in
+    ///  parallel and returns once all calls are done
+    /// @tparam Function A callable taking the first index and the index after the last index
+    ///  of a subrange
+    /// @param begin The first index of the range
+    /// @param end The index after the last index of the range
+    /// @param function The function to call
+    /// @param grain The size of the subranges that are not split any further, 0 to choose it
+    ///  from the size of the range and the number of threads
+    /// @exception Any exception thrown by the function, rethrown after the range is done; the
+    ///  subranges that were not started yet are skipped once the function throws
+    template <typename Function>
+    void parallel_for_ranges(size_t begin, size_t end, Function function, size_t grain = 0);
+
+    /// @brief Calls the given function for every index of every partition in parallel and
+    ///  returns once all calls are done; a partition is run by the workers of its NUMA node,
+    ///  workers of other nodes only take it over once they are out of local work
+    /// @tparam Function A callable taking an index
+    /// @param partitions The partitions, their NUMA nodes are taken modulo numa_node_count()
+    /// @param function The function to call
+    /// @param grain The size of the ranges that are not split any further, 0 to choose it from
+    ///  the size of the partitions and the number of threads
+    /// @exception Any exception thrown by the function, rethrown after the partitions are done
+    template <typename Function>
+    void parallel_for_partitioned(const std::vector<NumaPartition>& partitions, Function function,
+        size_t grain = 0);
+
+    /// @brief Get the number of NUMA nodes the workers are spread over
+    /// @return The number of NUMA nodes, 1 unless the pool was created with the numa option
+    size_t numa_node_count() const;
+
+    /// @brief Get the pool shared by all graph routines, started on first use
+    /// @return The shared pool
+    static ThreadPool& global();
+
+private:
+    /// @brief A single parallel_for, lives on the stack of its caller
+    struct Job {
+        /// @brief Calls the type-erased function on a subrange
+        void (*invoke)(const void* function, size_t begin, size_t end);
+
+        /// @brief The type-erased function
+        const void* function;
+
+        /// @brief The size of the subranges that are not split any further
+        size_t grain;
+
+        /// @brief The number of indices that were not done yet
+        std::atomic<size_t> remaining;
+
+        /// @brief Set once the function throws, the rest of the range is skipped
+        std::atomic<bool> failed;
+
+        /// @brief The first exception thrown by the function
+        std::exception_ptr error;
+
+        /// @brief Guards the first exception
+        std::mutex error_mutex;
+    };
+
+    /// @brief A subrange of a job waiting to be run
+    struct Task {
+        /// @brief The job the subrange belongs to
+        Job* job;
+
+        /// @brief The first index of the subrange
+        size_t begin;
+
+        /// @brief The index after the last index of the subrange
+        size_t end;
+    };
+
+    /// @brief A Chase-Lev deque of tasks, the owner pushes and pops at the bottom
+    ///  and any thread steals from the top
+    class WorkStealingDeque {
+    public:
+        /// @brief Constructs an empty deque
+        WorkStealingDeque();
+
+        /// @brief Pushes a task to the bottom, only the owner may call this
+        /// @param task The task
+        /// @exception std::bad_alloc If the deque cannot grow
+        void push(Task* task);
+
+        /// @brief Pops the most recently pushed task, only the owner may call this
+        /// @return The task, nullptr if the deque is empty
+        Task* pop();
+
+        /// @brief Steals the least recently pushed task, any thread may call this
+        /// @return The task, nullptr if the deque is empty or another thread won the task
+        Task* steal();
+
+        /// @brief Tests if the deque looks empty, may be outdated by the time it returns
+        /// @return True if the deque looks empty
+        bool empty() const;
+
+    private:
+        /// @brief A circular buffer of tasks, the capacity is a power of two
+        struct Buffer {
+            /// @brief Constructs a buffer with the given capacity
+            /// @param capacity The capacity, a power of two
+            explicit Buffer(size_t capacity);
+
+            /// @brief The capacity
+            size_t capacity;
+
+            /// @brief The slots
+            std::unique_ptr<std::atomic<Task*>[]> slots;
+        };
+
+        /// @brief The initial capacity of the buffer
+        static const size_t INITIAL_CAPACITY = 64;
+
+        /// @brief The index of the top, where thieves steal from
+        std::atomic<int64_t> top_;
+
+        /// @brief The index of the bottom, where the owner pushes and pops
+        std::atomic<int64_t> bottom_;
+
+        /// @brief The current buffer
+        std::atomic<Buffer*> buffer_;
+
+        /// @brief All the buffers ever used, a thief may still read a replaced buffer
+        std::vector<std::unique_ptr<Buffer>> buffers_;
+    };
+
+    /// @brief A worker thread and its deque
+    struct Worker {
+        /// @brief The pool the worker belongs to
+        ThreadPool* pool;
+
+        /// @brief The index of the worker
+        size_t index;
+
+        /// @brief The NUMA node of the worker
+        size_t numa_node;
+
+        /// @brief The hardware thread the worker is pinned to, if pinning
+        size_t cpu;
+
+        /// @brief The deque of the worker
+        WorkStealingDeque deque;
+
+        /// @brief The state of the random victim selection
+        uint64_t random;
+
+        /// @brief The thread of the worker
+        std::thread thread;
+    };
+
+    /// @brief A queue of tasks shared by many threads
+    struct TaskQueue {
+        /// @brief Constructs an empty queue
+        TaskQueue();
+
+        /// @brief The tasks
+        std::deque<Task*> tasks;
+
+        /// @brief The number of tasks, read without taking the lock
+        std::atomic<size_t> count;
+
+        /// @brief Guards the tasks
+        std::mutex mutex;
+    };
+
+    /// @brief The per-thread arena of tasks, tasks are reused instead of allocated for every
+    ///  split; a task is returned to the arena of the thread that ran it
+    struct TaskArena {
+        /// @brief The most tasks kept around per thread
+        static const size_t MAX_CACHED = 4096;
+
+        /// @brief Frees the cached tasks
+        ~TaskArena();
+
+        /// @brief The cached tasks
+        std::vector<Task*> free;
+    };
+
+    /// @brief Calls a function of the given type on each index of a subrange
+    /// @tparam Function A callable taking an index
+    /// @param function The function
+    /// @param begin The first index of the subrange
+    /// @param end The index after the last index of the subrange
+    template <typename Function>
+    static void invoke_each_(const void* function, size_t begin, size_t end);
+
+    /// @brief Calls a function of the given type on a subrange
+    /// @tparam Function A callable taking the first index and the index after the last index
+    /// @param function The function
+    /// @param begin The first index of the subrange
+    /// @param end The index after the last index of the subrange
+    template <typename Function>
+    static void invoke_range_(const void* function, size_t begin, size_t end);
+
+    /// @brief Runs a job over a range on the calling thread and helps until it is done
+    /// @param job The job
+    /// @param begin The first index of the range
+    /// @param end The index after the last index of the range
+    void run_(Job& job, size_t begin, size_t end);
+
+    /// @brief Hands the partitions of a job to the queues of their NUMA nodes and helps
+    ///  until the job is done
+    /// @param job The job
+    /// @param partitions The partitions
+    void run_partitioned_(Job& job, const std::vector<NumaPartition>& partitions);
+
+    /// @brief Helps with the waiting tasks until the given job is done
+    /// @param job The job
+    /// @param self The calling worker, nullptr for a thread outside of the pool
+    /// @exception The first exception thrown by the job's function
+    void wait_(Job& job, Worker* self);
+
+    /// @brief Get the worker of this pool running on the calling thread
+    /// @return The worker, nullptr if the calling thread is not a worker of this pool
+    Worker* current_worker_();
+
+    /// @brief Get the worker running on the calling thread, of any pool
+    /// @return A reference to the thread's worker pointer
+    static Worker*& thread_worker_();
+
+    /// @brief Get the task arena of the calling thread
+    /// @return The task arena
+    static TaskArena& thread_arena_();
+
+    /// @brief Takes a task from the arena of the calling thread or allocates a new one
+    /// @param job The job of the task
+    /// @param begin The first index of the subrange
+    /// @param end The index after the last index of the subrange
+    /// @return The task, nullptr if there isn't enough memory
+    static Task* allocate_task_(Job* job, size_t begin, size_t end);
+
+    /// @brief Returns a task to the arena of the calling thread
+    /// @param task The task
+    static void release_task_(Task* task);
+
+    /// @brief Splits and runs a subrange of a job, the subranges split off are pushed to the
+    ///  calling worker's deque or to the injection queue
+    /// @param job The job
+    /// @param begin The first index of the subrange
+    /// @param end The index after the last index of the subrange
+    /// @param self The calling worker, nullptr for a thread outside of the pool
+    void execute_(Job* job, size_t begin, size_t end, Worker* self);
+
+    /// @brief Runs a task taken from a deque or the injection queue and returns it to the arena
+    /// @param task The task
+    /// @param self The calling worker, nullptr for a thread outside of the pool
+    void execute_(Task* task, Worker* self);
+
+    /// @brief Makes a task available to the other threads
+    /// @param task The task
+    /// @param self The calling worker, nullptr for a thread outside of the pool
+    /// @return False if there wasn't enough memory to push the task
+    bool push_(Task* task, Worker* self);
+
+    /// @brief Pushes a task to a shared queue and wakes up the sleeping workers
+    /// @param queue The queue
+    /// @param task The task
+    /// @return False if there wasn't enough memory to push the task
+    bool push_shared_(TaskQueue& queue, Task* task);
+
+    /// @brief Takes the oldest task of a shared queue
+    /// @param queue The queue
+    /// @return The task, nullptr if the queue is empty
+    static Task* pop_shared_(TaskQueue& queue);
+
+    /// @brief Steals a task from the workers of the given NUMA node or of the other nodes
+    /// @param self The calling worker, nullptr for a thread outside of the pool
+    /// @param local True to steal from the workers on the node of the calling worker, false to
+    ///  steal from the rest
+    /// @return The task, nullptr if none was found
+    Task* steal_(Worker* self, bool local);
+
+    /// @brief Finds a task to run, from the own deque, the own node's queue, the injection queue,
+    ///  a worker on the same node, another node's queue or any other worker, in this order
+    /// @param self The calling worker, nullptr for a thread outside of the pool
+    /// @return The task, nullptr if none was found
+    Task* find_task_(Worker* self);
+
+    /// @brief Tests if there is any task waiting, may be outdated by the time it returns
+    /// @return True if there is a task waiting
+    bool has_work_() const;
+
+    /// @brief Wakes up the sleeping workers if there are any
+    void wake_();
+
+    /// @brief The main loop of a worker
+    /// @param self The worker
+    void work_(Worker* self);
+
+    /// @brief Pins the worker's thread to a hardware thread, does nothing if not supported
+    /// @param self The worker
+    static void pin_(Worker* self);
+
+    /// @brief The workers
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    /// @brief The tasks pushed by threads outside of the pool
+    TaskQueue injected_;
+
+    /// @brief The partitions waiting for the workers of every NUMA node
+    std::vector<std::unique_ptr<TaskQueue>> node_queues_;
+
+    /// @brief The number of sleeping workers
+    std::atomic<size_t> sleeping_;
+
+    /// @brief Incremented to wake up the sleeping workers, guarded by sleep_mutex_
+    uint64_t wake_epoch_;
+
+    /// @brief Set once the pool is being destroyed, guarded by sleep_mutex_
+    bool stopping_;
+
+    /// @brief Guards the sleeping
+    std::mutex sleep_mutex_;
+
+    /// @brief The sleeping workers wait on this
+    std::condition_variable sleep_condition_;
+};
+
+inline ThreadPool::WorkStealingDeque::Buffer::Buffer(size_t capacity)
+    : capacity(capacity), slots(new std::atomic<Task*>[capacity]) {}
+
+inline ThreadPool::WorkStealingDeque::WorkStealingDeque() : top_(0), bottom_(0) {
+    buffers_.emplace_back(new Buffer(INITIAL_CAPACITY));
+    buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+}
+
+inline void ThreadPool::WorkStealingDeque::push(Task* task) {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    int64_t top = top_.load(std::memory_order_acquire);
+    Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+    if (bottom - top >= static_cast<int64_t>(buffer->capacity)) {
+        buffers_.emplace_back(new Buffer(buffer->capacity * 2));
+        Buffer* grown = buffers_.back().get();
+        for (int64_t i = top; i < bottom; i++) {
+            grown->slots[i & (grown->capacity - 1)].store(
+                buffer->slots[i & (buffer->capacity - 1)].load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+        }
+        buffer_.store(grown, std::memory_order_release);
+        buffer = grown;
+    }
+    buffer->slots[bottom & (buffer->capacity - 1)].store(task, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_release);
+}
+
+inline ThreadPool::Task* ThreadPool::WorkStealingDeque::pop() {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_relaxed);
+    if (top > bottom) {
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Task* task = buffer->slots[bottom & (buffer->capacity - 1)].load(std::memory_order_relaxed);
+    if (top == bottom) {
+        // the last task, race the thieves for it
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+            std::memory_order_relaxed)) task = nullptr;
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return task;
+}
+
+inline ThreadPool::Task* ThreadPool::WorkStealingDeque::steal() {
+    int64_t top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) return nullptr;
+    Buffer* buffer = buffer_.load(std::memory_order_acquire);
+    Task* task = buffer->slots[top & (buffer->capacity - 1)].load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+        std::memory_order_relaxed)) return nullptr;
+    return task;
+}
+
+inline bool ThreadPool::WorkStealingDeque::empty() const {
+    return top_.load(std::memory_order_acquire) >= bottom_.load(std::memory_order_acquire);
+}
+
+inline ThreadPool::TaskArena::~TaskArena() {
+    for (Task* task : free) {
+        delete task;
+    }
+}
+
+inline ThreadPool::ThreadPool(const ThreadPoolOptions& options)
+    : sleeping_(0), wake_epoch_(0), stopping_(false) {
+    const NumaTopology& topology = NumaTopology::get();
+    size_t nodes = options.numa ? topology.node_count() : 1;
+    for (size_t node = 0; node < nodes; node++) {
+        node_queues_.emplace_back(new TaskQueue());
+    }
+    size_t hardware = std::max(std::thread::hardware_concurrency(), 1u);
+    // all workers exist before any of them starts stealing from the others
+    for (size_t i = 0; i < options.threads; i++) {
+        workers_.emplace_back(new Worker());
+        Worker* self = workers_.back().get();
+        self->pool = this;
+        self->index = i;
+        self->random = 0x9E3779B97F4A7C15ull * (i + 1);
+        self->numa_node = i % nodes;
+        if (options.numa) {
+            // the first hardware thread of the first node is left to the calling thread
+            const std::vector<size_t>& cpus = topology.cpus(self->numa_node);
+            size_t slot = i / nodes + (self->numa_node == 0 ? 1 : 0);
+            self->cpu = cpus[slot % cpus.size()];
+        }
+        else {
+            self->cpu = (i + 1) % hardware;
+        }
+    }
+    for (auto& worker : workers_) {
+        Worker* self = worker.get();
+        self->thread = std::thread([this, self]() { work_(self); });
+        if (options.pin || options.numa) pin_(self);
+    }
+}
+
+inline ThreadPool::TaskQueue::TaskQueue() : count(0) {}
+
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    sleep_condition_.notify_all();
+    for (auto& worker : workers_) {
+        worker->thread.join();
+    }
+}
+
+inline size_t ThreadPool::thread_count() const {
+    return workers_.size();
+}
+
+inline size_t ThreadPool::numa_node_count() const {
+    return node_queues_.size();
+}
+
+inline ThreadPool& ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
+
+template <typename Function>
+void ThreadPool::invoke_each_(const void* function, size_t begin, size_t end) {
+    const Function& callable = *static_cast<const Function*>(function);
+    for (size_t i = begin; i < end; i++) {
+        callable(i);
+    }
+}
+
+template <typename Function>
+void ThreadPool::invoke_range_(const void* function, size_t begin, size_t end) {
+    (*static_cast<const Function*>(function))(begin, end);
+}
+
+template <typename Function>
+void ThreadPool::parallel_for(size_t begin, size_t end, Function function, size_t grain) {
+    if (begin >= end) return;
+    Job job;
+    job.invoke = &ThreadPool::invoke_each_<Function>;
+    job.function = &function;
+    job.grain = grain;
+    run_(job, begin, end);
+}
+
+template <typename Function>
+void ThreadPool::parallel_for_ranges(size_t begin, size_t end, Function function, size_t grain) {
+    if (begin >= end) return;
+    Job job;
+    job.invoke = &ThreadPool::invoke_range_<Function>;
+    job.function = &function;
+    job.grain = grain;
+    run_(job, begin, end);
+}
+
+template <typename Function>
+void ThreadPool::parallel_for_partitioned(const std::vector<NumaPartition>& partitions,
+        Function function, size_t grain) {
+    Job job;
+    job.invoke = &ThreadPool::invoke_each_<Function>;
+    job.function = &function;
+    job.grain = grain;
+    run_partitioned_(job, partitions);
+}
+
+inline void ThreadPool::run_(Job& job, size_t begin, size_t end) {
+    // about 8 subranges per thread balance the load without splitting too much
+    if (job.grain == 0) job.grain = std::max<size_t>(1, (end - begin) / (8 * (thread_count() + 1)));
+    job.remaining.store(end - begin, std::memory_order_relaxed);
+    job.failed.store(false, std::memory_order_relaxed);
+
+    Worker* self = current_worker_();
+    execute_(&job, begin, end, self);
+    wait_(job, self);
+}
+
+inline void ThreadPool::run_partitioned_(Job& job, const std::vector<NumaPartition>& partitions) {
+    size_t total = 0;
+    for (const NumaPartition& partition : partitions) {
+        if (partition.end > partition.begin) total += partition.end - partition.begin;
+    }
+    if (total == 0) return;
+    if (job.grain == 0) job.grain = std::max<size_t>(1, total / (8 * (thread_count() + 1)));
+    job.remaining.store(total, std::memory_order_relaxed);
+    job.failed.store(false, std::memory_order_relaxed);
+
+    Worker* self = current_worker_();
+    for (const NumaPartition& partition : partitions) {
+        if (partition.end <= partition.begin) continue;
+        TaskQueue& queue = *node_queues_[partition.numa_node % node_queues_.size()];
+        Task* task = allocate_task_(&job, partition.begin, partition.end);
+        if (task != nullptr && push_shared_(queue, task)) continue;
+        // out of memory, run it right here instead
+        if (task != nullptr) release_task_(task);
+        execute_(&job, partition.begin, partition.end, self);
+    }
+    wait_(job, self);
+}
+
+inline void ThreadPool::wait_(Job& job, Worker* self) {
+    // help with whatever is waiting, the own deque holds this job's subranges first
+    while (job.remaining.load(std::memory_order_acquire) != 0) {
+        Task* task = find_task_(self);
+        if (task != nullptr) execute_(task, self);
+        else std::this_thread::yield();
+    }
+    if (job.error) std::rethrow_exception(job.error);
+}
+
+inline ThreadPool::Worker*& ThreadPool::thread_worker_() {
+    thread_local Worker* worker = nullptr;
+    return worker;
+}
+
+inline ThreadPool::Worker* ThreadPool::current_worker_() {
+    Worker* worker = thread_worker_();
+    return worker != nullptr && worker->pool == this ? worker : nullptr;
+}
+
+inline ThreadPool::TaskArena& ThreadPool::thread_arena_() {
+    thread_local TaskArena arena;
+    return arena;
+}
+
+inline ThreadPool::Task* ThreadPool::allocate_task_(Job* job, size_t begin, size_t end) {
+    TaskArena& arena = thread_arena_();
+    Task* task;
+    if (!arena.free.empty()) {
+        task = arena.free.back();
+        arena.free.pop_back();
+    }
+    else {
+        task = new (std::nothrow) Task;
+        if (task == nullptr) return nullptr;
+    }
+    task->job = job;
+    task->begin = begin;
+    task->end = end;
+    return task;
+}
+
+inline void ThreadPool::release_task_(Task* task) {
+    TaskArena& arena = thread_arena_();
+    if (arena.free.size() >= TaskArena::MAX_CACHED) {
+        delete task;
+        return;
+    }
+    try {
+        arena.free.push_back(task);
+    }
+    catch (...) {
+        delete task;
+    }
+}
+
+inline void ThreadPool::execute_(Task* task, Worker* self) {
+    Job* job = task->job;
+    size_t begin = task->begin;
+    size_t end = task->end;
+    release_task_(task);
+    execute_(job, begin, end, self);
+}
+
+inline void ThreadPool::execute_(Job* job, size_t begin, size_t end, Worker* self) {
+    while (end - begin > job->grain) {
+        size_t middle = begin + (end - begin) / 2;
+        Task* upper = allocate_task_(job, middle, end);
+        if (upper == nullptr) break;
+        if (!push_(upper, self)) {
+            release_task_(upper);
+            break;
+        }
+        end = middle;
+    }
+    if (!job->failed.load(std::memory_order_relaxed)) {
+        try {
+            job->invoke(job->function, begin, end);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(job->error_mutex);
+            if (!job->error) job->error = std::current_exception();
+            job->failed.store(true, std::memory_order_relaxed);
+        }
+    }
+    // the job may be gone as soon as the last indices are counted off
+    job->remaining.fetch_sub(end - begin, std::memory_order_acq_rel);
+}
+
+inline bool ThreadPool::push_(Task* task, Worker* self) {
+    if (self == nullptr) return push_shared_(injected_, task);
+    try {
+        self->deque.push(task);
+    }
+    catch (...) {
+        return false;
+    }
+    // pairs with the fence in work_, either the sleeper sees the task or this sees the sleeper
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed) != 0) wake_();
+    return true;
+}
+
+inline bool ThreadPool::push_shared_(TaskQueue& queue, Task* task) {
+    try {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(task);
+        queue.count.fetch_add(1, std::memory_order_release);
+    }
+    catch (...) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed) != 0) wake_();
+    return true;
+}
+
+inline ThreadPool::Task* ThreadPool::pop_shared_(TaskQueue& queue) {
+    if (queue.count.load(std::memory_order_acquire) == 0) return nullptr;
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return nullptr;
+    Task* task = queue.tasks.front();
+    queue.tasks.pop_front();
+    queue.count.fetch_sub(1, std::memory_order_relaxed);
+    return task;
+}
+
+inline ThreadPool::Task* ThreadPool::steal_(Worker* self, bool local) {
+    size_t count = workers_.size();
+    if (count == 0) return nullptr;
+    size_t start = 0;
+    if (self != nullptr) {
+        // xorshift, so the workers do not all go after the same victim
+        self->random ^= self->random << 13;
+        self->random ^= self->random >> 7;
+        self->random ^= self->random << 17;
+        start = static_cast<size_t>(self->random % count);
+    }
+    for (size_t i = 0; i < count; i++) {
+        Worker* victim = workers_[(start + i) % count].get();
+        if (victim == self) continue;
+        bool same_node = self != nullptr && victim->numa_node == self->numa_node;
+        if (same_node != local) continue;
+        Task* task = victim->deque.steal();
+        if (task != nullptr) return task;
+    }
+    return nullptr;
+}
+
+inline ThreadPool::Task* ThreadPool::find_task_(Worker* self) {
+    Task* task = nullptr;
+    if (self != nullptr) {
+        task = self->deque.pop();
+        if (task != nullptr) return task;
+        task = pop_shared_(*node_queues_[self->numa_node]);
+        if (task != nullptr) return task;
+    }
+    task = pop_shared_(injected_);
+    if (task != nullptr) return task;
+    if (self != nullptr) {
+        task = steal_(self, true);
+        if (task != nullptr) return task;
+    }
+    for (size_t node = 0; node < node_queues_.size(); node++) {
+        task = pop_shared_(*node_queues_[node]);
+        if (task != nullptr) return task;
+    }
+    return steal_(self, false);
+}
+
+inline bool ThreadPool::has_work_() const {
+    if (injected_.count.load(std::memory_order_acquire) != 0) return true;
+    for (const auto& queue : node_queues_) {
+        if (queue->count.load(std::memory_order_acquire) != 0) return true;
+    }
+    for (const auto& worker : workers_) {
+        if (!worker->deque.empty()) return true;
+    }
+    return false;
+}
+
+inline void ThreadPool::wake_() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        ++wake_epoch_;
+    }
+    sleep_condition_.notify_all();
+}
+
+inline void ThreadPool::work_(Worker* self) {
+    thread_worker_() = self;
+    // spinning a little before sleeping keeps short parallel_for calls off the kernel
+    const size_t SPINS = 64;
+    size_t idle = 0;
+    while (true) {
+        Task* task = find_task_(self);
+        if (task != nullptr) {
+            execute_(task, self);
+            idle = 0;
+            continue;
+        }
+        if (++idle < SPINS) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        if (stopping_) return;
+        uint64_t seen = wake_epoch_;
+        sleeping_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!has_work_()) {
+            sleep_condition_.wait(lock, [&]() { return stopping_ || wake_epoch_ != seen; });
+        }
+        sleeping_.fetch_sub(1, std::memory_order_relaxed);
+        idle = 0;
+    }
+}
+
+inline void ThreadPool::pin_(Worker* self) {
+    size_t cpu = self->cpu;
+#if defined(_WIN32)
+    if (cpu < sizeof(DWORD_PTR) * 8)
+        SetThreadAffinityMask(self->thread.native_handle(), DWORD_PTR(1) << cpu);
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(self->thread.native_handle(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include "CompressedCsr.h"
+#include "AdjacencyView.h"
+
+/// @file CompressedCsrBenchmark.cpp
+/// @brief Compares the memory and neighbor iteration time of the CompressedCsr against the sparse
+///  adjacency rows, run as CompressedCsrBenchmark [nodes] [average degree]
+
+
+using Clock = std::chrono::steady_clock;
+
+/// @brief Measures the time of visiting every neighbor of every node of the given view
+/// @tparam View The adjacency view
+/// @param view The view to iterate
+/// @param sum The sum of all visited targets, keeps the iteration from being optimized away
+/// @return The time per visited neighbor in nanoseconds
+template <typename View>
+double nanoseconds_per_neighbor(const View& view, size_t& sum) {
+    size_t visited = 0;
+    auto start = Clock::now();
+    for (size_t source = 0; source < view.size(); source++) {
+        view.for_each_neighbor(source, [&](size_t target) {
+            sum += target;
+            ++visited;
+        });
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+    return static_cast<double>(elapsed.count()) / std::max<size_t>(visited, 1);
+}
+
+int main(int argc, char** argv) {
+    size_t nodes = argc > 1 ? std::stoul(argv[1]) : 100000;
+    size_t degree = argc > 2 ? std::stoul(argv[2]) : 16;
+
+    DirectedGraph<int, int> graph;
+    std::mt19937_64 random(42);
+    for (size_t i = 0; i < nodes; i++) {
+        graph.nodes().add(0);
+    }
+    // a crawl-like graph, links are mostly local and often copied from the previous page
+    std::vector<size_t> previous;
+    for (size_t source = 0; source < nodes; source++) {
+        std::vector<size_t> current;
+        for (size_t target : previous) {
+            if (random() % 4 != 0) current.push_back(target);
+        }
+        while (current.size() < degree) {
+            current.push_back(random() % 8 == 0 ? random() % nodes
+                : (source + random() % 256) % nodes);
+        }
+        for (size_t target : current) {
+            if (!graph.edges().exists(source, target)) graph.edges().add(source, target, 0);
+        }
+        previous = current;
+    }
+    const Adjacency& adjacency = graph.edges().adjacency();
+
+    auto build_start = Clock::now();
+    CompressedCsr csr(graph.edges());
+    auto build_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+        Clock::now() - build_start);
+
+    size_t rows_bytes = nodes * sizeof(std::vector<std::pair<size_t, size_t>>)
+        + adjacency.entry_count() * sizeof(std::pair<size_t, size_t>);
+    size_t csr_bytes = csr.memory_usage();
+
+    size_t sum = 0;
+    double rows_time = nanoseconds_per_neighbor(adjacency_view(graph.edges()), sum);
+    double csr_time = nanoseconds_per_neighbor(csr, sum);
+
+    std::cout << nodes << " nodes, " << csr.entry_count() << " edges, "
+        << (adjacency.is_dense() ? "dense" : "sparse") << " adjacency, compressed in "
+        << build_time.count() << " ms" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(20) << "" << std::setw(16) << "rows" << std::setw(16) << "csr"
+        << std::endl;
+    std::cout << std::setw(20) << "bytes" << std::setw(16) << rows_bytes
+        << std::setw(16) << csr_bytes << std::endl;
+    std::cout << std::setw(20) << "bits per edge"
+        << std::setw(16) << 8.0 * rows_bytes / csr.entry_count()
+        << std::setw(16) << 8.0 * csr_bytes / csr.entry_count() << std::endl;
+    std::cout << std::setw(20) << "neighbor [ns]" << std::setw(16) << rows_time
+        << std::setw(16) << csr_time << std::endl;
+    std::cerr << sum << std::endl;
+    return 0;
+}
\ No newline at end of file
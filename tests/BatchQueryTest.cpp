@@ -0,0 +1,106 @@
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+#include "Graph.h"
+
+/// @file BatchQueryTest.cpp
+/// @brief Tests that the batch queries answer like the single ones, in the order of the queries
+///  whatever order they are grouped in, and refuse results of another size
+
+
+using TestGraph = DirectedGraph<int, int>;
+
+/// @brief Adds nodes and pseudo random edges, skipping the pairs already connected
+void build_random(TestGraph& graph, size_t nodes, size_t edges) {
+    for (size_t i = 0; i < nodes; i++) {
+        graph.nodes().add(static_cast<int>(i));
+    }
+    uint64_t state = 7;
+    for (size_t i = 0; i < edges; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t source = (state >> 33) % nodes;
+        size_t target = (state >> 13) % nodes;
+        if (!graph.edges().exists(source, target))
+            graph.edges().add(source, target, static_cast<int>(i));
+    }
+}
+
+/// @brief Builds queries over the nodes and a few past them, unsorted and repeating sources
+std::vector<std::pair<size_t, size_t>> make_queries(const TestGraph& graph, size_t count) {
+    std::vector<std::pair<size_t, size_t>> queries;
+    size_t nodes = graph.nodes().size();
+    for (size_t i = 0; i < count; i++) {
+        size_t source = (i * 7919) % (nodes + 2);
+        size_t target = (i * 104729 + 3) % (nodes + 2);
+        queries.emplace_back(source, target);
+        // every edge is asked for too, so some of the answers are true
+        if (i < graph.edges().size()) {
+            queries.emplace_back(graph.edges().sources()[i], graph.edges().targets()[i]);
+        }
+    }
+    return queries;
+}
+
+void check(const TestGraph& graph) {
+    std::vector<std::pair<size_t, size_t>> queries = make_queries(graph, 3000);
+    std::unique_ptr<bool[]> answers(new bool[queries.size()]);
+    std::vector<const Edge<int, int>*> edges(queries.size());
+    graph.edges().exists_batch(queries, std::span<bool>(answers.get(), queries.size()));
+    graph.edges().get_batch(queries, edges);
+    size_t nodes = graph.nodes().size();
+    size_t found = 0;
+    for (size_t i = 0; i < queries.size(); i++) {
+        auto [source, target] = queries[i];
+        bool expected = source < nodes && target < nodes && graph.edges().exists(source, target);
+        assert(answers[i] == expected);
+        assert(edges[i] == (expected ? &graph.edges().get(source, target) : nullptr));
+        found += expected ? 1 : 0;
+    }
+    assert(found >= graph.edges().size());
+}
+
+void test_answers_match_the_single_queries() {
+    TestGraph graph;
+    build_random(graph, 500, 3000);
+    check(graph);
+    // the existence filter answers most of the missing edges first
+    graph.edges().enable_existence_filter();
+    check(graph);
+}
+
+void test_results_of_another_size_are_refused() {
+    TestGraph graph;
+    build_random(graph, 10, 20);
+    std::vector<std::pair<size_t, size_t>> queries = { { 0, 1 }, { 1, 2 }, { 2, 3 } };
+    bool answers[4] = { true, true, true, true };
+    std::vector<const Edge<int, int>*> edges(2, nullptr);
+    for (size_t size : { 2, 4 }) {
+        bool thrown = false;
+        try {
+            graph.edges().exists_batch(queries, std::span<bool>(answers, size));
+        }
+        catch (const InvalidArgumentException&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    bool thrown = false;
+    try {
+        graph.edges().get_batch(queries, edges);
+    }
+    catch (const InvalidArgumentException&) {
+        thrown = true;
+    }
+    // nothing was answered
+    assert(thrown && answers[0] && answers[3] && edges[0] == nullptr && edges[1] == nullptr);
+}
+
+int main() {
+    test_answers_match_the_single_queries();
+    test_results_of_another_size_are_refused();
+    std::cout << "BatchQueryTest passed" << std::endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include <cassert>
+#include <iostream>
+#include <new>
+#include "Graph.h"
+#include "TestGraphs.h"
+
+/// @file BatchTest.cpp
+/// @brief Tests that a batch whose commit fails leaves the graph and its copies as they were
+
+
+/// @brief Data whose copies fail once a given number of them was made, the commit copies the
+///  staged data
+struct Flaky {
+    Flaky(int value = 0) : value(value) {}
+
+    Flaky(const Flaky& other) : value(other.value) {
+        if (copies_left == 0) throw std::bad_alloc();
+        if (copies_left > 0) --copies_left;
+    }
+
+    Flaky(Flaky&& other) noexcept : value(other.value) {}
+
+    Flaky& operator=(const Flaky& other) = default;
+
+    /// @brief The number of copies that still succeed, negative for no limit
+    static int copies_left;
+
+    int value;
+};
+
+int Flaky::copies_left = -1;
+
+using TestGraph = DirectedGraph<Flaky, Flaky>;
+
+void stage(TestGraph& graph) {
+    graph.begin_batch();
+    for (int i = 0; i < 15; i++) {
+        graph.stage_node(Flaky(100 + i));
+    }
+    graph.stage_edge(0, 2, Flaky(-1));
+    graph.stage_edge(24, 25, Flaky(-2));
+    graph.stage_edge(25, 39, Flaky(-3));
+    graph.stage_edge(39, 3, Flaky(-4));
+}
+
+void check_unchanged(const TestGraph& graph, uint64_t version) {
+    assert(graph.nodes().size() == 25 && graph.edges().size() == 24);
+    assert(graph.edges().adjacency().size() == 25);
+    assert(graph.edges().sources().size() == 24 && graph.edges().targets().size() == 24);
+    assert(!graph.edges().exists(0, 2) && graph.edges().exists(0, 1));
+    assert(graph.version() == version);
+    for (size_t i = 0; i < 25; i++) {
+        assert(graph.nodes()[i].getData().value == static_cast<int>(i));
+    }
+}
+
+void test_failed_commit_leaves_everything_as_it_was() {
+    // fails on the nodes, in the middle of the edges and on the last edge
+    for (int copies : { 3, 17, 18 }) {
+        TestGraph graph;
+        build_chain(graph, 25);
+        TestGraph copy(graph);
+        const Node<Flaky>& held = graph.nodes().get(24);
+        const Edge<Flaky, Flaky>& held_edge = graph.edges().get(23);
+        uint64_t version = graph.version();
+        stage(graph);
+        Flaky::copies_left = copies;
+        bool thrown = false;
+        try {
+            graph.commit();
+        }
+        catch (const UnavailableMemoryException&) {
+            thrown = true;
+        }
+        Flaky::copies_left = -1;
+        assert(thrown && graph.in_batch());
+        check_unchanged(graph, version);
+        check_unchanged(copy, copy.version());
+        assert(&held == &graph.nodes().get(24) && held.getData().value == 24);
+        assert(&held_edge == &graph.edges().get(23) && held_edge.getData().value == 23);
+        // the batch is still open, so the same commit can be retried
+        graph.commit();
+        assert(!graph.in_batch() && graph.version() != version);
+        assert(graph.nodes().size() == 40 && graph.edges().size() == 28);
+        assert(graph.edges().get(25, 39).getData().value == -3);
+        assert(graph.edges().get(24).getId() == 24 && graph.edges().exists(39, 3));
+        assert(&held == &graph.nodes().get(24));
+        check_unchanged(copy, copy.version());
+    }
+}
+
+void test_rollback_discards_the_batch() {
+    TestGraph graph;
+    build_chain(graph, 25);
+    uint64_t version = graph.version();
+    stage(graph);
+    graph.rollback();
+    assert(!graph.in_batch());
+    check_unchanged(graph, version);
+    bool thrown = false;
+    try {
+        graph.commit();
+    }
+    catch (const InvalidOperationException&) {
+        thrown = true;
+    }
+    assert(thrown);
+    graph.nodes().add(Flaky(25));
+    assert(graph.nodes().size() == 26);
+}
+
+int main() {
+    test_failed_commit_leaves_everything_as_it_was();
+    test_rollback_discards_the_batch();
+    std::cout << "BatchTest passed" << std::endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+#include "Graph.h"
+
+/// @file BloomFilterTest.cpp
+/// @brief Tests that the Bloom filter answers "maybe" for every pair inserted and "no" for
+///  about as many of the others as its bits per pair promise, and that a graph with the filter
+///  enabled answers exactly like one without it; built once with the AVX2 probe and once
+///  without, where the machine has AVX2
+
+
+/// @brief Counts the pairs of a fixed sequence the filter answers "maybe" for
+/// @param filter The filter
+/// @param first The first id of the sequence, none of its pairs were inserted below it
+/// @param count The number of pairs of the sequence
+/// @return The number of pairs answered "maybe"
+size_t count_maybe(const BloomFilter& filter, size_t first, size_t count) {
+    size_t maybe = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (filter.may_contain(first + i, i)) ++maybe;
+    }
+    return maybe;
+}
+
+void test_build_has_the_intended_probe() {
+#ifdef BLOOM_FILTER_TEST_AVX2
+#ifndef BLOOM_FILTER_AVX2
+    assert(false);
+#endif
+#else
+#ifdef BLOOM_FILTER_AVX2
+    assert(false);
+#endif
+#endif
+}
+
+void test_no_false_negatives_and_few_false_positives() {
+    // loose bounds around the rates of about 3%, 0.4% and 0.1%
+    const std::vector<std::pair<size_t, double>> rates = { { 8, 0.05 }, { 12, 0.008 },
+        { 16, 0.003 } };
+    for (const std::pair<size_t, double>& rate : rates) {
+        BloomFilter filter(100000, rate.first);
+        assert(filter.capacity() >= 100000 && filter.bits_per_pair() == rate.first);
+        for (size_t i = 0; i < 100000; i++) {
+            filter.insert(i, i * 7 + 1);
+        }
+        assert(filter.size() == 100000);
+        for (size_t i = 0; i < 100000; i++) {
+            assert(filter.may_contain(i, i * 7 + 1));
+        }
+        size_t maybe = count_maybe(filter, 5000000, 1000000);
+        assert(maybe > 0 && maybe < rate.second * 1000000);
+    }
+}
+
+void test_same_answers_with_and_without_avx2() {
+    // both builds set and test the same bits, so they agree on every pair, false positives too
+    BloomFilter filter(20000, 8);
+    uint64_t state = 7;
+    for (size_t i = 0; i < 20000; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        filter.insert(state >> 40, (state >> 16) & 0xffffff);
+    }
+    assert(count_maybe(filter, 1u << 30, 200000) == 5965);
+}
+
+void test_empty_and_copied_filters() {
+    BloomFilter none;
+    assert(none.may_contain(1, 2) && none.capacity() == 0 && none.bits_per_pair() == 0);
+    none.insert(1, 2);
+    assert(none.size() == 1 && none.may_contain(3, 4));
+    BloomFilter empty(1000, 12);
+    assert(count_maybe(empty, 0, 1000) == 0);
+    BloomFilter filter(1000, 12);
+    filter.insert(3, 4);
+    BloomFilter copy(filter);
+    BloomFilter assigned;
+    assigned = copy;
+    filter.insert(5, 6);
+    assert(copy.may_contain(3, 4) && copy.size() == 1 && assigned.may_contain(3, 4));
+    BloomFilter moved(std::move(filter));
+    assert(moved.may_contain(3, 4) && moved.may_contain(5, 6) && moved.size() == 2);
+}
+
+/// @brief Adds pseudo random edges, skipping the pairs already connected either way
+void add_random(Graph<int, int>& graph, size_t edges, uint64_t& state) {
+    size_t nodes = graph.nodes().size();
+    for (size_t i = 0; i < edges; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t source = (state >> 33) % nodes;
+        size_t target = (state >> 13) % nodes;
+        if (!graph.edges().exists(source, target) && !graph.edges().exists(target, source))
+            graph.edges().add(source, target, static_cast<int>(i));
+    }
+}
+
+void check_graph_answers_alike(Graph<int, int>& graph) {
+    const size_t nodes = 2000;
+    for (size_t i = 0; i < nodes; i++) {
+        graph.nodes().add(static_cast<int>(i));
+    }
+    uint64_t state = 11;
+    add_random(graph, 3000, state);
+    assert(graph.edges().existence_filter() == nullptr);
+    graph.edges().enable_existence_filter();
+    assert(graph.edges().existence_filter() != nullptr);
+    size_t capacity = graph.edges().existence_filter()->capacity();
+    // grows the filter past its capacity through single edges and a batch
+    add_random(graph, 3000, state);
+    graph.begin_batch();
+    for (size_t i = 0; i < 3000; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t source = (state >> 33) % nodes;
+        size_t target = (state >> 13) % nodes;
+        if (graph.edges().exists(source, target) || graph.edges().exists(target, source))
+            continue;
+        try {
+            graph.stage_edge(source, target, 0);
+        }
+        catch (const ConflictingItemException&) {
+            // staged already in this batch
+        }
+    }
+    graph.commit();
+    assert(graph.edges().existence_filter()->capacity() > capacity);
+    std::vector<std::pair<size_t, size_t>> queries;
+    size_t absent = 0;
+    size_t refused = 0;
+    for (size_t i = 0; i < 100000; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t source = (state >> 33) % nodes;
+        size_t target = (state >> 13) % nodes;
+        bool exists = graph.edges().adjacency().find(source, target) != Adjacency::NONE;
+        assert(graph.edges().exists(source, target) == exists);
+        if (!exists) {
+            ++absent;
+            if (!graph.edges().existence_filter()->may_contain(source, target)) ++refused;
+        }
+        queries.emplace_back(source, target);
+    }
+    // the filter spares the lookup of most absent edges
+    assert(refused > absent * 95 / 100);
+    std::unique_ptr<bool[]> results(new bool[queries.size()]);
+    graph.edges().exists_batch(queries, std::span<bool>(results.get(), queries.size()));
+    for (size_t i = 0; i < queries.size(); i++) {
+        assert(results[i] == graph.edges().exists(queries[i].first, queries[i].second));
+    }
+    graph.edges().disable_existence_filter();
+    assert(graph.edges().existence_filter() == nullptr);
+}
+
+void test_graph_answers_alike() {
+    DirectedGraph<int, int> directed;
+    check_graph_answers_alike(directed);
+    UndirectedGraph<int, int> undirected;
+    check_graph_answers_alike(undirected);
+    // copies keep the filter
+    DirectedGraph<int, int> graph;
+    graph.nodes().add(0);
+    graph.nodes().add(1);
+    graph.edges().enable_existence_filter();
+    graph.edges().add(0, 1, 0);
+    DirectedGraph<int, int> copy(graph);
+    assert(copy.edges().existence_filter() != nullptr);
+    assert(copy.edges().exists(0, 1) && !copy.edges().exists(1, 0));
+}
+
+int main() {
+    test_build_has_the_intended_probe();
+    test_no_false_negatives_and_few_false_positives();
+    test_same_answers_with_and_without_avx2();
+    test_empty_and_copied_filters();
+    test_graph_answers_alike();
+#ifdef BLOOM_FILTER_AVX2
+    std::cout << "BloomFilterTest passed with AVX2" << std::endl;
+#else
+    std::cout << "BloomFilterTest passed" << std::endl;
+#endif
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "ConcurrentGraph.h"
+
+/// @file ConcurrentGraphTest.cpp
+/// @brief Tests that readers of a concurrent graph always see a consistent graph while it is
+///  written to, that replaced storage is freed only once no reader can be using it, and that
+///  of many threads adding the same edge exactly one succeeds, the ids staying dense
+
+
+using TestGraph = ConcurrentDirectedGraph<int, int>;
+
+/// @brief Counts its instances still alive
+struct Counted {
+    Counted() {
+        ++alive;
+    }
+
+    ~Counted() {
+        --alive;
+    }
+
+    static std::atomic<int> alive;
+};
+
+std::atomic<int> Counted::alive(0);
+
+void test_elements_are_published_whole() {
+    my_array::ConcurrentArray<std::vector<size_t>> array;
+    std::atomic<bool> done(false);
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < 3; reader++) {
+        readers.emplace_back([&]() {
+            while (!done.load()) {
+                size_t size = array.size();
+                for (size_t i = 0; i < size; i++) {
+                    assert(array[i].size() == i % 5 && (i % 5 == 0 || array[i].back() == i));
+                }
+            }
+        });
+    }
+    // enough elements to take several segments
+    for (size_t i = 0; i < 5000; i++) {
+        array.emplace_back(i % 5, i);
+    }
+    done = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    assert(array.size() == 5000 && array[4999].size() == 4);
+}
+
+void test_readers_see_a_consistent_graph() {
+    TestGraph graph;
+    std::atomic<bool> done(false);
+    std::atomic<size_t> reads(0);
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < 4; reader++) {
+        readers.emplace_back([&]() {
+            while (!done.load() || reads.load() == 0) {
+                EpochManager::Guard guard = graph.pin();
+                size_t nodes = graph.size();
+                size_t edges = graph.edge_count();
+                // every visible edge has visible endpoints and can be looked up by them
+                for (size_t id = 0; id < edges; id++) {
+                    std::pair<size_t, size_t> ends = graph.endpoints(id);
+                    assert(ends.first < graph.size() && ends.second < graph.size());
+                    assert(graph.edge_id(ends.first, ends.second) == id);
+                    assert(graph.edge_data(id) == static_cast<int>(id));
+                }
+                for (size_t node = 0; node < nodes; node++) {
+                    assert(graph.node_data(node) == static_cast<int>(node));
+                    size_t previous = 0;
+                    bool first = true;
+                    graph.for_each_neighbor(node, [&](size_t target) {
+                        assert(first || target > previous);
+                        previous = target;
+                        first = false;
+                    });
+                }
+                ++reads;
+            }
+        });
+    }
+    // grows the rows of the first nodes again and again, so the readers hold replaced ones
+    size_t id = 0;
+    for (size_t node = 0; node < 200; node++) {
+        graph.add_node(static_cast<int>(node));
+        for (size_t source = 0; source < node && source < 8; source++) {
+            assert(graph.add_edge(source, node, static_cast<int>(id)) == id);
+            ++id;
+        }
+    }
+    done = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    assert(graph.size() == 200 && graph.edge_count() == id && reads.load() > 0);
+    assert(graph.exists(0, 199) && !graph.exists(199, 0) && graph.edge_id(7, 8) == 35);
+    graph.epochs().reclaim();
+    assert(graph.epochs().pending() == 0);
+}
+
+void test_retired_storage_outlives_the_pinned_readers() {
+    EpochManager epochs;
+    EpochManager::Guard pinned = epochs.pin();
+    epochs.retire(new Counted());
+    epochs.reclaim();
+    assert(Counted::alive.load() == 1 && epochs.pending() == 1);
+    // another thread reclaiming frees nothing either while the reader stays pinned
+    std::thread other([&]() {
+        epochs.reclaim();
+    });
+    other.join();
+    assert(Counted::alive.load() == 1);
+    {
+        EpochManager::Guard released = std::move(pinned);
+    }
+    epochs.reclaim();
+    assert(Counted::alive.load() == 0 && epochs.pending() == 0);
+    // what is still retired when the manager goes is freed with it
+    {
+        EpochManager dropped;
+        EpochManager::Guard guard = dropped.pin();
+        dropped.retire(new Counted());
+        dropped.reclaim();
+        assert(Counted::alive.load() == 1);
+    }
+    assert(Counted::alive.load() == 0);
+}
+
+void test_appends_from_many_threads() {
+    my_array::ConcurrentArray<size_t> array;
+    std::vector<std::vector<size_t>> indices(4);
+    std::vector<std::thread> writers;
+    for (size_t writer = 0; writer < 4; writer++) {
+        writers.emplace_back([&, writer]() {
+            for (size_t i = 0; i < 2000; i++) {
+                indices[writer].push_back(array.append(writer * 10000 + i));
+            }
+        });
+    }
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+    assert(array.size() == 8000);
+    std::set<size_t> distinct;
+    for (size_t writer = 0; writer < 4; writer++) {
+        for (size_t i = 0; i < 2000; i++) {
+            assert(array[indices[writer][i]] == writer * 10000 + i);
+            distinct.insert(indices[writer][i]);
+        }
+    }
+    assert(distinct.size() == 8000 && *distinct.rbegin() == 7999);
+}
+
+/// @brief An edge a thread added, with the id it got
+struct Added {
+    size_t id;
+    size_t source;
+    size_t target;
+};
+
+template <typename GraphType>
+void check_many_threads_add_edges() {
+    GraphType graph;
+    const size_t nodes = 60;
+    for (size_t node = 0; node < nodes; node++) {
+        graph.add_node(static_cast<int>(node));
+    }
+    // every thread tries the same edges in its own order, half of them reversed
+    std::vector<std::vector<Added>> added(8);
+    std::atomic<size_t> conflicts(0);
+    std::vector<std::thread> writers;
+    for (size_t writer = 0; writer < 8; writer++) {
+        writers.emplace_back([&, writer]() {
+            for (size_t i = 0; i < nodes * 5; i++) {
+                size_t pair = (writer * 37 + (writer % 2 == 0 ? i : nodes * 5 - 1 - i)) %
+                    (nodes * 5);
+                size_t source = pair / 5;
+                size_t target = (source * 7 + pair % 5 + 1) % nodes;
+                if (writer % 2 == 1) std::swap(source, target);
+                try {
+                    int data = static_cast<int>(source * 1000 + target);
+                    added[writer].push_back({ graph.add_edge(source, target, data), source,
+                        target });
+                }
+                catch (const ConflictingItemException&) {
+                    ++conflicts;
+                }
+            }
+        });
+    }
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+    std::set<std::pair<size_t, size_t>> expected;
+    for (size_t pair = 0; pair < nodes * 5; pair++) {
+        size_t source = pair / 5;
+        size_t target = (source * 7 + pair % 5 + 1) % nodes;
+        expected.emplace(source, target);
+        expected.emplace(target, source);
+        if (graph.is_undirected()) expected.erase({ std::max(source, target),
+            std::min(source, target) });
+    }
+    std::set<size_t> ids;
+    for (const std::vector<Added>& edges : added) {
+        for (const Added& edge : edges) {
+            assert(graph.endpoints(edge.id) == std::make_pair(edge.source, edge.target));
+            assert(graph.edge_data(edge.id) == static_cast<int>(edge.source * 1000 + edge.target));
+            assert(graph.edge_id(edge.source, edge.target) == edge.id);
+            assert(graph.edge_id(edge.target, edge.source) == edge.id || !graph.is_undirected());
+            ids.insert(edge.id);
+        }
+    }
+    assert(graph.edge_count() == expected.size() && ids.size() == expected.size());
+    assert(*ids.rbegin() == expected.size() - 1);
+    assert(conflicts.load() == 8 * nodes * 5 - expected.size());
+}
+
+void test_many_threads_add_edges() {
+    check_many_threads_add_edges<ConcurrentDirectedGraph<int, int>>();
+    check_many_threads_add_edges<ConcurrentUndirectedGraph<int, int>>();
+}
+
+int main() {
+    test_elements_are_published_whole();
+    test_readers_see_a_consistent_graph();
+    test_retired_storage_outlives_the_pinned_readers();
+    test_appends_from_many_threads();
+    test_many_threads_add_edges();
+    std::cout << "ConcurrentGraphTest passed" << std::endl;
+    return 0;
+}
\ No newline at end of file
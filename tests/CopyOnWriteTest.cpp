@@ -0,0 +1,168 @@
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "Graph.h"
+#include "TestGraphs.h"
+
+/// @file CopyOnWriteTest.cpp
+/// @brief Tests that copies of a graph share its elements until one of them writes to them
+
+
+using TestGraph = DirectedGraph<int, int>;
+
+static_assert(std::is_same_v<decltype(std::declval<const Nodes<int, int>&>().get(0)),
+    const Node<int>&>);
+static_assert(std::is_same_v<decltype(std::declval<const Nodes<int, int>&>()[0]),
+    const Node<int>&>);
+static_assert(std::is_same_v<decltype(std::declval<const Edges<int, int>&>().get(0)),
+    const Edge<int, int>&>);
+static_assert(std::is_same_v<decltype(std::declval<const Edges<int, int>&>().get(0, 1)),
+    const Edge<int, int>&>);
+static_assert(std::is_same_v<decltype(std::declval<const Edges<int, int>&>()[0][1]),
+    const Edge<int, int>&>);
+
+void test_reference_held_across_a_copy() {
+    std::unique_ptr<TestGraph> graph(new TestGraph());
+    build_chain(*graph, 30);
+    Node<int>& first = graph->nodes()[0];
+    std::unique_ptr<TestGraph> copy(new TestGraph(*graph));
+    graph->nodes()[1];
+    first.getData() = 777;
+    const TestGraph& original = *graph;
+    const TestGraph& copied = *copy;
+    assert(original.nodes()[0].getData() == 777);
+    assert(copied.nodes()[0].getData() == 0);
+    // the reference must stay valid whichever graph goes first
+    copy.reset();
+    first.getData() = 778;
+    assert(original.nodes()[0].getData() == 778);
+}
+
+void test_only_the_touched_block_is_copied() {
+    TestGraph graph;
+    build_chain(graph, 30);
+    TestGraph copy(graph);
+    const TestGraph& original = graph;
+    const TestGraph& copied = copy;
+    copy.nodes()[15].getData() = 1;
+    copy.edges()[3][4].getData() = -1;
+    assert(&copied.nodes()[15] != &original.nodes()[15]);
+    assert(&copied.nodes()[0] == &original.nodes()[0]);
+    assert(&copied.nodes()[25] == &original.nodes()[25]);
+    assert(&copied.edges()[3][4] != &original.edges()[3][4]);
+    assert(&copied.edges()[20][21] == &original.edges()[20][21]);
+    assert(original.nodes()[15].getData() == 15 && original.edges()[3][4].getData() == 3);
+    assert(copied.nodes()[15].getData() == 1 && copied.edges()[3][4].getData() == -1);
+}
+
+void test_adding_leaves_the_other_blocks_shared() {
+    TestGraph graph;
+    build_chain(graph, 25);
+    TestGraph copy(graph);
+    const TestGraph& original = graph;
+    const TestGraph& copied = copy;
+    copy.nodes().add(5);
+    copy.edges().add(24, 25, 24);
+    assert(copied.nodes().size() == 26 && original.nodes().size() == 25);
+    assert(copied.edges().size() == 25 && original.edges().size() == 24);
+    assert(&copied.nodes()[3] == &original.nodes()[3]);
+    assert(&copied.edges()[3][4] == &original.edges()[3][4]);
+    assert(!original.edges().exists(24) && copied.edges()[24][25].getData() == 24);
+}
+
+void test_const_access_copies_nothing() {
+    TestGraph graph;
+    build_chain(graph, 30);
+    TestGraph copy(graph);
+    const TestGraph& copied = copy;
+    for (size_t i = 0; i < copied.nodes().size(); i++) {
+        assert(&copied.nodes()[i] == &std::as_const(graph).nodes()[i]);
+    }
+    for (size_t i = 0; i < copied.edges().size(); i++) {
+        assert(&copied.edges().get(i) == &std::as_const(graph).edges().get(i));
+    }
+}
+
+void test_columns_indexes_and_filter_shared_until_written() {
+    TestGraph graph;
+    build_chain(graph, 30);
+    graph.nodes().properties().add<int>("weight").set(3, 7);
+    graph.nodes().add_index("data", HashNodeIndex<int>());
+    const SortedEdgeIndex<int>& edge_index =
+        graph.edges().add_index("data", SortedEdgeIndex<int>());
+    graph.edges().enable_existence_filter();
+    const BloomFilter* filter = graph.edges().existence_filter();
+    TestGraph copy(graph);
+    const TestGraph& original = graph;
+    const TestGraph& copied = copy;
+    assert(&copied.edges().sources()[5] == &original.edges().sources()[5]);
+    assert(&copied.edges().targets()[5] == &original.edges().targets()[5]);
+    assert(&copied.nodes().properties().column<int>("weight") ==
+        &original.nodes().properties().column<int>("weight"));
+    assert(&copied.nodes().index<HashNodeIndex<int>>("data") ==
+        &original.nodes().index<HashNodeIndex<int>>("data"));
+    assert(&copied.edges().index<SortedEdgeIndex<int>>("data") == &edge_index);
+    assert(copied.edges().existence_filter() == filter);
+    // writing copies only what it writes to, the original keeps its own in place
+    copy.nodes().properties().column<int>("weight").set(3, 8);
+    copy.nodes().add(30);
+    copy.edges().add(29, 30, 29);
+    assert(original.nodes().properties().column<int>("weight").get(3) == 7);
+    assert(copied.nodes().properties().column<int>("weight").get(3) == 8);
+    assert(&copied.edges().index<SortedEdgeIndex<int>>("data") != &edge_index);
+    assert(&original.edges().index<SortedEdgeIndex<int>>("data") == &edge_index);
+    assert(edge_index.size() == 29);
+    assert(copied.edges().index<SortedEdgeIndex<int>>("data").size() == 30);
+    assert(original.nodes().index<HashNodeIndex<int>>("data").size() == 30);
+    assert(copied.nodes().index<HashNodeIndex<int>>("data").size() == 31);
+    assert(original.edges().existence_filter() == filter);
+    assert(copied.edges().existence_filter() != filter);
+    assert(copied.edges().exists(29, 30) && copied.edges().sources()[29] == 29);
+    assert(original.edges().sources().size() == 29 && copied.edges().sources().size() == 30);
+    // the original writing hands the copies a copy and keeps its own in place
+    TestGraph second(graph);
+    graph.edges().add(0, 2, -1);
+    assert(&original.edges().index<SortedEdgeIndex<int>>("data") == &edge_index);
+    assert(edge_index.size() == 30 && original.edges().existence_filter() == filter);
+    assert(std::as_const(second).edges().index<SortedEdgeIndex<int>>("data").size() == 29);
+    assert(!std::as_const(second).edges().exists(0, 2));
+}
+
+void test_memory_usage_counts_the_shared_storage() {
+    TestGraph graph;
+    build_chain(graph, 2000);
+    graph.edges().add_index("data", SortedEdgeIndex<int>());
+    MemoryUsage alone = graph.memory_usage();
+    assert(alone.shared == 0 && !graph.edges().adjacency().is_dense());
+    // a sparse row of one entry, its header and its pointer in the table
+    assert(alone.adjacency >= 1999 * (sizeof(std::vector<std::pair<size_t, size_t>>) +
+        2 * sizeof(size_t)) + 2000 * sizeof(void*));
+    TestGraph copy(graph);
+    MemoryUsage original = graph.memory_usage();
+    MemoryUsage copied = copy.memory_usage();
+    // the copy only leaves out the spare capacity of the tables
+    assert(original.total() == alone.total());
+    assert(copied.total() - copied.slack == original.total() - original.slack);
+    assert(copied.shared == original.shared);
+    assert(original.shared >= original.nodes + original.edges + original.endpoints +
+        original.indexes && original.shared < original.total());
+    // writing unshares a block of nodes, the rest stays counted by both
+    copy.nodes()[0].getData() = -1;
+    MemoryUsage written = copy.memory_usage();
+    assert(written.shared < copied.shared && written.shared > 0);
+    assert(graph.memory_usage().shared == written.shared);
+}
+
+int main() {
+    test_reference_held_across_a_copy();
+    test_only_the_touched_block_is_copied();
+    test_adding_leaves_the_other_blocks_shared();
+    test_const_access_copies_nothing();
+    test_columns_indexes_and_filter_shared_until_written();
+    test_memory_usage_counts_the_shared_storage();
+    std::cout << "CopyOnWriteTest passed" << std::endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include <cassert>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <utility>
+#include <vector>
+#include "Graph.h"
+#include "TestGraphs.h"
+
+/// @file EdgeIndexTest.cpp
+/// @brief Tests that the sorted edge index holds the same edges in the same order whether they
+///  were inserted one by one, imported or committed at once, and that a failed commit leaves it
+///  as it was
+
+
+/// @brief A key with no default constructor
+struct Score {
+    explicit Score(int value) : value(value) {}
+
+    bool operator<(const Score& other) const {
+        return value < other.value;
+    }
+
+    int value;
+};
+
+/// @brief Projects the edge data modulo 50, failing to allocate once for the data failing holds
+struct ScoreOf {
+    Score operator()(int data) const {
+        if (data == failing) {
+            failing = -1;
+            throw std::bad_alloc();
+        }
+        return Score(data % 50);
+    }
+
+    static int failing;
+};
+
+int ScoreOf::failing = -1;
+
+using TestGraph = DirectedGraph<int, int>;
+using TestIndex = SortedEdgeIndex<int, ScoreOf>;
+
+/// @brief Lists the ids of the edges in the order of the index
+std::vector<size_t> ids(const TestIndex& index) {
+    std::vector<size_t> result;
+    index.for_each([&](size_t id, const Score&) { result.push_back(id); });
+    return result;
+}
+
+void test_keys_without_a_default() {
+    TestGraph graph;
+    build_chain(graph, 500);
+    const TestIndex& index = graph.edges().add_index("score", TestIndex());
+    assert(index.size() == 499 && index.count(Score(10), Score(20)) == 100);
+    assert(index.count_above(Score(47)) == 19);
+    std::vector<size_t> top;
+    index.top(3, [&](size_t id, const Score& key) {
+        assert(key.value == 49);
+        top.push_back(id);
+    });
+    assert((top == std::vector<size_t>{ 449, 399, 349 }));
+}
+
+void test_import_matches_inserting_one_by_one() {
+    TestGraph inserted;
+    inserted.edges().add_index("score", TestIndex());
+    build_chain(inserted, 2000);
+    std::stringstream printed;
+    inserted.print(printed);
+    TestGraph imported;
+    const TestIndex& index = imported.edges().add_index("score", TestIndex());
+    imported.import(printed);
+    assert(imported.edges().size() == 1999 && index.size() == 1999);
+    assert(ids(index) == ids(inserted.edges().index<TestIndex>("score")));
+}
+
+void test_commit_indexes_the_batch() {
+    TestGraph graph;
+    build_chain(graph, 100);
+    const TestIndex& index = graph.edges().add_index("score", TestIndex());
+    // a batch as large as the edges rebuilds the index, a small one inserts into it
+    for (size_t step : { 2, 3 }) {
+        graph.begin_batch();
+        size_t staged = step == 2 ? 98 : 5;
+        for (size_t i = 0; i < staged; i++) {
+            graph.stage_edge(i, i + step, static_cast<int>(1000 + i));
+        }
+        graph.commit();
+    }
+    assert(index.size() == 99 + 98 + 5 && &graph.edges().index<TestIndex>("score") == &index);
+    TestGraph inserted;
+    inserted.edges().add_index("score", TestIndex());
+    for (size_t i = 0; i < 100; i++) {
+        inserted.nodes().add(static_cast<int>(i));
+    }
+    for (size_t id = 0; id < graph.edges().size(); id++) {
+        const TestGraph& constant = graph;
+        inserted.edges().add(constant.edges().sources()[id], constant.edges().targets()[id],
+            constant.edges().get(id).getData());
+    }
+    assert(ids(index) == ids(inserted.edges().index<TestIndex>("score")));
+}
+
+void test_failed_commit_leaves_the_index() {
+    for (size_t staged : { 3, 200 }) {
+        TestGraph graph;
+        build_chain(graph, 300);
+        const TestIndex& index = graph.edges().add_index("score", TestIndex());
+        std::vector<size_t> before = ids(index);
+        graph.begin_batch();
+        for (size_t i = 0; i < staged; i++) {
+            graph.stage_edge(i, i + 2, static_cast<int>(1000 + i));
+        }
+        ScoreOf::failing = static_cast<int>(1000 + staged - 1);
+        bool thrown = false;
+        try {
+            graph.commit();
+        }
+        catch (const UnavailableMemoryException&) {
+            thrown = true;
+        }
+        assert(thrown && graph.in_batch() && graph.edges().size() == 299);
+        assert(ids(index) == before && &graph.edges().index<TestIndex>("score") == &index);
+        graph.commit();
+        assert(index.size() == 299 + staged);
+    }
+}
+
+int main() {
+    test_keys_without_a_default();
+    test_import_matches_inserting_one_by_one();
+    test_commit_indexes_the_batch();
+    test_failed_commit_leaves_the_index();
+    std::cout << "EdgeIndexTest passed" << std::endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "Graph.h"
+#include "TestGraphs.h"
+
+/// @file GraphSnapshotTest.cpp
+/// @brief Tests that a snapshot keeps showing the graph as it was while the graph is written to,
+///  also from another thread
+
+
+using TestGraph = DirectedGraph<int, int>;
+
+static_assert(std::is_same_v<decltype(std::declval<const GraphSnapshot<int, int>&>().node(0)),
+    const Node<int>&>);
+static_assert(std::is_same_v<decltype(std::declval<const GraphSnapshot<int, int>&>().edge(0)),
+    const Edge<int, int>&>);
+static_assert(std::is_same_v<decltype(std::declval<const GraphSnapshot<int, int>&>().edge(0, 1)),
+    const Edge<int, int>&>);
+
+void check(const GraphSnapshot<int, int>& snapshot, size_t nodes) {
+    assert(snapshot.size() == nodes && snapshot.edge_count() == nodes - 1);
+    for (size_t i = 0; i < nodes; i++) {
+        assert(snapshot.node(i).getData() == static_cast<int>(i));
+        size_t neighbors = 0;
+        snapshot.for_each_neighbor(i, [&](size_t target) {
+            assert(target == i + 1);
+            ++neighbors;
+        });
+        assert(neighbors == (i + 1 < nodes ? 1 : 0));
+    }
+    for (size_t i = 0; i + 1 < nodes; i++) {
+        assert(snapshot.exists(i, i + 1) && !snapshot.exists(i + 1, i));
+        assert(snapshot.edge(i, i + 1).getData() == static_cast<int>(i));
+        assert(snapshot.edge(i).getData() == static_cast<int>(i));
+    }
+}
+
+void test_writes_after_the_snapshot_stay_hidden() {
+    TestGraph graph;
+    build_chain(graph, 25);
+    GraphSnapshot<int, int> snapshot = graph.snapshot();
+    graph.nodes()[3].getData() = -1;
+    graph.edges()[3][4].getData() = -1;
+    graph.nodes().add(25);
+    graph.edges().add(24, 25, 24);
+    graph.edges().add(5, 3, -1);
+    check(snapshot, 25);
+    bool thrown = false;
+    try {
+        snapshot.node(25);
+    }
+    catch (const NonexistingItemException&) {
+        thrown = true;
+    }
+    assert(thrown);
+    assert(std::as_const(graph).nodes()[3].getData() == -1);
+    assert(std::as_const(graph).edges()[3][4].getData() == -1);
+}
+
+void test_reference_held_across_a_snapshot() {
+    TestGraph graph;
+    Node<int>& node = graph.nodes().add(1);
+    Edge<int, int>& edge = graph.edges().add(0, 0, 1);
+    {
+        GraphSnapshot<int, int> snapshot = graph.snapshot();
+        graph.nodes().add(2);
+        graph.edges().add(0, 1, 2);
+        node.getData() = 42;
+        edge.getData() = 42;
+        assert(snapshot.node(0).getData() == 1 && snapshot.edge(0).getData() == 1);
+        assert(&std::as_const(graph).nodes()[0] == &node);
+        assert(&std::as_const(graph).edges()[0][0] == &edge);
+    }
+    // the graph's elements never moved, so the references outlive the snapshot
+    node.getData() = 7;
+    edge.getData() = 7;
+    assert(std::as_const(graph).nodes()[0].getData() == 7);
+    assert(std::as_const(graph).edges()[0][0].getData() == 7);
+}
+
+void test_snapshot_outlives_the_graph() {
+    TestGraph* graph = new TestGraph();
+    build_chain(*graph, 25);
+    GraphSnapshot<int, int> snapshot = graph->snapshot();
+    graph->nodes()[0].getData() = -1;
+    delete graph;
+    check(snapshot, 25);
+}
+
+void test_read_from_another_thread_while_writing() {
+    TestGraph graph;
+    build_chain(graph, 100);
+    GraphSnapshot<int, int> snapshot = graph.snapshot();
+    std::thread reader([&] {
+        for (size_t round = 0; round < 20; round++) {
+            check(snapshot, 100);
+        }
+    });
+    for (size_t round = 0; round < 20; round++) {
+        for (size_t i = 0; i < 100; i++) {
+            graph.nodes()[i].getData() = -static_cast<int>(round);
+            graph.edges().add(i, (i + round + 2) % 100, static_cast<int>(round));
+            graph.edges().get(i).getData() = -static_cast<int>(round);
+        }
+        graph.nodes().add(-1);
+        // a snapshot taken meanwhile copies the graph as it is then
+        GraphSnapshot<int, int> later = graph.snapshot();
+        assert(later.size() == graph.nodes().size());
+    }
+    reader.join();
+    check(snapshot, 100);
+}
+
+int main() {
+    test_writes_after_the_snapshot_stay_hidden();
+    test_reference_held_across_a_snapshot();
+    test_snapshot_outlives_the_graph();
+    test_read_from_another_thread_while_writing();
+    std::cout << "GraphSnapshotTest passed" << std::endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "Graph.h"
+#include "AdjacencyView.h"
+#include "KHop.h"
+
+/// @file KHopTest.cpp
+/// @brief Tests that the k-hop extraction reaches the nodes a breadth first search reaches,
+///  grouped by hop in id order through small and large frontiers alike, and that the batch
+///  extraction answers every seed like a run of its own
+
+
+using TestGraph = DirectedGraph<int, int>;
+
+/// @brief Adds nodes and pseudo random edges, skipping the pairs already connected
+void build_random(TestGraph& graph, size_t nodes, size_t edges) {
+    for (size_t i = 0; i < nodes; i++) {
+        graph.nodes().add(static_cast<int>(i));
+    }
+    uint64_t state = 3;
+    for (size_t i = 0; i < edges; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t source = (state >> 33) % nodes;
+        size_t target = (state >> 13) % nodes;
+        if (!graph.edges().exists(source, target))
+            graph.edges().add(source, target, static_cast<int>(i));
+    }
+}
+
+/// @brief Reaches the nodes within k hops of the seeds by a breadth first search
+/// @return The nodes of every hop in id order, the seeds first; no empty hops
+template <typename View>
+std::vector<std::vector<size_t>> search(const View& view, const std::vector<size_t>& seeds,
+        size_t k) {
+    std::vector<bool> reached(view.size(), false);
+    std::vector<std::vector<size_t>> hops(1);
+    for (size_t seed : seeds) {
+        if (!reached[seed]) hops[0].push_back(seed);
+        reached[seed] = true;
+    }
+    for (size_t hop = 1; hop <= k; hop++) {
+        std::vector<size_t> next;
+        for (size_t node : hops.back()) {
+            view.for_each_neighbor(node, [&](size_t target) {
+                if (!reached[target]) next.push_back(target);
+                reached[target] = true;
+            });
+        }
+        if (next.empty()) break;
+        hops.push_back(next);
+    }
+    for (std::vector<size_t>& nodes : hops) {
+        std::sort(nodes.begin(), nodes.end());
+    }
+    return hops;
+}
+
+/// @brief Checks the last run of an extractor against a breadth first search
+template <typename View>
+void check(const KHop<View>& hop, const std::vector<size_t>& seeds, size_t k) {
+    std::vector<std::vector<size_t>> hops = search(hop.view(), seeds, k);
+    std::vector<size_t> nodes;
+    std::vector<size_t> counts;
+    for (const std::vector<size_t>& reached : hops) {
+        nodes.insert(nodes.end(), reached.begin(), reached.end());
+        counts.push_back(reached.size());
+    }
+    assert(hop.nodes() == nodes && hop.counts() == counts);
+    std::sort(nodes.begin(), nodes.end());
+    assert(hop.sorted_nodes() == nodes && k_hop(hop.view(), seeds, k) == nodes);
+    for (size_t node = 0; node < hop.view().size(); node++) {
+        assert(hop.contains(node) == std::binary_search(nodes.begin(), nodes.end(), node));
+    }
+}
+
+void test_hops_of_a_small_graph() {
+    TestGraph graph;
+    // a binary tree of 7 nodes, a leaf leading back to the root and one to another leaf
+    for (int i = 0; i < 8; i++) {
+        graph.nodes().add(i);
+    }
+    for (size_t node = 0; node < 3; node++) {
+        graph.edges().add(node, 2 * node + 1, 0);
+        graph.edges().add(node, 2 * node + 2, 0);
+    }
+    graph.edges().add(6, 0, 0);
+    graph.edges().add(3, 5, 0);
+    auto view = adjacency_view(graph.edges());
+    KHop<decltype(view)> hop(view);
+    hop.run(0, 0);
+    assert((hop.nodes() == std::vector<size_t>{ 0 } && hop.counts() == std::vector<size_t>{ 1 }));
+    hop.run(0, 2);
+    assert((hop.nodes() == std::vector<size_t>{ 0, 1, 2, 3, 4, 5, 6 }));
+    assert((hop.counts() == std::vector<size_t>{ 1, 2, 4 }));
+    // node 5 is reached through 3 and through 2 but counted once, by the hop reaching it first
+    hop.run(std::vector<size_t>{ 3, 6, 3 }, 5);
+    assert((hop.nodes() == std::vector<size_t>{ 3, 6, 0, 5, 1, 2, 4 }));
+    assert((hop.counts() == std::vector<size_t>{ 2, 2, 2, 1 }));
+    assert(!hop.contains(7) && !hop.contains(100));
+    bool thrown = false;
+    try {
+        hop.run(std::vector<size_t>{ 1, 8 }, 2);
+    }
+    catch (const NonexistingItemException&) {
+        thrown = true;
+    }
+    assert(thrown && hop.nodes().empty() && !hop.contains(1));
+    // the induced view keeps the edges between the reached nodes only
+    hop.run(1, 1);
+    size_t edges = 0;
+    auto induced = hop.induced();
+    for (size_t node = 0; node < induced.size(); node++) {
+        induced.for_each_neighbor(node, [&](size_t target) {
+            assert(node == 1 && (target == 3 || target == 4));
+            ++edges;
+        });
+    }
+    assert(edges == 2 && induced.contains(4) && !induced.contains(5));
+}
+
+void test_reaches_what_a_search_reaches() {
+    // sparse enough for small frontiers, and dense enough for frontiers taking most nodes
+    for (size_t edges : { 6000, 40000 }) {
+        TestGraph graph;
+        build_random(graph, 5000, edges);
+        auto view = adjacency_view(graph.edges());
+        KHop<decltype(view)> hop(view);
+        for (size_t run = 0; run < 60; run++) {
+            std::vector<size_t> seeds;
+            for (size_t seed = 0; seed <= run % 4; seed++) {
+                seeds.push_back((run * 7919 + seed * 104729) % 5000);
+            }
+            size_t k = run % 6;
+            hop.run(seeds, k);
+            check(hop, seeds, k);
+        }
+    }
+}
+
+void test_batch_answers_like_single_runs() {
+    TestGraph graph;
+    build_random(graph, 3000, 9000);
+    auto view = adjacency_view(graph.edges());
+    std::vector<size_t> seeds;
+    for (size_t i = 0; i < 300; i++) {
+        seeds.push_back((i * 7919) % 3000);
+    }
+    ThreadPoolOptions options;
+    options.threads = 3;
+    ThreadPool pool(options);
+    for (size_t k : { 1, 3 }) {
+        std::vector<std::vector<size_t>> nodes(seeds.size());
+        std::vector<std::vector<size_t>> counts(seeds.size());
+        k_hop_batch(view, seeds, k, [&](size_t i, const KHop<decltype(view)>& hop) {
+            nodes[i] = hop.nodes();
+            counts[i] = hop.counts();
+        }, pool, 7);
+        KHop<decltype(view)> hop(view);
+        for (size_t i = 0; i < seeds.size(); i++) {
+            hop.run(seeds[i], k);
+            assert(nodes[i] == hop.nodes() && counts[i] == hop.counts());
+        }
+    }
+    std::vector<size_t> missing = { 0, 3000 };
+    bool thrown = false;
+    try {
+        k_hop_batch(view, missing, 2, [](size_t, const KHop<decltype(view)>&) {}, pool);
+    }
+    catch (const NonexistingItemException&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+int main() {
+    test_hops_of_a_small_graph();
+    test_reaches_what_a_search_reaches();
+    test_batch_answers_like_single_runs();
+    std::cout << "KHopTest passed" << std::endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "MappedGraph.h"
+
+/// @file MappedGraphTest.cpp
+/// @brief Tests that a mapped graph opens again as it was synced, and that a file left unsynced
+///  by a crash opens rolled back to its last sync
+
+
+using TestGraph = MappedGraph<int, double>;
+
+/// @brief Reads every byte of a file
+std::vector<char> read_bytes(const std::string& filename) {
+    std::ifstream ifs(filename, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(ifs),
+        std::istreambuf_iterator<char>());
+}
+
+/// @brief Copies a file as it is now, what a crash leaves behind of a graph still open on it
+void copy_file(const std::string& from, const std::string& to) {
+    std::vector<char> bytes = read_bytes(from);
+    std::ofstream ofs(to, std::ios::binary | std::ios::trunc);
+    ofs.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+/// @brief Adds a chain of nodes, node i holds i and the edge i from node i to node i + 1 holds i
+void build_chain(TestGraph& graph, size_t nodes) {
+    for (size_t i = 0; i < nodes; i++) {
+        graph.add_node(static_cast<int>(i));
+    }
+    for (size_t i = 0; i + 1 < nodes; i++) {
+        graph.add_edge(i, i + 1, static_cast<double>(i));
+    }
+}
+
+size_t count_neighbors(const TestGraph& graph, size_t source) {
+    size_t neighbors = 0;
+    graph.for_each_neighbor(source, [&](size_t, size_t) { ++neighbors; });
+    return neighbors;
+}
+
+void test_reopen_after_sync() {
+    const std::string filename = "MappedGraphTest.reopen.bin";
+    std::remove(filename.c_str());
+    {
+        TestGraph graph(filename);
+        build_chain(graph, 3000);
+        graph.add_edge(2999, 0, -1.0);
+        graph.set_node(5, 50);
+        graph.set_edge(7, 0.5);
+        graph.sync();
+    }
+    TestGraph graph(filename);
+    assert(graph.node_count() == 3000 && graph.edge_count() == 3000);
+    assert(graph.node(5) == 50 && graph.node(6) == 6 && graph.edge(7) == 0.5);
+    assert(graph.exists(2999, 0) && graph.exists(0, 1) && !graph.exists(1, 0));
+    assert(graph.find(2999, 0) == 2999 && graph.source(2999) == 2999 && graph.target(2999) == 0);
+    assert(count_neighbors(graph, 0) == 1 && count_neighbors(graph, 2999) == 1);
+    bool thrown = false;
+    try {
+        TestGraph undirected(filename, true);
+    }
+    catch (const FileProcessingException&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::remove(filename.c_str());
+}
+
+void test_reading_leaves_the_file_unchanged() {
+    const std::string filename = "MappedGraphTest.read.bin";
+    std::remove(filename.c_str());
+    TestGraph graph(filename);
+    build_chain(graph, 100);
+    graph.sync();
+    std::vector<char> synced = read_bytes(filename);
+    // reads through a non-const graph are not changes
+    int nodes = 0;
+    double edges = 0;
+    for (size_t i = 0; i < graph.node_count(); i++) {
+        nodes += graph.node(i);
+    }
+    for (size_t i = 0; i < graph.edge_count(); i++) {
+        edges += graph.edge(i);
+    }
+    assert(nodes == 4950 && edges == 4851 && graph.exists(3, 4) && count_neighbors(graph, 3) == 1);
+    assert(read_bytes(filename) == synced);
+    std::remove(filename.c_str());
+}
+
+void test_crash_rolls_back_to_the_last_sync() {
+    const std::string filename = "MappedGraphTest.crash.bin";
+    const std::string crashed = "MappedGraphTest.crashed.bin";
+    std::remove(filename.c_str());
+    {
+        TestGraph graph(filename);
+        build_chain(graph, 1000);
+        graph.sync();
+        // the new nodes take a chunk of their own, the new edges link into synced lists
+        for (int i = 0; i < 2000; i++) {
+            graph.add_node(-i);
+        }
+        graph.add_edge(0, 2, 1.5);
+        graph.add_edge(1, 1500, 2.5);
+        graph.add_edge(1200, 3, 3.5);
+        copy_file(filename, crashed);
+    }
+    {
+        TestGraph graph(crashed);
+        assert(graph.node_count() == 1000 && graph.edge_count() == 999);
+        assert(!graph.exists(0, 2) && graph.exists(0, 1) && graph.exists(1, 2));
+        assert(count_neighbors(graph, 0) == 1 && count_neighbors(graph, 1) == 1);
+        for (size_t i = 0; i < graph.edge_count(); i++) {
+            assert(graph.source(i) == i && graph.target(i) == i + 1);
+        }
+        // the rolled back graph takes changes again and syncs them
+        graph.add_node(1000);
+        graph.add_edge(999, 1000, 999.0);
+        graph.add_edge(0, 2, 1.5);
+        graph.sync();
+    }
+    TestGraph graph(crashed);
+    assert(graph.node_count() == 1001 && graph.edge_count() == 1001);
+    assert(graph.exists(999, 1000) && graph.exists(0, 2) && count_neighbors(graph, 0) == 2);
+    std::remove(filename.c_str());
+    std::remove(crashed.c_str());
+}
+
+void test_memory_usage_adds_up_to_the_file() {
+    const std::string filename = "MappedGraphTest.memory.bin";
+    std::remove(filename.c_str());
+    {
+        TestGraph graph(filename);
+        build_chain(graph, 2000);
+        MemoryUsage usage = graph.memory_usage();
+        assert(usage.nodes == 2000 * sizeof(int) && usage.edges == 1999 * sizeof(double));
+        assert(usage.endpoints == 1999 * 16 && usage.adjacency == (2000 + 1999) * 16);
+        assert(usage.slack > 0 && usage.properties == 0 && usage.page_cache == 0);
+        graph.sync();
+        assert(usage.total() == read_bytes(filename).size());
+    }
+    std::remove(filename.c_str());
+}
+
+int main() {
+    test_reopen_after_sync();
+    test_reading_leaves_the_file_unchanged();
+    test_crash_rolls_back_to_the_last_sync();
+    test_memory_usage_adds_up_to_the_file();
+    std::cout << "MappedGraphTest passed" << std::endl;
+    return 0;
+}
\ No newline at end of file
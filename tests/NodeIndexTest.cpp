@@ -0,0 +1,107 @@
+#include <cassert>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include "Graph.h"
+
+/// @file NodeIndexTest.cpp
+/// @brief Tests that the hash index finds the lowest id among nodes with equal keys, and that a
+///  failed reindex leaves the indexes the nodes are found by
+
+
+/// @brief Projects the node data as it is, failing to allocate once for the data failing holds
+struct FailingOnce {
+    int operator()(int data) const {
+        if (data == failing) {
+            failing = -1;
+            throw std::bad_alloc();
+        }
+        return data;
+    }
+
+    static int failing;
+};
+
+int FailingOnce::failing = -1;
+
+
+void test_lowest_id_among_duplicates() {
+    HashNodeIndex<int> index;
+    for (size_t id = 0; id < 1000; id++) {
+        index.insert(id, static_cast<int>(id % 3));
+    }
+    assert(index.size() == 1000 && index.count(1) == 333);
+    assert(index.find(0) == 0 && index.find(1) == 1 && index.find(2) == 2);
+    assert(index.find(3) == HashNodeIndex<int>::NONE && index.count(3) == 0);
+    index.erase(1, 1);
+    assert(index.find(1) == 4 && index.count(1) == 332 && index.size() == 999);
+    index.erase(1, 1);
+    assert(index.size() == 999);
+}
+
+void test_ids_in_order_whatever_the_insertion_order() {
+    HashNodeIndex<int> index;
+    std::vector<size_t> ids = { 7, 3, 9, 1, 5 };
+    for (size_t id : ids) {
+        index.insert(id, 0);
+    }
+    assert(index.find(0) == 1);
+    std::vector<size_t> visited;
+    index.for_each(0, [&](size_t id) { visited.push_back(id); });
+    assert((visited == std::vector<size_t>{ 1, 3, 5, 7, 9 }));
+    for (size_t id : ids) {
+        index.erase(id, 0);
+    }
+    assert(index.size() == 0 && index.find(0) == HashNodeIndex<int>::NONE);
+}
+
+void test_find_through_the_nodes() {
+    DirectedGraph<std::string, int> graph;
+    graph.nodes().add_index("data", HashNodeIndex<std::string>());
+    for (size_t i = 0; i < 100; i++) {
+        graph.nodes().add(i % 2 == 0 ? "even" : "odd");
+    }
+    assert(graph.nodes().find("even")->getId() == 0);
+    assert(graph.nodes().find("odd")->getId() == 1);
+    graph.nodes()[0].getData() = "odd";
+    graph.nodes().reindex();
+    assert(graph.nodes().find("odd")->getId() == 0);
+    assert(graph.nodes().find("even")->getId() == 2);
+}
+
+void test_failed_reindex_keeps_the_indexes() {
+    DirectedGraph<int, int> graph;
+    // the indexes are rebuilt by name, the failing one first
+    const SortedNodeIndex<int, FailingOnce>& failing =
+        graph.nodes().add_index("by projection", SortedNodeIndex<int, FailingOnce>());
+    const HashNodeIndex<int>& data = graph.nodes().add_index("data", HashNodeIndex<int>());
+    for (int i = 0; i < 100; i++) {
+        graph.nodes().add(i);
+    }
+    graph.nodes()[10].getData() = 1000;
+    FailingOnce::failing = 50;
+    bool thrown = false;
+    try {
+        graph.nodes().reindex();
+    }
+    catch (const UnavailableMemoryException&) {
+        thrown = true;
+    }
+    assert(thrown && failing.size() == 100 && data.size() == 100);
+    // found by the index as it was before the change
+    assert(graph.nodes().find(50)->getId() == 50 && graph.nodes().find(99)->getId() == 99);
+    assert(graph.nodes().find(1000) == nullptr);
+    graph.nodes().reindex();
+    assert(graph.nodes().find(1000)->getId() == 10 && graph.nodes().find(10) == nullptr);
+    assert(failing.find(1000) == 10 && &graph.nodes().index<HashNodeIndex<int>>("data") == &data);
+}
+
+int main() {
+    test_lowest_id_among_duplicates();
+    test_ids_in_order_whatever_the_insertion_order();
+    test_find_through_the_nodes();
+    test_failed_reindex_keeps_the_indexes();
+    std::cout << "NodeIndexTest passed" << std::endl;
+    return 0;
+}
\ No newline at end of file
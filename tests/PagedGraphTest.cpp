@@ -0,0 +1,110 @@
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include "PagedGraph.h"
+
+/// @file PagedGraphTest.cpp
+/// @brief Tests that the index of a paged graph lists the neighbors of every node in the order
+///  of their edges, built by sequential passes even when the runs do not fit into the frames
+
+
+using TestGraph = PagedGraph<int, int>;
+
+/// @brief The neighbors of every node and the edges leading to them, in the order they were added
+using Reference = std::vector<std::vector<std::pair<size_t, size_t>>>;
+
+/// @brief Adds nodes and pseudo random edges to the graph and to the reference
+void build_random(TestGraph& graph, Reference& reference, size_t nodes, size_t edges) {
+    reference.assign(nodes, {});
+    for (size_t i = 0; i < nodes; i++) {
+        graph.add_node(static_cast<int>(i));
+    }
+    uint64_t state = 12345;
+    for (size_t i = 0; i < edges; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t source = (state >> 33) % nodes;
+        // every tenth edge is a loop, an undirected graph lists it once
+        size_t target = i % 10 == 0 ? source : (state >> 13) % nodes;
+        size_t id = graph.add_edge(source, target, static_cast<int>(i));
+        reference[source].emplace_back(target, id);
+        if (graph.is_undirected() && target != source) reference[target].emplace_back(source, id);
+    }
+}
+
+void check(TestGraph& graph, const Reference& reference) {
+    for (size_t node = 0; node < reference.size(); node++) {
+        std::vector<std::pair<size_t, size_t>> neighbors;
+        graph.for_each_neighbor(node, [&](size_t target, size_t edge) {
+            neighbors.emplace_back(target, edge);
+        });
+        assert(neighbors == reference[node]);
+    }
+}
+
+void test_index_lists_the_neighbors_in_edge_order() {
+    for (bool undirected : { false, true }) {
+        // a run gets what 16 frames of 256 bytes hold, so the edges take several runs
+        TestGraph graph("PagedGraphTest.index.bin", undirected, 16, 256);
+        Reference reference;
+        build_random(graph, reference, 600, 3000);
+        check(graph, reference);
+        // building again reuses the pages of the runs
+        size_t pages = graph.stats().misses;
+        size_t id = graph.add_edge(599, 0, -1);
+        reference[599].emplace_back(0, id);
+        if (undirected) reference[0].emplace_back(599, id);
+        check(graph, reference);
+        assert(graph.stats().misses > pages);
+    }
+}
+
+void test_index_reads_every_page_about_once() {
+    // 64 frames of 256 bytes give 16 runs
+    TestGraph graph("PagedGraphTest.pages.bin", false, 64, 256);
+    Reference reference;
+    build_random(graph, reference, 2000, 20000);
+    graph.flush();
+    size_t before = graph.stats().reads;
+    graph.build_index();
+    size_t built = graph.stats().reads - before;
+    // building again reads the kept pages of the runs and the index before writing them
+    before = graph.stats().reads;
+    graph.build_index();
+    size_t rebuilt = graph.stats().reads - before;
+    // the endpoints, the runs and the index; placing every neighbor at the offset of its node
+    // instead reads about two pages per edge
+    size_t pages = (20000 * (2 + 3 + 2) * sizeof(size_t) + 2001 * sizeof(size_t)) / 256;
+    assert(built <= 2 * pages && rebuilt <= 2 * pages);
+    check(graph, reference);
+}
+
+void test_memory_usage_counts_the_frames() {
+    TestGraph graph("PagedGraphTest.memory.bin", false, 16, 256);
+    Reference reference;
+    build_random(graph, reference, 600, 3000);
+    graph.build_index();
+    MemoryUsage usage = graph.memory_usage();
+    assert(usage.page_cache >= 16 * 256 && usage.slack > 0);
+    assert(usage.nodes == 0 && usage.edges == 0 && usage.adjacency == 0);
+    assert(usage.total() == usage.page_cache + usage.slack);
+}
+
+void test_empty_graph() {
+    TestGraph graph("PagedGraphTest.empty.bin");
+    graph.build_index();
+    graph.add_node(0);
+    size_t neighbors = 0;
+    graph.for_each_neighbor(0, [&](size_t, size_t) { ++neighbors; });
+    assert(neighbors == 0);
+}
+
+int main() {
+    test_index_lists_the_neighbors_in_edge_order();
+    test_index_reads_every_page_about_once();
+    test_memory_usage_counts_the_frames();
+    test_empty_graph();
+    std::cout << "PagedGraphTest passed" << std::endl;
+    return 0;
+}
\ No newline at end of file
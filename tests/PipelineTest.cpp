@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Pipeline.h"
+
+/// @file PipelineTest.cpp
+/// @brief Tests that the pipeline imports the same graph as Graph::import with every stage
+///  seeing the records in the order of the input, that a slow stage holds the faster ones back,
+///  and that a failing stage stops the whole pipeline
+
+
+using TestGraph = DirectedGraph<int, int>;
+using Batch = GraphPipeline<int, int>::Batch;
+
+/// @brief The number of nodes of the input
+const size_t NODES = 3000;
+
+/// @brief Prints a graph with a few thousand nodes and edges, with lines the import skips
+std::string make_input() {
+    TestGraph graph;
+    for (size_t i = 0; i < NODES; i++) {
+        graph.nodes().add(static_cast<int>(i * 10));
+    }
+    int data = 0;
+    for (size_t source = 0; source < NODES; source += 3) {
+        for (size_t target = source + 1; target < NODES; target += 211) {
+            graph.edges().add(source, target, data++);
+        }
+    }
+    std::ostringstream printed;
+    graph.print(printed);
+    return printed.str() + "not a record\n";
+}
+
+/// @brief Imports the input the plain way and prints it
+std::string import_plainly(const std::string& input) {
+    TestGraph graph;
+    std::istringstream is(input);
+    graph.import(is);
+    std::ostringstream printed;
+    graph.print(printed);
+    return printed.str();
+}
+
+void test_same_graph_as_import() {
+    std::string input = make_input();
+    std::string expected = import_plainly(input);
+    for (size_t batch_size : { 1, 7, 1024 }) {
+        TestGraph graph;
+        PipelineOptions options;
+        options.batch_size = batch_size;
+        options.queue_capacity = 2;
+        GraphPipeline<int, int> pipeline(graph, options);
+        // every stage sees the nodes and then the edges in the order of their ids
+        size_t transformed = 0;
+        size_t observed = 0;
+        auto in_order = [](const Batch& batch, size_t& next) {
+            for (const ImportRecord<int, int>& record : batch) {
+                assert(record.id == (record.is_edge ? next - NODES : next));
+                ++next;
+            }
+        };
+        pipeline.transform([&](Batch& batch) {
+            assert(batch.size() <= batch_size);
+            in_order(batch, transformed);
+        }).observe([&](const Batch& batch) { in_order(batch, observed); });
+        std::istringstream is(input);
+        pipeline.import(is);
+        assert(transformed == observed);
+        assert(observed == graph.nodes().size() + graph.edges().size());
+        std::ostringstream printed;
+        graph.print(printed);
+        assert(printed.str() == expected);
+        std::ostringstream exported;
+        pipeline.export_to(exported);
+        assert(exported.str() == expected);
+    }
+}
+
+void test_slow_stage_holds_the_others_back() {
+    std::string input = make_input();
+    TestGraph graph;
+    PipelineOptions options;
+    options.batch_size = 16;
+    options.queue_capacity = 1;
+    GraphPipeline<int, int> pipeline(graph, options);
+    std::atomic<size_t> transformed(0);
+    std::atomic<size_t> observed(0);
+    // only written by the transform stage, read once the import is done
+    size_t ahead = 0;
+    pipeline.transform([&](Batch&) {
+        size_t batches = ++transformed;
+        ahead = std::max(ahead, batches - observed.load());
+    }).observe([&](const Batch&) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        ++observed;
+    });
+    std::istringstream is(input);
+    pipeline.import(is);
+    // a batch in each of the two queues and one in every stage, the rest waits for the observer
+    assert(observed.load() == transformed.load() && transformed.load() > 200);
+    assert(ahead <= 2 * options.queue_capacity + 3);
+}
+
+void test_failing_stage_stops_the_pipeline() {
+    std::string input = make_input();
+    TestGraph graph;
+    PipelineOptions options;
+    options.batch_size = 5;
+    options.queue_capacity = 1;
+    GraphPipeline<int, int> pipeline(graph, options);
+    size_t calls = 0;
+    std::atomic<size_t> observed(0);
+    pipeline.transform([&](Batch&) {
+        if (++calls == 3) throw InvalidArgumentException("failed stage");
+    }).observe([&](const Batch& batch) { observed += batch.size(); });
+    bool thrown = false;
+    std::istringstream is(input);
+    try {
+        pipeline.import(is);
+    }
+    catch (InvalidArgumentException& exception) {
+        thrown = exception.what() == "failed stage";
+    }
+    // the two batches before the failing one may have been added
+    assert(thrown && graph.nodes().size() <= 10 && observed.load() <= 10);
+    // errors of parsing and of adding reach the caller too
+    TestGraph parsed;
+    GraphPipeline<int, int> parsing(parsed);
+    std::istringstream unparsable("node (0 {1})\nnode (x {2})\n");
+    thrown = false;
+    try {
+        parsing.import(unparsable);
+    }
+    catch (const ParsingException&) {
+        thrown = true;
+    }
+    assert(thrown);
+    TestGraph added;
+    GraphPipeline<int, int> adding(added);
+    std::istringstream duplicate("node (0 {1})\nnode (0 {2})\n");
+    thrown = false;
+    try {
+        adding.import(duplicate);
+    }
+    catch (const ConflictingItemException&) {
+        thrown = true;
+    }
+    assert(thrown && added.nodes().size() == 1);
+}
+
+void test_import_batches() {
+#ifdef GRAPH_COROUTINES
+    std::string input = make_input();
+    std::istringstream is(input);
+    size_t records = 0;
+    size_t batches = 0;
+    for (Batch& batch : TestGraph::import_batches(is, 100)) {
+        assert(batch.size() <= 100);
+        records += batch.size();
+        ++batches;
+    }
+    TestGraph graph;
+    std::istringstream again(input);
+    graph.import(again);
+    assert(records == graph.nodes().size() + graph.edges().size());
+    assert(batches == (records + 99) / 100);
+    // leaving the loop early destroys the suspended coroutine
+    std::istringstream partly(input);
+    for (Batch& batch : TestGraph::import_batches(partly, 10)) {
+        assert(batch.front().id == 0);
+        break;
+    }
+#endif
+}
+
+int main() {
+    test_same_graph_as_import();
+    test_slow_stage_holds_the_others_back();
+    test_failing_stage_stops_the_pipeline();
+    test_import_batches();
+    std::cout << "PipelineTest passed" << std::endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "Graph.h"
+#include "TestGraphs.h"
+
+/// @file PropertiesTest.cpp
+/// @brief Tests that the property columns pack their values, that the dictionary keeps every
+///  string once, and that the columns of a graph only take the rows of its nodes and edges
+
+
+using TestGraph = DirectedGraph<int, int>;
+
+void test_packed_width_follows_the_widest_value() {
+    PackedColumn<int64_t> column;
+    for (int64_t i = -500; i < 500; i++) {
+        column.set(static_cast<size_t>(i + 500), i * 3);
+    }
+    assert(column.bits() == 12 && column.get(0) == -1500 && column.get(999) == 1497);
+    column.set(2000, INT64_MIN);
+    assert(column.bits() == 64 && column.get(2000) == INT64_MIN && column.get(1500) == 0);
+    assert(column.get(5) == -1485 && column.size() == 2001);
+}
+
+void test_dictionary_keeps_every_string_once() {
+    DictionaryColumn column;
+    for (size_t i = 0; i < 1000; i++) {
+        column.set(i, std::string(100, 'a') + std::to_string(i % 500));
+    }
+    assert(column.cardinality() == 501 && column.code(0) == column.code(500));
+    assert(column.find(std::string(100, 'a') + "7") == column.code(7));
+    assert(column.find("b") == DictionaryColumn::NONE && column.find("") == 0);
+    // the strings take about 50 kB, a second copy of them would double that
+    assert(column.memory_usage() < 100000);
+    // a copy looks its strings up by its own dictionary
+    std::unique_ptr<PropertyColumn> cloned = column.clone();
+    DictionaryColumn& copy = static_cast<DictionaryColumn&>(*cloned);
+    copy.set(3, "copied");
+    copy.set(4, std::string(100, 'a') + "9");
+    assert(copy.find("copied") == 501 && column.find("copied") == DictionaryColumn::NONE);
+    assert(copy.get(4) == column.get(9) && copy.cardinality() == 502);
+    column.set(1, "original");
+    assert(column.find("original") == 501 && copy.value(501) == "copied");
+    assert(column.get(3) == std::string(100, 'a') + "3");
+}
+
+void test_rows_bound_by_the_nodes_and_edges() {
+    TestGraph graph;
+    build_chain(graph, 10);
+    PackedColumn<int>& weight = graph.nodes().properties().add<int>("weight");
+    weight.set(9, 1);
+    bool thrown = false;
+    try {
+        weight.set(10, 1);
+    }
+    catch (const NonexistingItemException&) {
+        thrown = true;
+    }
+    assert(thrown && weight.size() == 10);
+    thrown = false;
+    try {
+        graph.edges().properties().add<std::string>("label").set(9, "past the last edge");
+    }
+    catch (const NonexistingItemException&) {
+        thrown = true;
+    }
+    assert(thrown && std::as_const(graph).edges().properties().column<std::string>("label")
+        .size() == 0);
+    // a copy takes rows as its own nodes are added, the original keeps its bound
+    TestGraph copy(graph);
+    copy.nodes().add(10);
+    copy.nodes().properties().column<int>("weight").set(10, 2);
+    graph.nodes().add(10);
+    graph.nodes().add(11);
+    graph.nodes().properties().column<int>("weight").set(11, 3);
+    assert(std::as_const(copy).nodes().properties().column<int>("weight").get(10) == 2);
+    assert(std::as_const(graph).nodes().properties().column<int>("weight").get(10) == 0);
+    // columns outside of a graph have no bound
+    PlainColumn<double> unbound;
+    unbound.set(1000000, 0.5);
+    assert(unbound.size() == 1000001);
+}
+
+int main() {
+    test_packed_width_follows_the_widest_value();
+    test_dictionary_keeps_every_string_once();
+    test_rows_bound_by_the_nodes_and_edges();
+    std::cout << "PropertiesTest passed" << std::endl;
+    return 0;
+}
\ No newline at end of file
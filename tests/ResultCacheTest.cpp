@@ -0,0 +1,56 @@
+#include <cassert>
+#include <iostream>
+#include "Graph.h"
+
+/// @file ResultCacheTest.cpp
+/// @brief Tests that the ResultCache tells apart the keys of distinct parameters
+
+
+/// @brief Runs an algorithm through the cache and tells if it had to be computed
+/// @tparam Parameters The types of the parameters
+/// @param cache The cache
+/// @param parameters The parameters of the algorithm
+/// @return True if the result was computed, false if it was cached
+template <typename... Parameters>
+bool computed(ResultCache& cache, const Parameters&... parameters) {
+    bool ran = false;
+    cache.get<int>(0, "algorithm", [&]() { ran = true; return 0; }, parameters...);
+    return ran;
+}
+
+void test_close_floating_point_parameters_miss() {
+    ResultCache cache;
+    assert(computed(cache, 0.85000001));
+    assert(computed(cache, 0.85000002));
+    assert(!computed(cache, 0.85000001));
+    assert(computed(cache, 0.85000001f));
+    assert(computed(cache, 1.0 + 1e-15));
+    assert(computed(cache, 1.0));
+}
+
+void test_strings_with_separators_miss() {
+    ResultCache cache;
+    assert(computed(cache, std::string("a\x1f" "b")));
+    assert(computed(cache, std::string("a"), std::string("b")));
+    assert(computed(cache, std::string("a\x1f" "1:b")));
+    assert(computed(cache, std::string("a"), 1, std::string("b")));
+    assert(!computed(cache, std::string("a"), std::string("b")));
+}
+
+void test_parameter_counts_miss() {
+    ResultCache cache;
+    assert(computed(cache));
+    assert(computed(cache, std::string()));
+    assert(computed(cache, std::string(), std::string()));
+    assert(computed(cache, 12));
+    assert(computed(cache, 1, 2));
+    assert(!computed(cache, 1, 2));
+}
+
+int main() {
+    test_close_floating_point_parameters_miss();
+    test_strings_with_separators_miss();
+    test_parameter_counts_miss();
+    std::cout << "ResultCacheTest passed" << std::endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#ifndef __TEST_GRAPHS_H
+#define __TEST_GRAPHS_H
+
+#include <cstddef>
+#include "Graph.h"
+
+
+/// @file TestGraphs.h
+/// @brief Contains the graphs the tests are run on
+
+
+/// @brief Adds a chain of nodes to the graph, node i holds i and is connected to node i + 1 by
+///  the edge i holding i
+/// @tparam GraphType The type of the graph, its node and edge data constructible from an int
+/// @param graph The graph to add the chain to, expected to be empty
+/// @param nodes The number of nodes of the chain
+template <typename GraphType>
+void build_chain(GraphType& graph, size_t nodes) {
+    for (size_t i = 0; i < nodes; i++) {
+        graph.nodes().add(static_cast<int>(i));
+    }
+    for (size_t i = 0; i + 1 < nodes; i++) {
+        graph.edges().add(i, i + 1, static_cast<int>(i));
+    }
+}
+
+
+#endif
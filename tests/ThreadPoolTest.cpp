@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "ThreadPool.h"
+
+/// @file ThreadPoolTest.cpp
+/// @brief Tests that the work-stealing thread pool runs every index exactly once whatever its
+///  size, the grain and the nesting, that idle workers take over the halves split off, and that
+///  an exception thrown by the function reaches the caller
+
+
+/// @brief Makes the options of a pool with the given number of workers
+/// @param threads The number of workers
+/// @return The options
+ThreadPoolOptions with_threads(size_t threads) {
+    ThreadPoolOptions options;
+    options.threads = threads;
+    return options;
+}
+
+void test_every_index_runs_once() {
+    for (size_t threads : { 0, 1, 3 }) {
+        ThreadPool pool(with_threads(threads));
+        assert(pool.thread_count() == threads);
+        for (size_t grain : { 0, 1, 17 }) {
+            std::vector<int> runs(10007, 0);
+            pool.parallel_for(0, runs.size(), [&](size_t i) { ++runs[i]; }, grain);
+            assert(std::all_of(runs.begin(), runs.end(), [](int count) { return count == 1; }));
+            std::vector<std::pair<size_t, size_t>> ranges;
+            std::mutex mutex;
+            pool.parallel_for_ranges(5, 1005, [&](size_t begin, size_t end) {
+                std::lock_guard<std::mutex> lock(mutex);
+                ranges.emplace_back(begin, end);
+            }, grain);
+            std::sort(ranges.begin(), ranges.end());
+            size_t next = 5;
+            for (const std::pair<size_t, size_t>& range : ranges) {
+                assert(range.first == next && range.second > range.first);
+                next = range.second;
+            }
+            assert(next == 1005);
+        }
+        std::vector<NumaPartition> partitions = {
+            { 0, 300, 0 }, { 300, 310, 1 }, { 310, 1000, 0 }
+        };
+        std::vector<int> runs(1000, 0);
+        pool.parallel_for_partitioned(partitions, [&](size_t i) { ++runs[i]; }, 8);
+        assert(std::all_of(runs.begin(), runs.end(), [](int count) { return count == 1; }));
+        pool.parallel_for(7, 7, [](size_t) { assert(false); });
+    }
+}
+
+void test_idle_workers_take_over_halves() {
+    ThreadPool pool(with_threads(3));
+    // both halves wait for each other, so they only finish if two threads run them
+    std::atomic<int> started(0);
+    std::atomic<bool> met(true);
+    pool.parallel_for(0, 2, [&](size_t) {
+        ++started;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (started.load() < 2) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                met = false;
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }, 1);
+    assert(met.load() && started.load() == 2);
+}
+
+void test_nested_and_concurrent_callers() {
+    ThreadPool pool(with_threads(3));
+    std::vector<std::thread> callers;
+    for (int caller = 0; caller < 3; caller++) {
+        callers.emplace_back([&]() {
+            for (int repeat = 0; repeat < 20; repeat++) {
+                std::atomic<size_t> sum(0);
+                pool.parallel_for_ranges(5, 1005, [&](size_t begin, size_t end) {
+                    std::atomic<size_t> inner(0);
+                    pool.parallel_for(begin, end, [&](size_t i) { inner += i; }, 2);
+                    sum += inner.load();
+                }, 50);
+                assert(sum.load() == 1004 * 1005 / 2 - 10);
+            }
+        });
+    }
+    for (std::thread& caller : callers) {
+        caller.join();
+    }
+    std::atomic<size_t> count(0);
+    ThreadPool::global().parallel_for(0, 100, [&](size_t) { ++count; });
+    assert(count.load() == 100);
+}
+
+void test_exception_reaches_the_caller() {
+    for (size_t threads : { 0, 3 }) {
+        ThreadPool pool(with_threads(threads));
+        std::atomic<size_t> runs(0);
+        bool thrown = false;
+        try {
+            pool.parallel_for(0, 1000, [&](size_t i) {
+                ++runs;
+                if (i == 500) throw std::runtime_error("failed");
+            }, 10);
+        }
+        catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown && runs.load() <= 1000);
+        // the pool keeps working afterwards
+        runs = 0;
+        pool.parallel_for(0, 1000, [&](size_t) { ++runs; }, 10);
+        assert(runs.load() == 1000);
+    }
+}
+
+int main() {
+    test_every_index_runs_once();
+    test_idle_workers_take_over_halves();
+    test_nested_and_concurrent_callers();
+    test_exception_reaches_the_caller();
+    std::cout << "ThreadPoolTest passed" << std::endl;
+    return 0;
+}
\ No newline at end of file